@@ -22,11 +22,18 @@
 	результат, если вы хотите использовать его в дальнейшем.
 	Если вы хотите расширить функционал (сделать длительные нажатия и прочее), то используйте метод getTimeInCurrentState(). Он вернёт количество времени, в течении
 	которого кнопка находится в стабильном состоянии. Также, если вы хотите узнать, сколько времени кнопка была в предыдущем состоянии, используйте метот getTimeInLastState().
+	Метод isSettling() возвращает true, пока уровень на ноге отличается от стабильного состояния кнопки (идёт подавление дребезга). Пока он возвращает false
+	и кнопка отпущена, processStep() можно не вызывать - так менеджер сна (SleepManager) решает, можно ли уснуть до смены уровня на ноге.
 	Дописано за один вечер. ExtNeon. 07.12.2017
 */
 
 #include "Arduino.h"
 #include "HandledButton.h"
+#ifdef MYLIB_PROFILE
+	#include "Profiler.h"
+#else
+	#define PROFILER_SCOPE(id)
+#endif
 
 
 
@@ -59,6 +66,12 @@ boolean HandledButton::isClicked() {
 	return temp;
 }
 
+boolean HandledButton::isSettling() {
+	boolean dev_gettedState = digitalRead(_pin);
+	dev_gettedState = dev_buttonActiveState ? dev_gettedState : !dev_gettedState;
+	return dev_gettedState != dev_currentStableState || dev_lastReadedState != dev_currentStableState;
+}
+
 void HandledButton::attachHandlerToPushDown(void (*interruptFunc)()) {
 	pushDownHandler = interruptFunc;
 }
@@ -89,6 +102,7 @@ void HandledButton::processHandlers() {
 }
 
 void HandledButton::processStep() {
+	PROFILER_SCOPE(PROFILER_ID_BUTTON_STEP);
 	boolean dev_gettedState = digitalRead(_pin);
 	dev_gettedState = dev_buttonActiveState ? dev_gettedState : !dev_gettedState;
 	
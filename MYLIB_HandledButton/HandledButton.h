@@ -22,6 +22,8 @@
 	результат, если вы хотите использовать его в дальнейшем.
 	Если вы хотите расширить функционал (сделать длительные нажатия и прочее), то используйте метод getTimeInCurrentState(). Он вернёт количество времени, в течении
 	которого кнопка находится в стабильном состоянии. Также, если вы хотите узнать, сколько времени кнопка была в предыдущем состоянии, используйте метот getTimeInLastState().
+	Метод isSettling() возвращает true, пока уровень на ноге отличается от стабильного состояния кнопки (идёт подавление дребезга). Пока он возвращает false
+	и кнопка отпущена, processStep() можно не вызывать - так менеджер сна (SleepManager) решает, можно ли уснуть до смены уровня на ноге.
 	Дописано за один вечер. ExtNeon. 07.12.2017
 */
 
@@ -49,6 +51,7 @@ class HandledButton {
 		unsigned long getTimeInLastState();
 		boolean isPressed();
 		boolean isClicked();
+		boolean isSettling();
 		void processStep();
 		void processHandlers();
 	private:
@@ -0,0 +1,153 @@
+/**
+	EventTask_h - кооперативные задачи без собственного стека (в духе protothreads) поверх HandledEventTimer: вместо флагов и конечных автоматов
+	логика пишется последовательно, с ожиданиями посередине функции.
+	Задача - объект EventTask с функцией void тело(EventTask &task). Тело начинается макросом TASK_BEGIN(task) и кончается TASK_END(task),
+	между ними можно ждать:
+		* TASK_SLEEP_FOR(task, интервал) - заснуть на интервал в единицах таймера (обычно миллисекунды). Пробуждение планирует сам таймер:
+			у каждой задачи своё событие, и processStep() считает его так же, как остальные события.
+		* TASK_WAIT_FLAG(task, флаг) - ждать, пока volatile boolean флаг (например, поднятый в прерывании) станет true. Флаг проверяет
+			планировщик, не входя в тело задачи, и при пробуждении сбрасывает его в false.
+		* TASK_WAIT_UNTIL(task, условие) - ждать произвольного условия. Тело вызывается на каждом проходе processTasks(), чтобы проверить условие.
+		* TASK_WAIT_BUTTON(task, кнопка) - ждать нового клика HandledButton (кнопку нажали и отпустили, isClicked()); клик до начала ожидания не считается.
+		* TASK_YIELD(task) - уступить очередь остальным задачам до следующего прохода. TASK_EXIT(task) - закончить задачу досрочно.
+	Как в protothreads, локальные переменные тела между ожиданиями не сохраняются: храните состояние в статических переменных или в
+	объекте, переданном как контекст (getContext()). Макросы построены на switch и номере строки, поэтому внутри своего switch тела ждать нельзя,
+	и на одной строке может быть только одно ожидание. Если условие TASK_WAIT_UNTIL уже выполнено, задача не останавливается.
+	Планировщик TaskScheduler(таймер) хранит задачи списком (без кучи). addTask(задача) занимает в таймере одно событие без обработчика
+	(его флаг processHandlers() не трогает) и возвращает false, если массив событий таймера заполнен. В loop() вызывается processTasks():
+	он возобновляет задачи, которые проснулись (событие сработало или флаг поднят) или ждут условия.
+	Спящая задача стоит processStep() одного сложения, ждущая флага или условия - одной проверки (её событие выключено), закончившаяся - тоже.
+	Память на задачу на плате: 13 байт EventTask и 17 байт события HandledEvent.
+		HandledEventTimer timer(1);
+		TaskScheduler scheduler(timer);
+		void blink(EventTask &task) {
+			TASK_BEGIN(task);
+			while (true) {
+				digitalWrite(13, HIGH);
+				TASK_SLEEP_FOR(task, 100);
+				digitalWrite(13, LOW);
+				TASK_SLEEP_FOR(task, 900);
+			}
+			TASK_END(task);
+		}
+		EventTask blinker(blink);
+		setup(): scheduler.addTask(blinker); timer.start();   loop(): scheduler.processTasks();   по тику: timer.processStep();
+	restart() начинает задачу заново, isFinished() - дошла ли задача до TASK_END.
+	ExtNeon.
+*/
+
+#include "EventTask.h"
+
+EventTask::EventTask(void (*body)(EventTask &task), void *context) {
+	dev_body = body;
+	dev_context = context;
+	dev_next = NULL;
+	dev_flag = NULL;
+	dev_timer = NULL;
+	dev_resumePoint = 0;
+	dev_eventId = HET_NO_EVENT_ID;
+	dev_state = TASK_READY;
+}
+
+void *EventTask::getContext() {
+	return dev_context;
+}
+
+byte EventTask::getState() {
+	return dev_state;
+}
+
+boolean EventTask::isFinished() {
+	return dev_state == TASK_FINISHED;
+}
+
+void EventTask::restart() {
+	if (dev_timer != NULL) dev_timer->disableEvent(dev_eventId);
+	dev_resumePoint = 0;
+	dev_state = TASK_READY;
+}
+
+word EventTask::getResumePoint() {
+	return dev_resumePoint;
+}
+
+void EventTask::setResumePoint(word point) {
+	dev_resumePoint = point;
+}
+
+void EventTask::sleepFor(unsigned long interval) {
+	if (dev_timer == NULL) return; //Задача не добавлена в планировщик
+	uint8_t oldSREG = SREG;
+	cli(); //processStep() может вызываться из прерывания посреди записи счётчика
+	dev_timer->setEventInterval(dev_eventId, interval);
+	dev_timer->resetEvent(dev_eventId); //Счёт с нуля, флаг сброшен, событие включено
+	SREG = oldSREG;
+	dev_state = TASK_SLEEPING;
+}
+
+void EventTask::waitFlag(volatile boolean *flag) {
+	dev_flag = flag;
+	dev_state = TASK_WAITING_FLAG;
+}
+
+void EventTask::waitCondition() {
+	dev_state = TASK_WAITING;
+}
+
+void EventTask::yield() {
+	dev_state = TASK_READY;
+}
+
+void EventTask::finish() {
+	if (dev_timer != NULL) dev_timer->disableEvent(dev_eventId);
+	dev_state = TASK_FINISHED;
+}
+
+TaskScheduler::TaskScheduler(HandledEventTimer &timer) {
+	dev_timer = &timer;
+	dev_first = NULL;
+	dev_last = NULL;
+	dev_tasksCount = 0;
+}
+
+boolean TaskScheduler::addTask(EventTask &task) {
+	if (task.dev_timer != NULL) return false; //Уже в планировщике
+	word eventId = dev_timer->createEvent(HET_NO_EVENT, NULL);
+	if (eventId == HET_NO_EVENT_ID) return false;
+	dev_timer->disableEvent(eventId);
+	task.dev_timer = dev_timer;
+	task.dev_eventId = eventId;
+	task.dev_next = NULL;
+	if (dev_last == NULL) {
+		dev_first = &task;
+	} else {
+		dev_last->dev_next = &task;
+	}
+	dev_last = &task;
+	dev_tasksCount++;
+	return true;
+}
+
+void TaskScheduler::processTasks() {
+	for (EventTask *task = dev_first; task != NULL; task = task->dev_next) {
+		switch (task->dev_state) {
+			case TASK_SLEEPING:
+				//Однократное событие выключается в том же processStep(), где поднят флаг, - проверка без гонки с прерыванием
+				if (dev_timer->isEventActive(task->dev_eventId)) continue;
+				dev_timer->getEventState(task->dev_eventId);
+				break;
+			case TASK_WAITING_FLAG:
+				if (!*task->dev_flag) continue;
+				*task->dev_flag = false;
+				break;
+			case TASK_FINISHED:
+				continue;
+		}
+		task->dev_state = TASK_READY;
+		task->dev_body(*task);
+	}
+}
+
+word TaskScheduler::getTasksCount() {
+	return dev_tasksCount;
+}
@@ -0,0 +1,103 @@
+/**
+	EventTask_h - кооперативные задачи без собственного стека (в духе protothreads) поверх HandledEventTimer: вместо флагов и конечных автоматов
+	логика пишется последовательно, с ожиданиями посередине функции.
+	Задача - объект EventTask с функцией void тело(EventTask &task). Тело начинается макросом TASK_BEGIN(task) и кончается TASK_END(task),
+	между ними можно ждать:
+		* TASK_SLEEP_FOR(task, интервал) - заснуть на интервал в единицах таймера (обычно миллисекунды). Пробуждение планирует сам таймер:
+			у каждой задачи своё событие, и processStep() считает его так же, как остальные события.
+		* TASK_WAIT_FLAG(task, флаг) - ждать, пока volatile boolean флаг (например, поднятый в прерывании) станет true. Флаг проверяет
+			планировщик, не входя в тело задачи, и при пробуждении сбрасывает его в false.
+		* TASK_WAIT_UNTIL(task, условие) - ждать произвольного условия. Тело вызывается на каждом проходе processTasks(), чтобы проверить условие.
+		* TASK_WAIT_BUTTON(task, кнопка) - ждать нового клика HandledButton (кнопку нажали и отпустили, isClicked()); клик до начала ожидания не считается.
+		* TASK_YIELD(task) - уступить очередь остальным задачам до следующего прохода. TASK_EXIT(task) - закончить задачу досрочно.
+	Как в protothreads, локальные переменные тела между ожиданиями не сохраняются: храните состояние в статических переменных или в
+	объекте, переданном как контекст (getContext()). Макросы построены на switch и номере строки, поэтому внутри своего switch тела ждать нельзя,
+	и на одной строке может быть только одно ожидание. Если условие TASK_WAIT_UNTIL уже выполнено, задача не останавливается.
+	Планировщик TaskScheduler(таймер) хранит задачи списком (без кучи). addTask(задача) занимает в таймере одно событие без обработчика
+	(его флаг processHandlers() не трогает) и возвращает false, если массив событий таймера заполнен. В loop() вызывается processTasks():
+	он возобновляет задачи, которые проснулись (событие сработало или флаг поднят) или ждут условия.
+	Спящая задача стоит processStep() одного сложения, ждущая флага или условия - одной проверки (её событие выключено), закончившаяся - тоже.
+	Память на задачу на плате: 13 байт EventTask и 17 байт события HandledEvent.
+		HandledEventTimer timer(1);
+		TaskScheduler scheduler(timer);
+		void blink(EventTask &task) {
+			TASK_BEGIN(task);
+			while (true) {
+				digitalWrite(13, HIGH);
+				TASK_SLEEP_FOR(task, 100);
+				digitalWrite(13, LOW);
+				TASK_SLEEP_FOR(task, 900);
+			}
+			TASK_END(task);
+		}
+		EventTask blinker(blink);
+		setup(): scheduler.addTask(blinker); timer.start();   loop(): scheduler.processTasks();   по тику: timer.processStep();
+	restart() начинает задачу заново, isFinished() - дошла ли задача до TASK_END.
+	ExtNeon.
+*/
+
+#ifndef EventTask_h
+#define EventTask_h
+
+#include "Arduino.h"
+#include "HandledEventTimer.h"
+
+#define TASK_READY 0
+#define TASK_SLEEPING 1
+#define TASK_WAITING_FLAG 2
+#define TASK_WAITING 3
+#define TASK_FINISHED 4
+
+#define TASK_BEGIN(task) switch ((task).getResumePoint()) { case 0:
+#define TASK_END(task) } (task).finish(); return
+#define DEV_TASK_SUSPEND(task) (task).setResumePoint(__LINE__); return; case __LINE__:;
+#define TASK_SLEEP_FOR(task, interval) do { (task).sleepFor(interval); DEV_TASK_SUSPEND(task); } while (0)
+#define TASK_WAIT_FLAG(task, flag) do { (task).waitFlag(&(flag)); DEV_TASK_SUSPEND(task); } while (0)
+#define TASK_WAIT_UNTIL(task, condition) do { (task).setResumePoint(__LINE__); if (0) { case __LINE__:; } if (!(condition)) { (task).waitCondition(); return; } } while (0) //if (0) - без проваливания в метку case
+#define TASK_WAIT_BUTTON(task, button) do { (button).isClicked(); TASK_WAIT_UNTIL(task, (button).isClicked()); } while (0)
+#define TASK_YIELD(task) do { (task).yield(); DEV_TASK_SUSPEND(task); } while (0)
+#define TASK_EXIT(task) do { (task).finish(); return; } while (0)
+
+class TaskScheduler;
+
+class EventTask {
+	public:
+		EventTask(void (*body)(EventTask &task), void *context = NULL);
+		void *getContext();
+		byte getState();
+		boolean isFinished();
+		void restart();
+		//Для макросов TASK_*
+		word getResumePoint();
+		void setResumePoint(word point);
+		void sleepFor(unsigned long interval);
+		void waitFlag(volatile boolean *flag);
+		void waitCondition();
+		void yield();
+		void finish();
+	private:
+		friend class TaskScheduler;
+		void (*dev_body)(EventTask &task);
+		void *dev_context;
+		EventTask *dev_next;
+		volatile boolean *dev_flag;
+		HandledEventTimer *dev_timer;
+		word dev_resumePoint; //Строка последнего ожидания, 0 - начало тела
+		word dev_eventId;
+		byte dev_state;
+};
+
+class TaskScheduler {
+	public:
+		TaskScheduler(HandledEventTimer &timer);
+		boolean addTask(EventTask &task);
+		void processTasks();
+		word getTasksCount();
+	private:
+		HandledEventTimer *dev_timer;
+		EventTask *dev_first;
+		EventTask *dev_last;
+		word dev_tasksCount;
+};
+
+#endif
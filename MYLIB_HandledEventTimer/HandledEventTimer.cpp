@@ -9,25 +9,62 @@
 	Текущее состояние события можно проверить с помощью метода getEventState(), которому нужно передать ID события. Он возвращает булевое значение.
 	При его вызове, флаг события сбрасывается и вызов обработчика будет пропущен.
 	Можно прямо на лету менять интервал, деактивировать определённые события, останавливать весь таймер вообще.
+	Метод getTimeToNextEvent() возвращает, сколько осталось до ближайшего события (в тех же единицах, что и интервалы), или HET_NO_EVENT, если ждать нечего.
+	Так менеджер сна (SleepManager) узнаёт, сколько можно спать. Проспанное время затем учитывается вызовом processMcsStep(проспанное время).
+	Массив событий таймер по умолчанию выделяет сам и расширяет через realloc() при каждом createEvent(). Без кучи: передайте свой массив в конструктор
+	HandledEventTimer(интервал, массив HandledEvent, его размер) или создайте StaticHandledEventTimer<N>(интервал) - массив на N событий внутри объекта.
+	Тогда createEvent() возвращает HET_NO_EVENT_ID, когда массив заполнен. С флагом компиляции MYLIB_STATIC конструктора без массива нет.
+	Обработчик события может быть NULL: такие события processHandlers() пропускает, не сбрасывая флаг, - его читает владелец события через
+	getEventState(). На этом построены задачи EventTask (см. EventTask.h), которые пишутся последовательно и ждут через TASK_SLEEP_FOR().
 	Написано за один вечер. ExtNeon. 08.11.2017
 */
 #include "Arduino.h"
 #include "HandledEventTimer.h"
+#ifdef MYLIB_PROFILE
+	#include "Profiler.h"
+#else
+	#define PROFILER_SCOPE(id)
+#endif
 
 
 
+#ifndef MYLIB_STATIC
 HandledEventTimer::HandledEventTimer(word timerInterval) {
   events = NULL;
   enabled = false;
   dev_eventCount = 0;
+  dev_eventCapacity = 0;
+  dev_timerInterval = timerInterval;
+}
+#endif
+
+HandledEventTimer::HandledEventTimer(word timerInterval, HandledEvent *eventsBuffer, word capacity) {
+  events = eventsBuffer;
+  enabled = false;
+  dev_eventCount = 0;
+  dev_eventCapacity = eventsBuffer == NULL ? 0 : capacity;
   dev_timerInterval = timerInterval;
 }
 
 word HandledEventTimer::createEvent(unsigned long eventInterval, void (*eventHandler)()) {
+#ifdef MYLIB_STATIC
+  if (dev_eventCount >= dev_eventCapacity) return HET_NO_EVENT_ID;
+#else
+  if (dev_eventCapacity != 0 && dev_eventCount >= dev_eventCapacity) return HET_NO_EVENT_ID;
+#endif
   boolean lastEnabledState = enabled;
   enabled = false;
+#ifndef MYLIB_STATIC
+  if (dev_eventCapacity == 0) {
+    HandledEvent *grown = (HandledEvent *)realloc(events, sizeof(HandledEvent) * (dev_eventCount + 1));
+    if (grown == NULL) {
+      enabled = lastEnabledState;
+      return HET_NO_EVENT_ID;
+    }
+    events = grown;
+  }
+#endif
   dev_eventCount++;
-  events = (HandledEvent *)realloc(events, sizeof(HandledEvent) * dev_eventCount);
   events[dev_eventCount-1].flag = false;
   events[dev_eventCount-1].interval = eventInterval;
   events[dev_eventCount-1].counter = 0;
@@ -103,6 +140,24 @@ boolean HandledEventTimer::getEventState(word eventId) {
   return temp_flag;
 }
 
+unsigned long HandledEventTimer::getTimeToNextEvent() {
+  if (!enabled) return HET_NO_EVENT;
+  unsigned long nearest = HET_NO_EVENT;
+  for (word i = 0; i < dev_eventCount; i++) {
+	uint8_t oldSREG = SREG;
+	cli(); //processStep() может вызываться из прерывания посреди чтения 4-байтных счётчика и интервала
+	boolean active = events[i].active;
+	unsigned long counter = events[i].counter;
+	unsigned long interval = events[i].interval;
+	SREG = oldSREG;
+	if (active) {
+	  unsigned long left = counter < interval ? interval - counter : 0;
+	  if (left < nearest) nearest = left;
+	}
+  }
+  return nearest;
+}
+
 boolean HandledEventTimer::isEventActive(word eventId) {
   if (eventId >= dev_eventCount) return false;
   return events[eventId].active;
@@ -172,8 +227,9 @@ void HandledEventTimer::processMcsStep(word stepWidthMicros) {
 }
 
 void HandledEventTimer::processHandlers() {
+	PROFILER_SCOPE(PROFILER_ID_EVENT_TIMER_HANDLERS);
 	for (int i = 0; i < dev_eventCount; i++) {
-		if (getEventState(i)) {
+		if (events[i].handleProcedure != NULL && getEventState(i)) { //Флаги событий без обработчика читает их владелец (например, EventTask)
 			events[i].handleProcedure();
 		}
 	}
@@ -9,6 +9,13 @@
 	Текущее состояние события можно проверить с помощью метода getEventState(), которому нужно передать ID события. Он возвращает булевое значение.
 	При его вызове, флаг события сбрасывается и вызов обработчика будет пропущен.
 	Можно прямо на лету менять интервал, деактивировать определённые события, останавливать весь таймер вообще.
+	Метод getTimeToNextEvent() возвращает, сколько осталось до ближайшего события (в тех же единицах, что и интервалы), или HET_NO_EVENT, если ждать нечего.
+	Так менеджер сна (SleepManager) узнаёт, сколько можно спать. Проспанное время затем учитывается вызовом processMcsStep(проспанное время).
+	Массив событий таймер по умолчанию выделяет сам и расширяет через realloc() при каждом createEvent(). Без кучи: передайте свой массив в конструктор
+	HandledEventTimer(интервал, массив HandledEvent, его размер) или создайте StaticHandledEventTimer<N>(интервал) - массив на N событий внутри объекта.
+	Тогда createEvent() возвращает HET_NO_EVENT_ID, когда массив заполнен. С флагом компиляции MYLIB_STATIC конструктора без массива нет.
+	Обработчик события может быть NULL: такие события processHandlers() пропускает, не сбрасывая флаг, - его читает владелец события через
+	getEventState(). На этом построены задачи EventTask (см. EventTask.h), которые пишутся последовательно и ждут через TASK_SLEEP_FOR().
 	Написано за один вечер. ExtNeon. 08.11.2017
 */
 
@@ -18,6 +25,9 @@
 
 #include "Arduino.h"
 
+#define HET_NO_EVENT 0xFFFFFFFFUL
+#define HET_NO_EVENT_ID 0xFFFF //createEvent(): массив событий заполнен
+
 class HandledEvent {
 	public:
 		boolean flag;
@@ -33,11 +43,15 @@ class HandledEvent {
 class HandledEventTimer {
   private:
 	word dev_eventCount;
+	word dev_eventCapacity; //0 - массив выделяется в куче
 	boolean enabled;
 	HandledEvent *events;
 	word dev_timerInterval;
   public:
+#ifndef MYLIB_STATIC
 	HandledEventTimer(word timerInterval);
+#endif
+	HandledEventTimer(word timerInterval, HandledEvent *eventsBuffer, word capacity);
 	word createEvent(unsigned long eventInterval, void (*eventHandler)()); 
 	word createRepeatedEvent(unsigned long eventInterval, void (*eventHandler)(), word repeatationCount); //Создать повторяющееся событие.
 	void reset(); //Сбрасывает все счётчики событий 
@@ -50,6 +64,7 @@ class HandledEventTimer {
 	void setEventInterval(word eventId, unsigned long interval); 
 	void setRepeatability(word eventId, boolean repeatIt, word repeatationCount);
 	boolean getEventState(word eventId); //Возвращает состояние события, и сбрасывает его. 
+	unsigned long getTimeToNextEvent(); //Сколько осталось до ближайшего события, HET_NO_EVENT - активных событий нет
 	void resetEvent(word eventId); //Сбрасывает текущий таймер события а также его состояние 
 	void processStep();
 	void processMcsStep(word stepWidthMicros);
@@ -57,4 +72,11 @@ class HandledEventTimer {
 	void processHandlers(); //Вызывается в лупе.
 };
 
+template <word N> class StaticHandledEventTimer : public HandledEventTimer {
+  public:
+	StaticHandledEventTimer(word timerInterval) : HandledEventTimer(timerInterval, dev_storage, N) {}
+  private:
+	HandledEvent dev_storage[N];
+};
+
 #endif
\ No newline at end of file
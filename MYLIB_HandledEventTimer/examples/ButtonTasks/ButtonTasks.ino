@@ -0,0 +1,70 @@
+#include <TickDispatcher.h>
+#include <HandledEventTimer.h>
+#include <EventTask.h>
+#include <HandledButton.h>
+
+// Тик - 1 мс. Светодиод мигает своей задачей, вторая задача по клику кнопки даёт три коротких вспышки на ноге 12.
+// Задачи пишутся последовательно, без флагов и автоматов: между ожиданиями управление возвращается в loop().
+TickDispatcher ticker(1000);
+HandledEventTimer timer(1);
+TaskScheduler scheduler(timer);
+HandledButton button(2, 1);
+
+ISR(TIMER2_COMPA_vect) {
+  ticker.processTick();
+}
+
+void timerTask() {
+  timer.processStep();
+}
+
+void buttonTask() {
+  button.processStep();
+}
+
+void blink(EventTask &task) {
+  TASK_BEGIN(task);
+  while (true) {
+    digitalWrite(13, HIGH);
+    TASK_SLEEP_FOR(task, 100);
+    digitalWrite(13, LOW);
+    TASK_SLEEP_FOR(task, 900);
+  }
+  TASK_END(task);
+}
+
+static byte flashes; // Локальные переменные между ожиданиями не сохраняются
+
+void signal(EventTask &task) {
+  TASK_BEGIN(task);
+  while (true) {
+    TASK_WAIT_BUTTON(task, button);
+    for (flashes = 0; flashes < 3; flashes++) {
+      digitalWrite(12, HIGH);
+      TASK_SLEEP_FOR(task, 50);
+      digitalWrite(12, LOW);
+      TASK_SLEEP_FOR(task, 150);
+    }
+  }
+  TASK_END(task);
+}
+
+EventTask blinker(blink);
+EventTask signaller(signal);
+
+void setup()
+{
+  pinMode(12, OUTPUT);
+  pinMode(13, OUTPUT);
+  scheduler.addTask(blinker);
+  scheduler.addTask(signaller);
+  timer.start();
+  ticker.addTask(timerTask, 1);
+  ticker.addTask(buttonTask, 1);
+  ticker.begin();
+}
+
+void loop()
+{
+  scheduler.processTasks();
+}
@@ -0,0 +1,111 @@
+/**
+	KeyframePlayer_h - проигрыватель ключевых кадров для плавного управления ШИМ: яркость светодиодов, разгон и торможение моторов, положение сервопривода.
+	Работает так же, как PatternPlayer (повторы, пауза, максимальное время воспроизведения, processStep() - см. SequencePlayer.h), но вместо нот
+	воспроизводит ключевые кадры. Кадр - это значение, к которому нужно прийти, время перехода в миллисекундах и форма перехода:
+		* KF_STEP - значение меняется сразу в начале кадра и держится до его конца.
+		* KF_LINEAR - равномерно.
+		* KF_EASE_IN - с разгоном (квадратичная кривая).
+		* KF_EASE_OUT - с торможением.
+		* KF_EASE_IN_OUT - с разгоном и торможением (кривая 3t^2 - 2t^3).
+	Первый кадр начинается от текущего значения проигрывателя (при создании - initialValue), каждый следующий - от значения предыдущего кадра.
+	При повторе первый кадр начинается от значения последнего, поэтому цикл получается без скачков. Кадр с длительностью 0 держит своё значение до остановки.
+	При создании указывается метод с одним целочисленным параметром, который вызывается, только когда выходное значение изменилось, и интервал между
+	вызовами processStep(). Значения от -32768 до 32767, но разность значений соседних кадров не больше 65535.
+	Пример - плавное "дыхание" светодиода:
+		void setLed(int value) {analogWrite(9, value);}
+		const Keyframe breath[] = {{255, 1500, KF_EASE_IN_OUT}, {0, 1500, KF_EASE_IN_OUT}, {0, 500, KF_STEP}};
+		KeyframePlayer led(setLed, 10);
+		...
+		led.play(breath, 3, 1000); //Тысяча повторов
+	Значения считаются в фиксированной точке. Деление выполняется один раз в начале кадра, на каждом шаге - только умножения и сдвиги.
+	При остановке и паузе выход остаётся на текущем значении, а если последовательность закончилась - на значении последнего кадра.
+	Текущее значение возвращает метод getValue().
+	Пока проигрыватель играет, getTimeToNextStep() возвращает 0: значение меняется на каждом шаге, а ШИМ в глубоком сне стоит.
+*/
+
+#include "KeyframePlayer.h"
+
+KeyframePlayer::KeyframePlayer(void (*outputFunc) (int value), unsigned int timerInterval, int initialValue) : SequencePlayer(timerInterval) {
+	_outputFunc = outputFunc;
+	dev_keyframes = NULL;
+	dev_value = initialValue;
+	dev_lastOutput = initialValue;
+	dev_startValue = initialValue;
+	dev_targetValue = initialValue;
+	dev_delta = 0;
+	dev_phaseIncrement = 0;
+	dev_curve = KF_STEP;
+}
+
+void KeyframePlayer::play(const Keyframe *keyframes, int keyframesCount, int repeatationCount, unsigned int duration) {
+	dev_keyframes = keyframes;
+	dev_start(keyframes == NULL ? 0 : keyframesCount, repeatationCount, duration);
+}
+
+unsigned long KeyframePlayer::getTimeToNextStep() {
+	return getState() == PLAYING ? 0 : SP_NO_STEP;
+}
+
+int KeyframePlayer::getValue() {
+	return dev_value;
+}
+
+void KeyframePlayer::dev_loadStep() {
+	if (dev_currentStepIndex >= dev_arrayLength) {
+		dev_stepDuration = 0;
+		return;
+	}
+	const Keyframe *keyframe = &dev_keyframes[dev_currentStepIndex];
+	dev_targetValue = keyframe->value;
+	dev_stepDuration = keyframe->duration;
+	dev_curve = keyframe->curve;
+}
+
+void KeyframePlayer::dev_beginStep() {
+	dev_startValue = dev_value;
+	dev_delta = (long) dev_targetValue - dev_startValue;
+	dev_phaseIncrement = dev_stepDuration > 0 ? (1UL << DEV_KF_INCREMENT_BITS) / dev_stepDuration : 0; //Единственное деление на кадр
+}
+
+void KeyframePlayer::dev_endStep() {
+	dev_value = dev_targetValue; //Пропущенный кадр всё равно должен прийти к своему значению
+}
+
+void KeyframePlayer::dev_updateStep() {
+	if (dev_curve == KF_STEP || dev_stepDuration == 0) {
+		dev_value = dev_targetValue;
+	} else {
+		unsigned long phase = (dev_stepCounter * dev_phaseIncrement) >> (DEV_KF_INCREMENT_BITS - DEV_KF_PHASE_BITS);
+		if (phase > (1UL << DEV_KF_PHASE_BITS)) phase = 1UL << DEV_KF_PHASE_BITS;
+		long offset = (dev_delta * dev_applyCurve(dev_curve, phase) + (1L << (DEV_KF_PHASE_BITS - 1))) >> DEV_KF_PHASE_BITS;
+		dev_value = dev_startValue + offset;
+	}
+	dev_output();
+}
+
+void KeyframePlayer::dev_silence() {
+	dev_output(); //Если последовательность закончилась, выводим значение последнего кадра
+}
+
+void KeyframePlayer::dev_output() {
+	if (dev_value == dev_lastOutput) return;
+	dev_lastOutput = dev_value;
+	_outputFunc(dev_value);
+}
+
+word KeyframePlayer::dev_applyCurve(byte curve, word phase) {
+	const unsigned long one = 1UL << DEV_KF_PHASE_BITS;
+	unsigned long square = ((unsigned long) phase * phase) >> DEV_KF_PHASE_BITS;
+	switch (curve) {
+		case KF_EASE_IN:
+			return square;
+		case KF_EASE_OUT: {
+			unsigned long rest = one - phase;
+			return one - ((rest * rest) >> DEV_KF_PHASE_BITS);
+		}
+		case KF_EASE_IN_OUT:
+			return (square * (3 * one - 2 * (unsigned long) phase)) >> DEV_KF_PHASE_BITS;
+		default:
+			return phase;
+	}
+}
@@ -0,0 +1,74 @@
+/**
+	KeyframePlayer_h - проигрыватель ключевых кадров для плавного управления ШИМ: яркость светодиодов, разгон и торможение моторов, положение сервопривода.
+	Работает так же, как PatternPlayer (повторы, пауза, максимальное время воспроизведения, processStep() - см. SequencePlayer.h), но вместо нот
+	воспроизводит ключевые кадры. Кадр - это значение, к которому нужно прийти, время перехода в миллисекундах и форма перехода:
+		* KF_STEP - значение меняется сразу в начале кадра и держится до его конца.
+		* KF_LINEAR - равномерно.
+		* KF_EASE_IN - с разгоном (квадратичная кривая).
+		* KF_EASE_OUT - с торможением.
+		* KF_EASE_IN_OUT - с разгоном и торможением (кривая 3t^2 - 2t^3).
+	Первый кадр начинается от текущего значения проигрывателя (при создании - initialValue), каждый следующий - от значения предыдущего кадра.
+	При повторе первый кадр начинается от значения последнего, поэтому цикл получается без скачков. Кадр с длительностью 0 держит своё значение до остановки.
+	При создании указывается метод с одним целочисленным параметром, который вызывается, только когда выходное значение изменилось, и интервал между
+	вызовами processStep(). Значения от -32768 до 32767, но разность значений соседних кадров не больше 65535.
+	Пример - плавное "дыхание" светодиода:
+		void setLed(int value) {analogWrite(9, value);}
+		const Keyframe breath[] = {{255, 1500, KF_EASE_IN_OUT}, {0, 1500, KF_EASE_IN_OUT}, {0, 500, KF_STEP}};
+		KeyframePlayer led(setLed, 10);
+		...
+		led.play(breath, 3, 1000); //Тысяча повторов
+	Значения считаются в фиксированной точке. Деление выполняется один раз в начале кадра, на каждом шаге - только умножения и сдвиги.
+	При остановке и паузе выход остаётся на текущем значении, а если последовательность закончилась - на значении последнего кадра.
+	Текущее значение возвращает метод getValue().
+	Пока проигрыватель играет, getTimeToNextStep() возвращает 0: значение меняется на каждом шаге, а ШИМ в глубоком сне стоит.
+*/
+
+#ifndef KeyframePlayer_h
+#define KeyframePlayer_h
+
+#include "Arduino.h"
+#include "SequencePlayer.h"
+
+#define KF_STEP 0
+#define KF_LINEAR 1
+#define KF_EASE_IN 2
+#define KF_EASE_OUT 3
+#define KF_EASE_IN_OUT 4
+
+#define DEV_KF_PHASE_BITS 15 //Положение внутри кадра: 0..2^15
+#define DEV_KF_INCREMENT_BITS 24 //Приращение положения за миллисекунду хранится с запасом точности
+
+struct Keyframe {
+	int value;
+	int duration;
+	byte curve;
+};
+
+class KeyframePlayer : public SequencePlayer {
+	public:
+		KeyframePlayer(void (*outputFunc) (int value), unsigned int timerInterval, int initialValue = 0);
+		void play(const Keyframe *keyframes, int keyframesCount, int repeatationCount = 1, unsigned int duration = 0);
+		using SequencePlayer::play;
+		int getValue();
+		unsigned long getTimeToNextStep();
+	protected:
+		void dev_loadStep();
+		void dev_beginStep();
+		void dev_endStep();
+		void dev_updateStep();
+		void dev_silence();
+	private:
+		void (*_outputFunc) (int value);
+		const Keyframe *dev_keyframes;
+		int dev_value;
+		int dev_lastOutput;
+		int dev_startValue;
+		int dev_targetValue;
+		long dev_delta;
+		unsigned long dev_phaseIncrement;
+		byte dev_curve;
+		void dev_output();
+		static word dev_applyCurve(byte curve, word phase);
+};
+
+#endif
@@ -9,7 +9,17 @@
 			воспроизвести ноту.
 		* Метод без параметров, котрый будет выключать воспроизведение звука.
 		* Интервал между вызовами метода processStep().
+	Либо вместо двух методов указывается нога PP_TIMER1_PIN_A (9) или PP_TIMER1_PIN_B (10): PatternPlayer(нога, интервал). Тогда звук генерирует
+	сам Timer1 в режиме CTC, переключая выход OC1A или OC1B на каждом совпадении, без tone() и без прерываний. Смена ноты - запись предделителя,
+	OCR1A и TCNT1. Для нот по номеру MIDI (playProgmem()) период берётся из таблицы, рассчитанной при компиляции под F_CPU, для частот в герцах
+	(массивы, строки, RTTTL) - одно деление на ноту. Частоты ниже 16 Гц идут с предделителем 64, ниже 2 Гц не опускаются.
+	Пока звучит проигрыватель, Timer1 занят: analogWrite() на ногах 9 и 10 и библиотека Servo работать не будут. В паузах и после остановки
+	Timer1 остановлен, нога в LOW. Ногу нельзя подключать напрямую к динамику без резистора.
 	В параллельном потоке нужно циклически вызывать метод processStep().
+	Если интервал между вызовами непостоянен, вместо него вызывайте processStepMs(unsigned int ms), передавая время до следующего вызова, либо 
+	processStepAt(unsigned long timestamp), передавая текущее время (например, millis()). Если с прошлого вызова прошло больше, чем длится нота, 
+	пропускаются сразу все прошедшие ноты, а остаток времени переходит в следующую. Поэтому мелодия не растягивается и не отстаёт, как бы редко 
+	ни вызывался метод: общая длительность совпадает с суммой длительностей нот с точностью до одного интервала вызова.
 	Для воспроизведения можно использовать несколько способов:
 		* Вызов метода play, в параметры которого нужно обязательно передать целочисленный массив с частотами, целочисленный массив с длительностями и их длину.
 			Остальные два необязательных параметра - количество повторов и максимальная длительность воспроизведения. Если количество повторов = 0, то сигнал не воспроизводится.
@@ -17,7 +27,38 @@
 		* Вызов метода play c передачей ему в параметры отформатированную строку с данными. Её, в свою очередь, можно получить с помощью метода convertInpMelodyToStr, 
 			передав ему два массива с частотами нот и их длительностью и их длину.
 		Если частота ноты = 0, то будет воспроизводиться тишина.
-	Можно остановить воспроизведение, вызвав метод stop(). После этого можно запустить мелодию методом play(). При этом воспроизведение начнётся с нуля.
+		* Вызов метода play c передачей ему строки формата @N#f,d%f,d%...! в виде const char*. Строка разбирается за один проход без копирования и без 
+			выделения памяти под каждую ноту. Ноты записываются в буфер, заданный методом setMelodyBuffer(int* freqArray, int* durationArray, int capacity). 
+			Если буфер не задан, проигрыватель один раз выделяет его сам и в дальнейшем только расширяет при необходимости. Вариант play(String) работает так же.
+			Если строка ошибочна, воспроизведение останавливается, а код ошибки (PP_PARSE_ERR_*) можно узнать методом getParseError().
+		* Вызов метода playProgmem(const uint16_t* melody, int notesCount, byte durationUnit, ...) - воспроизведение упакованной мелодии прямо из флеш-памяти
+			(PROGMEM). Каждая нота занимает 2 байта: старший байт - номер ноты по MIDI (69 = ля первой октавы, 440Гц; 0 = пауза), младший - длительность
+			в единицах durationUnit миллисекунд (по умолчанию 10). Ноты читаются по одной в момент смены ноты, поэтому расход оперативной памяти не зависит от 
+			длины мелодии. Ноты удобно записывать макросами PP_NOTE(номер, длительность) и PP_REST(длительность):
+				const uint16_t alarm[] PROGMEM = {PP_NOTE(69, 20), PP_REST(5), PP_NOTE(81, 20)};
+				player.playProgmem(alarm, 3);
+			Частоту ноты по её номеру возвращает статический метод noteToFrequency(byte note). Номера выше PP_MAX_NOTE = 127 (за пределами MIDI) звучат
+			как пауза, а нота длиннее 32767 миллисекунд (255 единиц по 255 мс) укорачивается до этого значения - длительность шага хранится в int.
+		* Вызов метода playRtttl(const char* rtttl, ...) - воспроизведение мелодии в формате RTTTL. Мелодия компилируется в буфер нот так же, как строка
+			для play(const char*). Подробнее о формате и о компиляции RTTTL на компьютере - в файле Rtttl.h.
+		Для разбора строки в свои массивы без воспроизведения используйте статический метод parseMelody(const char* melody, int* freqArray, int* durationArray, 
+		int capacity). Он возвращает количество нот либо отрицательный код ошибки:
+			PP_PARSE_ERR_FORMAT - нарушен формат (неожиданный символ), PP_PARSE_ERR_NUMBER - число не помещается в int, PP_PARSE_ERR_TOO_LONG - нот больше, 
+			чем помещается в массивы, PP_PARSE_ERR_COUNT - количество нот не совпадает с заявленным N, PP_PARSE_ERR_UNTERMINATED - строка кончилась без '!'.
+		Метод convertInpMelodyToBuffer(int* freqArr, int* durationArr, int arrLength, char* buffer, int bufferSize) записывает ту же строку, что и 
+		convertInpMelodyToStr, в ваш буфер (с завершающим нулём). Он возвращает длину строки без нуля, даже если она не поместилась, - так можно узнать нужный размер.
+		Числа в строке могут быть отрицательными, поэтому parseMelody() читает обратно любую строку этих методов.
+	Метод setMuted(boolean muted) заглушает проигрыватель: мелодия продолжает идти, но методы воспроизведения и выключения звука не вызываются. 
+	После снятия заглушения текущая нота звучит заново, на оставшееся ей время. Этим пользуется микшер PlayerMixer (см. PlayerMixer.h), который 
+	делит один выход между несколькими проигрывателями.
+	Отсчёт времени, повторы, пауза и остановка общие для всех проигрывателей и вынесены в класс SequencePlayer (см. SequencePlayer.h). На нём же построен
+	KeyframePlayer - проигрыватель плавных переходов для светодиодов и моторов (см. KeyframePlayer.h).
+	Метод getTimeToNextStep() (см. SequencePlayer.h) во время звучащей ноты возвращает 0: звук генерирует таймер, который в глубоком сне стоит.
+	Во время паузы между нотами он возвращает время до следующей ноты, и менеджер сна (SleepManager) может усыпить контроллер.
+	Без кучи: задайте буфер нот методом setMelodyBuffer() или объявите StaticPatternPlayer<N>(функции звука, интервал) - буфер на N нот внутри объекта.
+	С флагом компиляции MYLIB_STATIC проигрыватель сам буфер не выделяет (без setMelodyBuffer() разбор строки вернёт PP_PARSE_ERR_TOO_LONG),
+	а play(String) и convertInpMelodyToStr() недоступны: String держит строку в куче.
+ После этого можно запустить мелодию методом play(). При этом воспроизведение начнётся с нуля.
 	Приостановить воспроизведение можно методом pause(). При этом, его можно будет продолжить с той же точки, используя метод play().
 	Написано за один вечер. ExtNeon. 08.11.2017
 */
@@ -25,120 +66,155 @@
 
 #include "Arduino.h"
 #include <PatternPlayer.h>
+#include "Rtttl.h"
+#include <limits.h>
 //#include <SignalPattern.h>
 
 
-PatternPlayer::PatternPlayer(void (*toneFunc) (int frequency, int duration), void (*noToneFunc) (), unsigned int timerInterval) {
-	dev_timerInterval = timerInterval;
+PatternPlayer::PatternPlayer(void (*toneFunc) (int frequency, int duration), void (*noToneFunc) (), unsigned int timerInterval) : SequencePlayer(timerInterval) {
 	_toneFunc = toneFunc;
 	_noToneFunc = noToneFunc;
-	dev_currentState = STOPPED;
-	dev_stepCounter = 0;
-	dev_repeatCounter = 0;
-	dev_currentStepIndex = 0;
-	dev_notInitialized = true;
+	dev_timer1Pin = 0;
+	dev_init();
+}
+
+PatternPlayer::PatternPlayer(byte timer1Pin, unsigned int timerInterval) : SequencePlayer(timerInterval) {
+	_toneFunc = NULL;
+	_noToneFunc = NULL;
+	dev_timer1Pin = timer1Pin == PP_TIMER1_PIN_B ? PP_TIMER1_PIN_B : PP_TIMER1_PIN_A;
+	dev_init();
+	digitalWrite(dev_timer1Pin, LOW); //В паузах выход сравнения отключён и нога держит этот уровень
+	pinMode(dev_timer1Pin, OUTPUT);
+}
+
+void PatternPlayer::dev_init() {
 	dev_freqArray = NULL;
 	dev_durationArray = NULL;
+	dev_progmemMelody = NULL;
+	dev_durationUnit = PP_DEFAULT_DURATION_UNIT;
+	dev_stepFrequency = 0;
+	dev_stepNote = DEV_PP_NO_NOTE;
+	dev_bufferFreqArray = NULL;
+	dev_bufferDurationArray = NULL;
+	dev_bufferCapacity = 0;
+	dev_bufferOwned = false;
+	dev_parseError = PP_PARSE_OK;
+	dev_muted = false;
 }
 
 void PatternPlayer::play(int (*freqArray), int (*durationArray), int arrayLength , int repeatationCount, unsigned int duration) {
-	dev_notInitialized = true;
 	dev_freqArray = freqArray;
 	dev_durationArray = durationArray;
-	dev_arrayLength = arrayLength;
-	dev_repeatationCount = repeatationCount;
-	dev_stepCounter = 0;
-	dev_repeatCounter = 0;
-	dev_currentStepIndex = 0;
-	max_duration_timer = 0;
-	max_duration = duration;
-	if (arrayLength == 0) {
-		dev_currentState = STOPPED;
-		return;
-	}
-	dev_currentState = PLAYING;
-	dev_notInitialized = false;
-	newStep = true;
+	dev_progmemMelody = NULL;
+	dev_start(arrayLength, repeatationCount, duration);
 }
 
-/*
-* 
-*/
-void PatternPlayer::processStep() {
-	processStepMs(dev_timerInterval);
+void PatternPlayer::playProgmem(const uint16_t *melody, int notesCount, byte durationUnit, int repeatationCount, unsigned int duration) {
+	dev_progmemMelody = melody;
+	dev_durationUnit = durationUnit;
+	dev_start(melody == NULL ? 0 : notesCount, repeatationCount, duration);
 }
 
-void PatternPlayer::processStepMs(unsigned int ms) {
-	dev_processStepOnly();
-	if (dev_currentState == PLAYING) moveStep(ms);
+static const word DEV_PP_TOP_OCTAVE[12] PROGMEM = {4186, 4435, 4699, 4978, 5274, 5588, 5920, 6272, 6645, 7040, 7459, 7902}; //MIDI 108-119
+
+int PatternPlayer::noteToFrequency(byte note) {
+	if (note == 0 || note > PP_MAX_NOTE) return 0; //Выше MIDI частота не поместилась бы в 16-битный int
+	word topFrequency = pgm_read_word(&DEV_PP_TOP_OCTAVE[note % 12]);
+	byte octave = note / 12;
+	if (octave >= 9) return (unsigned int) topFrequency << (octave - 9);
+	byte shift = 9 - octave;
+	return (topFrequency + (1 << (shift - 1))) >> shift;
 }
 
-void PatternPlayer::dev_processStepOnly() {
-	if (dev_currentState != PLAYING) return;
-	boolean temp_durationCheck = (max_duration_timer >= max_duration && max_duration != 0);
-	if (dev_currentStepIndex >= dev_arrayLength || temp_durationCheck) {
-				if (temp_durationCheck) stop();
-		if (dev_repeatationCount >= 1) {
-			dev_currentStepIndex = 0;
-			if (++dev_repeatCounter >= dev_repeatationCount) stop();
-			return;
-		} else {
-			dev_currentStepIndex = 0;
-		}
-		stop();
-		return;
+//Полупериод нот MIDI 24-35 (первая октава, 32.7-61.7 Гц) в тактах Timer1 с предделителем 8, частоты - в тысячных долях герца
+#define DEV_PP_T1_HALF_PERIOD(milliHertz) ((word) ((F_CPU * 1000ULL / 16 + (milliHertz) / 2) / (milliHertz)))
+static const word DEV_PP_T1_FIRST_OCTAVE[12] PROGMEM = {
+	DEV_PP_T1_HALF_PERIOD(32703), DEV_PP_T1_HALF_PERIOD(34648), DEV_PP_T1_HALF_PERIOD(36708), DEV_PP_T1_HALF_PERIOD(38891),
+	DEV_PP_T1_HALF_PERIOD(41203), DEV_PP_T1_HALF_PERIOD(43654), DEV_PP_T1_HALF_PERIOD(46249), DEV_PP_T1_HALF_PERIOD(48999),
+	DEV_PP_T1_HALF_PERIOD(51913), DEV_PP_T1_HALF_PERIOD(55000), DEV_PP_T1_HALF_PERIOD(58270), DEV_PP_T1_HALF_PERIOD(61735)
+};
+#define DEV_PP_T1_CLOCK_8 _BV(CS11)
+#define DEV_PP_T1_CLOCK_64 (_BV(CS11) | _BV(CS10))
+
+void PatternPlayer::dev_loadStep() {
+	dev_stepNote = DEV_PP_NO_NOTE;
+	if (dev_currentStepIndex >= dev_arrayLength) {
+		dev_stepFrequency = 0;
+		dev_stepDuration = 0;
+	} else if (dev_progmemMelody != NULL) {
+		uint16_t packedNote = pgm_read_word(&dev_progmemMelody[dev_currentStepIndex]);
+		dev_stepNote = packedNote >> 8;
+		if (dev_stepNote > PP_MAX_NOTE) dev_stepNote = 0; //Пауза
+		dev_stepFrequency = noteToFrequency(dev_stepNote);
+		unsigned long stepDuration = (unsigned long) (packedNote & 0xFF) * dev_durationUnit; //На AVR 255 * 255 не помещается в int
+		dev_stepDuration = stepDuration > DEV_PP_MAX_STEP_DURATION ? DEV_PP_MAX_STEP_DURATION : stepDuration;
 	} else {
-		if (newStep && dev_freqArray[dev_currentStepIndex] != 0) {
-			//Serial.println(dev_currentStepIndex + "=" +dev_currentPattern.getStep(dev_currentStepIndex).timerInterval);
-			_noToneFunc();
-			_toneFunc(dev_freqArray[dev_currentStepIndex], dev_durationArray[dev_currentStepIndex]);
-						/*setPeriod(dev_currentPattern.getStep(dev_currentStepIndex).timerInterval);
-			analogWrite(_playerPin, dev_currentPattern.getStep(dev_currentStepIndex).PWM_value);*/
-			newStep = false;
-		} else {
-			if (dev_stepCounter >= dev_durationArray[dev_currentStepIndex] && dev_durationArray[dev_currentStepIndex] != 0) {
-				dev_stepCounter -= dev_durationArray[dev_currentStepIndex];
-				dev_currentStepIndex++;
-				newStep = true;
-			}
-		}
+		dev_stepFrequency = dev_freqArray[dev_currentStepIndex];
+		dev_stepDuration = dev_durationArray[dev_currentStepIndex];
 	}
 }
 
-void PatternPlayer::moveStep(unsigned int moveToMillis) {
-	if (dev_durationArray[dev_currentStepIndex] != 0) {
-		dev_stepCounter += moveToMillis;
+void PatternPlayer::dev_beginStep() {
+	if (dev_muted) return;
+	dev_toneOff();
+	if (dev_stepFrequency != 0) dev_toneOn(dev_stepDuration - (int) dev_stepCounter); //Только оставшееся время ноты
+}
+
+void PatternPlayer::dev_toneOn(int duration) {
+	if (dev_timer1Pin == 0) {
+		_toneFunc(dev_stepFrequency, duration);
+		return;
 	}
-	if (max_duration > 0) {
-		max_duration_timer += moveToMillis;
+	if (dev_stepNote != DEV_PP_NO_NOTE && dev_stepNote >= 12) {
+		word halfPeriod = pgm_read_word(&DEV_PP_T1_FIRST_OCTAVE[dev_stepNote % 12]);
+		byte octave = dev_stepNote / 12;
+		if (octave >= 2) {
+			byte shift = octave - 2;
+			dev_timer1Start(DEV_PP_T1_CLOCK_8, shift == 0 ? halfPeriod - 1 : ((halfPeriod + (1 << (shift - 1))) >> shift) - 1);
+		} else {
+			dev_timer1Start(DEV_PP_T1_CLOCK_64, (halfPeriod >> 2) - 1); //MIDI 12-23: полупериод вдвое длиннее, а предделитель в 8 раз больше
+		}
+		return;
+	}
+	unsigned long frequency = dev_stepFrequency > 0 ? dev_stepFrequency : 1;
+	unsigned long halfPeriod = (F_CPU / 8 + frequency) / (2 * frequency);
+	if (halfPeriod <= 0x10000UL) {
+		dev_timer1Start(DEV_PP_T1_CLOCK_8, halfPeriod - 1);
+	} else {
+		halfPeriod = (halfPeriod + 4) >> 3;
+		dev_timer1Start(DEV_PP_T1_CLOCK_64, halfPeriod <= 0x10000UL ? halfPeriod - 1 : 0xFFFF);
 	}
 }
 
-void PatternPlayer::stop() {
-	dev_currentState = STOPPED;
-	dev_currentStepIndex = 0;
-	dev_stepCounter = 0;
-	dev_repeatCounter = 0;
-	max_duration_timer = 0;
-	_noToneFunc();
-	//Timer1.disablePwm(_playerPin);
+void PatternPlayer::dev_timer1Start(byte clockSelect, word top) {
+	TCCR1B = _BV(WGM12); //CTC, TOP = OCR1A, счётчик стоит
+	OCR1A = top;
+	OCR1B = 0; //Для OC1B: совпадение раз за период, как у OC1A
+	TCNT1 = 0; //Иначе при уменьшении TOP счётчик дошёл бы до 0xFFFF
+	TCCR1A = dev_timer1Pin == PP_TIMER1_PIN_A ? _BV(COM1A0) : _BV(COM1B0); //Переключение выхода на каждом совпадении
+	TCCR1B = _BV(WGM12) | clockSelect;
 }
 
-void PatternPlayer::pause() {
-	dev_currentState = PAUSED;
-	_noToneFunc();
+void PatternPlayer::dev_toneOff() {
+	if (dev_timer1Pin == 0) {
+		_noToneFunc();
+		return;
+	}
+	TCCR1B = 0;
+	TCCR1A = 0; //Нога снова управляется PORTB и держит LOW
 }
 
-void PatternPlayer::play() {
-	if (dev_notInitialized) return; //?сли мы просим невозможного
-	dev_currentState = PLAYING;
+unsigned long PatternPlayer::getTimeToNextStep() {
+	if (getState() == PLAYING && dev_stepFrequency != 0 && !dev_muted) return 0;
+	return SequencePlayer::getTimeToNextStep();
 }
 
-byte PatternPlayer::getState() {
-	return dev_currentState;
+void PatternPlayer::dev_silence() {
+	if (!dev_muted) dev_toneOff();
 }
 
 
+#ifndef MYLIB_STATIC
 String PatternPlayer::convertInpMelodyToStr(int *freqArr, int *durationArr, int arrLength) {
   //@N#f,d%f,d%!
   String tmp = '@' + String(arrLength) + '#';
@@ -148,47 +224,181 @@ String PatternPlayer::convertInpMelodyToStr(int *freqArr, int *durationArr, int
   tmp += '!';
   return tmp;
 }
+#endif
+
+int PatternPlayer::convertInpMelodyToBuffer(int *freqArr, int *durationArr, int arrLength, char *buffer, int bufferSize) {
+	//@N#f,d%f,d%!
+	char *position = buffer;
+	char *end = bufferSize > 0 ? buffer + bufferSize - 1 : buffer; //Последний байт - под завершающий ноль
+	int length = 0;
+	if (position < end) *position++ = '@';
+	length++;
+	position = dev_writeNumber(position, end, arrLength, &length);
+	if (position < end) *position++ = '#';
+	length++;
+	for (int i = 0; i < arrLength; i++) {
+		position = dev_writeNumber(position, end, freqArr[i], &length);
+		if (position < end) *position++ = ',';
+		length++;
+		position = dev_writeNumber(position, end, durationArr[i], &length);
+		if (position < end) *position++ = '%';
+		length++;
+	}
+	if (position < end) *position++ = '!';
+	length++;
+	if (bufferSize > 0) *position = 0;
+	return length;
+}
+
+char *PatternPlayer::dev_writeNumber(char *position, char *end, int value, int *length) {
+	char digits[sizeof(int) * 3]; //Хватает на все цифры int любой разрядности
+	byte count = 0;
+	unsigned int magnitude = value < 0 ? -(long) value : value;
+	if (value < 0) {
+		if (position < end) *position++ = '-';
+		(*length)++;
+	}
+	do {
+		digits[count++] = '0' + magnitude % 10;
+		magnitude /= 10;
+	} while (magnitude > 0);
+	while (count > 0) {
+		if (position < end) *position++ = digits[count - 1];
+		count--;
+		(*length)++;
+	}
+	return position;
+}
 
+const char *PatternPlayer::dev_parseNumber(const char *position, int *value) {
+	boolean negative = *position == '-'; //Так же, как пишет dev_writeNumber()
+	if (negative) position++;
+	if (*position < '0' || *position > '9') return NULL;
+	long result = 0;
+	while (*position >= '0' && *position <= '9') {
+		result = result * 10 + (*position++ - '0');
+		if (result > (long) INT_MAX + negative) return NULL;
+	}
+	*value = negative ? -result : result;
+	return position;
+}
+
+int PatternPlayer::parseMelody(const char *melody, int *freqArray, int *durationArray, int capacity) {
+	//@N#f,d%f,d%!
+	if (melody == NULL) return PP_PARSE_ERR_FORMAT;
+	const char *position = melody;
+	while (*position == ' ' || *position == '\r' || *position == '\n') position++;
+	if (*position++ != '@') return PP_PARSE_ERR_FORMAT;
+	int declaredLength;
+	if ((position = dev_parseNumber(position, &declaredLength)) == NULL) return PP_PARSE_ERR_NUMBER;
+	if (*position++ != '#') return PP_PARSE_ERR_FORMAT;
+	if (declaredLength > capacity) return PP_PARSE_ERR_TOO_LONG;
+	int count = 0;
+	while (*position != '!') {
+		if (*position == 0) return PP_PARSE_ERR_UNTERMINATED;
+		if (count >= declaredLength) return PP_PARSE_ERR_COUNT;
+		if ((position = dev_parseNumber(position, &freqArray[count])) == NULL) return PP_PARSE_ERR_NUMBER;
+		if (*position++ != ',') return PP_PARSE_ERR_FORMAT;
+		if ((position = dev_parseNumber(position, &durationArray[count])) == NULL) return PP_PARSE_ERR_NUMBER;
+		if (*position++ != '%') return PP_PARSE_ERR_FORMAT;
+		count++;
+	}
+	if (count != declaredLength) return PP_PARSE_ERR_COUNT;
+	position++;
+	while (*position == ' ' || *position == '\r' || *position == '\n') position++;
+	if (*position != 0) return PP_PARSE_ERR_FORMAT;
+	return count;
+}
+
+void PatternPlayer::setMelodyBuffer(int *freqArray, int *durationArray, int capacity) {
+	if (dev_currentState != STOPPED && dev_freqArray == dev_bufferFreqArray) stop();
+	freeArrays();
+	dev_bufferFreqArray = freqArray;
+	dev_bufferDurationArray = durationArray;
+	dev_bufferCapacity = capacity;
+	dev_bufferOwned = false;
+}
+
+void PatternPlayer::setMuted(boolean muted) {
+	if (muted == dev_muted) return;
+	if (muted && dev_currentState == PLAYING) dev_toneOff();
+	dev_muted = muted;
+	if (!muted) newStep = true; //Текущая нота прозвучит заново на оставшееся время
+}
+
+boolean PatternPlayer::isMuted() {
+	return dev_muted;
+}
+
+int PatternPlayer::getParseError() {
+	return dev_parseError;
+}
+
+#ifndef MYLIB_STATIC
 void PatternPlayer::play(String inputMelody, int repeatationCount, unsigned int duration) {
+	play(inputMelody.c_str(), repeatationCount, duration);
+}
+#endif
+
+void PatternPlayer::play(const char *inputMelody, int repeatationCount, unsigned int duration) {
 	dev_notInitialized = true;
-	freeArrays();
-	dev_arrayLength = inputMelody.substring(inputMelody.indexOf('@')+1, inputMelody.indexOf('#')).toInt();
-	if (dev_arrayLength == 0) {
-		dev_currentState = STOPPED;
+	dev_currentState = STOPPED;
+	const char *header = inputMelody;
+	while (header != NULL && (*header == ' ' || *header == '\r' || *header == '\n')) header++;
+	int declaredLength = 0;
+	if (header == NULL || *header != '@' || dev_parseNumber(header + 1, &declaredLength) == NULL) {
+		dev_parseError = PP_PARSE_ERR_FORMAT;
 		return;
 	}
-	dev_freqArray = (int*) malloc(sizeof(int) * dev_arrayLength);
-	dev_durationArray = (int*) malloc(sizeof(int) * dev_arrayLength);
-	inputMelody = inputMelody.substring(inputMelody.indexOf('#')+1, inputMelody.length());
-	for (int i = 0; i < dev_arrayLength; i++) {
-		if (inputMelody == "!") {
-			freeArrays();
-			dev_currentState = STOPPED;
-			return;
-		}
-		dev_freqArray[i] = inputMelody.substring(0, inputMelody.indexOf(',')).toInt();
-		dev_durationArray[i] = inputMelody.substring(inputMelody.indexOf(',') + 1, inputMelody.indexOf('%')).toInt();
-		inputMelody = inputMelody.substring(inputMelody.indexOf('%')+1, inputMelody.length());
+	dev_reserveBuffer(declaredLength);
+	int parsedLength = parseMelody(inputMelody, dev_bufferFreqArray, dev_bufferDurationArray, dev_bufferCapacity);
+	if (parsedLength <= 0) {
+		dev_parseError = parsedLength;
+		return;
 	}
-	if (inputMelody.substring(0, 1) != "!") {
-		freeArrays();
-		dev_currentState = STOPPED;
+	dev_parseError = PP_PARSE_OK;
+	play(dev_bufferFreqArray, dev_bufferDurationArray, parsedLength, repeatationCount, duration);
+}
+
+void PatternPlayer::playRtttl(const char *rtttl, int repeatationCount, unsigned int duration) {
+	dev_notInitialized = true;
+	dev_currentState = STOPPED;
+	int notesCount = Rtttl::parse(rtttl, NULL, NULL, 0); //Проверка и подсчёт нот, без записи
+	if (notesCount > 0 && dev_reserveBuffer(notesCount)) {
+		notesCount = Rtttl::compile(rtttl, dev_bufferFreqArray, dev_bufferDurationArray, dev_bufferCapacity);
+	} else if (notesCount > 0) {
+		notesCount = PP_PARSE_ERR_TOO_LONG;
+	}
+	if (notesCount <= 0) {
+		dev_parseError = notesCount;
 		return;
 	}
-	dev_repeatationCount = repeatationCount;
-	dev_stepCounter = 0;
-	dev_repeatCounter = 0;
-	dev_currentStepIndex = 0;
-	max_duration_timer = 0;
-	max_duration = duration;
-	dev_currentState = PLAYING;
-	dev_notInitialized = false;
-	newStep = true;
+	dev_parseError = PP_PARSE_OK;
+	play(dev_bufferFreqArray, dev_bufferDurationArray, notesCount, repeatationCount, duration);
+}
+
+boolean PatternPlayer::dev_reserveBuffer(int length) {
+#ifndef MYLIB_STATIC
+	if (length > dev_bufferCapacity && (dev_bufferOwned || dev_bufferFreqArray == NULL)) { //Свой буфер только расширяем
+		freeArrays();
+		dev_bufferFreqArray = (int*) malloc(sizeof(int) * length);
+		dev_bufferDurationArray = (int*) malloc(sizeof(int) * length);
+		dev_bufferOwned = true;
+		dev_bufferCapacity = dev_bufferFreqArray != NULL && dev_bufferDurationArray != NULL ? length : 0;
+	}
+#endif
+	return length <= dev_bufferCapacity;
 }
 
 void PatternPlayer::freeArrays() {
-	free(dev_durationArray);
-	dev_durationArray = NULL;
-	free(dev_freqArray);
-	dev_freqArray = NULL;
+#ifndef MYLIB_STATIC
+	if (dev_bufferOwned) {
+		free(dev_bufferDurationArray);
+		free(dev_bufferFreqArray);
+	}
+#endif
+	dev_bufferDurationArray = NULL;
+	dev_bufferFreqArray = NULL;
+	dev_bufferCapacity = 0;
+	dev_bufferOwned = false;
 }
\ No newline at end of file
@@ -9,7 +9,17 @@
 			воспроизвести ноту.
 		* Метод без параметров, котрый будет выключать воспроизведение звука.
 		* Интервал между вызовами метода processStep().
+	Либо вместо двух методов указывается нога PP_TIMER1_PIN_A (9) или PP_TIMER1_PIN_B (10): PatternPlayer(нога, интервал). Тогда звук генерирует
+	сам Timer1 в режиме CTC, переключая выход OC1A или OC1B на каждом совпадении, без tone() и без прерываний. Смена ноты - запись предделителя,
+	OCR1A и TCNT1. Для нот по номеру MIDI (playProgmem()) период берётся из таблицы, рассчитанной при компиляции под F_CPU, для частот в герцах
+	(массивы, строки, RTTTL) - одно деление на ноту. Частоты ниже 16 Гц идут с предделителем 64, ниже 2 Гц не опускаются.
+	Пока звучит проигрыватель, Timer1 занят: analogWrite() на ногах 9 и 10 и библиотека Servo работать не будут. В паузах и после остановки
+	Timer1 остановлен, нога в LOW. Ногу нельзя подключать напрямую к динамику без резистора.
 	В параллельном потоке нужно циклически вызывать метод processStep().
+	Если интервал между вызовами непостоянен, вместо него вызывайте processStepMs(unsigned int ms), передавая время до следующего вызова, либо 
+	processStepAt(unsigned long timestamp), передавая текущее время (например, millis()). Если с прошлого вызова прошло больше, чем длится нота, 
+	пропускаются сразу все прошедшие ноты, а остаток времени переходит в следующую. Поэтому мелодия не растягивается и не отстаёт, как бы редко 
+	ни вызывался метод: общая длительность совпадает с суммой длительностей нот с точностью до одного интервала вызова.
 	Для воспроизведения можно использовать несколько способов:
 		* Вызов метода play, в параметры которого нужно обязательно передать целочисленный массив с частотами, целочисленный массив с длительностями и их длину.
 			Остальные два необязательных параметра - количество повторов и максимальная длительность воспроизведения. Если количество повторов = 0, то сигнал не воспроизводится.
@@ -17,7 +27,38 @@
 		* Вызов метода play c передачей ему в параметры отформатированную строку с данными. Её, в свою очередь, можно получить с помощью метода convertInpMelodyToStr, 
 			передав ему два массива с частотами нот и их длительностью и их длину.
 		Если частота ноты = 0, то будет воспроизводиться тишина.
-	Можно остановить воспроизведение, вызвав метод stop(). После этого можно запустить мелодию методом play(). При этом воспроизведение начнётся с нуля.
+		* Вызов метода play c передачей ему строки формата @N#f,d%f,d%...! в виде const char*. Строка разбирается за один проход без копирования и без 
+			выделения памяти под каждую ноту. Ноты записываются в буфер, заданный методом setMelodyBuffer(int* freqArray, int* durationArray, int capacity). 
+			Если буфер не задан, проигрыватель один раз выделяет его сам и в дальнейшем только расширяет при необходимости. Вариант play(String) работает так же.
+			Если строка ошибочна, воспроизведение останавливается, а код ошибки (PP_PARSE_ERR_*) можно узнать методом getParseError().
+		* Вызов метода playProgmem(const uint16_t* melody, int notesCount, byte durationUnit, ...) - воспроизведение упакованной мелодии прямо из флеш-памяти
+			(PROGMEM). Каждая нота занимает 2 байта: старший байт - номер ноты по MIDI (69 = ля первой октавы, 440Гц; 0 = пауза), младший - длительность
+			в единицах durationUnit миллисекунд (по умолчанию 10). Ноты читаются по одной в момент смены ноты, поэтому расход оперативной памяти не зависит от 
+			длины мелодии. Ноты удобно записывать макросами PP_NOTE(номер, длительность) и PP_REST(длительность):
+				const uint16_t alarm[] PROGMEM = {PP_NOTE(69, 20), PP_REST(5), PP_NOTE(81, 20)};
+				player.playProgmem(alarm, 3);
+			Частоту ноты по её номеру возвращает статический метод noteToFrequency(byte note). Номера выше PP_MAX_NOTE = 127 (за пределами MIDI) звучат
+			как пауза, а нота длиннее 32767 миллисекунд (255 единиц по 255 мс) укорачивается до этого значения - длительность шага хранится в int.
+		* Вызов метода playRtttl(const char* rtttl, ...) - воспроизведение мелодии в формате RTTTL. Мелодия компилируется в буфер нот так же, как строка
+			для play(const char*). Подробнее о формате и о компиляции RTTTL на компьютере - в файле Rtttl.h.
+		Для разбора строки в свои массивы без воспроизведения используйте статический метод parseMelody(const char* melody, int* freqArray, int* durationArray, 
+		int capacity). Он возвращает количество нот либо отрицательный код ошибки:
+			PP_PARSE_ERR_FORMAT - нарушен формат (неожиданный символ), PP_PARSE_ERR_NUMBER - число не помещается в int, PP_PARSE_ERR_TOO_LONG - нот больше, 
+			чем помещается в массивы, PP_PARSE_ERR_COUNT - количество нот не совпадает с заявленным N, PP_PARSE_ERR_UNTERMINATED - строка кончилась без '!'.
+		Метод convertInpMelodyToBuffer(int* freqArr, int* durationArr, int arrLength, char* buffer, int bufferSize) записывает ту же строку, что и 
+		convertInpMelodyToStr, в ваш буфер (с завершающим нулём). Он возвращает длину строки без нуля, даже если она не поместилась, - так можно узнать нужный размер.
+		Числа в строке могут быть отрицательными, поэтому parseMelody() читает обратно любую строку этих методов.
+	Метод setMuted(boolean muted) заглушает проигрыватель: мелодия продолжает идти, но методы воспроизведения и выключения звука не вызываются. 
+	После снятия заглушения текущая нота звучит заново, на оставшееся ей время. Этим пользуется микшер PlayerMixer (см. PlayerMixer.h), который 
+	делит один выход между несколькими проигрывателями.
+	Отсчёт времени, повторы, пауза и остановка общие для всех проигрывателей и вынесены в класс SequencePlayer (см. SequencePlayer.h). На нём же построен
+	KeyframePlayer - проигрыватель плавных переходов для светодиодов и моторов (см. KeyframePlayer.h).
+	Метод getTimeToNextStep() (см. SequencePlayer.h) во время звучащей ноты возвращает 0: звук генерирует таймер, который в глубоком сне стоит.
+	Во время паузы между нотами он возвращает время до следующей ноты, и менеджер сна (SleepManager) может усыпить контроллер.
+	Без кучи: задайте буфер нот методом setMelodyBuffer() или объявите StaticPatternPlayer<N>(функции звука, интервал) - буфер на N нот внутри объекта.
+	С флагом компиляции MYLIB_STATIC проигрыватель сам буфер не выделяет (без setMelodyBuffer() разбор строки вернёт PP_PARSE_ERR_TOO_LONG),
+	а play(String) и convertInpMelodyToStr() недоступны: String держит строку в куче.
+ После этого можно запустить мелодию методом play(). При этом воспроизведение начнётся с нуля.
 	Приостановить воспроизведение можно методом pause(). При этом, его можно будет продолжить с той же точки, используя метод play().
 	Написано за один вечер. ExtNeon. 08.11.2017
 */
@@ -27,45 +68,95 @@
 #define PatternPlayer_h // тогда подключаем ее
 
 #include "Arduino.h"
+#include <avr/pgmspace.h>
+#include "SequencePlayer.h"
 //#include "SignalPattern.h"
 
 
-#define PLAYING 1
-#define PAUSED 2
-#define STOPPED 0
 #define DEV_PLAYER_STOPPED_PWM_VAL 0
 
-class PatternPlayer {
+#define PP_NOTE(note, units) ((uint16_t) (((note) << 8) | ((units) & 0xFF))) //Упакованная нота: номер MIDI и длительность в единицах
+#define PP_REST(units) PP_NOTE(0, units)
+#define PP_DEFAULT_DURATION_UNIT 10 //Миллисекунд в единице длительности упакованной ноты
+#define PP_MAX_NOTE 127 //Старший номер ноты MIDI, выше - пауза
+
+#define PP_TIMER1_PIN_A 9 //Выход OC1A
+#define PP_TIMER1_PIN_B 10 //Выход OC1B
+#define DEV_PP_NO_NOTE 0xFF //Нота задана частотой, а не номером MIDI
+#define DEV_PP_MAX_STEP_DURATION 32767 //Предел int на AVR, одинаковый на всех платформах
+
+#define PP_PARSE_OK 0
+#define PP_PARSE_ERR_FORMAT -1
+#define PP_PARSE_ERR_NUMBER -2
+#define PP_PARSE_ERR_TOO_LONG -3
+#define PP_PARSE_ERR_COUNT -4
+#define PP_PARSE_ERR_UNTERMINATED -5
+
+class PatternPlayer : public SequencePlayer {
 	public:
 		PatternPlayer(void (*toneFunc) (int frequency, int duration), void (*noToneFunc) (), unsigned int timerInterval);
+		PatternPlayer(byte timer1Pin, unsigned int timerInterval);
 		void play(int freqArray[], int durationArray[], int arrayLength, int repeatationCount = 1, unsigned int duration = 0);
+#ifndef MYLIB_STATIC
 		void play(String inputMelody, int repeatationCount = 1, unsigned int duration = 0);
-		void play();
-		void pause();
-		void stop();
-		byte getState();
-		void processStep();
-		void processStepMs(unsigned int ms);
+#endif
+		void play(const char *inputMelody, int repeatationCount = 1, unsigned int duration = 0);
+		using SequencePlayer::play;
+		void playRtttl(const char *rtttl, int repeatationCount = 1, unsigned int duration = 0);
+		void playProgmem(const uint16_t *melody, int notesCount, byte durationUnit = PP_DEFAULT_DURATION_UNIT, int repeatationCount = 1, unsigned int duration = 0);
+		static int noteToFrequency(byte note);
+		void setMelodyBuffer(int *freqArray, int *durationArray, int capacity);
+		int getParseError();
+		void setMuted(boolean muted);
+		boolean isMuted();
+		unsigned long getTimeToNextStep();
+#ifndef MYLIB_STATIC
 	    static String convertInpMelodyToStr(int *freqArr, int *durationArr, int arrLength);
+#endif
+		static int convertInpMelodyToBuffer(int *freqArr, int *durationArr, int arrLength, char *buffer, int bufferSize);
+		static int parseMelody(const char *melody, int *freqArray, int *durationArray, int capacity);
+	protected:
+		void dev_loadStep();
+		void dev_beginStep();
+		void dev_silence();
 	private:
-		unsigned int dev_stepCounter;
-		unsigned int dev_currentStepIndex;
-		unsigned int dev_timerInterval;
-		unsigned int max_duration;
-		unsigned int max_duration_timer;
-		int dev_repeatationCount;
-		int dev_repeatCounter;
-		byte dev_currentState;
 		int *dev_freqArray;
 		int *dev_durationArray;
-		int dev_arrayLength;
-		boolean dev_notInitialized;
 		void (*_toneFunc) (int frequency, int duration);
 		void (*_noToneFunc) ();
-		void dev_processStepOnly();
-		void moveStep(unsigned int moveToMillis);
+		byte dev_timer1Pin; //0 - звук через _toneFunc и _noToneFunc
+		void dev_init();
+		void dev_toneOn(int duration);
+		void dev_toneOff();
+		void dev_timer1Start(byte clockSelect, word top);
 		void freeArrays();
-		boolean newStep;
+		boolean dev_reserveBuffer(int length);
+		int *dev_bufferFreqArray; //Буфер для нот, разобранных из строки
+		int *dev_bufferDurationArray;
+		int dev_bufferCapacity;
+		boolean dev_bufferOwned;
+		int dev_parseError;
+		static const char *dev_parseNumber(const char *position, int *value);
+		static char *dev_writeNumber(char *position, char *end, int value, int *length);
+		const uint16_t *dev_progmemMelody; //Если не NULL - ноты читаются отсюда, а не из массивов
+		byte dev_durationUnit;
+		int dev_stepFrequency; //Текущая нота
+		byte dev_stepNote; //Её номер MIDI или DEV_PP_NO_NOTE
+		boolean dev_muted;
+};
+
+template <int N> class StaticPatternPlayer : public PatternPlayer {
+	public:
+		StaticPatternPlayer(void (*toneFunc) (int frequency, int duration), void (*noToneFunc) (), unsigned int timerInterval) :
+			PatternPlayer(toneFunc, noToneFunc, timerInterval) {
+			setMelodyBuffer(dev_frequencies, dev_durations, N);
+		}
+		StaticPatternPlayer(byte timer1Pin, unsigned int timerInterval) : PatternPlayer(timer1Pin, timerInterval) {
+			setMelodyBuffer(dev_frequencies, dev_durations, N);
+		}
+	private:
+		int dev_frequencies[N];
+		int dev_durations[N];
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,101 @@
+/**
+	PlayerMixer_h - микшер, который делит один звуковой выход (пищалку) между несколькими проигрывателями PatternPlayer.
+	Каждый проигрыватель (голос) получает приоритет. На каждом шаге выход отдаётся голосу с наибольшим приоритетом из воспроизводящих,
+	остальные голоса заглушаются (PatternPlayer::setMuted()). Так сигнал тревоги перебивает щелчок клавиши, а после его окончания звучит то, что осталось.
+	Голоса создаются как обычно, с одними и теми же методами воспроизведения и выключения звука, а затем добавляются в микшер:
+		PatternPlayer alarm(buzzerTone, buzzerNoTone, 10);
+		PatternPlayer click(buzzerTone, buzzerNoTone, 10);
+		PlayerMixer mixer(10);
+		...
+		mixer.addVoice(&alarm, 2, PM_PREEMPT_PAUSE);
+		mixer.addVoice(&click, 1);
+	Вместо processStep() каждого проигрывателя циклически вызывается mixer.processStep() (или processStepMs(ms)). Запускать и останавливать мелодии
+	нужно, как и раньше, методами самих проигрывателей.
+	Что происходит с вытесненным голосом, задаётся при добавлении:
+		* PM_PREEMPT_CONTINUE - мелодия идёт дальше без звука, как будто её слышно. Подходит для сигналов, привязанных ко времени.
+		* PM_PREEMPT_PAUSE - мелодия стоит на месте и продолжается с той же ноты, когда голос снова получит выход.
+	Метод setRoundRobin(unsigned int slotMs) включает псевдо-полифонию: голоса с одинаковым наибольшим приоритетом получают выход по очереди,
+	каждый на slotMs миллисекунд (0 - выключить). Все голоса в очереди при этом идут дальше независимо от правила вытеснения.
+	Метод getActiveVoice() возвращает голос, у которого сейчас выход (NULL, если не играет никто).
+	Время шага пропорционально количеству голосов и не зависит от длины мелодий. Голосов не больше PM_MAX_VOICES.
+*/
+
+#include "PlayerMixer.h"
+
+PlayerMixer::PlayerMixer(unsigned int timerInterval) {
+	dev_timerInterval = timerInterval;
+	dev_voicesCount = 0;
+	dev_activeVoice = PM_NO_VOICE;
+	dev_slotMs = 0;
+	dev_slotTimer = 0;
+}
+
+boolean PlayerMixer::addVoice(PatternPlayer *player, byte priority, byte preemptPolicy) {
+	if (player == NULL || dev_voicesCount >= PM_MAX_VOICES) return false;
+	player->setMuted(true); //Выход голос получит только от микшера
+	dev_voices[dev_voicesCount] = player;
+	dev_priorities[dev_voicesCount] = priority;
+	dev_policies[dev_voicesCount] = preemptPolicy;
+	dev_voicesCount++;
+	return true;
+}
+
+void PlayerMixer::setRoundRobin(unsigned int slotMs) {
+	dev_slotMs = slotMs;
+	dev_slotTimer = 0;
+}
+
+PatternPlayer *PlayerMixer::getActiveVoice() {
+	return dev_activeVoice == PM_NO_VOICE ? NULL : dev_voices[dev_activeVoice];
+}
+
+void PlayerMixer::processStep() {
+	processStepMs(dev_timerInterval);
+}
+
+void PlayerMixer::processStepMs(unsigned int ms) {
+	dev_arbitrate(ms);
+	byte topPriority = dev_activeVoice == PM_NO_VOICE ? 0 : dev_priorities[dev_activeVoice];
+	for (byte i = 0; i < dev_voicesCount; i++) {
+		boolean advance = i == dev_activeVoice || dev_policies[i] == PM_PREEMPT_CONTINUE || (dev_slotMs != 0 && dev_priorities[i] == topPriority);
+		if (advance) dev_voices[i]->processStepMs(ms);
+	}
+}
+
+void PlayerMixer::dev_arbitrate(unsigned int ms) {
+	byte topPriority = 0;
+	boolean anyPlaying = false;
+	for (byte i = 0; i < dev_voicesCount; i++) {
+		if (dev_voices[i]->getState() == PLAYING && (!anyPlaying || dev_priorities[i] > topPriority)) {
+			topPriority = dev_priorities[i];
+			anyPlaying = true;
+		}
+	}
+	byte nextVoice = dev_activeVoice;
+	boolean activeValid = dev_activeVoice != PM_NO_VOICE && dev_voices[dev_activeVoice]->getState() == PLAYING 
+		&& dev_priorities[dev_activeVoice] == topPriority;
+	if (activeValid && dev_slotMs != 0) {
+		dev_slotTimer += ms;
+		if (dev_slotTimer >= dev_slotMs) activeValid = false; //Время голоса вышло, ищем следующего в очереди
+	}
+	if (!anyPlaying) {
+		nextVoice = PM_NO_VOICE;
+	} else if (!activeValid) {
+		byte start = dev_activeVoice == PM_NO_VOICE || dev_slotMs == 0 ? 0 : dev_activeVoice + 1; //Без очереди - первый по порядку
+		for (byte n = 0; n < dev_voicesCount; n++) {
+			byte i = (start + n) % dev_voicesCount;
+			if (dev_voices[i]->getState() == PLAYING && dev_priorities[i] == topPriority) {
+				nextVoice = i;
+				break;
+			}
+		}
+	}
+	if (nextVoice == dev_activeVoice) {
+		if (dev_slotMs != 0 && !activeValid) dev_slotTimer = 0; //Голос в очереди один - он же получает следующий отрезок
+		return;
+	}
+	if (dev_activeVoice != PM_NO_VOICE) dev_voices[dev_activeVoice]->setMuted(true);
+	dev_activeVoice = nextVoice;
+	dev_slotTimer = 0;
+	if (dev_activeVoice != PM_NO_VOICE) dev_voices[dev_activeVoice]->setMuted(false);
+}
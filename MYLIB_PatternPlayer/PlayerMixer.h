@@ -0,0 +1,55 @@
+/**
+	PlayerMixer_h - микшер, который делит один звуковой выход (пищалку) между несколькими проигрывателями PatternPlayer.
+	Каждый проигрыватель (голос) получает приоритет. На каждом шаге выход отдаётся голосу с наибольшим приоритетом из воспроизводящих,
+	остальные голоса заглушаются (PatternPlayer::setMuted()). Так сигнал тревоги перебивает щелчок клавиши, а после его окончания звучит то, что осталось.
+	Голоса создаются как обычно, с одними и теми же методами воспроизведения и выключения звука, а затем добавляются в микшер:
+		PatternPlayer alarm(buzzerTone, buzzerNoTone, 10);
+		PatternPlayer click(buzzerTone, buzzerNoTone, 10);
+		PlayerMixer mixer(10);
+		...
+		mixer.addVoice(&alarm, 2, PM_PREEMPT_PAUSE);
+		mixer.addVoice(&click, 1);
+	Вместо processStep() каждого проигрывателя циклически вызывается mixer.processStep() (или processStepMs(ms)). Запускать и останавливать мелодии
+	нужно, как и раньше, методами самих проигрывателей.
+	Что происходит с вытесненным голосом, задаётся при добавлении:
+		* PM_PREEMPT_CONTINUE - мелодия идёт дальше без звука, как будто её слышно. Подходит для сигналов, привязанных ко времени.
+		* PM_PREEMPT_PAUSE - мелодия стоит на месте и продолжается с той же ноты, когда голос снова получит выход.
+	Метод setRoundRobin(unsigned int slotMs) включает псевдо-полифонию: голоса с одинаковым наибольшим приоритетом получают выход по очереди,
+	каждый на slotMs миллисекунд (0 - выключить). Все голоса в очереди при этом идут дальше независимо от правила вытеснения.
+	Метод getActiveVoice() возвращает голос, у которого сейчас выход (NULL, если не играет никто).
+	Время шага пропорционально количеству голосов и не зависит от длины мелодий. Голосов не больше PM_MAX_VOICES.
+*/
+
+#ifndef PlayerMixer_h
+#define PlayerMixer_h
+
+#include "Arduino.h"
+#include "PatternPlayer.h"
+
+#define PM_MAX_VOICES 4
+#define PM_NO_VOICE 0xFF
+
+#define PM_PREEMPT_CONTINUE 0
+#define PM_PREEMPT_PAUSE 1
+
+class PlayerMixer {
+	public:
+		PlayerMixer(unsigned int timerInterval);
+		boolean addVoice(PatternPlayer *player, byte priority, byte preemptPolicy = PM_PREEMPT_CONTINUE);
+		void setRoundRobin(unsigned int slotMs);
+		PatternPlayer *getActiveVoice();
+		void processStep();
+		void processStepMs(unsigned int ms);
+	private:
+		PatternPlayer *dev_voices[PM_MAX_VOICES];
+		byte dev_priorities[PM_MAX_VOICES];
+		byte dev_policies[PM_MAX_VOICES];
+		byte dev_voicesCount;
+		byte dev_activeVoice;
+		unsigned int dev_timerInterval;
+		unsigned int dev_slotMs;
+		unsigned int dev_slotTimer;
+		void dev_arbitrate(unsigned int ms);
+};
+
+#endif
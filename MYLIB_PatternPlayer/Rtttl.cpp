@@ -0,0 +1,160 @@
+/**
+	Rtttl_h - компилятор мелодий в формате RTTTL (Ring Tone Text Transfer Language) во внутренние форматы PatternPlayer.
+	Формат RTTTL: имя:d=4,o=5,b=120:8e6,8p,4c#6.,2a5 ... Секция настроек задаёт длительность (d), октаву (o) и темп (b) по умолчанию.
+	Каждая нота - [длительность]нота[#][.][октава][.], где нота - c, d, e, f, g, a, b (или h), p - пауза. Точка увеличивает длительность в полтора раза.
+	Октава 4 содержит ля 440Гц (a4 = нота 69 по MIDI).
+	
+	Разбор выполняется за один проход по строке, без копирования и без выделения памяти.
+		* parse(const char* rtttl, int* noteArray, int* durationArray, int capacity) - записывает номера нот по MIDI (0 - пауза) и длительности 
+			в миллисекундах. Если массивы равны NULL, строка только проверяется и считается количество нот.
+		* compile(const char* rtttl, int* freqArray, int* durationArray, int capacity) - то же, но вместо номеров нот записывает частоты, то есть
+			сразу массивы для PatternPlayer::play(). Ещё проще - вызвать PatternPlayer::playRtttl(const char* rtttl).
+		* pack(const int* noteArray, const int* durationArray, int count, uint16_t* packedArray, byte durationUnit) - упаковывает ноты в 2-байтовый
+			формат PatternPlayer::playProgmem() (см. PP_NOTE). Длительность делится на durationUnit с округлением; если она не помещается в байт, 
+			возвращается PP_PARSE_ERR_NUMBER.
+		* suggestDurationUnit(const int* durationArray, int count) - наименьшая единица длительности, при которой все ноты помещаются в упакованный формат.
+	Методы возвращают количество нот или отрицательный код ошибки PP_PARSE_ERR_* (см. PatternPlayer.h).
+	
+	Для мелодий, известных заранее, лучше компилировать их на компьютере: утилита extras/rtttl2progmem превращает RTTTL в массив PROGMEM для 
+	playProgmem(), так что на устройстве не тратится ни время на разбор, ни оперативная память. С ключом -b она также измеряет скорость разбора.
+*/
+
+#include "Arduino.h"
+#include "Rtttl.h"
+
+static const char DEV_RTTTL_SEMITONES[7] PROGMEM = {9, 11, 0, 2, 4, 5, 7}; //a, b, c, d, e, f, g
+
+const char *Rtttl::dev_skipSpaces(const char *position) {
+	while (*position == ' ' || *position == '\t' || *position == '\r' || *position == '\n') position++;
+	return position;
+}
+
+const char *Rtttl::dev_parseNumber(const char *position, int *value) {
+	if (*position < '0' || *position > '9') return NULL;
+	long result = 0;
+	while (*position >= '0' && *position <= '9') {
+		result = result * 10 + (*position++ - '0');
+		if (result > 32767) return NULL;
+	}
+	*value = result;
+	return position;
+}
+
+int Rtttl::parse(const char *rtttl, int *noteArray, int *durationArray, int capacity) {
+	if (rtttl == NULL) return PP_PARSE_ERR_FORMAT;
+	const char *position = rtttl;
+	while (*position != ':') { //Имя мелодии
+		if (*position == 0) return PP_PARSE_ERR_UNTERMINATED;
+		position++;
+	}
+	position++;
+	int defaultDuration = RTTTL_DEFAULT_DURATION;
+	int defaultOctave = RTTTL_DEFAULT_OCTAVE;
+	int bpm = RTTTL_DEFAULT_BPM;
+	while (true) { //Настройки: d=4,o=5,b=120:
+		position = dev_skipSpaces(position);
+		if (*position == ':') break;
+		if (*position == 0) return PP_PARSE_ERR_UNTERMINATED;
+		char key = *position++ | 0x20; //В нижний регистр
+		position = dev_skipSpaces(position);
+		if (*position++ != '=') return PP_PARSE_ERR_FORMAT;
+		int value;
+		if ((position = dev_parseNumber(dev_skipSpaces(position), &value)) == NULL) return PP_PARSE_ERR_NUMBER;
+		if (key == 'd') {
+			defaultDuration = value;
+		} else if (key == 'o') {
+			defaultOctave = value;
+		} else if (key == 'b') {
+			bpm = value;
+		} else {
+			return PP_PARSE_ERR_FORMAT;
+		}
+		position = dev_skipSpaces(position);
+		if (*position == ',') position++;
+		else if (*position != ':') return PP_PARSE_ERR_FORMAT;
+	}
+	position++;
+	if (defaultDuration == 0 || bpm == 0 || defaultOctave > 9) return PP_PARSE_ERR_NUMBER;
+	unsigned long wholeNote = 240000UL / bpm; //4 доли по 60000 / bpm миллисекунд
+	int count = 0;
+	while (true) {
+		position = dev_skipSpaces(position);
+		if (*position == 0) break;
+		int duration = defaultDuration;
+		if (*position >= '0' && *position <= '9') {
+			if ((position = dev_parseNumber(position, &duration)) == NULL || duration == 0) return PP_PARSE_ERR_NUMBER;
+		}
+		char name = *position++ | 0x20;
+		int semitone;
+		if (name == 'p') {
+			semitone = -1;
+		} else if (name == 'h') {
+			semitone = 11;
+		} else if (name >= 'a' && name <= 'g') {
+			semitone = pgm_read_byte(&DEV_RTTTL_SEMITONES[name - 'a']);
+		} else {
+			return PP_PARSE_ERR_FORMAT;
+		}
+		if (*position == '#') {
+			if (semitone >= 0) semitone++;
+			position++;
+		}
+		boolean dotted = false;
+		if (*position == '.') {
+			dotted = true;
+			position++;
+		}
+		int octave = defaultOctave;
+		if (*position >= '0' && *position <= '9') {
+			octave = *position++ - '0';
+		}
+		if (*position == '.') {
+			dotted = true;
+			position++;
+		}
+		position = dev_skipSpaces(position);
+		if (*position == ',') position++;
+		else if (*position != 0) return PP_PARSE_ERR_FORMAT;
+		if (noteArray != NULL) {
+			if (count >= capacity) return PP_PARSE_ERR_TOO_LONG;
+			unsigned long noteDuration = wholeNote / duration;
+			if (dotted) noteDuration += noteDuration / 2;
+			int note = semitone < 0 ? 0 : 12 * (octave + 1) + semitone;
+			noteArray[count] = note > 127 ? 127 : note;
+			durationArray[count] = noteDuration > 32767 ? 32767 : noteDuration;
+		}
+		count++;
+	}
+	return count;
+}
+
+int Rtttl::compile(const char *rtttl, int *freqArray, int *durationArray, int capacity) {
+	int count = parse(rtttl, freqArray, durationArray, capacity);
+	if (freqArray != NULL) {
+		for (int i = 0; i < count; i++) {
+			freqArray[i] = PatternPlayer::noteToFrequency(freqArray[i]);
+		}
+	}
+	return count;
+}
+
+int Rtttl::pack(const int *noteArray, const int *durationArray, int count, uint16_t *packedArray, byte durationUnit) {
+	if (durationUnit == 0) return PP_PARSE_ERR_NUMBER;
+	for (int i = 0; i < count; i++) {
+		unsigned int units = (durationArray[i] + durationUnit / 2) / durationUnit;
+		if (units == 0 && durationArray[i] > 0) units = 1; //Нота нулевой длительности у PatternPlayer звучит бесконечно
+		if (units > 255) return PP_PARSE_ERR_NUMBER;
+		packedArray[i] = PP_NOTE(noteArray[i], units);
+	}
+	return count;
+}
+
+byte Rtttl::suggestDurationUnit(const int *durationArray, int count) {
+	int longest = 0;
+	for (int i = 0; i < count; i++) {
+		if (durationArray[i] > longest) longest = durationArray[i];
+	}
+	unsigned int unit = (longest + 254) / 255;
+	if (unit == 0) unit = 1;
+	return unit > 255 ? 255 : unit;
+}
@@ -0,0 +1,43 @@
+/**
+	Rtttl_h - компилятор мелодий в формате RTTTL (Ring Tone Text Transfer Language) во внутренние форматы PatternPlayer.
+	Формат RTTTL: имя:d=4,o=5,b=120:8e6,8p,4c#6.,2a5 ... Секция настроек задаёт длительность (d), октаву (o) и темп (b) по умолчанию.
+	Каждая нота - [длительность]нота[#][.][октава][.], где нота - c, d, e, f, g, a, b (или h), p - пауза. Точка увеличивает длительность в полтора раза.
+	Октава 4 содержит ля 440Гц (a4 = нота 69 по MIDI).
+	
+	Разбор выполняется за один проход по строке, без копирования и без выделения памяти.
+		* parse(const char* rtttl, int* noteArray, int* durationArray, int capacity) - записывает номера нот по MIDI (0 - пауза) и длительности 
+			в миллисекундах. Если массивы равны NULL, строка только проверяется и считается количество нот.
+		* compile(const char* rtttl, int* freqArray, int* durationArray, int capacity) - то же, но вместо номеров нот записывает частоты, то есть
+			сразу массивы для PatternPlayer::play(). Ещё проще - вызвать PatternPlayer::playRtttl(const char* rtttl).
+		* pack(const int* noteArray, const int* durationArray, int count, uint16_t* packedArray, byte durationUnit) - упаковывает ноты в 2-байтовый
+			формат PatternPlayer::playProgmem() (см. PP_NOTE). Длительность делится на durationUnit с округлением; если она не помещается в байт, 
+			возвращается PP_PARSE_ERR_NUMBER.
+		* suggestDurationUnit(const int* durationArray, int count) - наименьшая единица длительности, при которой все ноты помещаются в упакованный формат.
+	Методы возвращают количество нот или отрицательный код ошибки PP_PARSE_ERR_* (см. PatternPlayer.h).
+	
+	Для мелодий, известных заранее, лучше компилировать их на компьютере: утилита extras/rtttl2progmem превращает RTTTL в массив PROGMEM для 
+	playProgmem(), так что на устройстве не тратится ни время на разбор, ни оперативная память. С ключом -b она также измеряет скорость разбора.
+*/
+
+#ifndef Rtttl_h
+#define Rtttl_h
+
+#include "Arduino.h"
+#include "PatternPlayer.h"
+
+#define RTTTL_DEFAULT_DURATION 4
+#define RTTTL_DEFAULT_OCTAVE 6
+#define RTTTL_DEFAULT_BPM 63
+
+class Rtttl {
+	public:
+		static int parse(const char *rtttl, int *noteArray, int *durationArray, int capacity);
+		static int compile(const char *rtttl, int *freqArray, int *durationArray, int capacity);
+		static int pack(const int *noteArray, const int *durationArray, int count, uint16_t *packedArray, byte durationUnit);
+		static byte suggestDurationUnit(const int *durationArray, int count);
+	private:
+		static const char *dev_skipSpaces(const char *position);
+		static const char *dev_parseNumber(const char *position, int *value);
+};
+
+#endif
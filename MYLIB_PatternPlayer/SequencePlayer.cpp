@@ -0,0 +1,149 @@
+/**
+	SequencePlayer_h - общий механизм проигрывателей последовательностей шагов: отсчёт времени шагов, повторы, пауза и ограничение времени воспроизведения.
+	Сам по себе ничего не воспроизводит. На нём построены PatternPlayer (ноты для пищалки) и KeyframePlayer (плавное изменение значения для ШИМ).
+	Наследник задаёт, что такое шаг, переопределяя методы:
+		* dev_loadStep() - прочитать шаг номер dev_currentStepIndex и записать его длительность в dev_stepDuration (0 - шаг длится до остановки).
+		* dev_beginStep() - шаг начался. dev_stepCounter - сколько миллисекунд шага уже прошло (если вызов опоздал).
+		* dev_endStep() - время шага вышло (вызывается и для пропущенных шагов, до загрузки следующего).
+		* dev_updateStep() - вызывается при каждой обработке, пока идёт шаг.
+		* dev_silence() - воспроизведение остановлено или приостановлено.
+	Наследник запускает последовательность методом dev_start(int stepsCount, int repeatationCount, unsigned int duration).
+	Остальное управление общее для всех проигрывателей:
+		* processStep() - вызывать циклически с интервалом, заданным при создании. processStepMs(unsigned int ms) - то же, с явным временем до следующего
+			вызова. processStepAt(unsigned long timestamp) - то же, но передаётся текущее время (например, millis()). Если с прошлого вызова прошло больше,
+			чем длится шаг, пропускаются сразу все прошедшие шаги, а остаток времени переходит в следующий. Поэтому последовательность не растягивается,
+			как бы редко ни вызывался метод: общая длительность совпадает с суммой длительностей шагов с точностью до одного интервала вызова.
+		* play() - продолжить после паузы, pause() - приостановить, stop() - остановить (следующий play() начнёт с начала), getState() - PLAYING, PAUSED или STOPPED.
+		* getTimeToNextStep() - сколько миллисекунд до границы шага (или конца максимального времени), когда проигрывателю снова нужен processStep().
+			SP_NO_STEP - проигрыватель не играет. Между границами шагов processStep() можно не вызывать, а пропущенное время передать
+			одним вызовом processStepMs() - так менеджер сна (SleepManager) усыпляет контроллер между нотами.
+	Если количество повторов меньше 1, последовательность не воспроизводится. Если максимальная длительность = 0, она не ограничена.
+	Методы шага виртуальные, поэтому каждый класс проигрывателя занимает в оперативной памяти таблицу виртуальных методов (около 14 байт на класс).
+*/
+
+#include "SequencePlayer.h"
+
+SequencePlayer::SequencePlayer(unsigned int timerInterval) {
+	dev_timerInterval = timerInterval;
+	dev_currentState = STOPPED;
+	dev_stepCounter = 0;
+	dev_repeatCounter = 0;
+	dev_repeatationCount = 0;
+	dev_currentStepIndex = 0;
+	dev_stepDuration = 0;
+	dev_arrayLength = 0;
+	max_duration = 0;
+	max_duration_timer = 0;
+	dev_notInitialized = true;
+	dev_timestampValid = false;
+	newStep = false;
+}
+
+void SequencePlayer::dev_start(int stepsCount, int repeatationCount, unsigned int duration) {
+	dev_arrayLength = stepsCount;
+	dev_repeatationCount = repeatationCount;
+	max_duration = duration;
+	dev_stepCounter = 0;
+	dev_repeatCounter = 0;
+	dev_currentStepIndex = 0;
+	max_duration_timer = 0;
+	dev_timestampValid = false;
+	dev_loadStep();
+	if (stepsCount <= 0) {
+		dev_currentState = STOPPED;
+		dev_notInitialized = true;
+		return;
+	}
+	dev_currentState = PLAYING;
+	dev_notInitialized = false;
+	newStep = true;
+}
+
+void SequencePlayer::processStep() {
+	processStepMs(dev_timerInterval);
+}
+
+void SequencePlayer::processStepMs(unsigned int ms) {
+	if (dev_currentState != PLAYING) return;
+	dev_processStepOnly();
+	if (dev_currentState == PLAYING) moveStep(ms);
+}
+
+void SequencePlayer::processStepAt(unsigned long timestamp) {
+	if (dev_currentState != PLAYING) return;
+	if (dev_timestampValid) moveStep(timestamp - dev_lastTimestamp); //Первый вызов после запуска только запоминает время
+	dev_lastTimestamp = timestamp;
+	dev_timestampValid = true;
+	dev_processStepOnly();
+}
+
+void SequencePlayer::dev_processStepOnly() {
+	if (max_duration != 0 && max_duration_timer >= max_duration) {
+		stop();
+		return;
+	}
+	while (dev_stepDuration != 0 && dev_stepCounter >= (unsigned int) dev_stepDuration) { //Пропускаем все шаги, время которых уже прошло
+		dev_stepCounter -= dev_stepDuration; //Остаток переходит в следующий шаг, поэтому последовательность не растягивается
+		dev_endStep();
+		if (++dev_currentStepIndex >= dev_arrayLength) {
+			if (dev_repeatationCount < 1 || ++dev_repeatCounter >= dev_repeatationCount) {
+				stop();
+				return;
+			}
+			dev_currentStepIndex = 0;
+		}
+		dev_loadStep();
+		newStep = true;
+	}
+	if (newStep) {
+		newStep = false;
+		dev_beginStep();
+	}
+	dev_updateStep();
+}
+
+void SequencePlayer::moveStep(unsigned long moveToMillis) {
+	if (dev_stepDuration != 0) {
+		dev_stepCounter += moveToMillis;
+	}
+	if (max_duration > 0) {
+		max_duration_timer += moveToMillis;
+	}
+}
+
+void SequencePlayer::stop() {
+	dev_currentState = STOPPED;
+	dev_currentStepIndex = 0;
+	dev_loadStep();
+	dev_stepCounter = 0;
+	dev_repeatCounter = 0;
+	max_duration_timer = 0;
+	dev_silence();
+}
+
+void SequencePlayer::pause() {
+	dev_currentState = PAUSED;
+	dev_silence();
+}
+
+void SequencePlayer::play() {
+	if (dev_notInitialized) return; //Если мы просим невозможного
+	dev_currentState = PLAYING;
+	dev_timestampValid = false; //Время паузы не считается
+}
+
+byte SequencePlayer::getState() {
+	return dev_currentState;
+}
+
+unsigned long SequencePlayer::getTimeToNextStep() {
+	if (dev_currentState != PLAYING) return SP_NO_STEP;
+	if (newStep) return 0; //Шаг ещё не начат
+	unsigned long left = SP_NO_STEP;
+	if (dev_stepDuration != 0) left = dev_stepCounter < (unsigned int) dev_stepDuration ? dev_stepDuration - dev_stepCounter : 0;
+	if (max_duration != 0) {
+		unsigned long durationLeft = max_duration_timer < max_duration ? max_duration - max_duration_timer : 0;
+		if (durationLeft < left) left = durationLeft;
+	}
+	return left;
+}
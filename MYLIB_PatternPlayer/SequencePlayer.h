@@ -0,0 +1,72 @@
+/**
+	SequencePlayer_h - общий механизм проигрывателей последовательностей шагов: отсчёт времени шагов, повторы, пауза и ограничение времени воспроизведения.
+	Сам по себе ничего не воспроизводит. На нём построены PatternPlayer (ноты для пищалки) и KeyframePlayer (плавное изменение значения для ШИМ).
+	Наследник задаёт, что такое шаг, переопределяя методы:
+		* dev_loadStep() - прочитать шаг номер dev_currentStepIndex и записать его длительность в dev_stepDuration (0 - шаг длится до остановки).
+		* dev_beginStep() - шаг начался. dev_stepCounter - сколько миллисекунд шага уже прошло (если вызов опоздал).
+		* dev_endStep() - время шага вышло (вызывается и для пропущенных шагов, до загрузки следующего).
+		* dev_updateStep() - вызывается при каждой обработке, пока идёт шаг.
+		* dev_silence() - воспроизведение остановлено или приостановлено.
+	Наследник запускает последовательность методом dev_start(int stepsCount, int repeatationCount, unsigned int duration).
+	Остальное управление общее для всех проигрывателей:
+		* processStep() - вызывать циклически с интервалом, заданным при создании. processStepMs(unsigned int ms) - то же, с явным временем до следующего
+			вызова. processStepAt(unsigned long timestamp) - то же, но передаётся текущее время (например, millis()). Если с прошлого вызова прошло больше,
+			чем длится шаг, пропускаются сразу все прошедшие шаги, а остаток времени переходит в следующий. Поэтому последовательность не растягивается,
+			как бы редко ни вызывался метод: общая длительность совпадает с суммой длительностей шагов с точностью до одного интервала вызова.
+		* play() - продолжить после паузы, pause() - приостановить, stop() - остановить (следующий play() начнёт с начала), getState() - PLAYING, PAUSED или STOPPED.
+		* getTimeToNextStep() - сколько миллисекунд до границы шага (или конца максимального времени), когда проигрывателю снова нужен processStep().
+			SP_NO_STEP - проигрыватель не играет. Между границами шагов processStep() можно не вызывать, а пропущенное время передать
+			одним вызовом processStepMs() - так менеджер сна (SleepManager) усыпляет контроллер между нотами.
+	Если количество повторов меньше 1, последовательность не воспроизводится. Если максимальная длительность = 0, она не ограничена.
+	Методы шага виртуальные, поэтому каждый класс проигрывателя занимает в оперативной памяти таблицу виртуальных методов (около 14 байт на класс).
+*/
+
+#ifndef SequencePlayer_h
+#define SequencePlayer_h
+
+#include "Arduino.h"
+
+#define PLAYING 1
+#define PAUSED 2
+#define STOPPED 0
+
+#define SP_NO_STEP 0xFFFFFFFFUL
+
+class SequencePlayer {
+	public:
+		SequencePlayer(unsigned int timerInterval);
+		void play();
+		void pause();
+		void stop();
+		byte getState();
+		virtual unsigned long getTimeToNextStep();
+		void processStep();
+		void processStepMs(unsigned int ms);
+		void processStepAt(unsigned long timestamp);
+	protected:
+		void dev_start(int stepsCount, int repeatationCount, unsigned int duration);
+		virtual void dev_loadStep() = 0;
+		virtual void dev_beginStep() = 0;
+		virtual void dev_endStep() {}
+		virtual void dev_updateStep() {}
+		virtual void dev_silence() = 0;
+		unsigned long dev_stepCounter; //Сколько миллисекунд уже идёт текущий шаг
+		int dev_currentStepIndex;
+		int dev_stepDuration;
+		int dev_arrayLength;
+		byte dev_currentState;
+		boolean dev_notInitialized;
+		boolean newStep;
+	private:
+		unsigned int dev_timerInterval;
+		unsigned int max_duration;
+		unsigned long max_duration_timer;
+		int dev_repeatationCount;
+		int dev_repeatCounter;
+		unsigned long dev_lastTimestamp; //Для processStepAt()
+		boolean dev_timestampValid;
+		void dev_processStepOnly();
+		void moveStep(unsigned long moveToMillis);
+};
+
+#endif
@@ -0,0 +1,127 @@
+/**
+	rtttl2progmem - компилятор RTTTL в массив PROGMEM для PatternPlayer::playProgmem(). Запускается на компьютере.
+	Использование:
+		rtttl2progmem [-n имя] [-u единица] [-b повторы] ["RTTTL"]
+	Если строка RTTTL не указана, она читается со стандартного ввода. Результат (массив, длина и единица длительности) печатается в стандартный вывод,
+	его можно сохранить в заголовочный файл скетча:
+		rtttl2progmem -n intro "Intro:d=8,o=5,b=140:c,e,g,c6" > intro_melody.h
+	и затем воспроизвести:
+		player.playProgmem(intro, INTRO_LENGTH, INTRO_UNIT);
+	Ключ -u задаёт единицу длительности в мс (по умолчанию - наименьшая подходящая, см. Rtttl::suggestDurationUnit()).
+	Ключ -b N вместо вывода массива N раз разбирает строку тем же кодом, что и на устройстве, и печатает скорость разбора.
+	Утилита собирается вместе с библиотеками на компьютере (CMakeLists.txt в корне репозитория): cmake -S . -B build && cmake --build build
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <Rtttl.h>
+
+static void printUsage() {
+	fprintf(stderr, "usage: rtttl2progmem [-n name] [-u unit_ms] [-b iterations] [\"rtttl\"]\n");
+}
+
+static std::string toUpper(const std::string &text) {
+	std::string result = text;
+	for (size_t i = 0; i < result.size(); i++) {
+		if (result[i] >= 'a' && result[i] <= 'z') result[i] -= 'a' - 'A';
+	}
+	return result;
+}
+
+static std::string defaultName(const std::string &rtttl) {
+	std::string name;
+	for (size_t i = 0; i < rtttl.size() && rtttl[i] != ':'; i++) {
+		char symbol = rtttl[i];
+		if ((symbol >= 'a' && symbol <= 'z') || (symbol >= 'A' && symbol <= 'Z') || (symbol >= '0' && symbol <= '9') || symbol == '_') {
+			name += symbol;
+		}
+	}
+	if (name.empty() || (name[0] >= '0' && name[0] <= '9')) name = "melody" + name;
+	return name;
+}
+
+static int benchmark(const std::string &rtttl, long iterations) {
+	std::vector<int> notes(rtttl.size()), durations(rtttl.size());
+	long checksum = 0;
+	int count = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (long i = 0; i < iterations; i++) {
+		count = Rtttl::parse(rtttl.c_str(), notes.data(), durations.data(), (int) notes.size());
+		checksum += count > 0 ? notes[count - 1] : count;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (count < 0) {
+		fprintf(stderr, "rtttl2progmem: parse error %d\n", count);
+		return 1;
+	}
+	printf("notes: %d, length: %u bytes, iterations: %ld, checksum: %ld\n", count, (unsigned int) rtttl.size(), iterations, checksum);
+	printf("%.1f ns/melody, %.1f ns/note, %.1f MB/s\n", seconds * 1e9 / iterations, seconds * 1e9 / iterations / (count ? count : 1),
+		rtttl.size() * (double) iterations / seconds / 1e6);
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	std::string name, rtttl;
+	int unit = 0;
+	long iterations = 0;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+			name = argv[++i];
+		} else if (!strcmp(argv[i], "-u") && i + 1 < argc) {
+			unit = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-b") && i + 1 < argc) {
+			iterations = atol(argv[++i]);
+		} else if (argv[i][0] == '-') {
+			printUsage();
+			return 2;
+		} else {
+			rtttl = argv[i];
+		}
+	}
+	if (rtttl.empty()) {
+		char chunk[256];
+		size_t length;
+		while ((length = fread(chunk, 1, sizeof(chunk), stdin)) > 0) rtttl.append(chunk, length);
+		while (!rtttl.empty() && (rtttl[rtttl.size() - 1] == '\n' || rtttl[rtttl.size() - 1] == '\r')) rtttl.erase(rtttl.size() - 1);
+	}
+	if (rtttl.empty() || unit < 0 || unit > 255 || iterations < 0) {
+		printUsage();
+		return 2;
+	}
+	if (iterations > 0) return benchmark(rtttl, iterations);
+
+	int count = Rtttl::parse(rtttl.c_str(), NULL, NULL, 0);
+	if (count <= 0) {
+		fprintf(stderr, "rtttl2progmem: parse error %d\n", count);
+		return 1;
+	}
+	std::vector<int> notes(count), durations(count);
+	std::vector<uint16_t> packed(count);
+	Rtttl::parse(rtttl.c_str(), notes.data(), durations.data(), count);
+	if (unit == 0) unit = Rtttl::suggestDurationUnit(durations.data(), count);
+	if (Rtttl::pack(notes.data(), durations.data(), count, packed.data(), unit) < 0) {
+		fprintf(stderr, "rtttl2progmem: duration unit %d ms is too small for this melody\n", unit);
+		return 1;
+	}
+	if (name.empty()) name = defaultName(rtttl);
+	std::string macroName = toUpper(name);
+	printf("//Generated by rtttl2progmem from: %s\n", rtttl.c_str());
+	printf("#define %s_LENGTH %d\n", macroName.c_str(), count);
+	printf("#define %s_UNIT %d\n", macroName.c_str(), unit);
+	printf("const uint16_t %s[] PROGMEM = {", name.c_str());
+	for (int i = 0; i < count; i++) {
+		if (i % 8 == 0) printf("\n\t");
+		if (notes[i] == 0) {
+			printf("PP_REST(%u)", packed[i] & 0xFF);
+		} else {
+			printf("PP_NOTE(%d, %u)", notes[i], packed[i] & 0xFF);
+		}
+		if (i + 1 < count) printf(", ");
+	}
+	printf("\n};\n");
+	return 0;
+}
@@ -0,0 +1,157 @@
+/**
+	Profiler_h - счётчики времени выполнения для библиотек MYLIB_*. Включаются при компиляции: без макроса MYLIB_PROFILE точки замера
+	превращаются в пустое место и не стоят ни байта, ни такта.
+	Включение в Arduino IDE - строка в platform.local.txt рядом с platform.txt ядра:
+		compiler.cpp.extra_flags=-DMYLIB_PROFILE
+	На компьютере - cmake -DMYLIB_PROFILE=ON.
+	Скетч тоже подключает <Profiler.h>, иначе Arduino IDE не добавит библиотеку в сборку.
+	Точки замера уже стоят в SevenSegmentsIndicator::refreshNext(), Voltmeter::processMeasurement(), HandledButton::processStep()
+	и HandledEventTimer::processHandlers(). Свои точки - макрос PROFILER_SCOPE(id) в начале функции, id от PROFILER_ID_USER до PROFILER_MAX_ENTRIES - 1:
+		void loop() {
+			PROFILER_SCOPE(PROFILER_ID_USER);
+			...
+		}
+	На каждую точку хранится: количество вызовов, из них вызовов с запрещёнными прерываниями (из ISR), минимальное, максимальное и суммарное время,
+	наибольшая глубина вложенности точек замера (1 - точка не вложена в другую, 2 - например, processStep() из прерывания, прервавшего refreshNext()).
+	Время на плате - в тактах процессора, по счётчику Timer0 (как у micros()), поэтому точность - 64 такта. На компьютере - в наносекундах по часам компьютера.
+	Profiler::dump() передаёт таблицу в последовательный порт в двоичном виде (PROFILER_DUMP_MAGIC, версия, единица времени, частота, записи,
+	контрольная сумма - см. Profiler.cpp). Принятые байты расшифровывает утилита extras/profdecode:
+		profdecode capture.bin
+	Profiler::reset() обнуляет таблицу.
+	ExtNeon.
+*/
+
+#include "Arduino.h"
+#include "Profiler.h"
+
+#ifdef MYLIB_HOST
+	#include <chrono>
+#else
+	extern "C" {
+		extern volatile unsigned long timer0_overflow_count; //wiring.c
+	}
+#endif
+
+/*
+	Формат Profiler::dump(), все числа - little-endian:
+		2 байта  PROFILER_DUMP_MAGIC
+		1 байт   PROFILER_DUMP_VERSION
+		1 байт   единица времени (PROFILER_UNIT_*)
+		1 байт   частота процессора, МГц
+		1 байт   количество записей N
+		N записей по 26 байт: номер точки (1), вызовы (4), вызовы из ISR (4), минимум (4), максимум (4), сумма (8), глубина (1)
+		1 байт   исключающее ИЛИ всех байтов после PROFILER_DUMP_MAGIC
+	Передаются только точки, которые вызывались хотя бы раз.
+*/
+
+ProfilerEntry Profiler::dev_entries[PROFILER_MAX_ENTRIES];
+volatile byte Profiler::dev_depth = 0;
+
+unsigned long Profiler::now() {
+#ifdef MYLIB_HOST
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+	uint8_t oldSREG = SREG;
+	cli();
+	unsigned long overflows = timer0_overflow_count;
+	byte count = TCNT0;
+	if ((TIFR0 & _BV(TOV0)) && count < 255) overflows++; //Переполнение ещё не обработано, как в micros()
+	SREG = oldSREG;
+	return ((overflows << 8) + count) * 64; //Предделитель Timer0 у ядра Arduino - 64
+#endif
+}
+
+byte Profiler::getTimeUnit() {
+#ifdef MYLIB_HOST
+	return PROFILER_UNIT_NANOSECONDS;
+#else
+	return PROFILER_UNIT_CYCLES;
+#endif
+}
+
+unsigned long Profiler::enter(byte id) {
+	uint8_t oldSREG = SREG;
+	cli();
+	byte depth = ++dev_depth;
+	if (id < PROFILER_MAX_ENTRIES && depth > dev_entries[id].maxDepth) dev_entries[id].maxDepth = depth;
+	SREG = oldSREG;
+	return now();
+}
+
+void Profiler::leave(byte id, unsigned long start) {
+	unsigned long elapsed = now() - start;
+	uint8_t oldSREG = SREG;
+	cli();
+	dev_depth--;
+	if (id < PROFILER_MAX_ENTRIES) {
+		ProfilerEntry &entry = dev_entries[id];
+		if (entry.calls == 0 || elapsed < entry.minTime) entry.minTime = elapsed;
+		if (elapsed > entry.maxTime) entry.maxTime = elapsed;
+		entry.totalTime += elapsed;
+		entry.calls++;
+		if (!(oldSREG & _BV(SREG_I))) entry.isrCalls++;
+	}
+	SREG = oldSREG;
+}
+
+boolean Profiler::getEntry(byte id, ProfilerEntry *entry) {
+	if (id >= PROFILER_MAX_ENTRIES) return false;
+	uint8_t oldSREG = SREG;
+	cli();
+	*entry = dev_entries[id];
+	SREG = oldSREG;
+	return entry->calls > 0;
+}
+
+byte Profiler::getDepth() {
+	return dev_depth;
+}
+
+void Profiler::reset() {
+	uint8_t oldSREG = SREG;
+	cli();
+	for (byte i = 0; i < PROFILER_MAX_ENTRIES; i++) {
+		dev_entries[i].calls = 0;
+		dev_entries[i].isrCalls = 0;
+		dev_entries[i].minTime = 0;
+		dev_entries[i].maxTime = 0;
+		dev_entries[i].totalTime = 0;
+		dev_entries[i].maxDepth = 0;
+	}
+	SREG = oldSREG;
+}
+
+void Profiler::dev_write(HardwareSerial &port, uint32_t value, byte size, byte *checksum) {
+	for (byte i = 0; i < size; i++) {
+		byte part = value >> (8 * i);
+		*checksum ^= part;
+		port.write(part);
+	}
+}
+
+void Profiler::dump(HardwareSerial &port) {
+	ProfilerEntry entries[PROFILER_MAX_ENTRIES];
+	byte count = 0;
+	for (byte i = 0; i < PROFILER_MAX_ENTRIES; i++) {
+		if (getEntry(i, &entries[i])) count++;
+	}
+	byte checksum = 0;
+	port.write(PROFILER_DUMP_MAGIC & 0xFF);
+	port.write(PROFILER_DUMP_MAGIC >> 8);
+	dev_write(port, PROFILER_DUMP_VERSION, 1, &checksum);
+	dev_write(port, getTimeUnit(), 1, &checksum);
+	dev_write(port, F_CPU / 1000000UL, 1, &checksum);
+	dev_write(port, count, 1, &checksum);
+	for (byte i = 0; i < PROFILER_MAX_ENTRIES; i++) {
+		if (entries[i].calls == 0) continue;
+		dev_write(port, i, 1, &checksum);
+		dev_write(port, entries[i].calls, 4, &checksum);
+		dev_write(port, entries[i].isrCalls, 4, &checksum);
+		dev_write(port, entries[i].minTime, 4, &checksum);
+		dev_write(port, entries[i].maxTime, 4, &checksum);
+		dev_write(port, entries[i].totalTime, 4, &checksum);
+		dev_write(port, entries[i].totalTime >> 32, 4, &checksum);
+		dev_write(port, entries[i].maxDepth, 1, &checksum);
+	}
+	port.write(checksum);
+}
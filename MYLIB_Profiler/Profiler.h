@@ -0,0 +1,89 @@
+/**
+	Profiler_h - счётчики времени выполнения для библиотек MYLIB_*. Включаются при компиляции: без макроса MYLIB_PROFILE точки замера
+	превращаются в пустое место и не стоят ни байта, ни такта.
+	Включение в Arduino IDE - строка в platform.local.txt рядом с platform.txt ядра:
+		compiler.cpp.extra_flags=-DMYLIB_PROFILE
+	На компьютере - cmake -DMYLIB_PROFILE=ON.
+	Скетч тоже подключает <Profiler.h>, иначе Arduino IDE не добавит библиотеку в сборку.
+	Точки замера уже стоят в SevenSegmentsIndicator::refreshNext(), Voltmeter::processMeasurement(), HandledButton::processStep()
+	и HandledEventTimer::processHandlers(). Свои точки - макрос PROFILER_SCOPE(id) в начале функции, id от PROFILER_ID_USER до PROFILER_MAX_ENTRIES - 1:
+		void loop() {
+			PROFILER_SCOPE(PROFILER_ID_USER);
+			...
+		}
+	На каждую точку хранится: количество вызовов, из них вызовов с запрещёнными прерываниями (из ISR), минимальное, максимальное и суммарное время,
+	наибольшая глубина вложенности точек замера (1 - точка не вложена в другую, 2 - например, processStep() из прерывания, прервавшего refreshNext()).
+	Время на плате - в тактах процессора, по счётчику Timer0 (как у micros()), поэтому точность - 64 такта. На компьютере - в наносекундах по часам компьютера.
+	Profiler::dump() передаёт таблицу в последовательный порт в двоичном виде (PROFILER_DUMP_MAGIC, версия, единица времени, частота, записи,
+	контрольная сумма - см. Profiler.cpp). Принятые байты расшифровывает утилита extras/profdecode:
+		profdecode capture.bin
+	Profiler::reset() обнуляет таблицу.
+	ExtNeon.
+*/
+
+#ifndef Profiler_h
+#define Profiler_h
+
+#include "Arduino.h"
+
+#define PROFILER_MAX_ENTRIES 8
+
+#define PROFILER_ID_SEVEN_SEGMENTS_REFRESH 0
+#define PROFILER_ID_VOLTMETER_MEASUREMENT 1
+#define PROFILER_ID_BUTTON_STEP 2
+#define PROFILER_ID_EVENT_TIMER_HANDLERS 3
+#define PROFILER_ID_USER 4 //Первый номер для своих точек замера
+
+#define PROFILER_UNIT_CYCLES 0
+#define PROFILER_UNIT_NANOSECONDS 1
+
+#define PROFILER_DUMP_MAGIC 0x5250 //"PR"
+#define PROFILER_DUMP_VERSION 1
+
+#ifdef MYLIB_PROFILE
+	#define PROFILER_SCOPE(id) ProfilerScope dev_profilerScope(id)
+#else
+	#define PROFILER_SCOPE(id)
+#endif
+
+class ProfilerEntry {
+	public:
+		unsigned long calls;
+		unsigned long isrCalls;
+		unsigned long minTime;
+		unsigned long maxTime;
+		uint64_t totalTime;
+		byte maxDepth;
+};
+
+class Profiler {
+	public:
+		static unsigned long now(); //Такты на плате, наносекунды на компьютере
+		static byte getTimeUnit();
+		static unsigned long enter(byte id);
+		static void leave(byte id, unsigned long start);
+		static boolean getEntry(byte id, ProfilerEntry *entry); //Копия записи, false - точка ни разу не вызывалась
+		static byte getDepth();
+		static void reset();
+		static void dump(HardwareSerial &port);
+	private:
+		static ProfilerEntry dev_entries[PROFILER_MAX_ENTRIES];
+		static volatile byte dev_depth;
+		static void dev_write(HardwareSerial &port, uint32_t value, byte size, byte *checksum);
+};
+
+class ProfilerScope {
+	public:
+		ProfilerScope(byte id) {
+			dev_id = id;
+			dev_start = Profiler::enter(id);
+		}
+		~ProfilerScope() {
+			Profiler::leave(dev_id, dev_start);
+		}
+	private:
+		byte dev_id;
+		unsigned long dev_start;
+};
+
+#endif
@@ -0,0 +1,102 @@
+/**
+	ProfileDump_h - расшифровка двоичной таблицы Profiler::dump() на компьютере (формат - в Profiler.cpp) и печать отчёта.
+	decodeProfileDumps() находит в принятых байтах все целые дампы с верной контрольной суммой (между ними может быть любой другой вывод скетча),
+	formatProfileReport() печатает таблицу: вызовы, вызовы из ISR, минимальное, среднее и максимальное время в микросекундах, доля в суммарном времени,
+	глубина вложенности. Время в тактах переводится в микросекунды по частоте из дампа.
+*/
+
+#include "ProfileDump.h"
+#include <Profiler.h>
+#include <cstdio>
+
+#define DEV_DUMP_HEADER_SIZE 6
+#define DEV_DUMP_ENTRY_SIZE 26
+
+static uint64_t readLittleEndian(const uint8_t *data, size_t size) {
+	uint64_t value = 0;
+	for (size_t i = 0; i < size; i++) {
+		value |= (uint64_t) data[i] << (8 * i);
+	}
+	return value;
+}
+
+static bool decodeAt(const uint8_t *data, size_t size, ProfileDump *dump, size_t *length) {
+	if (size < DEV_DUMP_HEADER_SIZE + 1 || readLittleEndian(data, 2) != PROFILER_DUMP_MAGIC || data[2] != PROFILER_DUMP_VERSION) return false;
+	size_t count = data[5];
+	*length = DEV_DUMP_HEADER_SIZE + count * DEV_DUMP_ENTRY_SIZE + 1;
+	if (count > PROFILER_MAX_ENTRIES || size < *length) return false;
+	uint8_t checksum = 0;
+	for (size_t i = 2; i < *length; i++) {
+		checksum ^= data[i]; //Вместе с самой контрольной суммой должен получиться 0
+	}
+	if (checksum != 0) return false;
+	dump->version = data[2];
+	dump->timeUnit = data[3];
+	dump->cpuMhz = data[4];
+	dump->entries.clear();
+	for (size_t i = 0; i < count; i++) {
+		const uint8_t *record = data + DEV_DUMP_HEADER_SIZE + i * DEV_DUMP_ENTRY_SIZE;
+		ProfileDumpEntry entry;
+		entry.id = record[0];
+		entry.calls = readLittleEndian(record + 1, 4);
+		entry.isrCalls = readLittleEndian(record + 5, 4);
+		entry.minTime = readLittleEndian(record + 9, 4);
+		entry.maxTime = readLittleEndian(record + 13, 4);
+		entry.totalTime = readLittleEndian(record + 17, 8);
+		entry.maxDepth = record[25];
+		dump->entries.push_back(entry);
+	}
+	return true;
+}
+
+std::vector<ProfileDump> decodeProfileDumps(const uint8_t *data, size_t size) {
+	std::vector<ProfileDump> dumps;
+	size_t position = 0;
+	while (position < size) {
+		ProfileDump dump;
+		size_t length;
+		if (decodeAt(data + position, size - position, &dump, &length)) {
+			dumps.push_back(dump);
+			position += length;
+		} else {
+			position++;
+		}
+	}
+	return dumps;
+}
+
+std::string profileEntryName(uint8_t id) {
+	switch (id) {
+		case PROFILER_ID_SEVEN_SEGMENTS_REFRESH: return "SevenSegmentsIndicator::refreshNext";
+		case PROFILER_ID_VOLTMETER_MEASUREMENT: return "Voltmeter::processMeasurement";
+		case PROFILER_ID_BUTTON_STEP: return "HandledButton::processStep";
+		case PROFILER_ID_EVENT_TIMER_HANDLERS: return "HandledEventTimer::processHandlers";
+	}
+	char name[16];
+	snprintf(name, sizeof(name), "user %u", id - PROFILER_ID_USER);
+	return name;
+}
+
+std::string formatProfileReport(const ProfileDump &dump) {
+	//Такты переводятся в микросекунды по частоте процессора, наносекунды - делением на 1000
+	double toMicros = dump.timeUnit == PROFILER_UNIT_CYCLES ? 1.0 / (dump.cpuMhz ? dump.cpuMhz : 1) : 0.001;
+	uint64_t grandTotal = 0;
+	for (size_t i = 0; i < dump.entries.size(); i++) {
+		grandTotal += dump.entries[i].totalTime;
+	}
+	std::string report;
+	char line[256];
+	snprintf(line, sizeof(line), "time unit: %s, CPU %u MHz\n", dump.timeUnit == PROFILER_UNIT_CYCLES ? "cycles" : "ns", dump.cpuMhz);
+	report += line;
+	snprintf(line, sizeof(line), "%-36s %10s %10s %10s %10s %10s %7s %5s\n", "entry", "calls", "isr", "min us", "avg us", "max us", "share", "depth");
+	report += line;
+	for (size_t i = 0; i < dump.entries.size(); i++) {
+		const ProfileDumpEntry &entry = dump.entries[i];
+		double average = entry.calls ? (double) entry.totalTime / entry.calls : 0;
+		double share = grandTotal ? 100.0 * entry.totalTime / grandTotal : 0;
+		snprintf(line, sizeof(line), "%-36s %10u %10u %10.2f %10.2f %10.2f %6.1f%% %5u\n", profileEntryName(entry.id).c_str(), entry.calls, entry.isrCalls,
+			entry.minTime * toMicros, average * toMicros, entry.maxTime * toMicros, share, entry.maxDepth);
+		report += line;
+	}
+	return report;
+}
@@ -0,0 +1,37 @@
+/**
+	ProfileDump_h - расшифровка двоичной таблицы Profiler::dump() на компьютере (формат - в Profiler.cpp) и печать отчёта.
+	decodeProfileDumps() находит в принятых байтах все целые дампы с верной контрольной суммой (между ними может быть любой другой вывод скетча),
+	formatProfileReport() печатает таблицу: вызовы, вызовы из ISR, минимальное, среднее и максимальное время в микросекундах, доля в суммарном времени,
+	глубина вложенности. Время в тактах переводится в микросекунды по частоте из дампа.
+*/
+
+#ifndef ProfileDump_h
+#define ProfileDump_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+struct ProfileDumpEntry {
+	uint8_t id;
+	uint32_t calls;
+	uint32_t isrCalls;
+	uint32_t minTime;
+	uint32_t maxTime;
+	uint64_t totalTime;
+	uint8_t maxDepth;
+};
+
+struct ProfileDump {
+	uint8_t version;
+	uint8_t timeUnit;
+	uint8_t cpuMhz;
+	std::vector<ProfileDumpEntry> entries;
+};
+
+std::vector<ProfileDump> decodeProfileDumps(const uint8_t *data, size_t size);
+std::string profileEntryName(uint8_t id);
+std::string formatProfileReport(const ProfileDump &dump);
+
+#endif
@@ -0,0 +1,54 @@
+/**
+	profdecode - отчёт по двоичной таблице Profiler::dump(), принятой из последовательного порта. Запускается на компьютере.
+	Использование:
+		profdecode [-a] [файл]
+	Если файл не указан, байты читаются со стандартного ввода, например:
+		stty -F /dev/ttyUSB0 115200 raw && timeout 5 cat /dev/ttyUSB0 > capture.bin && profdecode capture.bin
+	По умолчанию печатается последний целый дамп, с ключом -a - все по порядку. Остальной вывод скетча пропускается.
+	Утилита собирается вместе с библиотеками на компьютере (CMakeLists.txt в корне репозитория): cmake -S . -B build && cmake --build build
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "ProfileDump.h"
+
+static void printUsage() {
+	fprintf(stderr, "usage: profdecode [-a] [file]\n");
+}
+
+int main(int argc, char **argv) {
+	bool all = false;
+	const char *path = NULL;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-a")) {
+			all = true;
+		} else if (argv[i][0] == '-') {
+			printUsage();
+			return 2;
+		} else {
+			path = argv[i];
+		}
+	}
+	FILE *input = path ? fopen(path, "rb") : stdin;
+	if (input == NULL) {
+		fprintf(stderr, "profdecode: cannot open %s\n", path);
+		return 1;
+	}
+	std::vector<uint8_t> data;
+	uint8_t chunk[256];
+	size_t length;
+	while ((length = fread(chunk, 1, sizeof(chunk), input)) > 0) data.insert(data.end(), chunk, chunk + length);
+	if (path) fclose(input);
+
+	std::vector<ProfileDump> dumps = decodeProfileDumps(data.data(), data.size());
+	if (dumps.empty()) {
+		fprintf(stderr, "profdecode: no profiler dump found in %u bytes\n", (unsigned int) data.size());
+		return 1;
+	}
+	for (size_t i = all ? 0 : dumps.size() - 1; i < dumps.size(); i++) {
+		if (all) printf("dump %u:\n", (unsigned int) i + 1);
+		printf("%s", formatProfileReport(dumps[i]).c_str());
+	}
+	return 0;
+}
@@ -0,0 +1,236 @@
+/**
+	SerialProtocol_h - приём команд по последовательному порту в двоичных кадрах без кучи: байты складываются в кольцевой буфер
+	фиксированного размера и разбираются по мере прихода, а принятый кадр передаётся обработчику прямо из буфера, без копирования.
+	Замена приёму строки через String buf += c (см. старый пример PrintSerial), которая на каждом байте перевыделяла память.
+	Кадр:
+		SPR_SYNC (0xA5) | команда | длина данных (0..SPR_MAX_PAYLOAD) | данные | CRC-8 (многочлен 0x07) от команды, длины и данных
+	Числа в данных передаются младшим байтом вперёд.
+	При создании указывается порт (обычно Serial), его скорость задаёт скетч (Serial.begin()).
+	Обработчики добавляются методом addCommand(команда, функция) (до SPR_MAX_COMMANDS = 12), функция получает ProtocolFrame &frame:
+		* frame.getCommand(), frame.getLength() - команда и длина данных.
+		* frame.getByte(i), frame.getWord(i), frame.getLong(i) - числа из данных по смещению i, читаются прямо из кольцевого буфера.
+		* frame.copyTo(буфер, размер) - скопировать данные, frame.copyText(буфер, размер) - скопировать как строку с нулём в конце.
+		Данные действительны только до выхода из обработчика.
+	Ответы: sendFrame(команда, данные, длина) или sendReply(frame, данные, длина) - ответ с командой запроса | SPR_REPLY_FLAG.
+	Метод processInput() вызывается в loop(): он забирает все принятые портом байты и вызывает обработчики целых кадров.
+	Байты можно подавать и по одному методом feed(байт). Из обработчика processInput() и feed() вызывать нельзя.
+	Разбор: байты до SPR_SYNC пропускаются. Если длина больше SPR_MAX_PAYLOAD или не сошлась контрольная сумма, отбрасывается только
+	байт SPR_SYNC, и поиск начала кадра продолжается с уже принятых байтов - так после потерянного байта теряется один кадр, а не поток.
+	Встроенная команда SPR_CMD_STATISTICS (0x00) отвечает счётчиками (по 4 байта): принято байт, кадров, ошибок контрольной суммы,
+	пропущенных байтов, неизвестных команд. На неизвестную команду приходит ответ SPR_REPLY_UNKNOWN с её кодом.
+	Коды SPR_CMD_DIGITS, SPR_CMD_TEXT, SPR_CMD_MELODY, SPR_CMD_STOP, SPR_CMD_VOLTAGE - общие для скетчей с индикатором, плеером и вольтметром
+	(см. пример IndicatorCommands), обработчики для них пишет скетч.
+	Статистика: getBytesCount(), getFramesCount(), getChecksumErrorsCount(), getDroppedBytesCount(), getUnknownCommandsCount(),
+	getSentFramesCount(), resetStatistics(). Байты, потерянные самим портом (его буфер - 64 байта), видны как ошибки контрольной суммы.
+	ExtNeon.
+*/
+
+#include "SerialProtocol.h"
+
+#if (SPR_RING_SIZE & (SPR_RING_SIZE - 1)) || SPR_RING_SIZE > 256 || SPR_RING_SIZE < SPR_MAX_PAYLOAD + DEV_SPR_HEADER_SIZE + 1
+#error "SPR_RING_SIZE must be a power of two, at most 256 and hold the largest frame"
+#endif
+
+byte ProtocolFrame::getCommand() {
+	return dev_command;
+}
+
+byte ProtocolFrame::getLength() {
+	return dev_length;
+}
+
+byte ProtocolFrame::getByte(byte index) {
+	if (index >= dev_length) return 0;
+	return dev_ring[(byte)(dev_start + index) & (SPR_RING_SIZE - 1)];
+}
+
+word ProtocolFrame::getWord(byte index) {
+	return getByte(index) | ((word)getByte(index + 1) << 8);
+}
+
+unsigned long ProtocolFrame::getLong(byte index) {
+	return getWord(index) | ((unsigned long)getWord(index + 2) << 16);
+}
+
+byte ProtocolFrame::copyTo(byte *destination, byte size) {
+	if (size > dev_length) size = dev_length;
+	for (byte i = 0; i < size; i++) {
+		destination[i] = getByte(i);
+	}
+	return size;
+}
+
+byte ProtocolFrame::copyText(char *destination, byte size) {
+	if (size == 0) return 0;
+	byte length = copyTo((byte *)destination, size - 1);
+	destination[length] = 0;
+	return length;
+}
+
+SerialProtocol::SerialProtocol(HardwareSerial &port) : dev_port(port) {
+	dev_start = 0;
+	dev_count = 0;
+	dev_commandsCount = 0;
+	resetStatistics();
+}
+
+boolean SerialProtocol::addCommand(byte command, void (*handler)(ProtocolFrame &frame)) {
+	if (handler == NULL) return false;
+	for (byte i = 0; i < dev_commandsCount; i++) {
+		if (dev_commands[i] != command) continue;
+		dev_handlers[i] = handler;
+		return true;
+	}
+	if (dev_commandsCount >= SPR_MAX_COMMANDS) return false;
+	dev_commands[dev_commandsCount] = command;
+	dev_handlers[dev_commandsCount] = handler;
+	dev_commandsCount++;
+	return true;
+}
+
+void SerialProtocol::processInput() {
+	while (dev_port.available() > 0) {
+		feed(dev_port.read());
+	}
+}
+
+void SerialProtocol::feed(byte value) {
+	dev_bytes++;
+	if (dev_count == 0 && value != SPR_SYNC) { //Между кадрами ждём только начало кадра
+		dev_droppedBytes++;
+		return;
+	}
+	dev_ring[(byte)(dev_start + dev_count) & (SPR_RING_SIZE - 1)] = value;
+	dev_count++;
+	dev_parse();
+}
+
+byte SerialProtocol::crc8(byte crc, byte value) {
+	crc ^= value;
+	for (byte i = 0; i < 8; i++) {
+		crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+	}
+	return crc;
+}
+
+byte SerialProtocol::dev_at(byte offset) {
+	return dev_ring[(byte)(dev_start + offset) & (SPR_RING_SIZE - 1)];
+}
+
+void SerialProtocol::dev_parse() {
+	//Обычно кадр проверяется один раз, когда пришёл его последний байт. В цикл возвращаемся только после отброшенного синхробайта:
+	//следующий кадр мог начаться среди уже принятых байтов
+	while (dev_count >= DEV_SPR_HEADER_SIZE) {
+		byte length = dev_at(2);
+		if (length > SPR_MAX_PAYLOAD) {
+			dev_resync();
+			continue;
+		}
+		byte frameSize = DEV_SPR_HEADER_SIZE + length + 1;
+		if (dev_count < frameSize) return;
+		byte crc = 0;
+		for (byte i = 1; i < frameSize - 1; i++) {
+			crc = crc8(crc, dev_at(i));
+		}
+		if (crc != dev_at(frameSize - 1)) {
+			dev_checksumErrors++;
+			dev_resync();
+			continue;
+		}
+		ProtocolFrame frame;
+		frame.dev_ring = dev_ring;
+		frame.dev_start = (byte)(dev_start + DEV_SPR_HEADER_SIZE) & (SPR_RING_SIZE - 1);
+		frame.dev_command = dev_at(1);
+		frame.dev_length = length;
+		dev_frames++;
+		dev_dispatch(frame);
+		dev_start = (byte)(dev_start + frameSize) & (SPR_RING_SIZE - 1);
+		dev_count -= frameSize;
+		while (dev_count > 0 && dev_at(0) != SPR_SYNC) {
+			dev_resync();
+		}
+	}
+}
+
+void SerialProtocol::dev_resync() {
+	do {
+		dev_start = (byte)(dev_start + 1) & (SPR_RING_SIZE - 1);
+		dev_count--;
+		dev_droppedBytes++;
+	} while (dev_count > 0 && dev_at(0) != SPR_SYNC);
+}
+
+void SerialProtocol::dev_dispatch(ProtocolFrame &frame) {
+	byte command = frame.getCommand();
+	if (command == SPR_CMD_STATISTICS) {
+		dev_sendStatistics(frame);
+		return;
+	}
+	for (byte i = 0; i < dev_commandsCount; i++) {
+		if (dev_commands[i] != command) continue;
+		dev_handlers[i](frame);
+		return;
+	}
+	dev_unknownCommands++;
+	sendFrame(SPR_REPLY_UNKNOWN, &command, 1);
+}
+
+void SerialProtocol::dev_sendStatistics(ProtocolFrame &frame) {
+	unsigned long counters[5] = {dev_bytes, dev_frames, dev_checksumErrors, dev_droppedBytes, dev_unknownCommands};
+	byte payload[5 * 4];
+	for (byte i = 0; i < sizeof(payload); i++) {
+		payload[i] = counters[i / 4] >> (8 * (i % 4));
+	}
+	sendReply(frame, payload, sizeof(payload));
+}
+
+void SerialProtocol::sendFrame(byte command, const byte *payload, byte length) {
+	if (length > SPR_MAX_PAYLOAD) length = SPR_MAX_PAYLOAD;
+	byte crc = crc8(crc8(0, command), length);
+	dev_port.write(SPR_SYNC);
+	dev_port.write(command);
+	dev_port.write(length);
+	for (byte i = 0; i < length; i++) {
+		dev_port.write(payload[i]);
+		crc = crc8(crc, payload[i]);
+	}
+	dev_port.write(crc);
+	dev_sentFrames++;
+}
+
+void SerialProtocol::sendReply(ProtocolFrame &frame, const byte *payload, byte length) {
+	sendFrame(frame.getCommand() | SPR_REPLY_FLAG, payload, length);
+}
+
+unsigned long SerialProtocol::getBytesCount() {
+	return dev_bytes;
+}
+
+unsigned long SerialProtocol::getFramesCount() {
+	return dev_frames;
+}
+
+unsigned long SerialProtocol::getChecksumErrorsCount() {
+	return dev_checksumErrors;
+}
+
+unsigned long SerialProtocol::getDroppedBytesCount() {
+	return dev_droppedBytes;
+}
+
+unsigned long SerialProtocol::getUnknownCommandsCount() {
+	return dev_unknownCommands;
+}
+
+unsigned long SerialProtocol::getSentFramesCount() {
+	return dev_sentFrames;
+}
+
+void SerialProtocol::resetStatistics() {
+	dev_bytes = 0;
+	dev_frames = 0;
+	dev_checksumErrors = 0;
+	dev_droppedBytes = 0;
+	dev_unknownCommands = 0;
+	dev_sentFrames = 0;
+}
@@ -0,0 +1,106 @@
+/**
+	SerialProtocol_h - приём команд по последовательному порту в двоичных кадрах без кучи: байты складываются в кольцевой буфер
+	фиксированного размера и разбираются по мере прихода, а принятый кадр передаётся обработчику прямо из буфера, без копирования.
+	Замена приёму строки через String buf += c (см. старый пример PrintSerial), которая на каждом байте перевыделяла память.
+	Кадр:
+		SPR_SYNC (0xA5) | команда | длина данных (0..SPR_MAX_PAYLOAD) | данные | CRC-8 (многочлен 0x07) от команды, длины и данных
+	Числа в данных передаются младшим байтом вперёд.
+	При создании указывается порт (обычно Serial), его скорость задаёт скетч (Serial.begin()).
+	Обработчики добавляются методом addCommand(команда, функция) (до SPR_MAX_COMMANDS = 12), функция получает ProtocolFrame &frame:
+		* frame.getCommand(), frame.getLength() - команда и длина данных.
+		* frame.getByte(i), frame.getWord(i), frame.getLong(i) - числа из данных по смещению i, читаются прямо из кольцевого буфера.
+		* frame.copyTo(буфер, размер) - скопировать данные, frame.copyText(буфер, размер) - скопировать как строку с нулём в конце.
+		Данные действительны только до выхода из обработчика.
+	Ответы: sendFrame(команда, данные, длина) или sendReply(frame, данные, длина) - ответ с командой запроса | SPR_REPLY_FLAG.
+	Метод processInput() вызывается в loop(): он забирает все принятые портом байты и вызывает обработчики целых кадров.
+	Байты можно подавать и по одному методом feed(байт). Из обработчика processInput() и feed() вызывать нельзя.
+	Разбор: байты до SPR_SYNC пропускаются. Если длина больше SPR_MAX_PAYLOAD или не сошлась контрольная сумма, отбрасывается только
+	байт SPR_SYNC, и поиск начала кадра продолжается с уже принятых байтов - так после потерянного байта теряется один кадр, а не поток.
+	Встроенная команда SPR_CMD_STATISTICS (0x00) отвечает счётчиками (по 4 байта): принято байт, кадров, ошибок контрольной суммы,
+	пропущенных байтов, неизвестных команд. На неизвестную команду приходит ответ SPR_REPLY_UNKNOWN с её кодом.
+	Коды SPR_CMD_DIGITS, SPR_CMD_TEXT, SPR_CMD_MELODY, SPR_CMD_STOP, SPR_CMD_VOLTAGE - общие для скетчей с индикатором, плеером и вольтметром
+	(см. пример IndicatorCommands), обработчики для них пишет скетч.
+	Статистика: getBytesCount(), getFramesCount(), getChecksumErrorsCount(), getDroppedBytesCount(), getUnknownCommandsCount(),
+	getSentFramesCount(), resetStatistics(). Байты, потерянные самим портом (его буфер - 64 байта), видны как ошибки контрольной суммы.
+	ExtNeon.
+*/
+
+#ifndef SerialProtocol_h
+#define SerialProtocol_h
+
+#include "Arduino.h"
+
+#define SPR_RING_SIZE 128 //Степень двойки, не меньше SPR_MAX_PAYLOAD + 4
+#define SPR_MAX_PAYLOAD 64
+#define SPR_MAX_COMMANDS 12
+#define SPR_SYNC 0xA5
+
+#define SPR_REPLY_FLAG 0x80
+#define SPR_REPLY_UNKNOWN 0xFF
+
+#define SPR_CMD_STATISTICS 0x00
+#define SPR_CMD_DIGITS 0x01 //Данные - значения разрядов (setDigitValue())
+#define SPR_CMD_TEXT 0x02 //Данные - текст для print()
+#define SPR_CMD_MELODY 0x03 //Данные - упакованные ноты PP_NOTE() по 2 байта
+#define SPR_CMD_STOP 0x04
+#define SPR_CMD_VOLTAGE 0x05 //Ответ - милливольты, 4 байта
+
+#define DEV_SPR_HEADER_SIZE 3 //Синхробайт, команда, длина
+
+class SerialProtocol;
+
+class ProtocolFrame {
+	public:
+		byte getCommand();
+		byte getLength();
+		byte getByte(byte index);
+		word getWord(byte index);
+		unsigned long getLong(byte index);
+		byte copyTo(byte *destination, byte size);
+		byte copyText(char *destination, byte size);
+	private:
+		friend class SerialProtocol;
+		const byte *dev_ring;
+		byte dev_start; //Начало данных в кольцевом буфере
+		byte dev_command;
+		byte dev_length;
+};
+
+class SerialProtocol {
+	public:
+		SerialProtocol(HardwareSerial &port);
+		boolean addCommand(byte command, void (*handler)(ProtocolFrame &frame));
+		void processInput();
+		void feed(byte value);
+		void sendFrame(byte command, const byte *payload, byte length);
+		void sendReply(ProtocolFrame &frame, const byte *payload, byte length);
+		unsigned long getBytesCount();
+		unsigned long getFramesCount();
+		unsigned long getChecksumErrorsCount();
+		unsigned long getDroppedBytesCount();
+		unsigned long getUnknownCommandsCount();
+		unsigned long getSentFramesCount();
+		void resetStatistics();
+		static byte crc8(byte crc, byte value);
+	private:
+		HardwareSerial &dev_port;
+		byte dev_ring[SPR_RING_SIZE];
+		byte dev_start; //Синхробайт текущего кадра
+		byte dev_count; //Принято байтов текущего кадра (и следующих за ним)
+		byte dev_commands[SPR_MAX_COMMANDS];
+		void (*dev_handlers[SPR_MAX_COMMANDS])(ProtocolFrame &frame);
+		byte dev_commandsCount;
+		unsigned long dev_bytes;
+		unsigned long dev_frames;
+		unsigned long dev_checksumErrors;
+		unsigned long dev_droppedBytes;
+		unsigned long dev_unknownCommands;
+		unsigned long dev_sentFrames;
+		byte dev_at(byte offset);
+		void dev_parse();
+		void dev_resync();
+		void dev_dispatch(ProtocolFrame &frame);
+		void dev_sendStatistics(ProtocolFrame &frame);
+};
+
+#endif
@@ -0,0 +1,95 @@
+#include <SerialProtocol.h>
+#include <SevenSegmentsIndicator.h>
+#include <PatternPlayer.h>
+#include <Voltmeter.h>
+
+// Индикатор, пищалка на ноге 9 и вольтметр на A0 управляются с компьютера кадрами SerialProtocol:
+//   SPR_CMD_DIGITS - значения разрядов, SPR_CMD_TEXT - текст, SPR_CMD_MELODY - ноты PP_NOTE() по 2 байта,
+//   SPR_CMD_STOP - остановить мелодию, SPR_CMD_VOLTAGE - ответ с напряжением на A0 в милливольтах.
+// Куча не используется: кадр разбирается в кольцевом буфере протокола, ноты - в статических массивах скетча.
+#define BUZZER_PIN 9
+#define PLAYER_STEP_MS 10
+
+byte segmentsPins[8] = {2, 3, 4, 5, 6, 7, 8, 14};
+byte digitsPins[4] = {10, 11, 12, 13};
+SevenSegmentsIndicator indicator(segmentsPins, 4, digitsPins);
+SerialProtocol protocol(Serial);
+Voltmeter battery(A0);
+int melodyFrequencies[SPR_MAX_PAYLOAD / 2];
+int melodyDurations[SPR_MAX_PAYLOAD / 2];
+byte playerCountdown = PLAYER_STEP_MS;
+unsigned long millivolts; // getMillivolts() сглаживает результат между вызовами, поэтому читаем его после каждого измерения
+
+void buzzerTone(int frequency, int duration) {
+  tone(BUZZER_PIN, frequency, duration);
+}
+
+void buzzerNoTone() {
+  noTone(BUZZER_PIN);
+}
+
+PatternPlayer player(buzzerTone, buzzerNoTone, PLAYER_STEP_MS);
+
+void setDigits(ProtocolFrame &frame) {
+  for (byte i = 0; i < 4; i++) {
+    indicator.setDigitValue(i, frame.getByte(i));
+  }
+}
+
+void printText(ProtocolFrame &frame) {
+  char text[SPR_MAX_PAYLOAD + 1];
+  frame.copyText(text, sizeof(text));
+  indicator.print(text);
+}
+
+void playMelody(ProtocolFrame &frame) {
+  byte count = frame.getLength() / 2;
+  player.stop();
+  for (byte i = 0; i < count; i++) {
+    word note = frame.getWord(i * 2);
+    melodyFrequencies[i] = PatternPlayer::noteToFrequency(note >> 8);
+    melodyDurations[i] = (note & 0xFF) * PP_DEFAULT_DURATION_UNIT;
+  }
+  player.play(melodyFrequencies, melodyDurations, count);
+}
+
+void stopMelody(ProtocolFrame &frame) {
+  player.stop();
+}
+
+void sendVoltage(ProtocolFrame &frame) {
+  byte reply[4];
+  for (byte i = 0; i < 4; i++) {
+    reply[i] = millivolts >> (8 * i);
+  }
+  protocol.sendReply(frame, reply, sizeof(reply));
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  protocol.addCommand(SPR_CMD_DIGITS, setDigits);
+  protocol.addCommand(SPR_CMD_TEXT, printText);
+  protocol.addCommand(SPR_CMD_MELODY, playMelody);
+  protocol.addCommand(SPR_CMD_STOP, stopMelody);
+  protocol.addCommand(SPR_CMD_VOLTAGE, sendVoltage);
+  indicator.print("----");
+  // Timer0 уже используется millis() - добавляем прерывание по совпадению A (примерно раз в миллисекунду)
+  OCR0A = 0xAF;
+  TIMSK0 |= _BV(OCIE0A);
+}
+
+void loop()
+{
+  protocol.processInput();
+  battery.processMeasurement();
+  millivolts = battery.getMillivolts();
+}
+
+ISR(TIMER0_COMPA_vect) {
+  indicator.refreshNext();
+  if (--playerCountdown == 0) {
+    playerCountdown = PLAYER_STEP_MS;
+    player.processStep();
+  }
+}
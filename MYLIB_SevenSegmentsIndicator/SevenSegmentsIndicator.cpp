@@ -17,12 +17,17 @@
 	Для вывода информации на дисплей можно использовать следующие методы:
 		* Метод print(String str, boolean shiftToRight). Принимает на вход строку, интерпретирует её и записывает в память для вывода. Необязательный параметр - режим выравнивания.
 			Если указано false, то выводимый текст будет выровнен слева, по умолчанию справа.
+		* Метод print(const char *str, boolean shiftToRight) - то же для обычной строки, без кучи: строка разбирается на месте, не копируясь.
+			Его удобно вызывать из обработчиков команд, принятых в буфер фиксированного размера (см. MYLIB_SerialProtocol).
 		* Метод setDigitValue(byte digitIndex, byte value). Принимает на вход индекс разряда и устанавливоемое значение. Устанавливает определённое значение разряда по индексу.
 			Значение разряда вводится в форме байта, в котором каждый бит соотносится с определённым сегментом. 
 			Последовательность (начиная со старшего бита): A, B, C, D, E, F, G, dp.
 		
 	Можно выключать и опять включать индикацию  методом setPowerState(), останавливать смену разрядов методом stopRefreshing() и возобновлять её методом resumeRefreshing().
 	Также, можно физически отключить индикацию точки при помощи метода setPointShow(), который принимает на вход булево значение.
+	Память разрядов конструктор выделяет оператором new и не освобождает. Без кучи её можно передать пятым параметром, после типа выводов разряда
+	(массив на countOfDigits байт) или объявить StaticSevenSegmentsIndicator<N>(пины сегментов, пины разрядов) на N разрядов.
+	При компиляции с MYLIB_STATIC выделяющего конструктора и print(String) нет - вывод строки только через print(const char*).
 	Написано за один вечер. ExtNeon. 06.06.2018
 	
 	
@@ -39,13 +44,29 @@
 
 #include "Arduino.h"
 #include "SevenSegmentsIndicator.h"
+#ifdef MYLIB_PROFILE
+	#include "Profiler.h"
+#else
+	#define PROFILER_SCOPE(id)
+#endif
 
+#ifndef MYLIB_STATIC
 SevenSegmentsIndicator::SevenSegmentsIndicator(byte *segmentPins, byte countOfDigits, byte *digitsPins, boolean digitPinType) {
+	_indicatorMemory = new byte[countOfDigits];
+	dev_init(segmentPins, countOfDigits, digitsPins, digitPinType);
+}
+#endif
+
+SevenSegmentsIndicator::SevenSegmentsIndicator(byte *segmentPins, byte countOfDigits, byte *digitsPins, boolean digitPinType, byte *memory) {
+	_indicatorMemory = memory;
+	dev_init(segmentPins, countOfDigits, digitsPins, digitPinType);
+}
+
+void SevenSegmentsIndicator::dev_init(byte *segmentPins, byte countOfDigits, byte *digitsPins, boolean digitPinType) {
 	_segmentPins = segmentPins;
 	_digitPins = digitsPins;
 	_countOfDigits = countOfDigits;
 	_digitPinType = digitPinType;
-	_indicatorMemory = new byte[countOfDigits];
 	for (int i = 0; i < countOfDigits; i++) {
 		_indicatorMemory[i] = SSI_DIGIT_EIGHT | SSI_ADDITIVE_DOTPOINT;
 	}
@@ -57,38 +78,39 @@ SevenSegmentsIndicator::SevenSegmentsIndicator(byte *segmentPins, byte countOfDi
 
 SevenSegmentsIndicator::SevenSegmentsIndicator() {}
 
+#ifndef MYLIB_STATIC
 void SevenSegmentsIndicator::print(String str, boolean shiftToRight) {
-	//Serial.println("LAST DIGIT VALUE IS " + String(_indicatorMemory[_countOfDigits - 1]));
-	//delay(1000);
-	while (str.length() < _countOfDigits) {
-		if (shiftToRight) {
-			str = ' ' + str;
-		} else {
-			str = str + ' ';
-		}
+	print(str.c_str(), shiftToRight);
+}
+#endif
+
+void SevenSegmentsIndicator::print(const char *str, boolean shiftToRight) {
+	if (str == NULL) str = "";
+	//Символ - любой знак, кроме точки сразу после не-точки: она добавляется к предыдущему разряду
+	byte symbolsCount = 0;
+	for (const char *c = str; *c; c++) {
+		if (*c != '.' || c == str || c[-1] == '.') symbolsCount++;
 	}
-	word usedDigits = 0;
-	int lastStrIndex;
-	for (lastStrIndex = 0; lastStrIndex <= str.length() && usedDigits <= _countOfDigits; lastStrIndex++) {
-		if (str.charAt(lastStrIndex) != '.') usedDigits++;
+	byte blank = interpretateSymbolToActiveSegments(' ');
+	byte i = 0;
+	if (shiftToRight) {
+		for (; i + symbolsCount < _countOfDigits; i++) {
+			_indicatorMemory[i] = blank;
+		}
 	}
-	String cuttedStr = str.substring(0, lastStrIndex);
-	cuttedStr.toUpperCase();
-	//Serial.println("CUTTED STR = " + cuttedStr);
-	for (int i = 0; i < _countOfDigits && cuttedStr.length() > 0; i++) {
-		_indicatorMemory[i] = interpretateSymbolToActiveSegments(cuttedStr.charAt(0));
-		//Serial.println(String(i) + " print cycle iteration. Processing " + cuttedStr.charAt(0) + ". Tranlsated into: " + String(interpretateSymbolToActiveSegments(String(cuttedStr.charAt(0)))));
-		
-		boolean manyDotsFlag = cuttedStr.charAt(0) == '.';
-		cuttedStr = cuttedStr.substring(1, cuttedStr.length());
-		if (cuttedStr.length() > 0 && !manyDotsFlag) {
-			if (cuttedStr.charAt(0) == '.') {
-				_indicatorMemory[i] = _indicatorMemory[i] | SSI_ADDITIVE_DOTPOINT; //Binary OR
-				cuttedStr = cuttedStr.substring(1, cuttedStr.length());
-			}
+	const char *c = str;
+	for (; i < _countOfDigits && *c; i++) {
+		boolean isDot = *c == '.';
+		_indicatorMemory[i] = interpretateSymbolToActiveSegments(toupper(*c));
+		c++;
+		if (!isDot && *c == '.') {
+			_indicatorMemory[i] |= SSI_ADDITIVE_DOTPOINT;
+			c++;
 		}
 	}
-	
+	for (; i < _countOfDigits; i++) {
+		_indicatorMemory[i] = blank;
+	}
 }
 
 void SevenSegmentsIndicator::displayCustomSymbols(byte* symbols, byte countOfSymbols) {
@@ -218,6 +240,7 @@ void SevenSegmentsIndicator::setDigitValue(byte digitIndex, byte value) {
 }
 
 void SevenSegmentsIndicator::refreshNext() {
+	PROFILER_SCOPE(PROFILER_ID_SEVEN_SEGMENTS_REFRESH);
 	if (_enabled) {
 		if (_refreshing){
 			if (_currentActiveDigit >= 0) {
@@ -17,6 +17,8 @@
 	Для вывода информации на дисплей можно использовать следующие методы:
 		* Метод print(String str, boolean shiftToRight). Принимает на вход строку, интерпретирует её и записывает в память для вывода. Необязательный параметр - режим выравнивания.
 			Если указано false, то выводимый текст будет выровнен слева, по умолчанию справа.
+		* Метод print(const char *str, boolean shiftToRight) - то же для обычной строки, без кучи: строка разбирается на месте, не копируясь.
+			Его удобно вызывать из обработчиков команд, принятых в буфер фиксированного размера (см. MYLIB_SerialProtocol).
 		* Метод setDigitValue(byte digitIndex, byte value). Принимает на вход индекс разряда и устанавливоемое значение. Устанавливает определённое значение разряда по индексу.
 			Значение разряда вводится в форме байта, в котором каждый бит соотносится с определённым сегментом. 
 			Последовательность (начиная со старшего бита): A, B, C, D, E, F, G, dp.
@@ -26,6 +28,9 @@
 		
 	Можно выключать и опять включать индикацию  методом setPowerState(), останавливать смену разрядов методом stopRefreshing() и возобновлять её методом resumeRefreshing().
 	Также, можно физически отключить индикацию точки при помощи метода setPointShow(), который принимает на вход булево значение.
+	Память разрядов конструктор выделяет оператором new и не освобождает. Без кучи её можно передать пятым параметром, после типа выводов разряда
+	(массив на countOfDigits байт) или объявить StaticSevenSegmentsIndicator<N>(пины сегментов, пины разрядов) на N разрядов.
+	При компиляции с MYLIB_STATIC выделяющего конструктора и print(String) нет - вывод строки только через print(const char*).
 	Написано за один вечер. ExtNeon. 06.06.2018
 	
 	
@@ -90,10 +95,16 @@ const byte SSI_ADDITIVE_DOTPOINT = 0b00000001;
 
 class SevenSegmentsIndicator {
 	public:
+#ifndef MYLIB_STATIC
 		SevenSegmentsIndicator(byte *segmentPins, byte countOfDigits, byte *digitsPins, boolean digitPinType = SSI_DGPIN_ANODE); //+
+#endif
+		SevenSegmentsIndicator(byte *segmentPins, byte countOfDigits, byte *digitsPins, boolean digitPinType, byte *memory);
 		SevenSegmentsIndicator();
 		void refreshNext(); //+
+#ifndef MYLIB_STATIC
 		void print(String str, boolean shiftToRight = true); //+
+#endif
+		void print(const char *str, boolean shiftToRight = true);
 		void displayCustomSymbols(byte* symbols, byte countOfSymbols); //++
 		void setPowerState(boolean enabled); //+
 		boolean getPowerState(); //+
@@ -115,6 +126,15 @@ class SevenSegmentsIndicator {
 		void insolateDigitPins(); //+
 		byte interpretateSymbolToActiveSegments(char __inputSymbol ); //+
 		boolean getBitState(byte input, byte bitIndex); //+
+		void dev_init(byte *segmentPins, byte countOfDigits, byte *digitsPins, boolean digitPinType);
+};
+
+template <byte N> class StaticSevenSegmentsIndicator : public SevenSegmentsIndicator {
+	public:
+		StaticSevenSegmentsIndicator(byte *segmentPins, byte *digitsPins, boolean digitPinType = SSI_DGPIN_ANODE) :
+			SevenSegmentsIndicator(segmentPins, N, digitsPins, digitPinType, dev_storage) {}
+	private:
+		byte dev_storage[N];
 };
 
 #endif
\ No newline at end of file
@@ -16,7 +16,10 @@ void setup()
   TIMSK0 |= _BV(OCIE0A);
 }
 
-String buf = "";
+// Строка копится в массиве фиксированного размера, а не в String: String перевыделял память на каждом байте.
+// Двоичные команды с контрольной суммой - в примере IndicatorCommands библиотеки MYLIB_SerialProtocol.
+char buf[32];
+byte bufLength = 0;
 
 void loop()
 { 
@@ -24,10 +27,11 @@ void loop()
   while (Serial.available()) {
     char a = (char) Serial.read();
     if (a == '\n') {
+      buf[bufLength] = 0;
       indicator.print(buf, false);
-      buf = "";
-    } else {
-      buf += a;
+      bufLength = 0;
+    } else if (bufLength < sizeof(buf) - 1) {
+      buf[bufLength++] = a;
     }
   }
   //indicator.print(String(millis() / 1000));
@@ -0,0 +1,174 @@
+/**
+	SleepManager_h - менеджер сна для устройств на батарейках. Вместо того чтобы будить контроллер на каждый шаг всех библиотек, он спрашивает
+	у каждого компонента, когда тот понадобится в следующий раз, и спит до этого момента в самом глубоком допустимом режиме.
+	Компонент добавляется методом addComponent(), которому передаются две функции:
+		* Срок - сколько миллисекунд компоненту можно не вызывать processStep(). 0 - нужен каждый шаг, SM_NO_DEADLINE - ждать нечего.
+		* Учёт сна (необязательно) - вызывается после глубокого сна с проспанным временем в миллисекундах, пока шаги не вызывались.
+	Сроки библиотек MYLIB_*:
+		* HandledEventTimer - getTimeToNextEvent(), учёт сна - processMcsStep(проспанное время) (интервалы событий должны быть в миллисекундах).
+		* PatternPlayer, KeyframePlayer - getTimeToNextStep(), учёт сна - processStepMs(проспанное время).
+		* HandledButton - isSettling() || isPressed() ? 0 : SM_NO_DEADLINE. Ногу кнопки нужно добавить методом addWakePin(), тогда нажатие разбудит контроллер.
+		* SevenSegmentsIndicator - getPowerState() ? 0 : SM_NO_DEADLINE: включённый индикатор нужно обновлять постоянно.
+	Пример:
+		unsigned long eventsDeadline() {return events.getTimeToNextEvent();}
+		void eventsCatchUp(unsigned long sleptMs) {events.processMcsStep(sleptMs);}
+		...
+		sleeper.addComponent(eventsDeadline, eventsCatchUp);
+		sleeper.addWakePin(BUTTON_PIN);
+		...
+		void loop() {
+			events.processHandlers();
+			button.processHandlers();
+			sleeper.sleep();
+		}
+	Метод sleep() выбирает режим:
+		* Если ближайший срок меньше SM_MIN_DEEP_SLEEP (16 мс - наименьший период сторожевого таймера), контроллер засыпает в режиме idle до любого
+			прерывания (тика TickDispatcher или Timer0 ядра Arduino). Таймеры работают, шаги вызываются как обычно.
+		* Иначе - power-down. Будит сторожевой таймер через наибольший период из 16, 32, ... 8192 мс, не превышающий срок, или смена уровня на ноге
+			из addWakePin(). Timer0 и Timer2 в power-down стоят, поэтому millis() и TickDispatcher это время не видят: проспанное время передаётся
+			компонентам через функции учёта сна, а общая сумма возвращается методом getSleptMillis().
+			Если разбудила нога, сколько прошло времени, неизвестно: учитывается 0, поэтому события таймера могут запоздать не больше чем на период сна.
+	Обработчики прерываний объявляются в скетче (без них прерывание перезапускает контроллер):
+		ISR(WDT_vect) {
+			sleeper.processWatchdog();
+		}
+		EMPTY_INTERRUPT(PCINT2_vect); //Ноги 0-7; PCINT0_vect - ноги 8-13, PCINT1_vect - A0-A5
+	Сторожевой таймер используется только на время глубокого сна и после пробуждения выключается.
+	Статистика: getIdleSleepsCount(), getDeepSleepsCount(), getSleptMillis(). На компьютере эмулятор считает время в каждом режиме сна
+	(HostMcu::getSleepCycles(SLEEP_MODE_*)), по нему считается доля активного времени (см. host/bench/bench_sleep.cpp).
+	ExtNeon.
+*/
+
+#include "Arduino.h"
+#include "SleepManager.h"
+
+SleepManager::SleepManager() {
+	dev_componentsCount = 0;
+	for (byte i = 0; i < 3; i++) {
+		dev_pinChangeMasks[i] = 0;
+	}
+	dev_deepSleepAllowed = true;
+	dev_watchdogFired = false;
+	dev_sleptMillis = 0;
+	dev_idleSleeps = 0;
+	dev_deepSleeps = 0;
+}
+
+boolean SleepManager::addComponent(unsigned long (*deadlineFunc)(), void (*catchUpFunc)(unsigned long sleptMs)) {
+	if (deadlineFunc == NULL || dev_componentsCount >= SM_MAX_COMPONENTS) return false;
+	dev_components[dev_componentsCount].deadlineFunc = deadlineFunc;
+	dev_components[dev_componentsCount].catchUpFunc = catchUpFunc;
+	dev_componentsCount++;
+	return true;
+}
+
+boolean SleepManager::addWakePin(byte pin) {
+#if defined (__AVR_ATmega328__) || defined (__AVR_ATmega328P__) || defined(__AVR_ATmega168__) || defined(__AVR_ATmega88__) || defined(MYLIB_HOST)
+	if (pin < 8) {
+		dev_pinChangeMasks[2] |= _BV(pin); //PORTD - PCINT16..23
+	} else if (pin < 14) {
+		dev_pinChangeMasks[0] |= _BV(pin - 8); //PORTB - PCINT0..5
+	} else if (pin < 20) {
+		dev_pinChangeMasks[1] |= _BV(pin - 14); //PORTC - PCINT8..13
+	} else {
+		return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+void SleepManager::setDeepSleepAllowed(boolean allowed) {
+	dev_deepSleepAllowed = allowed;
+}
+
+unsigned long SleepManager::getNextDeadline() {
+	unsigned long nearest = SM_NO_DEADLINE;
+	for (byte i = 0; i < dev_componentsCount; i++) {
+		unsigned long deadline = dev_components[i].deadlineFunc();
+		if (deadline < nearest) nearest = deadline;
+	}
+	return nearest;
+}
+
+byte SleepManager::sleep() {
+	unsigned long deadline = getNextDeadline();
+	if (!dev_deepSleepAllowed || deadline < SM_MIN_DEEP_SLEEP) {
+		dev_sleepIdle();
+		return SM_SLEEP_IDLE;
+	}
+	byte prescaler = 0; //Наибольший период сторожевого таймера, не превышающий срок
+	while (prescaler < SM_MAX_WATCHDOG_PRESCALER && ((unsigned long) SM_MIN_DEEP_SLEEP << (prescaler + 1)) <= deadline) prescaler++;
+	unsigned long slept = dev_sleepDeep(prescaler);
+	dev_sleptMillis += slept;
+	if (slept > 0) {
+		for (byte i = 0; i < dev_componentsCount; i++) {
+			if (dev_components[i].catchUpFunc != NULL) dev_components[i].catchUpFunc(slept);
+		}
+	}
+	return SM_SLEEP_DEEP;
+}
+
+void SleepManager::dev_sleepIdle() {
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	sleep_enable();
+	sleep_cpu();
+	sleep_disable();
+	dev_idleSleeps++;
+}
+
+unsigned long SleepManager::dev_sleepDeep(byte prescaler) {
+	cli();
+	dev_watchdogFired = false;
+	wdt_reset();
+	WDTCSR = _BV(WDCE) | _BV(WDE); //Смена настроек - в течение 4 тактов после этой записи
+	WDTCSR = _BV(WDIE) | (prescaler & 7) | ((prescaler & 8) ? _BV(WDP3) : 0);
+#if defined (__AVR_ATmega328__) || defined (__AVR_ATmega328P__) || defined(__AVR_ATmega168__) || defined(__AVR_ATmega88__) || defined(MYLIB_HOST)
+	byte oldPinChangeControl = PCICR;
+	byte oldPinChangeMasks[3] = {PCMSK0, PCMSK1, PCMSK2};
+	byte pinChangeControl = 0;
+	for (byte i = 0; i < 3; i++) {
+		if (dev_pinChangeMasks[i]) pinChangeControl |= _BV(i);
+	}
+	PCMSK0 = oldPinChangeMasks[0] | dev_pinChangeMasks[0];
+	PCMSK1 = oldPinChangeMasks[1] | dev_pinChangeMasks[1];
+	PCMSK2 = oldPinChangeMasks[2] | dev_pinChangeMasks[2];
+	PCIFR = pinChangeControl; //Старые изменения уровня не должны будить сразу
+	PCICR = oldPinChangeControl | pinChangeControl;
+#endif
+	set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+	sleep_enable();
+	sleep_bod_disable();
+	sei(); //Инструкция после sei() выполняется до любого прерывания, поэтому пробуждение не потеряется
+	sleep_cpu();
+	sleep_disable();
+	cli();
+	WDTCSR = _BV(WDCE) | _BV(WDE);
+	WDTCSR = 0;
+#if defined (__AVR_ATmega328__) || defined (__AVR_ATmega328P__) || defined(__AVR_ATmega168__) || defined(__AVR_ATmega88__) || defined(MYLIB_HOST)
+	PCICR = oldPinChangeControl;
+	PCMSK0 = oldPinChangeMasks[0];
+	PCMSK1 = oldPinChangeMasks[1];
+	PCMSK2 = oldPinChangeMasks[2];
+#endif
+	sei();
+	dev_deepSleeps++;
+	return dev_watchdogFired ? (unsigned long) SM_MIN_DEEP_SLEEP << prescaler : 0;
+}
+
+void SleepManager::processWatchdog() {
+	dev_watchdogFired = true;
+}
+
+unsigned long SleepManager::getSleptMillis() {
+	return dev_sleptMillis;
+}
+
+unsigned long SleepManager::getIdleSleepsCount() {
+	return dev_idleSleeps;
+}
+
+unsigned long SleepManager::getDeepSleepsCount() {
+	return dev_deepSleeps;
+}
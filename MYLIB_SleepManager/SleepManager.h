@@ -0,0 +1,88 @@
+/**
+	SleepManager_h - менеджер сна для устройств на батарейках. Вместо того чтобы будить контроллер на каждый шаг всех библиотек, он спрашивает
+	у каждого компонента, когда тот понадобится в следующий раз, и спит до этого момента в самом глубоком допустимом режиме.
+	Компонент добавляется методом addComponent(), которому передаются две функции:
+		* Срок - сколько миллисекунд компоненту можно не вызывать processStep(). 0 - нужен каждый шаг, SM_NO_DEADLINE - ждать нечего.
+		* Учёт сна (необязательно) - вызывается после глубокого сна с проспанным временем в миллисекундах, пока шаги не вызывались.
+	Сроки библиотек MYLIB_*:
+		* HandledEventTimer - getTimeToNextEvent(), учёт сна - processMcsStep(проспанное время) (интервалы событий должны быть в миллисекундах).
+		* PatternPlayer, KeyframePlayer - getTimeToNextStep(), учёт сна - processStepMs(проспанное время).
+		* HandledButton - isSettling() || isPressed() ? 0 : SM_NO_DEADLINE. Ногу кнопки нужно добавить методом addWakePin(), тогда нажатие разбудит контроллер.
+		* SevenSegmentsIndicator - getPowerState() ? 0 : SM_NO_DEADLINE: включённый индикатор нужно обновлять постоянно.
+	Пример:
+		unsigned long eventsDeadline() {return events.getTimeToNextEvent();}
+		void eventsCatchUp(unsigned long sleptMs) {events.processMcsStep(sleptMs);}
+		...
+		sleeper.addComponent(eventsDeadline, eventsCatchUp);
+		sleeper.addWakePin(BUTTON_PIN);
+		...
+		void loop() {
+			events.processHandlers();
+			button.processHandlers();
+			sleeper.sleep();
+		}
+	Метод sleep() выбирает режим:
+		* Если ближайший срок меньше SM_MIN_DEEP_SLEEP (16 мс - наименьший период сторожевого таймера), контроллер засыпает в режиме idle до любого
+			прерывания (тика TickDispatcher или Timer0 ядра Arduino). Таймеры работают, шаги вызываются как обычно.
+		* Иначе - power-down. Будит сторожевой таймер через наибольший период из 16, 32, ... 8192 мс, не превышающий срок, или смена уровня на ноге
+			из addWakePin(). Timer0 и Timer2 в power-down стоят, поэтому millis() и TickDispatcher это время не видят: проспанное время передаётся
+			компонентам через функции учёта сна, а общая сумма возвращается методом getSleptMillis().
+			Если разбудила нога, сколько прошло времени, неизвестно: учитывается 0, поэтому события таймера могут запоздать не больше чем на период сна.
+	Обработчики прерываний объявляются в скетче (без них прерывание перезапускает контроллер):
+		ISR(WDT_vect) {
+			sleeper.processWatchdog();
+		}
+		EMPTY_INTERRUPT(PCINT2_vect); //Ноги 0-7; PCINT0_vect - ноги 8-13, PCINT1_vect - A0-A5
+	Сторожевой таймер используется только на время глубокого сна и после пробуждения выключается.
+	Статистика: getIdleSleepsCount(), getDeepSleepsCount(), getSleptMillis(). На компьютере эмулятор считает время в каждом режиме сна
+	(HostMcu::getSleepCycles(SLEEP_MODE_*)), по нему считается доля активного времени (см. host/bench/bench_sleep.cpp).
+	ExtNeon.
+*/
+
+#ifndef SleepManager_h
+#define SleepManager_h
+
+#include "Arduino.h"
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+
+#define SM_MAX_COMPONENTS 8
+#define SM_NO_DEADLINE 0xFFFFFFFFUL
+#define SM_MIN_DEEP_SLEEP 16 //Наименьший период сторожевого таймера, мс
+#define SM_MAX_WATCHDOG_PRESCALER 9 //8192 мс
+
+#define SM_SLEEP_IDLE 1
+#define SM_SLEEP_DEEP 2
+
+class SleepComponent {
+	public:
+		unsigned long (*deadlineFunc)();
+		void (*catchUpFunc)(unsigned long sleptMs);
+};
+
+class SleepManager {
+	public:
+		SleepManager();
+		boolean addComponent(unsigned long (*deadlineFunc)(), void (*catchUpFunc)(unsigned long sleptMs) = NULL);
+		boolean addWakePin(byte pin);
+		void setDeepSleepAllowed(boolean allowed);
+		unsigned long getNextDeadline();
+		byte sleep(); //Возвращает SM_SLEEP_IDLE или SM_SLEEP_DEEP
+		void processWatchdog(); //Вызывается из ISR(WDT_vect)
+		unsigned long getSleptMillis();
+		unsigned long getIdleSleepsCount();
+		unsigned long getDeepSleepsCount();
+	private:
+		SleepComponent dev_components[SM_MAX_COMPONENTS];
+		byte dev_componentsCount;
+		byte dev_pinChangeMasks[3]; //PCMSK0, PCMSK1, PCMSK2
+		boolean dev_deepSleepAllowed;
+		volatile boolean dev_watchdogFired;
+		unsigned long dev_sleptMillis;
+		unsigned long dev_idleSleeps;
+		unsigned long dev_deepSleeps;
+		void dev_sleepIdle();
+		unsigned long dev_sleepDeep(byte prescaler);
+};
+
+#endif
@@ -0,0 +1,73 @@
+#include <SleepManager.h>
+#include <TickDispatcher.h>
+#include <HandledEventTimer.h>
+#include <HandledButton.h>
+
+// Светодиод мигает раз в 2 секунды, кнопка на ноге 2 переключает мигание. Всё остальное время контроллер спит в power-down.
+TickDispatcher ticker(1000);
+SleepManager sleeper;
+HandledEventTimer events(1);
+HandledButton button(2, 1);
+boolean blinking = true;
+
+ISR(TIMER2_COMPA_vect) {
+  ticker.processTick();
+}
+
+ISR(WDT_vect) {
+  sleeper.processWatchdog();
+}
+
+EMPTY_INTERRUPT(PCINT2_vect);
+
+void blink() {
+  if (!blinking) return;
+  digitalWrite(LED_BUILTIN, HIGH);
+  delay(5);
+  digitalWrite(LED_BUILTIN, LOW);
+}
+
+void toggleBlinking() {
+  blinking = !blinking;
+}
+
+void eventsTask() {
+  events.processStep();
+}
+
+void buttonTask() {
+  button.processStep();
+}
+
+unsigned long eventsDeadline() {
+  return events.getTimeToNextEvent();
+}
+
+void eventsCatchUp(unsigned long sleptMs) {
+  events.processMcsStep(sleptMs);
+}
+
+unsigned long buttonDeadline() {
+  return button.isSettling() || button.isPressed() ? 0 : SM_NO_DEADLINE;
+}
+
+void setup()
+{
+  pinMode(LED_BUILTIN, OUTPUT);
+  events.createRepeatedEvent(2000, blink, 0);
+  events.start();
+  button.attachHandlerToPushDown(toggleBlinking);
+  ticker.addTask(eventsTask);
+  ticker.addTask(buttonTask);
+  ticker.begin();
+  sleeper.addComponent(eventsDeadline, eventsCatchUp);
+  sleeper.addComponent(buttonDeadline);
+  sleeper.addWakePin(2);
+}
+
+void loop()
+{
+  events.processHandlers();
+  button.processHandlers();
+  sleeper.sleep();
+}
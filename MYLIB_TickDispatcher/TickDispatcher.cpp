@@ -0,0 +1,228 @@
+/**
+	TickDispatcher_h - библиотека, заменяющая самописный обработчик прерывания таймера, из которого вызываются все processStep() библиотек MYLIB_*.
+	Диспетчер занимает Timer2 в режиме CTC и на каждом тике вызывает зарегистрированные задачи, каждую со своим делителем частоты и фазой.
+	Кнопкам нужен 1 мс, индикатору 2 мс, плееру 10 мс - с тиком 1 мс задаются делители 1, 2 и 10, а фазы разносят задачи
+	по разным тикам, чтобы они не собирались в одном прерывании.
+	При создании указывается:
+		* Период тика в микросекундах (не больше 16384 при 16 МГц).
+	После, нужно добавить задачи методом addTask(), параметрами которого являются функция, делитель и фаза. Он возвращает ID задачи (TD_NO_TASK, если места нет).
+	Если фаза не задана (TD_AUTO_PHASE), диспетчер выбирает ту, при которой задача реже всего совпадает с уже добавленными.
+	Метод begin() настраивает таймер и разрешает прерывание. Возвращает false, если такой период таймером не получить.
+	Обработчик прерывания объявляется в скетче:
+		TickDispatcher ticker(1000);
+		ISR(TIMER2_COMPA_vect) {
+			ticker.processTick();
+		}
+	Timer2 также использует tone(), поэтому вместе с диспетчером звук нужно выводить через Timer1 (см. PatternPlayer).
+	Статистика на задачу: количество вызовов, суммарное и максимальное время в тактах процессора (getTaskCycles(), getTaskMaxCycles()).
+	Время меряется по счётчику таймера, поэтому его точность - один шаг предделителя.
+	getTickMaxCycles() - самое долгое прерывание целиком, getOverrunsCount() - сколько раз прерывание не успело закончиться до следующего тика.
+	ExtNeon.
+*/
+
+#include "Arduino.h"
+#include "TickDispatcher.h"
+
+TickDispatcher::TickDispatcher(unsigned int tickMicros) {
+	dev_tickMicros = tickMicros;
+	dev_tasksCount = 0;
+	dev_prescaler = 0;
+	dev_clockSelect = 0;
+	dev_compareValue = 0;
+	dev_ticksCount = 0;
+	resetStatistics();
+}
+
+boolean TickDispatcher::begin() {
+	static const word prescalers[7] = {1, 8, 32, 64, 128, 256, 1024}; //Предделители Timer2, CS22..CS20 = 1..7
+	unsigned long cycles = (unsigned long)dev_tickMicros * (F_CPU / 1000000UL);
+	if (cycles == 0) return false;
+	for (byte i = 0; i < 7; i++) {
+		if (cycles / prescalers[i] > 256) continue;
+		dev_prescaler = prescalers[i];
+		dev_clockSelect = i + 1;
+		dev_compareValue = cycles / prescalers[i] - 1;
+		uint8_t oldSREG = SREG;
+		cli();
+		TIMSK2 &= ~(_BV(OCIE2A) | _BV(OCIE2B) | _BV(TOIE2));
+		ASSR &= ~_BV(AS2);
+		TCCR2A = _BV(WGM21); //CTC, TOP = OCR2A
+		TCCR2B = dev_clockSelect;
+		OCR2A = dev_compareValue;
+		TCNT2 = 0;
+		TIFR2 = _BV(OCF2A) | _BV(OCF2B) | _BV(TOV2);
+		TIMSK2 |= _BV(OCIE2A);
+		SREG = oldSREG;
+		return true;
+	}
+	return false;
+}
+
+void TickDispatcher::start() {
+	if (dev_clockSelect == 0) return;
+	TIFR2 = _BV(OCF2A);
+	TIMSK2 |= _BV(OCIE2A);
+}
+
+void TickDispatcher::stop() {
+	TIMSK2 &= ~_BV(OCIE2A);
+}
+
+boolean TickDispatcher::isRunning() {
+	return dev_clockSelect != 0 && (TIMSK2 & _BV(OCIE2A));
+}
+
+byte TickDispatcher::addTask(void (*taskFunc)(), byte divider, byte phase) {
+	if (taskFunc == NULL || dev_tasksCount >= TD_MAX_TASKS) return TD_NO_TASK;
+	if (divider == 0) divider = 1;
+	phase = phase == TD_AUTO_PHASE ? dev_choosePhase(divider) : phase % divider;
+	TickTask &task = dev_tasks[dev_tasksCount];
+	task.taskFunc = taskFunc;
+	task.divider = divider;
+	task.phase = phase;
+	task.calls = 0;
+	task.totalCycles = 0;
+	task.maxCycles = 0;
+	uint8_t oldSREG = SREG;
+	cli();
+	task.countdown = (phase + divider - dev_ticksCount % divider) % divider + 1; //Фаза отсчитывается от общего счётчика тиков
+	task.enabled = true;
+	dev_tasksCount++;
+	SREG = oldSREG;
+	return dev_tasksCount - 1;
+}
+
+void TickDispatcher::setTaskEnabled(byte taskId, boolean enabled) {
+	if (taskId >= dev_tasksCount) return;
+	dev_tasks[taskId].enabled = enabled;
+}
+
+byte TickDispatcher::getTasksCount() {
+	return dev_tasksCount;
+}
+
+byte TickDispatcher::getTaskPhase(byte taskId) {
+	if (taskId >= dev_tasksCount) return 0;
+	return dev_tasks[taskId].phase;
+}
+
+unsigned int TickDispatcher::getTickMicros() {
+	return dev_tickMicros;
+}
+
+byte TickDispatcher::dev_gcd(byte a, byte b) {
+	while (b) {
+		byte temp = a % b;
+		a = b;
+		b = temp;
+	}
+	return a;
+}
+
+byte TickDispatcher::dev_choosePhase(byte divider) {
+	//Задачи с делителями d1, d2 и фазами p1, p2 совпадают, если (p1 - p2) делится на НОД(d1, d2), и тогда - раз в НОК(d1, d2) тиков.
+	//Выбираем фазу с наименьшей суммарной частотой совпадений, при равенстве - наименьшую.
+	byte bestPhase = 0;
+	word bestCost = 0xFFFF;
+	for (byte phase = 0; phase < divider; phase++) {
+		word cost = 0;
+		for (byte i = 0; i < dev_tasksCount; i++) {
+			byte gcd = dev_gcd(divider, dev_tasks[i].divider);
+			if (((int)phase - dev_tasks[i].phase) % gcd == 0) cost += ((word)gcd << 8) / dev_tasks[i].divider;
+		}
+		if (cost < bestCost) {
+			bestCost = cost;
+			bestPhase = phase;
+		}
+	}
+	return bestPhase;
+}
+
+unsigned long TickDispatcher::dev_elapsedCycles(byte fromCount, byte toCount) {
+	word period = dev_compareValue + 1;
+	word counts = toCount >= fromCount ? toCount - fromCount : period - fromCount + toCount;
+	return (unsigned long)counts * dev_prescaler;
+}
+
+void TickDispatcher::processTick() {
+	for (byte i = 0; i < dev_tasksCount; i++) {
+		TickTask &task = dev_tasks[i];
+		if (--task.countdown) continue;
+		task.countdown = task.divider;
+		if (!task.enabled) continue;
+		byte startCount = TCNT2;
+		boolean startFlag = TIFR2 & _BV(OCF2A);
+		task.taskFunc();
+		byte endCount = TCNT2;
+		unsigned long cycles = dev_elapsedCycles(startCount, endCount);
+		if (!startFlag && (TIFR2 & _BV(OCF2A))) cycles += (unsigned long)(dev_compareValue + 1) * dev_prescaler; //Задача заняла больше тика
+		task.calls++;
+		task.totalCycles += cycles;
+		if (cycles > task.maxCycles) task.maxCycles = cycles;
+	}
+	dev_ticksCount++;
+	unsigned long tickCycles = dev_elapsedCycles(0, TCNT2); //Счётчик сбрасывается в 0 в момент тика, так что сюда входит и вход в прерывание
+	if (TIFR2 & _BV(OCF2A)) { //Следующий тик уже наступил
+		dev_overrunsCount++;
+		tickCycles += (unsigned long)(dev_compareValue + 1) * dev_prescaler;
+	}
+	if (tickCycles > dev_tickMaxCycles) dev_tickMaxCycles = tickCycles;
+}
+
+unsigned long TickDispatcher::dev_atomicRead(volatile unsigned long *value) {
+	uint8_t oldSREG = SREG;
+	cli();
+	unsigned long temp = *value;
+	SREG = oldSREG;
+	return temp;
+}
+
+unsigned long TickDispatcher::getTicksCount() {
+	return dev_atomicRead(&dev_ticksCount);
+}
+
+unsigned long TickDispatcher::getTaskCalls(byte taskId) {
+	if (taskId >= dev_tasksCount) return 0;
+	return dev_atomicRead(&dev_tasks[taskId].calls);
+}
+
+unsigned long TickDispatcher::getTaskCycles(byte taskId) {
+	if (taskId >= dev_tasksCount) return 0;
+	return dev_atomicRead(&dev_tasks[taskId].totalCycles);
+}
+
+unsigned long TickDispatcher::getTaskMaxCycles(byte taskId) {
+	if (taskId >= dev_tasksCount) return 0;
+	return dev_atomicRead(&dev_tasks[taskId].maxCycles);
+}
+
+float TickDispatcher::getTaskAverageMicros(byte taskId) {
+	uint8_t oldSREG = SREG;
+	cli();
+	unsigned long calls = getTaskCalls(taskId);
+	unsigned long cycles = getTaskCycles(taskId);
+	SREG = oldSREG;
+	if (calls == 0) return 0;
+	return (float)cycles / calls / (F_CPU / 1000000.);
+}
+
+unsigned long TickDispatcher::getTickMaxCycles() {
+	return dev_atomicRead(&dev_tickMaxCycles);
+}
+
+unsigned long TickDispatcher::getOverrunsCount() {
+	return dev_atomicRead(&dev_overrunsCount);
+}
+
+void TickDispatcher::resetStatistics() {
+	uint8_t oldSREG = SREG;
+	cli();
+	for (byte i = 0; i < dev_tasksCount; i++) {
+		dev_tasks[i].calls = 0;
+		dev_tasks[i].totalCycles = 0;
+		dev_tasks[i].maxCycles = 0;
+	}
+	dev_overrunsCount = 0;
+	dev_tickMaxCycles = 0;
+	SREG = oldSREG;
+}
@@ -0,0 +1,81 @@
+/**
+	TickDispatcher_h - библиотека, заменяющая самописный обработчик прерывания таймера, из которого вызываются все processStep() библиотек MYLIB_*.
+	Диспетчер занимает Timer2 в режиме CTC и на каждом тике вызывает зарегистрированные задачи, каждую со своим делителем частоты и фазой.
+	Кнопкам нужен 1 мс, индикатору 2 мс, плееру 10 мс - с тиком 1 мс задаются делители 1, 2 и 10, а фазы разносят задачи
+	по разным тикам, чтобы они не собирались в одном прерывании.
+	При создании указывается:
+		* Период тика в микросекундах (не больше 16384 при 16 МГц).
+	После, нужно добавить задачи методом addTask(), параметрами которого являются функция, делитель и фаза. Он возвращает ID задачи (TD_NO_TASK, если места нет).
+	Если фаза не задана (TD_AUTO_PHASE), диспетчер выбирает ту, при которой задача реже всего совпадает с уже добавленными.
+	Метод begin() настраивает таймер и разрешает прерывание. Возвращает false, если такой период таймером не получить.
+	Обработчик прерывания объявляется в скетче:
+		TickDispatcher ticker(1000);
+		ISR(TIMER2_COMPA_vect) {
+			ticker.processTick();
+		}
+	Timer2 также использует tone(), поэтому вместе с диспетчером звук нужно выводить через Timer1 (см. PatternPlayer).
+	Статистика на задачу: количество вызовов, суммарное и максимальное время в тактах процессора (getTaskCycles(), getTaskMaxCycles()).
+	Время меряется по счётчику таймера, поэтому его точность - один шаг предделителя.
+	getTickMaxCycles() - самое долгое прерывание целиком, getOverrunsCount() - сколько раз прерывание не успело закончиться до следующего тика.
+	ExtNeon.
+*/
+
+#ifndef TickDispatcher_h
+#define TickDispatcher_h
+
+#include "Arduino.h"
+
+#define TD_MAX_TASKS 8
+#define TD_NO_TASK 0xFF
+#define TD_AUTO_PHASE 0xFF
+
+class TickTask {
+	public:
+		void (*taskFunc)();
+		byte divider;
+		byte phase;
+		byte countdown;
+		boolean enabled;
+		volatile unsigned long calls;
+		volatile unsigned long totalCycles;
+		volatile unsigned long maxCycles;
+};
+
+class TickDispatcher {
+	public:
+		TickDispatcher(unsigned int tickMicros);
+		boolean begin(); //Настраивает Timer2 и запускает тики
+		void start();
+		void stop();
+		boolean isRunning();
+		byte addTask(void (*taskFunc)(), byte divider = 1, byte phase = TD_AUTO_PHASE);
+		void setTaskEnabled(byte taskId, boolean enabled);
+		byte getTasksCount();
+		byte getTaskPhase(byte taskId);
+		unsigned int getTickMicros();
+		void processTick(); //Вызывается из ISR(TIMER2_COMPA_vect)
+		unsigned long getTicksCount();
+		unsigned long getTaskCalls(byte taskId);
+		unsigned long getTaskCycles(byte taskId);
+		unsigned long getTaskMaxCycles(byte taskId);
+		float getTaskAverageMicros(byte taskId);
+		unsigned long getTickMaxCycles();
+		unsigned long getOverrunsCount();
+		void resetStatistics();
+	private:
+		TickTask dev_tasks[TD_MAX_TASKS];
+		byte dev_tasksCount;
+		unsigned int dev_tickMicros;
+		word dev_prescaler;
+		byte dev_clockSelect;
+		byte dev_compareValue;
+		volatile unsigned long dev_ticksCount;
+		volatile unsigned long dev_overrunsCount;
+		volatile unsigned long dev_tickMaxCycles;
+		byte dev_choosePhase(byte divider);
+		unsigned long dev_elapsedCycles(byte fromCount, byte toCount);
+		unsigned long dev_atomicRead(volatile unsigned long *value);
+		static byte dev_gcd(byte a, byte b);
+};
+
+#endif
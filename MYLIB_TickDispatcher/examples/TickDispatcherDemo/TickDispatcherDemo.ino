@@ -0,0 +1,55 @@
+#include <TickDispatcher.h>
+#include <HandledButton.h>
+#include <SevenSegmentsIndicator.h>
+
+// Один тик - 1 мс. Кнопка опрашивается каждый тик, индикатор обновляется раз в 2 тика.
+TickDispatcher ticker(1000);
+HandledButton button(A0, 1);
+SevenSegmentsIndicator indicator;
+
+byte segmentsPins[8] = {2, 3, 4, 5, 6, 7, 8, 9};
+byte digitsPins[3] = {10, 11, 12};
+unsigned int clicks = 0;
+unsigned long lastReport = 0;
+
+ISR(TIMER2_COMPA_vect) {
+  ticker.processTick();
+}
+
+void buttonTask() {
+  button.processStep();
+}
+
+void indicatorTask() {
+  indicator.refreshNext();
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  indicator = SevenSegmentsIndicator(segmentsPins, 3, digitsPins);
+  ticker.addTask(buttonTask, 1);
+  ticker.addTask(indicatorTask, 2); // Фазу выберет диспетчер
+  ticker.begin();
+}
+
+void loop()
+{
+  button.processHandlers();
+  if (button.isClicked()) {
+    clicks++;
+    indicator.print(String(clicks));
+  }
+  // Раз в секунду выводим, сколько в среднем микросекунд каждая задача занимает в прерывании
+  if (millis() - lastReport >= 1000) {
+    lastReport = millis();
+    for (byte i = 0; i < ticker.getTasksCount(); i++) {
+      Serial.print(ticker.getTaskAverageMicros(i));
+      Serial.print(" us, max ");
+      Serial.print(ticker.getTaskMaxCycles(i));
+      Serial.print(" cycles; ");
+    }
+    Serial.print("overruns: ");
+    Serial.println(ticker.getOverrunsCount());
+  }
+}
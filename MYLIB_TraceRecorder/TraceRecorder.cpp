@@ -0,0 +1,309 @@
+/**
+	TraceRecorder_h - запись входов устройства (уровни ног, коды АЦП, номера тиков) в кольцевой буфер, чтобы ошибку, пойманную в поле, можно было
+	воспроизвести на компьютере: утилита extras/tracereplay прогоняет запись через те же библиотеки (HandledButton, Voltmeter), что работают на плате.
+	При создании указывается:
+		* Буфер и его размер в байтах. Буфер выделяет скетч (обычно статический массив), запись его не выделяет и не освобождает.
+		* Длительность тика в микросекундах - с каким интервалом вызывается processTick(). Нужна только для воспроизведения.
+	Ноги добавляются методом addPin() (до TR_MAX_PINS = 8), пока запись пуста. Метод processTick() вызывается с постоянным интервалом (например,
+	задачей TickDispatcher перед задачами кнопок): он считает тики и, если уровень хотя бы одной ноги изменился, добавляет запись.
+	Коды АЦП записываются методом recordAdc(канал, код) (канал от 0 до TR_MAX_ADC_CHANNELS - 1), например, рядом с Voltmeter::processSample(код)
+	или Voltmeter::readRaw(). Метод recordMark(значение) ставит метку (например, "пользователь нажал кнопку сообщения об ошибке").
+	Запись начинается методом start() и останавливается методом stop(). Пока запись остановлена, тики не считаются. clear() очищает буфер.
+	Сжатие: каждая запись хранит только разницу с предыдущей. Номер тика - разница с прошлой записью (до 62 тиков - в байте заголовка, больше - добавочными
+	байтами по 7 бит), код АЦП - разница с прошлым кодом того же канала (так же, по 7 бит). Смена уровней ног занимает 2 байта, код АЦП - 3-4 байта,
+	тики без изменений места не занимают.
+	Когда буфер заполнен, самые старые записи вытесняются: их итог (номер тика, уровни ног, коды АЦП) переходит в начальное состояние записи,
+	поэтому буфер всегда хранит последние события перед ошибкой. getDroppedRecordsCount() - сколько записей вытеснено.
+	Выгрузка:
+		* dump(Serial) - передать запись в последовательный порт в двоичном виде (формат - в TraceRecorder.cpp).
+		* copyTo(буфер, размер) - то же в память, например, чтобы сохранить в EEPROM; getDumpSize() - сколько байт понадобится.
+		На время выгрузки запись приостанавливается.
+	На компьютере:
+		tracereplay capture.bin - события записи. tracereplay -b 2:10,30,50 capture.bin - прогнать запись через HandledButton на ноге 2 с временем
+		удержания 10, 30 и 50 мс. tracereplay -v 0:1,8,32 capture.bin - через Voltmeter с 1, 8 и 32 выборками фильтра. Подробнее - extras/tracereplay.
+	ExtNeon.
+*/
+
+#include "Arduino.h"
+#include "TraceRecorder.h"
+
+/*
+	Запись в буфере: байт заголовка (тип записи TR_RECORD_* в битах 7-6, разница тиков с прошлой записью в битах 5-0), затем, если разница
+	не меньше DEV_TR_LONG_DELTA, сама разница по 7 бит (младшие вперёд, бит 7 - "дальше есть ещё байт"), затем данные записи:
+		TR_RECORD_PINS - 1 байт: уровни ног (бит i - нога, добавленная i-той).
+		TR_RECORD_ADC  - 1 байт канала и разница кода с прошлым кодом канала: знак в младшем бите (0, -1, 1, -2... -> 0, 1, 2, 3...), по 7 бит.
+		TR_RECORD_MARK - 1 байт значения метки.
+	Формат dump() и copyTo(), все числа - little-endian:
+		2 байта  TR_DUMP_MAGIC
+		1 байт   TR_DUMP_VERSION
+		2 байта  длительность тика, мкс
+		4 байта  номер тика на момент выгрузки
+		1 байт   количество ног N, затем N байт - номера ног
+		1 байт   маска каналов АЦП, затем по 2 байта начального кода на каждый канал из маски
+		4 байта  номер тика начального состояния
+		1 байт   начальные уровни ног
+		2 байта  длина записей L, затем L байт записей от старых к новым
+		1 байт   исключающее ИЛИ всех байтов после TR_DUMP_MAGIC
+*/
+
+TraceRecorder::TraceRecorder(byte *buffer, word bufferSize, unsigned int tickMicros) {
+	dev_buffer = buffer;
+	dev_bufferSize = bufferSize;
+	dev_tickMicros = tickMicros;
+	dev_pinsCount = 0;
+	dev_recording = false;
+	clear();
+}
+
+boolean TraceRecorder::addPin(byte pin) {
+	if (dev_pinsCount >= TR_MAX_PINS || dev_records != 0 || dev_dropped != 0) return false;
+	dev_pins[dev_pinsCount++] = pin;
+	dev_lastPins = dev_readPins();
+	dev_basePins = dev_lastPins;
+	return true;
+}
+
+void TraceRecorder::start() {
+	dev_recording = true;
+}
+
+void TraceRecorder::stop() {
+	dev_recording = false;
+}
+
+boolean TraceRecorder::isRecording() {
+	return dev_recording;
+}
+
+void TraceRecorder::clear() {
+	uint8_t oldSREG = SREG;
+	cli();
+	dev_head = 0;
+	dev_used = 0;
+	dev_ticks = 0;
+	dev_lastRecordTick = 0;
+	dev_lastPins = dev_readPins();
+	dev_basePins = dev_lastPins;
+	dev_baseTick = 0;
+	dev_adcChannels = 0;
+	for (byte i = 0; i < TR_MAX_ADC_CHANNELS; i++) {
+		dev_lastCodes[i] = 0;
+		dev_baseCodes[i] = 0;
+	}
+	dev_records = 0;
+	dev_dropped = 0;
+	SREG = oldSREG;
+}
+
+void TraceRecorder::processTick() {
+	if (!dev_recording) return;
+	dev_ticks++;
+	byte levels = dev_readPins();
+	if (levels == dev_lastPins) return;
+	byte record[DEV_TR_MAX_RECORD_SIZE];
+	byte length = dev_beginRecord(record, TR_RECORD_PINS);
+	record[length++] = levels;
+	dev_append(record, length);
+	dev_lastPins = levels;
+}
+
+void TraceRecorder::recordAdc(byte channel, word code) {
+	if (!dev_recording || channel >= TR_MAX_ADC_CHANNELS) return;
+	uint8_t oldSREG = SREG;
+	cli();
+	int difference = (int) code - (int) dev_lastCodes[channel];
+	byte record[DEV_TR_MAX_RECORD_SIZE];
+	byte length = dev_beginRecord(record, TR_RECORD_ADC);
+	record[length++] = channel;
+	length += dev_putVarint(record + length, difference < 0 ? ((unsigned long) -difference << 1) - 1 : (unsigned long) difference << 1);
+	dev_append(record, length);
+	dev_lastCodes[channel] = code;
+	dev_adcChannels |= _BV(channel);
+	SREG = oldSREG;
+}
+
+void TraceRecorder::recordMark(byte value) {
+	if (!dev_recording) return;
+	uint8_t oldSREG = SREG;
+	cli();
+	byte record[DEV_TR_MAX_RECORD_SIZE];
+	byte length = dev_beginRecord(record, TR_RECORD_MARK);
+	record[length++] = value;
+	dev_append(record, length);
+	SREG = oldSREG;
+}
+
+unsigned long TraceRecorder::getTicksCount() {
+	uint8_t oldSREG = SREG;
+	cli();
+	unsigned long ticks = dev_ticks;
+	SREG = oldSREG;
+	return ticks;
+}
+
+word TraceRecorder::getUsedBytes() {
+	uint8_t oldSREG = SREG;
+	cli();
+	word used = dev_used;
+	SREG = oldSREG;
+	return used;
+}
+
+unsigned long TraceRecorder::getRecordsCount() {
+	uint8_t oldSREG = SREG;
+	cli();
+	unsigned long records = dev_records;
+	SREG = oldSREG;
+	return records;
+}
+
+unsigned long TraceRecorder::getDroppedRecordsCount() {
+	uint8_t oldSREG = SREG;
+	cli();
+	unsigned long dropped = dev_dropped;
+	SREG = oldSREG;
+	return dropped;
+}
+
+word TraceRecorder::getDumpSize() {
+	byte channels = 0;
+	for (byte i = 0; i < TR_MAX_ADC_CHANNELS; i++) {
+		if (dev_adcChannels & _BV(i)) channels++;
+	}
+	return 2 + 1 + 2 + 4 + 1 + dev_pinsCount + 1 + 2 * channels + 4 + 1 + 2 + getUsedBytes() + 1;
+}
+
+word TraceRecorder::copyTo(byte *destination, word size) {
+	boolean wasRecording = dev_recording;
+	dev_recording = false;
+	word dumpSize = getDumpSize();
+	if (dumpSize <= size) {
+		dev_writeDump(NULL, destination);
+	} else {
+		dumpSize = 0;
+	}
+	dev_recording = wasRecording;
+	return dumpSize;
+}
+
+void TraceRecorder::dump(HardwareSerial &port) {
+	boolean wasRecording = dev_recording;
+	dev_recording = false;
+	dev_writeDump(&port, NULL);
+	dev_recording = wasRecording;
+}
+
+void TraceRecorder::dev_writeDump(HardwareSerial *port, byte *destination) {
+	word position = 0;
+	byte checksum = 0;
+	dev_write(port, destination, &position, NULL, TR_DUMP_MAGIC, 2);
+	dev_write(port, destination, &position, &checksum, TR_DUMP_VERSION, 1);
+	dev_write(port, destination, &position, &checksum, dev_tickMicros, 2);
+	dev_write(port, destination, &position, &checksum, dev_ticks, 4);
+	dev_write(port, destination, &position, &checksum, dev_pinsCount, 1);
+	for (byte i = 0; i < dev_pinsCount; i++) {
+		dev_write(port, destination, &position, &checksum, dev_pins[i], 1);
+	}
+	dev_write(port, destination, &position, &checksum, dev_adcChannels, 1);
+	for (byte i = 0; i < TR_MAX_ADC_CHANNELS; i++) {
+		if (dev_adcChannels & _BV(i)) dev_write(port, destination, &position, &checksum, dev_baseCodes[i], 2);
+	}
+	dev_write(port, destination, &position, &checksum, dev_baseTick, 4);
+	dev_write(port, destination, &position, &checksum, dev_basePins, 1);
+	dev_write(port, destination, &position, &checksum, dev_used, 2);
+	for (word i = 0; i < dev_used; i++) {
+		dev_write(port, destination, &position, &checksum, dev_peek(i), 1);
+	}
+	dev_write(port, destination, &position, NULL, checksum, 1);
+}
+
+void TraceRecorder::dev_write(HardwareSerial *port, byte *destination, word *position, byte *checksum, uint32_t value, byte size) {
+	for (byte i = 0; i < size; i++) {
+		byte part = value >> (8 * i);
+		if (checksum != NULL) *checksum ^= part;
+		if (port != NULL) port->write(part);
+		if (destination != NULL) destination[(*position)++] = part;
+	}
+}
+
+byte TraceRecorder::dev_readPins() {
+	byte levels = 0;
+	for (byte i = 0; i < dev_pinsCount; i++) {
+		if (digitalRead(dev_pins[i])) levels |= _BV(i);
+	}
+	return levels;
+}
+
+byte TraceRecorder::dev_beginRecord(byte *record, byte type) {
+	unsigned long delta = dev_ticks - dev_lastRecordTick;
+	dev_lastRecordTick = dev_ticks;
+	if (delta < DEV_TR_LONG_DELTA) {
+		record[0] = (type << 6) | delta;
+		return 1;
+	}
+	record[0] = (type << 6) | DEV_TR_LONG_DELTA;
+	return 1 + dev_putVarint(record + 1, delta);
+}
+
+void TraceRecorder::dev_append(const byte *record, byte length) {
+	if (length > dev_bufferSize) return;
+	while (dev_bufferSize - dev_used < length) dev_dropOldest();
+	for (byte i = 0; i < length; i++) {
+		dev_buffer[dev_head] = record[i];
+		if (++dev_head >= dev_bufferSize) dev_head = 0;
+	}
+	dev_used += length;
+	dev_records++;
+}
+
+void TraceRecorder::dev_dropOldest() {
+	word offset = 0;
+	byte header = dev_peek(offset++);
+	unsigned long delta = header & DEV_TR_LONG_DELTA;
+	if (delta == DEV_TR_LONG_DELTA) delta = dev_peekVarint(&offset);
+	dev_baseTick += delta;
+	switch (header >> 6) {
+		case TR_RECORD_PINS:
+			dev_basePins = dev_peek(offset++);
+			break;
+		case TR_RECORD_ADC: {
+			byte channel = dev_peek(offset++);
+			unsigned long zigzag = dev_peekVarint(&offset);
+			int difference = (zigzag & 1) ? -(int) ((zigzag + 1) >> 1) : (int) (zigzag >> 1);
+			dev_baseCodes[channel] += difference;
+			break;
+		}
+		default:
+			offset++;
+			break;
+	}
+	dev_used -= offset;
+	dev_records--;
+	dev_dropped++;
+}
+
+byte TraceRecorder::dev_peek(word offset) {
+	return dev_buffer[(dev_head + dev_bufferSize - dev_used + offset) % dev_bufferSize];
+}
+
+unsigned long TraceRecorder::dev_peekVarint(word *offset) {
+	unsigned long value = 0;
+	byte shift = 0;
+	byte part;
+	do {
+		part = dev_peek((*offset)++);
+		value |= (unsigned long) (part & 0x7F) << shift;
+		shift += 7;
+	} while (part & 0x80);
+	return value;
+}
+
+byte TraceRecorder::dev_putVarint(byte *destination, unsigned long value) {
+	byte length = 0;
+	while (value >= 0x80) {
+		destination[length++] = (value & 0x7F) | 0x80;
+		value >>= 7;
+	}
+	destination[length++] = value;
+	return length;
+}
@@ -0,0 +1,93 @@
+/**
+	TraceRecorder_h - запись входов устройства (уровни ног, коды АЦП, номера тиков) в кольцевой буфер, чтобы ошибку, пойманную в поле, можно было
+	воспроизвести на компьютере: утилита extras/tracereplay прогоняет запись через те же библиотеки (HandledButton, Voltmeter), что работают на плате.
+	При создании указывается:
+		* Буфер и его размер в байтах. Буфер выделяет скетч (обычно статический массив), запись его не выделяет и не освобождает.
+		* Длительность тика в микросекундах - с каким интервалом вызывается processTick(). Нужна только для воспроизведения.
+	Ноги добавляются методом addPin() (до TR_MAX_PINS = 8), пока запись пуста. Метод processTick() вызывается с постоянным интервалом (например,
+	задачей TickDispatcher перед задачами кнопок): он считает тики и, если уровень хотя бы одной ноги изменился, добавляет запись.
+	Коды АЦП записываются методом recordAdc(канал, код) (канал от 0 до TR_MAX_ADC_CHANNELS - 1), например, рядом с Voltmeter::processSample(код)
+	или Voltmeter::readRaw(). Метод recordMark(значение) ставит метку (например, "пользователь нажал кнопку сообщения об ошибке").
+	Запись начинается методом start() и останавливается методом stop(). Пока запись остановлена, тики не считаются. clear() очищает буфер.
+	Сжатие: каждая запись хранит только разницу с предыдущей. Номер тика - разница с прошлой записью (до 62 тиков - в байте заголовка, больше - добавочными
+	байтами по 7 бит), код АЦП - разница с прошлым кодом того же канала (так же, по 7 бит). Смена уровней ног занимает 2 байта, код АЦП - 3-4 байта,
+	тики без изменений места не занимают.
+	Когда буфер заполнен, самые старые записи вытесняются: их итог (номер тика, уровни ног, коды АЦП) переходит в начальное состояние записи,
+	поэтому буфер всегда хранит последние события перед ошибкой. getDroppedRecordsCount() - сколько записей вытеснено.
+	Выгрузка:
+		* dump(Serial) - передать запись в последовательный порт в двоичном виде (формат - в TraceRecorder.cpp).
+		* copyTo(буфер, размер) - то же в память, например, чтобы сохранить в EEPROM; getDumpSize() - сколько байт понадобится.
+		На время выгрузки запись приостанавливается.
+	На компьютере:
+		tracereplay capture.bin - события записи. tracereplay -b 2:10,30,50 capture.bin - прогнать запись через HandledButton на ноге 2 с временем
+		удержания 10, 30 и 50 мс. tracereplay -v 0:1,8,32 capture.bin - через Voltmeter с 1, 8 и 32 выборками фильтра. Подробнее - extras/tracereplay.
+	ExtNeon.
+*/
+
+#ifndef TraceRecorder_h
+#define TraceRecorder_h
+
+#include "Arduino.h"
+
+#define TR_MAX_PINS 8
+#define TR_MAX_ADC_CHANNELS 8
+
+#define TR_RECORD_PINS 0
+#define TR_RECORD_ADC 1
+#define TR_RECORD_MARK 2
+
+#define TR_DUMP_MAGIC 0x5254 //"TR"
+#define TR_DUMP_VERSION 1
+
+#define DEV_TR_LONG_DELTA 63 //В заголовке записи: разница тиков не поместилась в 6 бит и передана отдельно
+#define DEV_TR_MAX_RECORD_SIZE 10 //Заголовок (1) + разница тиков (5) + канал (1) + разница кода (3)
+
+class TraceRecorder {
+	public:
+		TraceRecorder(byte *buffer, word bufferSize, unsigned int tickMicros);
+		boolean addPin(byte pin);
+		void start();
+		void stop();
+		boolean isRecording();
+		void clear();
+		void processTick(); //Вызывается с интервалом tickMicros, например, из прерывания
+		void recordAdc(byte channel, word code);
+		void recordMark(byte value);
+		unsigned long getTicksCount();
+		word getUsedBytes();
+		unsigned long getRecordsCount();
+		unsigned long getDroppedRecordsCount();
+		word getDumpSize();
+		word copyTo(byte *destination, word size);
+		void dump(HardwareSerial &port);
+	private:
+		byte *dev_buffer;
+		word dev_bufferSize;
+		word dev_head; //Куда пишется следующий байт
+		word dev_used;
+		unsigned int dev_tickMicros;
+		byte dev_pins[TR_MAX_PINS];
+		byte dev_pinsCount;
+		volatile boolean dev_recording;
+		volatile unsigned long dev_ticks;
+		unsigned long dev_lastRecordTick;
+		byte dev_lastPins;
+		word dev_lastCodes[TR_MAX_ADC_CHANNELS];
+		byte dev_adcChannels; //Каналы, по которым есть записи (или были до вытеснения)
+		unsigned long dev_baseTick; //Начальное состояние записи: итог вытесненных записей
+		byte dev_basePins;
+		word dev_baseCodes[TR_MAX_ADC_CHANNELS];
+		unsigned long dev_records;
+		unsigned long dev_dropped;
+		byte dev_readPins();
+		byte dev_beginRecord(byte *record, byte type);
+		void dev_append(const byte *record, byte length);
+		void dev_dropOldest();
+		byte dev_peek(word offset);
+		unsigned long dev_peekVarint(word *offset);
+		static byte dev_putVarint(byte *destination, unsigned long value);
+		void dev_writeDump(HardwareSerial *port, byte *destination);
+		static void dev_write(HardwareSerial *port, byte *destination, word *position, byte *checksum, uint32_t value, byte size);
+};
+
+#endif
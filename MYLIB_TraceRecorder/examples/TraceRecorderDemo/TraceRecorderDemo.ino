@@ -0,0 +1,50 @@
+#include <TraceRecorder.h>
+#include <TickDispatcher.h>
+#include <HandledButton.h>
+#include <Voltmeter.h>
+
+// Запись кнопки на ноге 2 и кодов АЦП на A0. По символу 'd' из монитора порта запись выгружается в порт:
+//   stty -F /dev/ttyUSB0 115200 raw && (sleep 2; echo d) > /dev/ttyUSB0 & timeout 5 cat /dev/ttyUSB0 > capture.bin
+//   tracereplay -b 2:10,30,50 -v 0:1,8,32 capture.bin
+byte traceBuffer[512];
+TraceRecorder recorder(traceBuffer, sizeof(traceBuffer), 1000);
+TickDispatcher ticker(1000);
+HandledButton button(2, 1);
+Voltmeter battery(A0);
+unsigned long lastMeasurement = 0;
+
+ISR(TIMER2_COMPA_vect) {
+  ticker.processTick();
+}
+
+void recorderTask() {
+  recorder.processTick();
+}
+
+void buttonTask() {
+  button.processStep();
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  recorder.addPin(2);
+  recorder.start();
+  ticker.addTask(recorderTask); // Первой: кнопка увидит тот же уровень, что попал в запись
+  ticker.addTask(buttonTask);
+  ticker.begin();
+}
+
+void loop()
+{
+  button.processHandlers();
+  if (millis() - lastMeasurement >= 10) {
+    lastMeasurement = millis();
+    word code = battery.readRaw();
+    recorder.recordAdc(0, code);
+    battery.processSample(code);
+  }
+  if (Serial.available() && Serial.read() == 'd') {
+    recorder.dump(Serial);
+  }
+}
@@ -0,0 +1,238 @@
+/**
+	TraceReplay_h - расшифровка записи TraceRecorder::dump() на компьютере (формат - в TraceRecorder.cpp) и воспроизведение её на эмуляторе контроллера.
+	decodeTraces() находит в принятых байтах все целые записи с верной контрольной суммой (между ними может быть любой другой вывод скетча)
+	и восстанавливает абсолютные номера тиков, уровни ног и коды АЦП. formatTraceEvents() печатает события по одному на строку.
+	TraceReplayer подаёт запись на текущий эмулятор (HostMcu::current()) тик за тиком:
+		* Перед первым тиком ноги получают начальные уровни записи (setPinInput()), начальные коды передаются обработчику АЦП.
+		* На каждом тике модельное время сдвигается на длительность тика, затем применяются события этого тика: смена уровней ног - через
+			setPinInput(), коды АЦП - обработчику setAdcHandler() (например, voltmeter.processSample(code)), метки - обработчику setMarkHandler().
+			После этого вызывается обработчик тика setTickHandler() - в нём вызываются те же processStep(), что на плате вызывались по тику.
+	Поэтому библиотеки получают те же входы в том же порядке, что и на плате, но без ожидания: тик стоит столько, сколько выполняется код
+	библиотек (см. host/bench/bench_libraries.cpp). Больше всего стоит сдвиг модельного времени (около микросекунды на тик - эмулятор считает таймеры).
+	Если библиотеки считают время только по тикам (HandledButton, HandledEventTimer, Voltmeter::processSample()), его можно выключить методом
+	setClockEnabled(false) - тогда воспроизведение идёт в десятки тысяч раз быстрее реального времени, но millis() и micros() стоят на месте.
+	Пример - сколько нажатий увидела бы кнопка с другим временем удержания:
+		HandledButton button(2, 1, 50);
+		TraceReplayer replayer(traces.back());
+		replayer.setTickHandler([&]() {button.processStep(); if (button.isClicked()) clicks++;});
+		replayer.run();
+*/
+
+#include "TraceReplay.h"
+#include <TraceRecorder.h>
+#include <HostMcu.h>
+#include <cstdio>
+
+static uint64_t readLittleEndian(const uint8_t *data, size_t size) {
+	uint64_t value = 0;
+	for (size_t i = 0; i < size; i++) {
+		value |= (uint64_t) data[i] << (8 * i);
+	}
+	return value;
+}
+
+static bool readVarint(const uint8_t *data, size_t size, size_t *position, uint32_t *value) {
+	*value = 0;
+	for (uint8_t shift = 0; shift < 35; shift += 7) {
+		if (*position >= size) return false;
+		uint8_t part = data[(*position)++];
+		*value |= (uint32_t) (part & 0x7F) << shift;
+		if (!(part & 0x80)) return true;
+	}
+	return false;
+}
+
+static bool decodeRecords(const uint8_t *data, size_t size, Trace *trace) {
+	uint32_t tick = trace->startTick;
+	uint16_t codes[TR_MAX_ADC_CHANNELS];
+	for (int i = 0; i < TR_MAX_ADC_CHANNELS; i++) {
+		codes[i] = trace->startCodes[i];
+	}
+	size_t position = 0;
+	while (position < size) {
+		uint8_t header = data[position++];
+		uint32_t delta = header & DEV_TR_LONG_DELTA;
+		if (delta == DEV_TR_LONG_DELTA && !readVarint(data, size, &position, &delta)) return false;
+		tick += delta;
+		TraceEvent event;
+		event.tick = tick;
+		event.type = header >> 6;
+		event.channel = 0;
+		if (position >= size) return false;
+		switch (event.type) {
+			case TR_RECORD_PINS:
+			case TR_RECORD_MARK:
+				event.value = data[position++];
+				break;
+			case TR_RECORD_ADC: {
+				event.channel = data[position++];
+				uint32_t zigzag;
+				if (event.channel >= TR_MAX_ADC_CHANNELS || !readVarint(data, size, &position, &zigzag)) return false;
+				int difference = (zigzag & 1) ? -(int) ((zigzag + 1) >> 1) : (int) (zigzag >> 1);
+				codes[event.channel] += difference;
+				event.value = codes[event.channel];
+				break;
+			}
+			default:
+				return false;
+		}
+		trace->events.push_back(event);
+	}
+	return tick <= trace->endTick;
+}
+
+static bool decodeAt(const uint8_t *data, size_t size, Trace *trace, size_t *length) {
+	size_t position = 0;
+	if (size < 10 || readLittleEndian(data, 2) != TR_DUMP_MAGIC || data[2] != TR_DUMP_VERSION) return false;
+	trace->version = data[2];
+	trace->tickMicros = readLittleEndian(data + 3, 2);
+	trace->endTick = readLittleEndian(data + 5, 4);
+	size_t pinsCount = data[9];
+	position = 10;
+	if (pinsCount > TR_MAX_PINS || size < position + pinsCount + 1) return false;
+	trace->pins.assign(data + position, data + position + pinsCount);
+	position += pinsCount;
+	trace->adcChannels = data[position++];
+	for (int i = 0; i < TR_MAX_ADC_CHANNELS; i++) {
+		trace->startCodes[i] = 0;
+		if (!(trace->adcChannels & (1 << i))) continue;
+		if (size < position + 2) return false;
+		trace->startCodes[i] = readLittleEndian(data + position, 2);
+		position += 2;
+	}
+	if (size < position + 7) return false;
+	trace->startTick = readLittleEndian(data + position, 4);
+	trace->startPins = data[position + 4];
+	size_t recordsSize = readLittleEndian(data + position + 5, 2);
+	position += 7;
+	*length = position + recordsSize + 1;
+	if (size < *length) return false;
+	uint8_t checksum = 0;
+	for (size_t i = 2; i < *length; i++) {
+		checksum ^= data[i]; //Вместе с самой контрольной суммой должен получиться 0
+	}
+	if (checksum != 0) return false;
+	trace->events.clear();
+	return decodeRecords(data + position, recordsSize, trace);
+}
+
+std::vector<Trace> decodeTraces(const uint8_t *data, size_t size) {
+	std::vector<Trace> traces;
+	size_t position = 0;
+	while (position < size) {
+		Trace trace;
+		size_t length;
+		if (decodeAt(data + position, size - position, &trace, &length)) {
+			traces.push_back(trace);
+			position += length;
+		} else {
+			position++;
+		}
+	}
+	return traces;
+}
+
+std::string formatTraceEvents(const Trace &trace) {
+	std::string report;
+	char line[256];
+	snprintf(line, sizeof(line), "tick %u us, ticks %u..%u (%.3f s), %u events, pins:", trace.tickMicros, trace.startTick, trace.endTick,
+		(double) (trace.endTick - trace.startTick) * trace.tickMicros / 1e6, (unsigned int) trace.events.size());
+	report += line;
+	for (size_t i = 0; i < trace.pins.size(); i++) {
+		snprintf(line, sizeof(line), " %u=%u", trace.pins[i], (trace.startPins >> i) & 1);
+		report += line;
+	}
+	report += "\n";
+	for (size_t i = 0; i < trace.events.size(); i++) {
+		const TraceEvent &event = trace.events[i];
+		switch (event.type) {
+			case TR_RECORD_PINS: {
+				snprintf(line, sizeof(line), "%10u pins", event.tick);
+				report += line;
+				for (size_t pin = 0; pin < trace.pins.size(); pin++) {
+					snprintf(line, sizeof(line), " %u=%u", trace.pins[pin], (event.value >> pin) & 1);
+					report += line;
+				}
+				report += "\n";
+				break;
+			}
+			case TR_RECORD_ADC:
+				snprintf(line, sizeof(line), "%10u adc %u = %u\n", event.tick, event.channel, event.value);
+				report += line;
+				break;
+			default:
+				snprintf(line, sizeof(line), "%10u mark %u\n", event.tick, event.value);
+				report += line;
+				break;
+		}
+	}
+	return report;
+}
+
+TraceReplayer::TraceReplayer(const Trace &trace) : dev_trace(trace) {
+	dev_nextEvent = 0;
+	dev_tick = trace.startTick;
+	dev_started = false;
+	dev_clockEnabled = true;
+}
+
+void TraceReplayer::setTickHandler(std::function<void ()> handler) {
+	dev_tickHandler = handler;
+}
+
+void TraceReplayer::setAdcHandler(std::function<void (uint8_t channel, uint16_t code)> handler) {
+	dev_adcHandler = handler;
+}
+
+void TraceReplayer::setMarkHandler(std::function<void (uint8_t value)> handler) {
+	dev_markHandler = handler;
+}
+
+void TraceReplayer::setClockEnabled(bool enabled) {
+	dev_clockEnabled = enabled;
+}
+
+bool TraceReplayer::step() {
+	if (!dev_started) {
+		dev_started = true;
+		dev_applyPins(dev_trace.startPins);
+		for (int i = 0; i < TR_MAX_ADC_CHANNELS; i++) {
+			if ((dev_trace.adcChannels & (1 << i)) && dev_adcHandler) dev_adcHandler(i, dev_trace.startCodes[i]);
+		}
+	}
+	if (dev_tick >= dev_trace.endTick) return false;
+	dev_tick++;
+	if (dev_clockEnabled) HostMcu::current().advanceMicros(dev_trace.tickMicros);
+	while (dev_nextEvent < dev_trace.events.size() && dev_trace.events[dev_nextEvent].tick <= dev_tick) {
+		const TraceEvent &event = dev_trace.events[dev_nextEvent++];
+		switch (event.type) {
+			case TR_RECORD_PINS:
+				dev_applyPins(event.value);
+				break;
+			case TR_RECORD_ADC:
+				if (dev_adcHandler) dev_adcHandler(event.channel, event.value);
+				break;
+			default:
+				if (dev_markHandler) dev_markHandler(event.value);
+				break;
+		}
+	}
+	if (dev_tickHandler) dev_tickHandler();
+	return true;
+}
+
+uint32_t TraceReplayer::run(uint32_t ticks) {
+	uint32_t done = 0;
+	while (done < ticks && step()) done++;
+	return done;
+}
+
+uint32_t TraceReplayer::getTick() {
+	return dev_tick;
+}
+
+void TraceReplayer::dev_applyPins(uint8_t levels) {
+	for (size_t i = 0; i < dev_trace.pins.size(); i++) {
+		HostMcu::current().setPinInput(dev_trace.pins[i], (levels >> i) & 1);
+	}
+}
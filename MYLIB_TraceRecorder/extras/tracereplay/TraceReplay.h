@@ -0,0 +1,74 @@
+/**
+	TraceReplay_h - расшифровка записи TraceRecorder::dump() на компьютере (формат - в TraceRecorder.cpp) и воспроизведение её на эмуляторе контроллера.
+	decodeTraces() находит в принятых байтах все целые записи с верной контрольной суммой (между ними может быть любой другой вывод скетча)
+	и восстанавливает абсолютные номера тиков, уровни ног и коды АЦП. formatTraceEvents() печатает события по одному на строку.
+	TraceReplayer подаёт запись на текущий эмулятор (HostMcu::current()) тик за тиком:
+		* Перед первым тиком ноги получают начальные уровни записи (setPinInput()), начальные коды передаются обработчику АЦП.
+		* На каждом тике модельное время сдвигается на длительность тика, затем применяются события этого тика: смена уровней ног - через
+			setPinInput(), коды АЦП - обработчику setAdcHandler() (например, voltmeter.processSample(code)), метки - обработчику setMarkHandler().
+			После этого вызывается обработчик тика setTickHandler() - в нём вызываются те же processStep(), что на плате вызывались по тику.
+	Поэтому библиотеки получают те же входы в том же порядке, что и на плате, но без ожидания: тик стоит столько, сколько выполняется код
+	библиотек (см. host/bench/bench_libraries.cpp). Больше всего стоит сдвиг модельного времени (около микросекунды на тик - эмулятор считает таймеры).
+	Если библиотеки считают время только по тикам (HandledButton, HandledEventTimer, Voltmeter::processSample()), его можно выключить методом
+	setClockEnabled(false) - тогда воспроизведение идёт в десятки тысяч раз быстрее реального времени, но millis() и micros() стоят на месте.
+	Пример - сколько нажатий увидела бы кнопка с другим временем удержания:
+		HandledButton button(2, 1, 50);
+		TraceReplayer replayer(traces.back());
+		replayer.setTickHandler([&]() {button.processStep(); if (button.isClicked()) clicks++;});
+		replayer.run();
+*/
+
+#ifndef TraceReplay_h
+#define TraceReplay_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct TraceEvent {
+	uint32_t tick;
+	uint8_t type; //TR_RECORD_*
+	uint8_t channel; //Канал АЦП
+	uint16_t value; //Уровни ног, код АЦП или значение метки
+};
+
+struct Trace {
+	uint8_t version;
+	uint16_t tickMicros;
+	uint32_t startTick; //Начальное состояние - на этом тике
+	uint32_t endTick; //Тик на момент выгрузки
+	std::vector<uint8_t> pins;
+	uint8_t startPins;
+	uint8_t adcChannels;
+	uint16_t startCodes[8];
+	std::vector<TraceEvent> events;
+};
+
+std::vector<Trace> decodeTraces(const uint8_t *data, size_t size);
+std::string formatTraceEvents(const Trace &trace);
+
+class TraceReplayer {
+	public:
+		TraceReplayer(const Trace &trace);
+		void setTickHandler(std::function<void ()> handler);
+		void setAdcHandler(std::function<void (uint8_t channel, uint16_t code)> handler);
+		void setMarkHandler(std::function<void (uint8_t value)> handler);
+		void setClockEnabled(bool enabled);
+		bool step(); //Один тик, false - запись закончилась
+		uint32_t run(uint32_t ticks = UINT32_MAX); //Возвращает количество выполненных тиков
+		uint32_t getTick();
+	private:
+		const Trace &dev_trace;
+		size_t dev_nextEvent;
+		uint32_t dev_tick;
+		bool dev_started;
+		bool dev_clockEnabled;
+		std::function<void ()> dev_tickHandler;
+		std::function<void (uint8_t channel, uint16_t code)> dev_adcHandler;
+		std::function<void (uint8_t value)> dev_markHandler;
+		void dev_applyPins(uint8_t levels);
+};
+
+#endif
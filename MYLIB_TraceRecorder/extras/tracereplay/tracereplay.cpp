@@ -0,0 +1,155 @@
+/**
+	tracereplay - печать и воспроизведение записи TraceRecorder::dump(), принятой из последовательного порта (или прочитанной из EEPROM). Запускается на компьютере.
+	Использование:
+		tracereplay [-a] [-b нога:удержание,...] [-v канал:выборки,...] [файл]
+	Если файл не указан, байты читаются со стандартного ввода, например:
+		stty -F /dev/ttyUSB0 115200 raw && timeout 5 cat /dev/ttyUSB0 > capture.bin && tracereplay capture.bin
+	Без ключей печатаются события последней целой записи, с ключом -a - всех записей по порядку.
+	-b 2:10,30,50 - прогнать последнюю запись через HandledButton на ноге 2 (нога должна быть в записи) с временем удержания 10, 30 и 50 мс
+		и напечатать, сколько нажатий и отпусканий увидела кнопка при каждом времени.
+	-v 0:1,8,32 - прогнать коды канала 0 через Voltmeter (опорное 5 В, без делителя) с 1, 8 и 32 выборками фильтра и напечатать
+		наименьшее, наибольшее и последнее значение в милливольтах после прогрева фильтра (DEV_WARMUP_CODES кодов сверх количества выборок).
+	Ключи -b и -v можно повторять. Кнопке и вольтметру модельное время не нужно, поэтому оно не сдвигается (TraceReplayer::setClockEnabled(false)).
+	В конце печатается скорость воспроизведения относительно реального времени.
+	Утилита собирается вместе с библиотеками на компьютере (CMakeLists.txt в корне репозитория): cmake -S . -B build && cmake --build build
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "TraceReplay.h"
+#include "HostMcu.h"
+#include "HandledButton.h"
+#include "Voltmeter.h"
+
+#define DEV_WARMUP_CODES 16 //Встроенный фильтр Voltmeter усредняет результат с прошлым, поэтому после заполнения выборок нужно ещё несколько кодов
+
+struct Sweep {
+	int target; //Нога или канал
+	std::vector<int> values;
+};
+
+static double replaySeconds = 0;
+static double replayedSeconds = 0;
+
+static void printUsage() {
+	fprintf(stderr, "usage: tracereplay [-a] [-b pin:hold,...] [-v channel:samples,...] [file]\n");
+}
+
+static bool parseSweep(const char *text, Sweep *sweep) {
+	char *end;
+	sweep->target = strtol(text, &end, 10);
+	if (end == text || *end != ':') return false;
+	do {
+		text = end + 1;
+		int value = strtol(text, &end, 10);
+		if (end == text || value <= 0) return false;
+		sweep->values.push_back(value);
+	} while (*end == ',');
+	return *end == 0;
+}
+
+static void runReplay(TraceReplayer &replayer, const Trace &trace) {
+	replayer.setClockEnabled(false);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	uint32_t ticks = replayer.run();
+	replaySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	replayedSeconds += (double) ticks * trace.tickMicros / 1e6;
+}
+
+static void sweepButton(const Trace &trace, const Sweep &sweep) {
+	unsigned int tickMs = trace.tickMicros >= 1000 ? trace.tickMicros / 1000 : 1;
+	for (size_t i = 0; i < sweep.values.size(); i++) {
+		HostMcu::current().reset();
+		HandledButton button(sweep.target, tickMs, sweep.values[i]);
+		unsigned int presses = 0, releases = 0;
+		TraceReplayer replayer(trace);
+		replayer.setTickHandler([&]() {
+			boolean wasPressed = button.isPressed();
+			button.processStep();
+			if (button.isPressed() && !wasPressed) presses++;
+			if (!button.isPressed() && wasPressed) releases++;
+		});
+		runReplay(replayer, trace);
+		printf("button %d, hold %4d ms: %u presses, %u releases\n", sweep.target, sweep.values[i], presses, releases);
+	}
+}
+
+static void sweepVoltmeter(const Trace &trace, const Sweep &sweep) {
+	for (size_t i = 0; i < sweep.values.size(); i++) {
+		HostMcu::current().reset();
+		Voltmeter voltmeter(A0 + sweep.target, 5., 0, 1, sweep.values[i]);
+		unsigned long samples = 0, minimum = 0xFFFFFFFFUL, maximum = 0, last = 0;
+		TraceReplayer replayer(trace);
+		replayer.setAdcHandler([&](uint8_t channel, uint16_t code) {
+			if (channel != sweep.target) return;
+			voltmeter.processSample(code);
+			last = voltmeter.getMillivolts(); //Как в скетче: результат читается после каждого кода
+			if (++samples < (unsigned long) sweep.values[i] + DEV_WARMUP_CODES) return;
+			if (last < minimum) minimum = last;
+			if (last > maximum) maximum = last;
+		});
+		runReplay(replayer, trace);
+		if (maximum == 0 && minimum == 0xFFFFFFFFUL) {
+			printf("adc %d, %3d samples: not enough codes\n", sweep.target, sweep.values[i]);
+		} else {
+			printf("adc %d, %3d samples: min %lu mV, max %lu mV, ripple %lu mV, last %lu mV\n", sweep.target, sweep.values[i], minimum, maximum,
+				maximum - minimum, last);
+		}
+	}
+}
+
+int main(int argc, char **argv) {
+	bool all = false;
+	const char *path = NULL;
+	std::vector<Sweep> buttons, voltmeters;
+	for (int i = 1; i < argc; i++) {
+		Sweep sweep;
+		if (!strcmp(argv[i], "-a")) {
+			all = true;
+		} else if ((!strcmp(argv[i], "-b") || !strcmp(argv[i], "-v")) && i + 1 < argc && parseSweep(argv[i + 1], &sweep)) {
+			(argv[i][1] == 'b' ? buttons : voltmeters).push_back(sweep);
+			i++;
+		} else if (argv[i][0] == '-') {
+			printUsage();
+			return 2;
+		} else {
+			path = argv[i];
+		}
+	}
+	FILE *input = path ? fopen(path, "rb") : stdin;
+	if (input == NULL) {
+		fprintf(stderr, "tracereplay: cannot open %s\n", path);
+		return 1;
+	}
+	std::vector<uint8_t> data;
+	uint8_t chunk[256];
+	size_t length;
+	while ((length = fread(chunk, 1, sizeof(chunk), input)) > 0) data.insert(data.end(), chunk, chunk + length);
+	if (path) fclose(input);
+
+	std::vector<Trace> traces = decodeTraces(data.data(), data.size());
+	if (traces.empty()) {
+		fprintf(stderr, "tracereplay: no trace found in %u bytes\n", (unsigned int) data.size());
+		return 1;
+	}
+	if (buttons.empty() && voltmeters.empty()) {
+		for (size_t i = all ? 0 : traces.size() - 1; i < traces.size(); i++) {
+			if (all) printf("trace %u:\n", (unsigned int) i + 1);
+			printf("%s", formatTraceEvents(traces[i]).c_str());
+		}
+		return 0;
+	}
+	const Trace &trace = traces.back();
+	for (size_t i = 0; i < buttons.size(); i++) {
+		sweepButton(trace, buttons[i]);
+	}
+	for (size_t i = 0; i < voltmeters.size(); i++) {
+		sweepVoltmeter(trace, voltmeters[i]);
+	}
+	if (replaySeconds > 0) printf("replayed %.1f s of trace in %.3f s (%.0fx real time)\n", replayedSeconds, replaySeconds, replayedSeconds / replaySeconds);
+	return 0;
+}
@@ -0,0 +1,145 @@
+/**
+	ADCScanner_h - фоновый опрос нескольких вольтметров (Voltmeter) по кругу, без ожидания окончания преобразования в основном цикле.
+	Метод Voltmeter::processMeasurement() при каждом вызове заново настраивает ADMUX/ADCSRA и ждёт окончания преобразования (до 208 микросекунд), всё это время 
+	процессор простаивает. Сканер же переводит АЦП в режим непрерывного преобразования (free running, автозапуск) с прерыванием по его окончанию. 
+	В прерывании результат передаётся в фильтр соответствующего вольтметра (Voltmeter::processSample()), а в ADMUX записывается следующий канал.
+	Основной цикл только читает уже готовые значения методом getVoltage().
+	
+	При создании указывается:
+		* Необязательный параметр - тактовая частота АЦП. Принимает те же значения ADC_RATE_*, что и Voltmeter::set_CTRL_STAT_REG_VAL(). По умолчанию ADC_RATE_250KHz.
+	
+	Вольтметры добавляются методом addVoltmeter(Voltmeter* voltmeter), максимум ADC_SCANNER_MAX_CHANNELS штук. Добавлять их можно только при остановленном сканере.
+	Опрос запускается методом start() и останавливается методом stop().
+	Сканер не устанавливает обработчик прерывания сам, чтобы не конфликтовать с вашим кодом. Его нужно объявить в скетче:
+		ISR(ADC_vect) {
+			scanner.processInterrupt();
+		}
+	Особенность режима непрерывного преобразования: новое значение ADMUX применяется не к текущему, а к следующему преобразованию. Сканер учитывает это сам.
+	Самый первый результат после start() отбрасывается.
+	Пока сканер запущен, не вызывайте processMeasurement() у вольтметров - они используют тот же АЦП.
+	Каналы опрашиваются сгруппированными по источнику опорного напряжения, так что за один круг источник меняется не больше раз, чем их используется. 
+	После смены источника сканер отбрасывает столько преобразований, сколько задано вольтметру методом enableREFcalibrationPass(), и учитывает их в 
+	Voltmeter::getDiscardedConversionsCount().
+	
+	Статистика:
+		* getConversionsCount(channelIndex) - количество результатов, переданных вольтметру с данным индексом (в порядке добавления).
+		* getTotalConversionsCount() - общее количество результатов.
+		* getChannelThroughput(channelIndex) - количество преобразований канала в секунду с момента запуска или вызова resetStatistics().
+*/
+
+#include "Arduino.h"
+#include "ADCScanner.h"
+
+ADCScanner::ADCScanner(byte adcRate) {
+	dev_adcRate = adcRate;
+	dev_channelsCount = 0;
+	dev_running = false;
+	dev_schedulePosition = 0;
+	dev_scheduleIndex = 0;
+	dev_settleLeft = 0;
+	dev_convertingChannel = 0;
+	dev_convertingDiscard = true;
+	dev_queuedChannel = 0;
+	dev_queuedDiscard = true;
+	resetStatistics();
+}
+
+boolean ADCScanner::addVoltmeter(Voltmeter *voltmeter) {
+	if (dev_running || voltmeter == NULL || dev_channelsCount >= ADC_SCANNER_MAX_CHANNELS) return false;
+	dev_channels[dev_channelsCount] = voltmeter;
+	dev_conversionsCount[dev_channelsCount] = 0;
+	byte reference = voltmeter->_pin & VOLTMETER_REF_MASK;
+	byte position = dev_channelsCount;
+	while (position > 0 && (dev_channels[dev_order[position - 1]]->_pin & VOLTMETER_REF_MASK) > reference) { //Вставка с сохранением группировки
+		dev_order[position] = dev_order[position - 1];
+		position--;
+	}
+	dev_order[position] = dev_channelsCount;
+	dev_channelsCount++;
+	return true;
+}
+
+byte ADCScanner::getChannelsCount() {
+	return dev_channelsCount;
+}
+
+void ADCScanner::start() {
+	if (dev_running || dev_channelsCount == 0) return;
+	dev_schedulePosition = dev_channelsCount - 1;
+	dev_settleLeft = 0;
+	dev_queuedDiscard = false;
+	dev_queueNext(); //ADMUX = первый канал
+	dev_convertingChannel = dev_queuedChannel;
+	dev_convertingDiscard = true; //Первое преобразование после перезапуска АЦП отбрасываем
+	dev_running = true;
+	resetStatistics();
+	ADCSRB &= ~(_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0)); //Источник автозапуска - free running
+	ADCSRA = (dev_adcRate & B00000111) | _BV(ADEN) | _BV(ADSC) | _BV(ADATE) | _BV(ADIF) | _BV(ADIE);
+}
+
+void ADCScanner::stop() {
+	ADCSRA &= ~(_BV(ADATE) | _BV(ADIE));
+	dev_running = false;
+}
+
+boolean ADCScanner::isRunning() {
+	return dev_running;
+}
+
+void ADCScanner::dev_queueNext() {
+	if (!dev_queuedDiscard) { //Предыдущий канал получил свой результат - переходим к следующему
+		if (++dev_schedulePosition >= dev_channelsCount) dev_schedulePosition = 0;
+		dev_scheduleIndex = dev_order[dev_schedulePosition];
+		ADMUX = dev_channels[dev_scheduleIndex]->_pin;
+		dev_settleLeft = dev_channels[dev_scheduleIndex]->dev_applyReference();
+	}
+	dev_queuedChannel = dev_scheduleIndex;
+	dev_queuedDiscard = dev_settleLeft > 0;
+	if (dev_settleLeft) dev_settleLeft--;
+}
+
+void ADCScanner::processInterrupt() {
+	word adcValue = dev_channels[dev_convertingChannel]->AnReadEnd();
+	byte readyChannel = dev_convertingChannel;
+	boolean readyDiscard = dev_convertingDiscard;
+	dev_convertingChannel = dev_queuedChannel; //Уже идёт с ADMUX, записанным в прошлом прерывании
+	dev_convertingDiscard = dev_queuedDiscard;
+	dev_queueNext();
+	if (!readyDiscard) {
+		dev_channels[readyChannel]->processSample(adcValue);
+		dev_conversionsCount[readyChannel]++;
+	}
+}
+
+unsigned long ADCScanner::getConversionsCount(byte channelIndex) {
+	if (channelIndex >= dev_channelsCount) return 0;
+	uint8_t oldSREG = SREG;
+	cli();
+	unsigned long temp = dev_conversionsCount[channelIndex];
+	SREG = oldSREG;
+	return temp;
+}
+
+unsigned long ADCScanner::getTotalConversionsCount() {
+	unsigned long sum = 0;
+	for (byte i = 0; i < dev_channelsCount; i++) {
+		sum += getConversionsCount(i);
+	}
+	return sum;
+}
+
+float ADCScanner::getChannelThroughput(byte channelIndex) {
+	unsigned long elapsed = micros() - dev_statisticsStart;
+	if (elapsed == 0) return 0;
+	return getConversionsCount(channelIndex) * 1000000. / elapsed;
+}
+
+void ADCScanner::resetStatistics() {
+	uint8_t oldSREG = SREG;
+	cli();
+	for (byte i = 0; i < ADC_SCANNER_MAX_CHANNELS; i++) {
+		dev_conversionsCount[i] = 0;
+	}
+	dev_statisticsStart = micros();
+	SREG = oldSREG;
+}
@@ -0,0 +1,69 @@
+/**
+	ADCScanner_h - фоновый опрос нескольких вольтметров (Voltmeter) по кругу, без ожидания окончания преобразования в основном цикле.
+	Метод Voltmeter::processMeasurement() при каждом вызове заново настраивает ADMUX/ADCSRA и ждёт окончания преобразования (до 208 микросекунд), всё это время 
+	процессор простаивает. Сканер же переводит АЦП в режим непрерывного преобразования (free running, автозапуск) с прерыванием по его окончанию. 
+	В прерывании результат передаётся в фильтр соответствующего вольтметра (Voltmeter::processSample()), а в ADMUX записывается следующий канал.
+	Основной цикл только читает уже готовые значения методом getVoltage().
+	
+	При создании указывается:
+		* Необязательный параметр - тактовая частота АЦП. Принимает те же значения ADC_RATE_*, что и Voltmeter::set_CTRL_STAT_REG_VAL(). По умолчанию ADC_RATE_250KHz.
+	
+	Вольтметры добавляются методом addVoltmeter(Voltmeter* voltmeter), максимум ADC_SCANNER_MAX_CHANNELS штук. Добавлять их можно только при остановленном сканере.
+	Опрос запускается методом start() и останавливается методом stop().
+	Сканер не устанавливает обработчик прерывания сам, чтобы не конфликтовать с вашим кодом. Его нужно объявить в скетче:
+		ISR(ADC_vect) {
+			scanner.processInterrupt();
+		}
+	Особенность режима непрерывного преобразования: новое значение ADMUX применяется не к текущему, а к следующему преобразованию. Сканер учитывает это сам.
+	Самый первый результат после start() отбрасывается.
+	Пока сканер запущен, не вызывайте processMeasurement() у вольтметров - они используют тот же АЦП.
+	Каналы опрашиваются сгруппированными по источнику опорного напряжения, так что за один круг источник меняется не больше раз, чем их используется. 
+	После смены источника сканер отбрасывает столько преобразований, сколько задано вольтметру методом enableREFcalibrationPass(), и учитывает их в 
+	Voltmeter::getDiscardedConversionsCount().
+	
+	Статистика:
+		* getConversionsCount(channelIndex) - количество результатов, переданных вольтметру с данным индексом (в порядке добавления).
+		* getTotalConversionsCount() - общее количество результатов.
+		* getChannelThroughput(channelIndex) - количество преобразований канала в секунду с момента запуска или вызова resetStatistics().
+*/
+
+#ifndef ADCScanner_h
+#define ADCScanner_h
+
+#include "Arduino.h"
+#include "Voltmeter.h"
+
+#define ADC_SCANNER_MAX_CHANNELS 8 //У ATmega328 8 аналоговых входов
+
+class ADCScanner {
+	public:
+		ADCScanner(byte adcRate = ADC_RATE_250KHz);
+		boolean addVoltmeter(Voltmeter *voltmeter);
+		byte getChannelsCount();
+		void start();
+		void stop();
+		boolean isRunning();
+		void processInterrupt(); //Вызывается из ISR(ADC_vect)
+		unsigned long getConversionsCount(byte channelIndex);
+		unsigned long getTotalConversionsCount();
+		float getChannelThroughput(byte channelIndex);
+		void resetStatistics();
+	private:
+		Voltmeter *dev_channels[ADC_SCANNER_MAX_CHANNELS];
+		volatile unsigned long dev_conversionsCount[ADC_SCANNER_MAX_CHANNELS];
+		byte dev_order[ADC_SCANNER_MAX_CHANNELS]; //Индексы каналов, сгруппированные по источнику опорного напряжения
+		byte dev_channelsCount;
+		byte dev_adcRate;
+		boolean dev_running;
+		volatile byte dev_schedulePosition; //Позиция в dev_order канала, записанного в ADMUX
+		volatile byte dev_scheduleIndex; //Канал, номер которого записан в ADMUX
+		volatile byte dev_settleLeft; //Сколько ещё преобразований отбросить после смены источника
+		volatile byte dev_convertingChannel; //Канал, преобразование которого идёт сейчас
+		volatile boolean dev_convertingDiscard; //Результат текущего преобразования будет отброшен
+		volatile byte dev_queuedChannel; //Канал следующего преобразования
+		volatile boolean dev_queuedDiscard;
+		unsigned long dev_statisticsStart;
+		void dev_queueNext();
+};
+
+#endif
@@ -0,0 +1,159 @@
+/**
+	AnalogKeypad_h - аналоговая клавиатура: несколько кнопок на одном аналоговом пине через резистивную лестницу (делитель).
+	Код АЦП читается через регистры вольтметра (Voltmeter::readRaw()), без пересчёта в вольты, а номер кнопки определяется по заранее построенной таблице
+	диапазонов: старшие биты кода - индекс в таблице, значение в ней - номер кнопки. То есть на каждую выборку приходится одно обращение к таблице 
+	вместо цепочки сравнений с плавающей точкой. Таблица занимает 1024 >> AKP_TABLE_SHIFT байт (по умолчанию 64), граница между кнопками определяется 
+	с точностью 2^AKP_TABLE_SHIFT единиц АЦП (по умолчанию 16).
+	Подавление дребезга и события устроены так же, как в HandledButton: кнопка должна оставаться стабильной заданное время, после чего выставляются флаги,
+	а обработчики вызываются из processHandlers().
+	
+	При создании указывается:
+		* Вольтметр, созданный на пине клавиатуры. Делитель и фильтр вольтметра не используются, нужен только пин и опорное напряжение.
+		* Массив кодов АЦП, соответствующих каждой кнопке (от 1 до AKP_MAX_KEYS = 8 кнопок). Номер кнопки - индекс в этом массиве.
+			Массив нужен только при создании, хранить его не обязательно.
+		* Количество кнопок.
+		* Интервал между вызовами метода processStep().
+		* Необязательный параметр - время, в течение которого кнопка должна оставаться стабильной. По умолчанию AKP_DEFAULT_HOLD_TIME = 30 миллисекунд.
+		* Необязательный параметр - код АЦП, когда ни одна кнопка не нажата. По умолчанию 1023 (пин подтянут к питанию).
+	Каждый код АЦП относится к ближайшей по коду кнопке (или к состоянию "ничего не нажато"), границы проходят посередине между соседними кодами.
+	
+	В параллельном потоке нужно циклически вызывать метод processStep(), он выполняет одно преобразование. Если код АЦП получен иначе (например, через 
+	ADCScanner и фильтр), передайте его методу processCode(word adcCode).
+	Обработчики принимают номер кнопки:
+		* Кнопка нажата - attachHandlerToPushDown(void (*handlerFunc)(byte key));
+		* Кнопка отжата - attachHandlerToPullUp(void (*handlerFunc)(byte key));
+		* Кнопка поменяла своё состояние - attachHandlerToChange(void (*handlerFunc)(byte key));
+	Вызов обработчиков осуществляется из того места, где вызывается метод processHandlers(). Вызывайте его в loop().
+	Также есть методы isPressed(byte key), getPressedKey() (AKP_NO_KEY, если ничего не нажато), isClicked(byte key) - сбрасывает флаг клика этой кнопки,
+	getTimeInCurrentState() и getTimeInLastState() - как у HandledButton.
+*/
+
+#include "Arduino.h"
+#include "AnalogKeypad.h"
+
+AnalogKeypad::AnalogKeypad(Voltmeter *voltmeter, const word *keyCodes, byte keysCount, word timerInterval, unsigned long minimalHoldTime, word idleCode) {
+	dev_voltmeter = voltmeter;
+	if (keysCount > AKP_MAX_KEYS) keysCount = AKP_MAX_KEYS;
+	for (word bucket = 0; bucket < AKP_TABLE_SIZE; bucket++) { //Строим таблицу один раз: каждому диапазону - ближайшая кнопка
+		word bucketCenter = (bucket << AKP_TABLE_SHIFT) + (1 << (AKP_TABLE_SHIFT - 1));
+		word bestDistance = bucketCenter > idleCode ? bucketCenter - idleCode : idleCode - bucketCenter;
+		byte bestKey = AKP_NO_KEY;
+		for (byte key = 0; key < keysCount; key++) {
+			word distance = bucketCenter > keyCodes[key] ? bucketCenter - keyCodes[key] : keyCodes[key] - bucketCenter;
+			if (distance < bestDistance) {
+				bestDistance = distance;
+				bestKey = key;
+			}
+		}
+		dev_bandTable[bucket] = bestKey;
+	}
+	pushDownHandler = NULL;
+	pullUpHandler = NULL;
+	changedHandler = NULL;
+	dev_lastReadedKey = AKP_NO_KEY;
+	dev_currentStableKey = AKP_NO_KEY;
+	dev_pushedDown = 0;
+	dev_pulledUp = 0;
+	dev_clicked = 0;
+	dev_changed = 0;
+	dev_minimalHoldTime = minimalHoldTime;
+	dev_timerInterval = timerInterval;
+	dev_holdStateCounter = 0;
+	dev_timeInLastState = 0;
+}
+
+void AnalogKeypad::attachHandlerToPushDown(void (*handlerFunc)(byte key)) {
+	pushDownHandler = handlerFunc;
+}
+
+void AnalogKeypad::attachHandlerToPullUp(void (*handlerFunc)(byte key)) {
+	pullUpHandler = handlerFunc;
+}
+
+void AnalogKeypad::attachHandlerToChange(void (*handlerFunc)(byte key)) {
+	changedHandler = handlerFunc;
+}
+
+byte AnalogKeypad::getPressedKey() {
+	return dev_currentStableKey;
+}
+
+boolean AnalogKeypad::isPressed(byte key) {
+	return key != AKP_NO_KEY && dev_currentStableKey == key;
+}
+
+boolean AnalogKeypad::isClicked(byte key) {
+	if (key >= AKP_MAX_KEYS) return false;
+	uint8_t oldSREG = SREG;
+	cli();
+	boolean temp = dev_clicked & (1 << key);
+	dev_clicked &= ~(1 << key);
+	SREG = oldSREG;
+	return temp;
+}
+
+byte AnalogKeypad::decode(word adcCode) {
+	if (adcCode > 1023) adcCode = 1023;
+	return dev_bandTable[adcCode >> AKP_TABLE_SHIFT];
+}
+
+void AnalogKeypad::processStep() {
+	processCode(dev_voltmeter->readRaw());
+}
+
+void AnalogKeypad::processCode(word adcCode) {
+	byte gettedKey = decode(adcCode);
+	
+	if (gettedKey == dev_lastReadedKey) {
+		dev_holdStateCounter += dev_timerInterval;
+	} else {
+		if (dev_holdStateCounter > dev_minimalHoldTime) {
+			dev_timeInLastState = dev_holdStateCounter;
+		}
+		dev_holdStateCounter = 0;
+		dev_lastReadedKey = gettedKey;
+	}
+	
+	if (dev_holdStateCounter >= dev_minimalHoldTime && dev_currentStableKey != dev_lastReadedKey) {
+		if (dev_currentStableKey != AKP_NO_KEY) { //Переход с одной кнопки на другую - это отпускание первой и нажатие второй
+			dev_pulledUp |= 1 << dev_currentStableKey;
+			dev_clicked |= 1 << dev_currentStableKey;
+			dev_changed |= 1 << dev_currentStableKey;
+		}
+		dev_currentStableKey = dev_lastReadedKey;
+		if (dev_currentStableKey != AKP_NO_KEY) {
+			dev_pushedDown |= 1 << dev_currentStableKey;
+			dev_changed |= 1 << dev_currentStableKey;
+		}
+	}
+	
+	if (dev_holdStateCounter >= DEV_AKP_MAX_COUNTER_VALUE) {
+		dev_holdStateCounter = DEV_AKP_MAX_COUNTER_VALUE;
+	}
+}
+
+void AnalogKeypad::dev_dispatch(volatile byte &mask, void (*handlerFunc)(byte key)) {
+	if (mask == 0 || handlerFunc == NULL) return;
+	uint8_t oldSREG = SREG;
+	cli();
+	byte pending = mask;
+	mask = 0;
+	SREG = oldSREG;
+	for (byte key = 0; key < AKP_MAX_KEYS; key++) {
+		if (pending & (1 << key)) handlerFunc(key);
+	}
+}
+
+void AnalogKeypad::processHandlers() {
+	dev_dispatch(dev_pulledUp, pullUpHandler); //При переходе с кнопки на кнопку сначала отпускается старая
+	dev_dispatch(dev_pushedDown, pushDownHandler);
+	dev_dispatch(dev_changed, changedHandler);
+}
+
+unsigned long AnalogKeypad::getTimeInCurrentState() {
+	return dev_holdStateCounter > dev_minimalHoldTime ? dev_holdStateCounter - dev_minimalHoldTime : 0;
+}
+
+unsigned long AnalogKeypad::getTimeInLastState() {
+	return dev_timeInLastState;
+}
@@ -0,0 +1,79 @@
+/**
+	AnalogKeypad_h - аналоговая клавиатура: несколько кнопок на одном аналоговом пине через резистивную лестницу (делитель).
+	Код АЦП читается через регистры вольтметра (Voltmeter::readRaw()), без пересчёта в вольты, а номер кнопки определяется по заранее построенной таблице
+	диапазонов: старшие биты кода - индекс в таблице, значение в ней - номер кнопки. То есть на каждую выборку приходится одно обращение к таблице 
+	вместо цепочки сравнений с плавающей точкой. Таблица занимает 1024 >> AKP_TABLE_SHIFT байт (по умолчанию 64), граница между кнопками определяется 
+	с точностью 2^AKP_TABLE_SHIFT единиц АЦП (по умолчанию 16).
+	Подавление дребезга и события устроены так же, как в HandledButton: кнопка должна оставаться стабильной заданное время, после чего выставляются флаги,
+	а обработчики вызываются из processHandlers().
+	
+	При создании указывается:
+		* Вольтметр, созданный на пине клавиатуры. Делитель и фильтр вольтметра не используются, нужен только пин и опорное напряжение.
+		* Массив кодов АЦП, соответствующих каждой кнопке (от 1 до AKP_MAX_KEYS = 8 кнопок). Номер кнопки - индекс в этом массиве.
+			Массив нужен только при создании, хранить его не обязательно.
+		* Количество кнопок.
+		* Интервал между вызовами метода processStep().
+		* Необязательный параметр - время, в течение которого кнопка должна оставаться стабильной. По умолчанию AKP_DEFAULT_HOLD_TIME = 30 миллисекунд.
+		* Необязательный параметр - код АЦП, когда ни одна кнопка не нажата. По умолчанию 1023 (пин подтянут к питанию).
+	Каждый код АЦП относится к ближайшей по коду кнопке (или к состоянию "ничего не нажато"), границы проходят посередине между соседними кодами.
+	
+	В параллельном потоке нужно циклически вызывать метод processStep(), он выполняет одно преобразование. Если код АЦП получен иначе (например, через 
+	ADCScanner и фильтр), передайте его методу processCode(word adcCode).
+	Обработчики принимают номер кнопки:
+		* Кнопка нажата - attachHandlerToPushDown(void (*handlerFunc)(byte key));
+		* Кнопка отжата - attachHandlerToPullUp(void (*handlerFunc)(byte key));
+		* Кнопка поменяла своё состояние - attachHandlerToChange(void (*handlerFunc)(byte key));
+	Вызов обработчиков осуществляется из того места, где вызывается метод processHandlers(). Вызывайте его в loop().
+	Также есть методы isPressed(byte key), getPressedKey() (AKP_NO_KEY, если ничего не нажато), isClicked(byte key) - сбрасывает флаг клика этой кнопки,
+	getTimeInCurrentState() и getTimeInLastState() - как у HandledButton.
+*/
+
+#ifndef AnalogKeypad_h
+#define AnalogKeypad_h
+
+#include "Arduino.h"
+#include "Voltmeter.h"
+
+#define AKP_MAX_KEYS 8 //Флаги событий хранятся битовыми масками в байте
+#define AKP_NO_KEY 0xFF
+#define AKP_DEFAULT_HOLD_TIME 30
+#define AKP_TABLE_SHIFT 4 //Точность границ - 16 единиц АЦП
+#define AKP_TABLE_SIZE (1024 >> AKP_TABLE_SHIFT)
+
+#define DEV_AKP_MAX_COUNTER_VALUE 960000 //Защита счётчика удержания от переполнения
+
+class AnalogKeypad {
+	public:
+		AnalogKeypad(Voltmeter *voltmeter, const word *keyCodes, byte keysCount, word timerInterval, unsigned long minimalHoldTime = AKP_DEFAULT_HOLD_TIME, word idleCode = 1023);
+		void attachHandlerToPushDown(void (*handlerFunc)(byte key));
+		void attachHandlerToPullUp(void (*handlerFunc)(byte key));
+		void attachHandlerToChange(void (*handlerFunc)(byte key));
+		byte getPressedKey();
+		boolean isPressed(byte key);
+		boolean isClicked(byte key);
+		byte decode(word adcCode);
+		unsigned long getTimeInCurrentState();
+		unsigned long getTimeInLastState();
+		void processStep();
+		void processCode(word adcCode);
+		void processHandlers();
+	private:
+		void (*pushDownHandler)(byte key);
+		void (*pullUpHandler)(byte key);
+		void (*changedHandler)(byte key);
+		Voltmeter *dev_voltmeter;
+		byte dev_bandTable[AKP_TABLE_SIZE];
+		byte dev_lastReadedKey;
+		volatile byte dev_currentStableKey;
+		volatile byte dev_pushedDown; //Битовые маски по номерам кнопок
+		volatile byte dev_pulledUp;
+		volatile byte dev_clicked;
+		volatile byte dev_changed;
+		unsigned long dev_minimalHoldTime;
+		word dev_timerInterval;
+		unsigned long dev_holdStateCounter;
+		unsigned long dev_timeInLastState;
+		void dev_dispatch(volatile byte &mask, void (*handlerFunc)(byte key));
+};
+
+#endif
@@ -0,0 +1,151 @@
+/**
+	VoltageWatcher_h - слежение за порогами напряжения вольтметра (Voltmeter) с гистерезисом и временем удержания. Например, для обнаружения просадки питания
+	или разряда батареи без постоянного опроса getVoltage() в loop().
+	Наблюдатель подключается к вольтметру методом Voltmeter::addWatcher(VoltageWatcher* watcher) и проверяется прямо в processSample() на каждом новом 
+	значении (после передискретизации и подключённого фильтра; без фильтра - на каждой отдельной выборке). Пороги заранее пересчитываются в единицы АЦП, 
+	поэтому проверка - это одно сравнение целых чисел на наблюдателя.
+	
+	При создании указывается:
+		* Нижний порог окна в милливольтах.
+		* Верхний порог окна в милливольтах. Для простого порога (без окна) укажите его равным нижнему.
+		* Необязательный параметр - гистерезис в милливольтах. Чтобы вернуться из области ниже окна, напряжение должно подняться выше нижнего порога на 
+			величину гистерезиса; чтобы вернуться из области выше окна - опуститься ниже верхнего порога на эту же величину. По умолчанию 0.
+		* Необязательный параметр - время удержания, в количестве значений подряд. Напряжение должно оставаться за границей столько значений подряд,
+			прежде чем состояние сменится. Время удержания = количество значений * интервал между ними. По умолчанию 1 (сразу).
+	
+	Напряжение находится в одной из областей: VW_ZONE_BELOW (ниже окна), VW_ZONE_INSIDE (в окне), VW_ZONE_ABOVE (выше окна). Текущую область возвращает метод 
+	getZone(), до первого значения он возвращает VW_ZONE_UNKNOWN. Первое значение только определяет область, обработчики при этом не вызываются.
+	Обработчики, как и у HandledButton, подключаются к событиям:
+		* Переход выше окна - attachHandlerToRising(void (*handlerFunc)());
+		* Переход ниже окна - attachHandlerToFalling(void (*handlerFunc)());
+		* Возврат в окно - attachHandlerToInWindow(void (*handlerFunc)());
+	В processSample() (возможно, из прерывания) только выставляются флаги, а сами обработчики вызываются из того места, где вызывается метод processHandlers()
+	наблюдателя, либо Voltmeter::processHandlers() для всех наблюдателей вольтметра. Вызывайте его в loop().
+	Проверить события без обработчиков можно методами isRisen(), isFallen() и isInWindow(). Они сбрасывают флаг события.
+*/
+
+#include "Arduino.h"
+#include "VoltageWatcher.h"
+#include "Voltmeter.h"
+
+VoltageWatcher::VoltageWatcher(word lowMillivolts, word highMillivolts, word hysteresisMillivolts, word holdCount) {
+	risingHandler = NULL;
+	fallingHandler = NULL;
+	inWindowHandler = NULL;
+	dev_lowMillivolts = lowMillivolts < highMillivolts ? lowMillivolts : highMillivolts;
+	dev_highMillivolts = lowMillivolts < highMillivolts ? highMillivolts : lowMillivolts;
+	dev_hysteresisMillivolts = hysteresisMillivolts;
+	dev_holdCount = holdCount < 1 ? 1 : holdCount;
+	dev_holdCounter = 0;
+	dev_lowCode = 0;
+	dev_highCode = 0;
+	dev_windowSpan = 0;
+	dev_belowExit = 0;
+	dev_aboveExit = 0;
+	dev_zone = VW_ZONE_UNKNOWN;
+	dev_risen = false;
+	dev_fallen = false;
+	dev_inWindow = false;
+	dev_next = NULL;
+}
+
+void VoltageWatcher::dev_applyScale(Voltmeter *voltmeter) {
+	dev_lowCode = voltmeter->dev_millivoltsToReading(dev_lowMillivolts);
+	dev_highCode = voltmeter->dev_millivoltsToReading(dev_highMillivolts);
+	dev_windowSpan = dev_highCode - dev_lowCode;
+	dev_belowExit = voltmeter->dev_millivoltsToReading((unsigned long) dev_lowMillivolts + dev_hysteresisMillivolts);
+	dev_aboveExit = dev_highMillivolts > dev_hysteresisMillivolts ? voltmeter->dev_millivoltsToReading(dev_highMillivolts - dev_hysteresisMillivolts) : 0;
+	dev_holdCounter = 0;
+	dev_zone = VW_ZONE_UNKNOWN;
+}
+
+byte VoltageWatcher::dev_classify(word reading) {
+	if (reading > dev_highCode) return VW_ZONE_ABOVE;
+	if (reading < dev_lowCode) return VW_ZONE_BELOW;
+	return VW_ZONE_INSIDE;
+}
+
+void VoltageWatcher::dev_evaluate(word reading) {
+	boolean leaving;
+	switch (dev_zone) { //На каждую выборку - одно сравнение с порогом текущей области
+		case VW_ZONE_INSIDE:
+			leaving = (word) (reading - dev_lowCode) > dev_windowSpan;
+			break;
+		case VW_ZONE_ABOVE:
+			leaving = reading < dev_aboveExit;
+			break;
+		case VW_ZONE_BELOW:
+			leaving = reading > dev_belowExit;
+			break;
+		default:
+			dev_zone = dev_classify(reading);
+			return;
+	}
+	if (!leaving) {
+		dev_holdCounter = 0;
+		return;
+	}
+	if (++dev_holdCounter < dev_holdCount) return;
+	dev_holdCounter = 0;
+	byte newZone = dev_classify(reading);
+	if (newZone == dev_zone) return;
+	dev_zone = newZone;
+	if (newZone == VW_ZONE_ABOVE) {
+		dev_risen = true;
+	} else if (newZone == VW_ZONE_BELOW) {
+		dev_fallen = true;
+	} else {
+		dev_inWindow = true;
+	}
+}
+
+void VoltageWatcher::attachHandlerToRising(void (*handlerFunc)()) {
+	risingHandler = handlerFunc;
+}
+
+void VoltageWatcher::attachHandlerToFalling(void (*handlerFunc)()) {
+	fallingHandler = handlerFunc;
+}
+
+void VoltageWatcher::attachHandlerToInWindow(void (*handlerFunc)()) {
+	inWindowHandler = handlerFunc;
+}
+
+byte VoltageWatcher::getZone() {
+	return dev_zone;
+}
+
+boolean VoltageWatcher::isRisen() {
+	boolean temp = dev_risen;
+	dev_risen = false;
+	return temp;
+}
+
+boolean VoltageWatcher::isFallen() {
+	boolean temp = dev_fallen;
+	dev_fallen = false;
+	return temp;
+}
+
+boolean VoltageWatcher::isInWindow() {
+	boolean temp = dev_inWindow;
+	dev_inWindow = false;
+	return temp;
+}
+
+void VoltageWatcher::processHandlers() {
+	if (dev_risen && risingHandler != NULL) {
+		risingHandler();
+		dev_risen = false;
+	}
+	
+	if (dev_fallen && fallingHandler != NULL) {
+		fallingHandler();
+		dev_fallen = false;
+	}
+	
+	if (dev_inWindow && inWindowHandler != NULL) {
+		inWindowHandler();
+		dev_inWindow = false;
+	}
+}
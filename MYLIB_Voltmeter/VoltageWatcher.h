@@ -0,0 +1,75 @@
+/**
+	VoltageWatcher_h - слежение за порогами напряжения вольтметра (Voltmeter) с гистерезисом и временем удержания. Например, для обнаружения просадки питания
+	или разряда батареи без постоянного опроса getVoltage() в loop().
+	Наблюдатель подключается к вольтметру методом Voltmeter::addWatcher(VoltageWatcher* watcher) и проверяется прямо в processSample() на каждом новом 
+	значении (после передискретизации и подключённого фильтра; без фильтра - на каждой отдельной выборке). Пороги заранее пересчитываются в единицы АЦП, 
+	поэтому проверка - это одно сравнение целых чисел на наблюдателя.
+	
+	При создании указывается:
+		* Нижний порог окна в милливольтах.
+		* Верхний порог окна в милливольтах. Для простого порога (без окна) укажите его равным нижнему.
+		* Необязательный параметр - гистерезис в милливольтах. Чтобы вернуться из области ниже окна, напряжение должно подняться выше нижнего порога на 
+			величину гистерезиса; чтобы вернуться из области выше окна - опуститься ниже верхнего порога на эту же величину. По умолчанию 0.
+		* Необязательный параметр - время удержания, в количестве значений подряд. Напряжение должно оставаться за границей столько значений подряд,
+			прежде чем состояние сменится. Время удержания = количество значений * интервал между ними. По умолчанию 1 (сразу).
+	
+	Напряжение находится в одной из областей: VW_ZONE_BELOW (ниже окна), VW_ZONE_INSIDE (в окне), VW_ZONE_ABOVE (выше окна). Текущую область возвращает метод 
+	getZone(), до первого значения он возвращает VW_ZONE_UNKNOWN. Первое значение только определяет область, обработчики при этом не вызываются.
+	Обработчики, как и у HandledButton, подключаются к событиям:
+		* Переход выше окна - attachHandlerToRising(void (*handlerFunc)());
+		* Переход ниже окна - attachHandlerToFalling(void (*handlerFunc)());
+		* Возврат в окно - attachHandlerToInWindow(void (*handlerFunc)());
+	В processSample() (возможно, из прерывания) только выставляются флаги, а сами обработчики вызываются из того места, где вызывается метод processHandlers()
+	наблюдателя, либо Voltmeter::processHandlers() для всех наблюдателей вольтметра. Вызывайте его в loop().
+	Проверить события без обработчиков можно методами isRisen(), isFallen() и isInWindow(). Они сбрасывают флаг события.
+*/
+
+#ifndef VoltageWatcher_h
+#define VoltageWatcher_h
+
+#include "Arduino.h"
+
+#define VW_ZONE_UNKNOWN 0
+#define VW_ZONE_BELOW 1
+#define VW_ZONE_INSIDE 2
+#define VW_ZONE_ABOVE 3
+
+class Voltmeter;
+
+class VoltageWatcher {
+	public:
+		VoltageWatcher(word lowMillivolts, word highMillivolts, word hysteresisMillivolts = 0, word holdCount = 1);
+		void attachHandlerToRising(void (*handlerFunc)());
+		void attachHandlerToFalling(void (*handlerFunc)());
+		void attachHandlerToInWindow(void (*handlerFunc)());
+		byte getZone();
+		boolean isRisen();
+		boolean isFallen();
+		boolean isInWindow();
+		void processHandlers();
+	private:
+		void (*risingHandler)();
+		void (*fallingHandler)();
+		void (*inWindowHandler)();
+		word dev_lowMillivolts;
+		word dev_highMillivolts;
+		word dev_hysteresisMillivolts;
+		word dev_holdCount;
+		word dev_holdCounter;
+		word dev_lowCode; //Пороги в единицах Voltmeter::dev_currentReading()
+		word dev_highCode;
+		word dev_windowSpan;
+		word dev_belowExit;
+		word dev_aboveExit;
+		volatile byte dev_zone;
+		volatile boolean dev_risen;
+		volatile boolean dev_fallen;
+		volatile boolean dev_inWindow;
+		VoltageWatcher *dev_next;
+		void dev_applyScale(Voltmeter *voltmeter);
+		void dev_evaluate(word reading);
+		byte dev_classify(word reading);
+		friend class Voltmeter;
+};
+
+#endif
@@ -29,6 +29,12 @@
 	измерение займёт в 30 раз больше времени!!! Для его включения, вызовите один раз функцию enableREFcalibrationPass(). Вы также можете передать ей количество 
 	проходов для калибрации. По умолчанию: 30.
 	Включение данной функции сильно замедлит работу вольтметра. Для компенсации потери скорости вы можете увеличить тактовую частоту АЦП.
+	Библиотека помнит, какой источник опорного напряжения был применён последним (общий для всех вольтметров), поэтому калибровочные проходы выполняются 
+	только тогда, когда источник действительно меняется. Если вы сами меняете ADMUX (например, вызываете analogRead()), вызовите Voltmeter::invalidateReference().
+	Чтобы свести количество переключений к минимуму, измеряйте несколько вольтметров сразу статическим методом measureAll(Voltmeter** voltmeters, byte count):
+	он группирует вольтметры по источнику опорного напряжения, начиная с уже применённого.
+	Для настройки можно узнать количество переключений источника (getReferenceSwitchCount()) и отброшенных при этом преобразований (getDiscardedConversionsCount()).
+	Обнулить эти счётчики можно методом resetReferenceStatistics().
 	
 	Если вы хотите изменить скорость преобразования/включить прерывания по завершению преобразования, либо произвести иные манипуляции с регистром ADCSRA, используйте метод
 	set_CTRL_STAT_REG_VAL(byte new_ADCSRA_val), принимающий байтовое значение, которое будет записываться в регистр каждый раз при произведении измерения.
@@ -47,6 +53,21 @@
 	Для проведения измерений напряжения большего, чем опорное, необходимо сделать резистивный делитель, а в конструкторе вводятся параметры верхнего и нижнего резистора.
 	Можно дополнительно изменить количество выборок. Если необходимо отключить фильтрацию - укажите 1.
 	Также, изменение количества выборок и разброса возможно методом setFilterSamplesCount(byte countOfSamples). 
+	Усреднение только снижает шум, но не добавляет разрядности. Для повышения разрешения используйте передискретизацию методом setOversampling(byte extraBits):
+	на каждый результат берётся 4^extraBits преобразований, их сумма сдвигается вправо на extraBits, и получается результат разрядностью 10 + extraBits бит
+	(extraBits от 1 до VOLTMETER_MAX_OVERSAMPLING_BITS = 4, то есть до 14 бит). 0 выключает режим. Метод processMeasurement() в этом режиме выполняет все 
+	4^extraBits преобразований за один вызов. Для работы метода нужен шум на входе хотя бы в 1 единицу АЦП - на идеально стабильном сигнале разрешение не вырастет.
+	Чтобы скорость оставалась приемлемой, совмещайте передискретизацию с более высокой частотой АЦП (ADC_RATE_500KHz, ADC_RATE_1MHz): например, 16 преобразований 
+	на 1МГц занимают примерно столько же, сколько одно на 125КГц.
+	Текущую разрядность возвращает метод getEffectiveBits(), ожидаемое число преобразований в секунду при выбранной частоте АЦП - getConversionRate(), 
+	а число готовых результатов в секунду с учётом передискретизации - getResultRate().
+	Вместо встроенного усреднения можно подключить свой целочисленный конвейер фильтров (скользящее и экспоненциальное среднее, медиана, БИХ-фильтр, 
+	прореживание) методом setFilter(VoltmeterFilter* filter). Набор фильтров и их расход памяти описаны в файле VoltmeterFilters.h. 
+	Передайте NULL, чтобы вернуться к встроенному усреднению.
+	
+	Массив выборок фильтра вольтметр выделяет в куче (realloc() в конструкторе и в setFilterSamplesCount()). Чтобы обойтись без кучи, отдайте ему свой массив:
+	Voltmeter(пин, массив word, количество выборок, опорное, R1, R2), или объявите StaticVoltmeter<N>(пин, опорное, R1, R2) - N выборок хранятся в объекте.
+	Тогда setFilterSamplesCount() может только уменьшить количество выборок до размера массива. С флагом MYLIB_STATIC остаётся только этот вариант.
 	
 	Для того, чтобы узнать верхнюю границу вольтметра с определёнными параметрами, используйте эту формулу:
 	|-------------------------------|
@@ -55,28 +76,105 @@
 	Где REF - опорное напряжение, а R1 и R2 - параметры верхнего и нижнего резисторов делителя соответственно.
 	Для проведения очередного измерения и учёта его результата в усреднённом напряжении, в цикле/таймере/отдельном потоке вызывается метод processMeasurement()
 	Для того, чтобы узнать текущий уровень напряжения на этом выводе, вызывается метод getVoltage().
+	Если достаточно целого числа милливольт, используйте метод getMillivolts(). Он не использует вычислений с плавающей точкой: коэффициент пересчёта в 
+	виде целого числа со сдвигом вычисляется один раз в setDividerParams(), а усреднение ведётся в целых числах с 6 дробными битами.
+	Если результат преобразования получен не самим вольтметром (например, из прерывания АЦП), его можно учесть в фильтре методом processSample(word adcValue).
+	Для непрерывного фонового опроса нескольких вольтметров без ожидания окончания преобразования используйте класс ADCScanner (файл ADCScanner.h).
+	Для слежения за порогами напряжения (просадка питания, разряд батареи) с гистерезисом и временем удержания подключите наблюдателей VoltageWatcher 
+	(файл VoltageWatcher.h) методом addWatcher(VoltageWatcher* watcher). Они проверяются на каждом новом значении в processSample(), а их обработчики 
+	вызываются из метода processHandlers(), который нужно вызывать в loop().
+	Метод readRaw() выполняет одно преобразование и возвращает код АЦП без фильтрации и пересчёта. На нём построена аналоговая клавиатура AnalogKeypad
+	(файл AnalogKeypad.h) - несколько кнопок на одном пине через резистивную лестницу.
+	Для быстрой записи серии выборок с постоянной частотой (диагностика пульсаций) и потоковой статистики (минимум, максимум, среднее, RMS, размах) 
+	используйте класс VoltmeterBurst (файл VoltmeterBurst.h). Статистику в единицах АЦП можно перевести в вольты методом codesToVoltage(float codes).
 	Начало положено by ExtNeon. 05.11.2017
 */
 
 #include "Arduino.h"
 #include "Voltmeter.h"
+#ifdef MYLIB_PROFILE
+	#include "Profiler.h"
+#else
+	#define PROFILER_SCOPE(id)
+#endif
 
 void Voltmeter::enableREFcalibrationPass(byte amountOfPasses) {
 	_EXP_DEV_ENABLE_CALIBRATION_PASS_AMNT = amountOfPasses;
 }
 
+volatile byte Voltmeter::dev_appliedReference = VOLTMETER_REF_UNKNOWN;
+volatile unsigned long Voltmeter::dev_referenceSwitchCount = 0;
+volatile unsigned long Voltmeter::dev_discardedConversionsCount = 0;
+
+byte Voltmeter::dev_applyReference() {
+	byte reference = _pin & VOLTMETER_REF_MASK;
+	if (reference == dev_appliedReference) return 0;
+	if (dev_appliedReference != VOLTMETER_REF_UNKNOWN) dev_referenceSwitchCount++;
+	dev_appliedReference = reference;
+	dev_discardedConversionsCount += _EXP_DEV_ENABLE_CALIBRATION_PASS_AMNT;
+	return _EXP_DEV_ENABLE_CALIBRATION_PASS_AMNT;
+}
+
 void Voltmeter::AnReadStart() {	  
   ADMUX=_pin;
-  if (_EXP_DEV_ENABLE_CALIBRATION_PASS_AMNT) {
-	  for (byte i = 0; i < _EXP_DEV_ENABLE_CALIBRATION_PASS_AMNT; i++) {
-		  ADCSRA= dev_ctrl_stat_reg;
-		  while(isADCReadInProcess());
-		  AnReadEnd();
-	  }
+  byte passes = dev_applyReference(); //Калибруемся только при реальной смене источника
+  for (byte i = 0; i < passes; i++) {
+	  ADCSRA= dev_ctrl_stat_reg;
+	  while(isADCReadInProcess());
+	  AnReadEnd();
   }
   ADCSRA= dev_ctrl_stat_reg;
 }
 
+void Voltmeter::dev_measureGroup(Voltmeter **voltmeters, byte count, byte reference) {
+	for (byte i = 0; i < count; i++) {
+		if ((voltmeters[i]->_pin & VOLTMETER_REF_MASK) == reference) {
+			voltmeters[i]->processMeasurement();
+		}
+	}
+}
+
+void Voltmeter::measureAll(Voltmeter **voltmeters, byte count) {
+	static const byte references[3] = {B01000000, B11000000, B00000000}; //AVCC, 1.1V, AREF
+	byte firstReference = dev_appliedReference;
+	if (firstReference != VOLTMETER_REF_UNKNOWN) {
+		dev_measureGroup(voltmeters, count, firstReference);
+	}
+	for (byte i = 0; i < 3; i++) {
+		if (references[i] != firstReference) {
+			dev_measureGroup(voltmeters, count, references[i]);
+		}
+	}
+}
+
+void Voltmeter::invalidateReference() {
+	dev_appliedReference = VOLTMETER_REF_UNKNOWN;
+}
+
+unsigned long Voltmeter::getReferenceSwitchCount() {
+	uint8_t oldSREG = SREG;
+	cli();
+	unsigned long temp = dev_referenceSwitchCount;
+	SREG = oldSREG;
+	return temp;
+}
+
+unsigned long Voltmeter::getDiscardedConversionsCount() {
+	uint8_t oldSREG = SREG;
+	cli();
+	unsigned long temp = dev_discardedConversionsCount;
+	SREG = oldSREG;
+	return temp;
+}
+
+void Voltmeter::resetReferenceStatistics() {
+	uint8_t oldSREG = SREG;
+	cli();
+	dev_referenceSwitchCount = 0;
+	dev_discardedConversionsCount = 0;
+	SREG = oldSREG;
+}
+
 uint16_t Voltmeter::AnReadEnd() {
   uint8_t __ADC_RESULT_LOW_BYTE = ADCL;
   uint16_t __ADC_RESULT_HIGH_BYTE = ADCH; 
@@ -87,19 +185,36 @@ bool Voltmeter::isADCReadInProcess() {
 	return ADCSRA & (1 << ADSC);
 }
 
+#ifndef MYLIB_STATIC
 Voltmeter::Voltmeter(byte measurement_Pin, float ctrl_ref_voltage, float rdiv_TopResistance, float rdiv_BottomResistance, byte filterCountOfSamples) {
-	setDividerParams(rdiv_TopResistance, rdiv_BottomResistance, ctrl_ref_voltage);
 	setFilterSamplesCount(filterCountOfSamples);
+	dev_init(measurement_Pin, ctrl_ref_voltage, rdiv_TopResistance, rdiv_BottomResistance);
+}
+#endif
+
+Voltmeter::Voltmeter(byte measurement_Pin, word *samplesBuffer, byte samplesCount, float ctrl_ref_voltage, float rdiv_TopResistance, float rdiv_BottomResistance) {
+	if (samplesBuffer == NULL || samplesCount == 0) { //Без массива - фильтр из одной выборки
+		samplesBuffer = &dev_singleSample;
+		samplesCount = 1;
+	}
+	samples = samplesBuffer;
+	dev_samplesCapacity = samplesCount;
+	setFilterSamplesCount(samplesCount);
+	dev_init(measurement_Pin, ctrl_ref_voltage, rdiv_TopResistance, rdiv_BottomResistance);
+}
+
+void Voltmeter::dev_init(byte measurement_Pin, float ctrl_ref_voltage, float rdiv_TopResistance, float rdiv_BottomResistance) {
+	setDividerParams(rdiv_TopResistance, rdiv_BottomResistance, ctrl_ref_voltage);
 	byte inputModeByte = B11111110; //14 pin input mode
 	byte targetBit = measurement_Pin - 14; //Which bit is need to turn to 0
 	while (targetBit-- > 0) { //Shifting bitmask
-		shl(inputModeByte); //To the left with cyclic mode
+		inputModeByte = shl(inputModeByte); //To the left with cyclic mode
 	}
 	DDRC &= inputModeByte; //Applying pin mode
 	byte referenceMask = 0; //Selecting the ref source, mask is two high bits.
 	if (ctrl_ref_voltage == 5.) {
 		referenceMask = B01000000; //If AVCC, then 01
-	} else if (ctrl_ref_voltage == 1.1) {
+	} else if (ctrl_ref_voltage == 1.1f) { //float 1.1 не равно double 1.1
 		referenceMask = B11000000; //If vInt, then 11
 	} //Else AREF, 00
 	_pin = measurement_Pin - 14 + referenceMask ;
@@ -112,38 +227,176 @@ void Voltmeter::set_CTRL_STAT_REG_VAL(byte new_ADCSRA_val) {
 
 void Voltmeter::setDividerParams(float rdiv_TopResistance, float rdiv_BottomResistance, float ctrl_ref_voltage) {
 	dev_transferCoeff = (ctrl_ref_voltage / 1024.) / (rdiv_BottomResistance / (rdiv_TopResistance + rdiv_BottomResistance));
+	//Выбираем наибольший сдвиг, при котором 0xFFFF * масштаб ещё помещается в 32 бита
+	double millivoltsPerCode = dev_transferCoeff * 1000.;
+	dev_millivoltsShift = 24;
+	while (dev_millivoltsShift > 0 && millivoltsPerCode * (1UL << dev_millivoltsShift) >= 65536.) {
+		dev_millivoltsShift--;
+	}
+	dev_millivoltsScale = millivoltsPerCode * (1UL << dev_millivoltsShift) + 0.5;
+	for (VoltageWatcher *watcher = dev_watchers; watcher != NULL; watcher = watcher->dev_next) {
+		watcher->dev_applyScale(this);
+	}
+}
+
+word Voltmeter::dev_millivoltsToReading(unsigned long millivolts) {
+	float reading = millivolts / (dev_transferCoeff * 1000.) * (1 << DEV_VLM_RESULT_FRACTION_BITS) + 0.5;
+	return reading > 65535. ? 65535 : reading;
+}
+
+void Voltmeter::addWatcher(VoltageWatcher *watcher) {
+	if (watcher == NULL) return;
+	watcher->dev_applyScale(this);
+	uint8_t oldSREG = SREG;
+	cli();
+	watcher->dev_next = dev_watchers;
+	dev_watchers = watcher;
+	SREG = oldSREG;
+}
+
+void Voltmeter::processHandlers() {
+	for (VoltageWatcher *watcher = dev_watchers; watcher != NULL; watcher = watcher->dev_next) {
+		watcher->processHandlers();
+	}
 }
 
 void Voltmeter::setFilterSamplesCount(byte countOfSamples) {
 	dev_maxFilterSamplesCount = countOfSamples < 1 ? 1 : countOfSamples;
-	samples = realloc(samples, dev_maxFilterSamplesCount * sizeof(word));
+#ifndef MYLIB_STATIC
+	if (dev_samplesCapacity == 0) samples = (word *)realloc(samples, dev_maxFilterSamplesCount * sizeof(word));
+#endif
+	if (dev_samplesCapacity != 0 && dev_maxFilterSamplesCount > dev_samplesCapacity) dev_maxFilterSamplesCount = dev_samplesCapacity;
 	for (byte i = 0; i < dev_maxFilterSamplesCount; i++) {
 		samples[i] = 0;
 	}
 }
 
 void Voltmeter::processMeasurement() {
+	PROFILER_SCOPE(PROFILER_ID_VOLTMETER_MEASUREMENT);
 	AnReadStart();
-	for (word i = 1; i < dev_maxFilterSamplesCount; i++) {
-		samples[i] = samples[i - 1];
+	word conversionsLeft = 1 << (2 * dev_oversamplingBits);
+	while (true) {
+		while (isADCReadInProcess());
+		processSample(AnReadEnd());
+		if (--conversionsLeft == 0) break;
+		ADCSRA = dev_ctrl_stat_reg; //Канал и источник уже выбраны
 	}
+}
+
+word Voltmeter::readRaw() {
+	AnReadStart();
 	while (isADCReadInProcess());
-	samples[0] = AnReadEnd();
+	return AnReadEnd();
+}
+
+void Voltmeter::setOversampling(byte extraBits) {
+	uint8_t oldSREG = SREG;
+	cli();
+	dev_oversamplingBits = extraBits > VOLTMETER_MAX_OVERSAMPLING_BITS ? VOLTMETER_MAX_OVERSAMPLING_BITS : extraBits;
+	dev_oversampleCount = 0;
+	dev_oversampleSum = 0;
+	for (byte i = 0; i < dev_maxFilterSamplesCount; i++) { //Старые выборки другой разрядности
+		samples[i] = 0;
+	}
+	if (dev_filter != NULL) dev_filter->reset();
+	dev_changed = true;
+	SREG = oldSREG;
+}
+
+byte Voltmeter::getEffectiveBits() {
+	return 10 + dev_oversamplingBits;
+}
+
+unsigned long Voltmeter::getConversionRate() {
+	return conversionRateFor(dev_ctrl_stat_reg);
+}
+
+unsigned long Voltmeter::conversionRateFor(byte adcRate) {
+	byte prescalerBits = adcRate & B00000111;
+	unsigned long prescaler = prescalerBits == 0 ? 2 : 1UL << prescalerBits;
+	return F_CPU / prescaler / DEV_VLM_CONVERSION_ADC_CLOCKS;
+}
+
+unsigned long Voltmeter::getResultRate() {
+	return getConversionRate() >> (2 * dev_oversamplingBits);
+}
+
+void Voltmeter::setFilter(VoltmeterFilter *filter) {
+	uint8_t oldSREG = SREG;
+	cli();
+	dev_filter = filter;
+	if (dev_filter != NULL) dev_filter->reset();
 	dev_changed = true;
+	SREG = oldSREG;
+}
+
+void Voltmeter::processSample(word adcValue) {
+	if (dev_oversamplingBits) {
+		dev_oversampleSum += adcValue;
+		if (++dev_oversampleCount < (1 << (2 * dev_oversamplingBits))) return;
+		adcValue = dev_oversampleSum >> dev_oversamplingBits;
+		dev_oversampleSum = 0;
+		dev_oversampleCount = 0;
+	}
+	if (dev_filter != NULL) {
+		if (!dev_filter->process(adcValue, adcValue)) return;
+		dev_filteredValue = adcValue;
+	} else {
+		for (byte i = dev_maxFilterSamplesCount - 1; i > 0; i--) {
+			samples[i] = samples[i - 1];
+		}
+		samples[0] = adcValue;
+	}
+	dev_changed = true;
+	if (dev_watchers != NULL) {
+		word reading = adcValue << (DEV_VLM_RESULT_FRACTION_BITS - dev_oversamplingBits);
+		for (VoltageWatcher *watcher = dev_watchers; watcher != NULL; watcher = watcher->dev_next) {
+			watcher->dev_evaluate(reading);
+		}
+	}
 }
 
 word Voltmeter::averageFromSamples() {
-	float sumOfSamples = 0;
+	unsigned long sumOfSamples = 0;
 	for (byte i = 0; i < dev_maxFilterSamplesCount; i++) {
 		sumOfSamples += samples[i];
 	}
-	return sumOfSamples / (float) dev_maxFilterSamplesCount;
+	return sumOfSamples / dev_maxFilterSamplesCount;
 }
 
-float Voltmeter::getVoltage() {
+word Voltmeter::dev_currentReading() {
+	byte scaleShift = DEV_VLM_RESULT_FRACTION_BITS - dev_oversamplingBits; //Результат всегда в 1/64 единицы 10-битного АЦП
+	if (dev_filter != NULL) {
+		return dev_filteredValue << scaleShift;
+	}
 	if (dev_changed) {
-		dev_lastResult = dev_maxFilterSamplesCount > 1 ? (dev_lastResult + averageFromSamples()) / 2 : samples[0];
+		if (dev_maxFilterSamplesCount > 1) {
+			dev_lastResult = ((unsigned long) dev_lastResult + ((unsigned long) averageFromSamples() << scaleShift)) >> 1;
+		} else {
+			dev_lastResult = samples[0] << scaleShift;
+		}
 		dev_changed = false;
 	}
-	return dev_lastResult * dev_transferCoeff;
+	return dev_lastResult;
+}
+
+float Voltmeter::getVoltage() {
+	uint8_t oldSREG = SREG; //Выборки могут обновляться из прерывания АЦП (ADCScanner)
+	cli();
+	word reading = dev_currentReading();
+	SREG = oldSREG;
+	return reading * dev_transferCoeff / (1 << DEV_VLM_RESULT_FRACTION_BITS);
+}
+
+float Voltmeter::codesToVoltage(float codes) {
+	return codes * dev_transferCoeff;
+}
+
+unsigned long Voltmeter::getMillivolts() {
+	uint8_t oldSREG = SREG;
+	cli();
+	word reading = dev_currentReading();
+	SREG = oldSREG;
+	byte shift = dev_millivoltsShift + DEV_VLM_RESULT_FRACTION_BITS;
+	return ((unsigned long) reading * dev_millivoltsScale + (1UL << (shift - 1))) >> shift;
 }
\ No newline at end of file
@@ -29,6 +29,12 @@
 	измерение займёт в 30 раз больше времени!!! Для его включения, вызовите один раз функцию enableREFcalibrationPass(). Вы также можете передать ей количество 
 	проходов для калибрации. По умолчанию: 30.
 	Включение данной функции сильно замедлит работу вольтметра. Для компенсации потери скорости вы можете увеличить тактовую частоту АЦП.
+	Библиотека помнит, какой источник опорного напряжения был применён последним (общий для всех вольтметров), поэтому калибровочные проходы выполняются 
+	только тогда, когда источник действительно меняется. Если вы сами меняете ADMUX (например, вызываете analogRead()), вызовите Voltmeter::invalidateReference().
+	Чтобы свести количество переключений к минимуму, измеряйте несколько вольтметров сразу статическим методом measureAll(Voltmeter** voltmeters, byte count):
+	он группирует вольтметры по источнику опорного напряжения, начиная с уже применённого.
+	Для настройки можно узнать количество переключений источника (getReferenceSwitchCount()) и отброшенных при этом преобразований (getDiscardedConversionsCount()).
+	Обнулить эти счётчики можно методом resetReferenceStatistics().
 	
 	Если вы хотите изменить скорость преобразования/включить прерывания по завершению преобразования, либо произвести иные манипуляции с регистром ADCSRA, используйте метод
 	set_CTRL_STAT_REG_VAL(byte new_ADCSRA_val), принимающий байтовое значение, которое будет записываться в регистр каждый раз при произведении измерения.
@@ -47,6 +53,21 @@
 	Для проведения измерений напряжения большего, чем опорное, необходимо сделать резистивный делитель, а в конструкторе вводятся параметры верхнего и нижнего резистора.
 	Можно дополнительно изменить количество выборок. Если необходимо отключить фильтрацию - укажите 1.
 	Также, изменение количества выборок и разброса возможно методом setFilterSamplesCount(byte countOfSamples). 
+	Усреднение только снижает шум, но не добавляет разрядности. Для повышения разрешения используйте передискретизацию методом setOversampling(byte extraBits):
+	на каждый результат берётся 4^extraBits преобразований, их сумма сдвигается вправо на extraBits, и получается результат разрядностью 10 + extraBits бит
+	(extraBits от 1 до VOLTMETER_MAX_OVERSAMPLING_BITS = 4, то есть до 14 бит). 0 выключает режим. Метод processMeasurement() в этом режиме выполняет все 
+	4^extraBits преобразований за один вызов. Для работы метода нужен шум на входе хотя бы в 1 единицу АЦП - на идеально стабильном сигнале разрешение не вырастет.
+	Чтобы скорость оставалась приемлемой, совмещайте передискретизацию с более высокой частотой АЦП (ADC_RATE_500KHz, ADC_RATE_1MHz): например, 16 преобразований 
+	на 1МГц занимают примерно столько же, сколько одно на 125КГц.
+	Текущую разрядность возвращает метод getEffectiveBits(), ожидаемое число преобразований в секунду при выбранной частоте АЦП - getConversionRate(), 
+	а число готовых результатов в секунду с учётом передискретизации - getResultRate().
+	Вместо встроенного усреднения можно подключить свой целочисленный конвейер фильтров (скользящее и экспоненциальное среднее, медиана, БИХ-фильтр, 
+	прореживание) методом setFilter(VoltmeterFilter* filter). Набор фильтров и их расход памяти описаны в файле VoltmeterFilters.h. 
+	Передайте NULL, чтобы вернуться к встроенному усреднению.
+	
+	Массив выборок фильтра вольтметр выделяет в куче (realloc() в конструкторе и в setFilterSamplesCount()). Чтобы обойтись без кучи, отдайте ему свой массив:
+	Voltmeter(пин, массив word, количество выборок, опорное, R1, R2), или объявите StaticVoltmeter<N>(пин, опорное, R1, R2) - N выборок хранятся в объекте.
+	Тогда setFilterSamplesCount() может только уменьшить количество выборок до размера массива. С флагом MYLIB_STATIC остаётся только этот вариант.
 	
 	Для того, чтобы узнать верхнюю границу вольтметра с определёнными параметрами, используйте эту формулу:
 	|-------------------------------|
@@ -55,6 +76,17 @@
 	Где REF - опорное напряжение, а R1 и R2 - параметры верхнего и нижнего резисторов делителя соответственно.
 	Для проведения очередного измерения и учёта его результата в усреднённом напряжении, в цикле/таймере/отдельном потоке вызывается метод processMeasurement()
 	Для того, чтобы узнать текущий уровень напряжения на этом выводе, вызывается метод getVoltage().
+	Если достаточно целого числа милливольт, используйте метод getMillivolts(). Он не использует вычислений с плавающей точкой: коэффициент пересчёта в 
+	виде целого числа со сдвигом вычисляется один раз в setDividerParams(), а усреднение ведётся в целых числах с 6 дробными битами.
+	Если результат преобразования получен не самим вольтметром (например, из прерывания АЦП), его можно учесть в фильтре методом processSample(word adcValue).
+	Для непрерывного фонового опроса нескольких вольтметров без ожидания окончания преобразования используйте класс ADCScanner (файл ADCScanner.h).
+	Для слежения за порогами напряжения (просадка питания, разряд батареи) с гистерезисом и временем удержания подключите наблюдателей VoltageWatcher 
+	(файл VoltageWatcher.h) методом addWatcher(VoltageWatcher* watcher). Они проверяются на каждом новом значении в processSample(), а их обработчики 
+	вызываются из метода processHandlers(), который нужно вызывать в loop().
+	Метод readRaw() выполняет одно преобразование и возвращает код АЦП без фильтрации и пересчёта. На нём построена аналоговая клавиатура AnalogKeypad
+	(файл AnalogKeypad.h) - несколько кнопок на одном пине через резистивную лестницу.
+	Для быстрой записи серии выборок с постоянной частотой (диагностика пульсаций) и потоковой статистики (минимум, максимум, среднее, RMS, размах) 
+	используйте класс VoltmeterBurst (файл VoltmeterBurst.h). Статистику в единицах АЦП можно перевести в вольты методом codesToVoltage(float codes).
 	Начало положено by ExtNeon. 05.11.2017
 */
 
@@ -62,7 +94,7 @@
 #ifndef Voltmeter_h // если библиотека не подключена
 #define Voltmeter_h // тогда подключаем ее
 
-#if defined (__AVR_ATmega328__) || defined (__AVR_ATmega328P__) || defined(__AVR_ATmega168__) || defined(__AVR_ATmega88__) 
+#if defined (__AVR_ATmega328__) || defined (__AVR_ATmega328P__) || defined(__AVR_ATmega168__) || defined(__AVR_ATmega88__) || defined(MYLIB_HOST)
 
 #define shl(x) ((x << 1) | (x >> 7)) //Cyclic shift bits in byte to the left
 #define shr(x) ((x >> 1) | (x << 7)) //Cyclic shift bits in byte to the right
@@ -75,36 +107,93 @@
 #define ADC_RATE_4MHz B11000010
 #define ADC_RATE_8MHz B11000001
 
+#define DEV_VLM_RESULT_FRACTION_BITS 6 //Дробные биты усреднённого результата: 1023 << 6 ещё помещается в word
+#define VOLTMETER_MAX_OVERSAMPLING_BITS 4 //4^4 = 256 преобразований на результат, 14 бит
+#define DEV_VLM_CONVERSION_ADC_CLOCKS 13 //Длительность преобразования в тактах АЦП
+
+#define VOLTMETER_REF_MASK B11000000 //Биты REFS1:0 регистра ADMUX
+#define VOLTMETER_REF_UNKNOWN 0xFF //Источник опорного напряжения ещё не применялся или был изменён извне
+
 #include "Arduino.h"
 #include <avr/io.h>
+#include "VoltmeterFilters.h"
+#include "VoltageWatcher.h"
 
 class Voltmeter {
 	public:
+#ifndef MYLIB_STATIC
 		Voltmeter(byte measurement_Pin, float ctrl_ref_voltage = 5., float rdiv_TopResistance = 0, float rdiv_BottomResistance = 1, byte filterCountOfSamples = 3);
+#endif
+		Voltmeter(byte measurement_Pin, word *samplesBuffer, byte samplesCount, float ctrl_ref_voltage = 5., float rdiv_TopResistance = 0, float rdiv_BottomResistance = 1);
 		void setDividerParams(float rdiv_TopResistance, float rdiv_BottomResistance, float ctrl_ref_voltage);
 		void setFilterSamplesCount(byte countOfSamples);
+		void setFilter(VoltmeterFilter *filter);
+		void setOversampling(byte extraBits);
+		byte getEffectiveBits();
+		unsigned long getConversionRate();
+		unsigned long getResultRate();
+		static unsigned long conversionRateFor(byte adcRate);
 		float getVoltage();
+		unsigned long getMillivolts();
+		float codesToVoltage(float codes);
+		void addWatcher(VoltageWatcher *watcher);
+		void processHandlers();
 		void processMeasurement();
+		word readRaw();
+		void processSample(word adcValue);
 		void set_CTRL_STAT_REG_VAL(byte new_ADCSRA_val);
 		void enableREFcalibrationPass(byte amountOfPasses = 30);
+		static void measureAll(Voltmeter **voltmeters, byte count);
+		static void invalidateReference();
+		static unsigned long getReferenceSwitchCount();
+		static unsigned long getDiscardedConversionsCount();
+		static void resetReferenceStatistics();
 	private:
+		static volatile byte dev_appliedReference;
+		static volatile unsigned long dev_referenceSwitchCount;
+		static volatile unsigned long dev_discardedConversionsCount;
+		static void dev_measureGroup(Voltmeter **voltmeters, byte count, byte reference);
+		byte dev_applyReference();
 		void AnReadStart();
 		uint16_t AnReadEnd();
 		boolean isADCReadInProcess();
 		word averageFromSamples();
+		word dev_currentReading();
+		word dev_millivoltsToReading(unsigned long millivolts);
 		byte _pin;
 		//short *dev_vlmSumValue;
 		byte dev_maxFilterSamplesCount; //Максимальное количество сложений для усреднения
 		word* samples = NULL;
+		byte dev_samplesCapacity = 0; //Размер массива выборок скетча, 0 - массив в куче
+		word dev_singleSample;
+		void dev_init(byte measurement_Pin, float ctrl_ref_voltage, float rdiv_TopResistance, float rdiv_BottomResistance);
 		//int dev_countOfMeasures = 0;
 		//short dev_sum = 0;
 		double dev_transferCoeff;
+		unsigned long dev_millivoltsScale; //Милливольт на единицу АЦП, умноженные на 2^dev_millivoltsShift
+		byte dev_millivoltsShift;
 		boolean dev_changed = true;
-		float dev_lastResult;
+		word dev_lastResult = 0; //Усреднённый результат с DEV_VLM_RESULT_FRACTION_BITS дробными битами
+		VoltmeterFilter *dev_filter = NULL;
+		word dev_filteredValue = 0;
+		byte dev_oversamplingBits = 0;
+		word dev_oversampleCount = 0;
+		unsigned long dev_oversampleSum = 0;
+		VoltageWatcher *dev_watchers = NULL;
 		//byte _filterRange;
 		byte dev_ctrl_stat_reg = ADC_RATE_250KHz; 
 		byte _EXP_DEV_ENABLE_CALIBRATION_PASS_AMNT = 0;
-		
+		friend class ADCScanner;
+		friend class VoltmeterBurst;
+		friend class VoltageWatcher;
+};
+
+template <byte N> class StaticVoltmeter : public Voltmeter {
+	public:
+		StaticVoltmeter(byte measurement_Pin, float ctrl_ref_voltage = 5., float rdiv_TopResistance = 0, float rdiv_BottomResistance = 1) :
+			Voltmeter(measurement_Pin, dev_storage, N, ctrl_ref_voltage, rdiv_TopResistance, rdiv_BottomResistance) {}
+	private:
+		word dev_storage[N];
 };
 #else
 #error  Ваш контроллер библиотекой Voltmeter Registers Operation не поддерживается
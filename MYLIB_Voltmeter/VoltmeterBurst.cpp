@@ -0,0 +1,130 @@
+/**
+	VoltmeterBurst_h - быстрая запись серии выборок одного вольтметра (Voltmeter) для диагностики пульсаций.
+	АЦП переводится в режим непрерывного преобразования с прерыванием по его окончанию, поэтому выборки идут с постоянной частотой, заданной 
+	делителем ADC_RATE_*, а не с частотой вызовов processMeasurement(). Каждая выборка из прерывания записывается в буфер и учитывается в потоковой 
+	статистике (минимум, максимум, среднее, RMS, размах - см. VoltmeterStatistics.h).
+	
+	При создании указывается вольтметр, с пина которого ведётся запись. Его делитель и источник опорного напряжения используются как есть.
+	
+	Запуск - метод start(word* buffer, word length, byte adcRate = ADC_RATE_1MHz). Буфер выделяете вы сами; запись закончится, когда он заполнится 
+	(проверяется методом isDone()). Если передать NULL, буфер не используется, и статистика накапливается непрерывно, пока не будет вызван stop().
+	Как и в ADCScanner, обработчик прерывания объявляется в скетче:
+		ISR(ADC_vect) {
+			burst.processInterrupt();
+		}
+	Пока идёт запись, не используйте этот АЦП ни в вольтметрах, ни в ADCScanner.
+	
+	Отчёт:
+		* getCapturedCount() - количество записанных выборок.
+		* getSampleRate() - фактическая частота выборок в секунду.
+		* getOverruns() - оценка количества потерянных выборок: сколько преобразований должно было пройти за время записи при выбранной частоте АЦП,
+			минус сколько было записано. Если число растёт, обработчик прерывания не успевает - уменьшите частоту АЦП.
+		* getStatistics() - потоковая статистика в единицах АЦП. Перевести её в вольты можно методом Voltmeter::codesToVoltage().
+	Ориентировочно: при 16МГц обработка одной выборки занимает несколько микросекунд, так что ADC_RATE_1MHz (13 микросекунд на выборку) работает без потерь,
+	а на ADC_RATE_2MHz и выше стоит проверять getOverruns().
+*/
+
+#include "Arduino.h"
+#include "VoltmeterBurst.h"
+
+VoltmeterBurst::VoltmeterBurst(Voltmeter *voltmeter) {
+	dev_voltmeter = voltmeter;
+	dev_buffer = NULL;
+	dev_length = 0;
+	dev_capturedCount = 0;
+	dev_discardLeft = 0;
+	dev_running = false;
+	dev_startTime = 0;
+	dev_endTime = 0;
+	dev_conversionRate = 0;
+}
+
+boolean VoltmeterBurst::start(word *buffer, word length, byte adcRate) {
+	if (dev_running || (buffer != NULL && length == 0)) return false;
+	dev_buffer = buffer;
+	dev_length = length;
+	dev_capturedCount = 0;
+	dev_startTime = 0;
+	dev_endTime = 0;
+	dev_statistics.reset();
+	dev_conversionRate = Voltmeter::conversionRateFor(adcRate);
+	ADMUX = dev_voltmeter->_pin;
+	dev_discardLeft = dev_voltmeter->dev_applyReference() + 1; //+1: первое преобразование после перезапуска АЦП
+	dev_running = true;
+	ADCSRB &= ~(_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0)); //Free running
+	ADCSRA = (adcRate & B00000111) | _BV(ADEN) | _BV(ADSC) | _BV(ADATE) | _BV(ADIF) | _BV(ADIE);
+	return true;
+}
+
+void VoltmeterBurst::dev_finish() {
+	ADCSRA &= ~(_BV(ADATE) | _BV(ADIE));
+	dev_endTime = micros();
+	dev_running = false;
+}
+
+void VoltmeterBurst::stop() {
+	uint8_t oldSREG = SREG;
+	cli();
+	if (dev_running) dev_finish();
+	SREG = oldSREG;
+}
+
+boolean VoltmeterBurst::isRunning() {
+	return dev_running;
+}
+
+boolean VoltmeterBurst::isDone() {
+	return !dev_running && dev_buffer != NULL && dev_capturedCount >= dev_length;
+}
+
+void VoltmeterBurst::processInterrupt() {
+	word adcValue = dev_voltmeter->AnReadEnd();
+	if (!dev_running) return;
+	if (dev_discardLeft) {
+		dev_discardLeft--;
+		return;
+	}
+	if (dev_capturedCount == 0) dev_startTime = micros(); //Отсчёт времени с первой записанной выборки
+	dev_statistics.add(adcValue);
+	if (dev_buffer != NULL) {
+		dev_buffer[dev_capturedCount] = adcValue;
+		if (++dev_capturedCount >= dev_length) dev_finish();
+	} else {
+		dev_capturedCount++;
+	}
+}
+
+unsigned long VoltmeterBurst::getCapturedCount() {
+	uint8_t oldSREG = SREG;
+	cli();
+	unsigned long temp = dev_capturedCount;
+	SREG = oldSREG;
+	return temp;
+}
+
+unsigned long VoltmeterBurst::dev_elapsedMicros() {
+	uint8_t oldSREG = SREG;
+	cli();
+	unsigned long endTime = dev_running ? micros() : dev_endTime;
+	unsigned long elapsed = endTime - dev_startTime;
+	SREG = oldSREG;
+	return elapsed;
+}
+
+float VoltmeterBurst::getSampleRate() {
+	unsigned long captured = getCapturedCount();
+	unsigned long elapsed = dev_elapsedMicros();
+	if (captured < 2 || elapsed == 0) return 0;
+	return (captured - 1) * 1000000. / elapsed; //Между первой и последней выборкой captured - 1 интервалов
+}
+
+unsigned long VoltmeterBurst::getOverruns() {
+	unsigned long captured = getCapturedCount();
+	if (captured == 0) return 0;
+	unsigned long expected = (float) dev_elapsedMicros() * dev_conversionRate / 1000000. + 1;
+	return expected > captured ? expected - captured : 0;
+}
+
+VoltmeterStatistics &VoltmeterBurst::getStatistics() {
+	return dev_statistics;
+}
@@ -0,0 +1,61 @@
+/**
+	VoltmeterBurst_h - быстрая запись серии выборок одного вольтметра (Voltmeter) для диагностики пульсаций.
+	АЦП переводится в режим непрерывного преобразования с прерыванием по его окончанию, поэтому выборки идут с постоянной частотой, заданной 
+	делителем ADC_RATE_*, а не с частотой вызовов processMeasurement(). Каждая выборка из прерывания записывается в буфер и учитывается в потоковой 
+	статистике (минимум, максимум, среднее, RMS, размах - см. VoltmeterStatistics.h).
+	
+	При создании указывается вольтметр, с пина которого ведётся запись. Его делитель и источник опорного напряжения используются как есть.
+	
+	Запуск - метод start(word* buffer, word length, byte adcRate = ADC_RATE_1MHz). Буфер выделяете вы сами; запись закончится, когда он заполнится 
+	(проверяется методом isDone()). Если передать NULL, буфер не используется, и статистика накапливается непрерывно, пока не будет вызван stop().
+	Как и в ADCScanner, обработчик прерывания объявляется в скетче:
+		ISR(ADC_vect) {
+			burst.processInterrupt();
+		}
+	Пока идёт запись, не используйте этот АЦП ни в вольтметрах, ни в ADCScanner.
+	
+	Отчёт:
+		* getCapturedCount() - количество записанных выборок.
+		* getSampleRate() - фактическая частота выборок в секунду.
+		* getOverruns() - оценка количества потерянных выборок: сколько преобразований должно было пройти за время записи при выбранной частоте АЦП,
+			минус сколько было записано. Если число растёт, обработчик прерывания не успевает - уменьшите частоту АЦП.
+		* getStatistics() - потоковая статистика в единицах АЦП. Перевести её в вольты можно методом Voltmeter::codesToVoltage().
+	Ориентировочно: при 16МГц обработка одной выборки занимает несколько микросекунд, так что ADC_RATE_1MHz (13 микросекунд на выборку) работает без потерь,
+	а на ADC_RATE_2MHz и выше стоит проверять getOverruns().
+*/
+
+#ifndef VoltmeterBurst_h
+#define VoltmeterBurst_h
+
+#include "Arduino.h"
+#include "Voltmeter.h"
+#include "VoltmeterStatistics.h"
+
+class VoltmeterBurst {
+	public:
+		VoltmeterBurst(Voltmeter *voltmeter);
+		boolean start(word *buffer, word length, byte adcRate = ADC_RATE_1MHz);
+		void stop();
+		boolean isRunning();
+		boolean isDone();
+		void processInterrupt(); //Вызывается из ISR(ADC_vect)
+		unsigned long getCapturedCount();
+		float getSampleRate();
+		unsigned long getOverruns();
+		VoltmeterStatistics &getStatistics();
+	private:
+		Voltmeter *dev_voltmeter;
+		VoltmeterStatistics dev_statistics;
+		word *dev_buffer;
+		word dev_length;
+		volatile unsigned long dev_capturedCount;
+		volatile byte dev_discardLeft; //Преобразования, отбрасываемые после запуска и смены источника опорного напряжения
+		volatile boolean dev_running;
+		volatile unsigned long dev_startTime;
+		volatile unsigned long dev_endTime;
+		unsigned long dev_conversionRate;
+		void dev_finish();
+		unsigned long dev_elapsedMicros();
+};
+
+#endif
@@ -0,0 +1,229 @@
+/**
+	VoltmeterFilters_h - набор целочисленных фильтров для вольтметра (Voltmeter), из которых собирается цепочка (конвейер) обработки выборок АЦП.
+	Стандартный фильтр вольтметра - скользящее среднее, считаемое в getVoltage() с плавающей точкой. Для разных линий питания нужны разные фильтры, поэтому
+	вольтметру можно подключить свой конвейер методом setFilter(VoltmeterFilter* filter). Тогда каждая выборка проходит через конвейер прямо в processSample(),
+	а getVoltage() только умножает готовый результат на коэффициент.
+	Все ступени работают только с целыми числами. Параметры ступеней задаются шаблонами, поэтому размеры буферов и сдвиги известны на этапе компиляции,
+	а деление на степень двойки компилятор заменяет сдвигом.
+
+	Ступени (в скобках - занимаемая оперативная память, N - параметр шаблона):
+		* MovingAverageStage<N> - скользящее среднее по N выборкам с накопленной суммой, O(1) на выборку. (2*N + 6 байт)
+			Желательно, чтобы N было степенью двойки - тогда деление заменяется сдвигом.
+		* EMAStage<SHIFT> - экспоненциальное скользящее среднее с коэффициентом 1/2^SHIFT (SHIFT от 1 до 15). Выход доходит до входа точно. (5 байт)
+		* MedianStage<N> - медиана по N (нечётное, от 3 до 9) последним выборкам. Отсекает одиночные выбросы. (2*N + 2 байта)
+		* IIRStage<ALPHA, SHIFT> - БИХ-фильтр первого порядка y += (x - y) * ALPHA / 2^SHIFT, ALPHA < 2^SHIFT, SHIFT не больше 8.
+			Внутреннее значение хранится с SHIFT дробными битами, приращение округляется к ближайшему в обе стороны, поэтому выход доходит
+			до входа точно - и при росте, и при спаде. (5 байт)
+		* DecimatorStage<N> - прореживание: выдаёт среднее каждых N выборок, остальные вызовы результата не дают. (5 байт)
+	Ступени объединяются шаблоном FilterChain<Первая, Вторая>. Для более длинной цепочки вложите FilterChain во вторую ступень. Цепочка занимает столько же,
+	сколько её ступени вместе.
+	Чтобы подключить конвейер к вольтметру, оберните его в VoltmeterFilterPipeline<...>. Обёртка добавляет указатель на таблицу виртуальных методов (2 байта),
+	сама таблица (около 8 байт на каждый тип конвейера) на AVR тоже лежит в оперативной памяти.
+
+	Пример: медиана по 3 выборкам для отсечения выбросов, затем экспоненциальное среднее с коэффициентом 1/16:
+		VoltmeterFilterPipeline<FilterChain<MedianStage<3>, EMAStage<4> > > batteryFilter;
+		...
+		battery.setFilter(&batteryFilter);
+
+	Накопители ступеней - uint32_t и int32_t, поэтому на компьютере (host/tests) ступени считают так же, как на плате. Там sizeof() ступени
+	с 32-битным накопителем округляется вверх до кратного 4 - на AVR выравнивания нет.
+
+	Каждая ступень имеет метод boolean process(word input, word &output), который возвращает false, если на этой выборке результата нет (прореживание),
+	и метод reset(), сбрасывающий её состояние. Первая выборка после сброса заполняет состояние целиком, поэтому разгона фильтра нет.
+*/
+
+#ifndef VoltmeterFilters_h
+#define VoltmeterFilters_h
+
+#include "Arduino.h"
+
+class VoltmeterFilter {
+	public:
+		virtual boolean process(word input, word &output) = 0;
+		virtual void reset() = 0;
+};
+
+template <byte N>
+class MovingAverageStage {
+	static_assert(N >= 1, "MovingAverageStage: N must be at least 1");
+	public:
+		MovingAverageStage() {
+			reset();
+		}
+		boolean process(word input, word &output) {
+			if (!dev_filled) {
+				for (byte i = 0; i < N; i++) {
+					dev_window[i] = input;
+				}
+				dev_sum = (uint32_t) input * N;
+				dev_filled = true;
+			} else {
+				dev_sum += input;
+				dev_sum -= dev_window[dev_index];
+				dev_window[dev_index] = input;
+			}
+			if (++dev_index >= N) dev_index = 0;
+			output = dev_sum / N;
+			return true;
+		}
+		void reset() {
+			dev_index = 0;
+			dev_filled = false;
+		}
+	private:
+		uint32_t dev_sum; //32-битные поля - первыми, чтобы на компьютере не было дыр для выравнивания
+		word dev_window[N];
+		byte dev_index;
+		boolean dev_filled;
+};
+
+template <byte SHIFT>
+class EMAStage {
+	static_assert(SHIFT >= 1 && SHIFT <= 15, "EMAStage: SHIFT must be 1..15");
+	public:
+		EMAStage() {
+			reset();
+		}
+		boolean process(word input, word &output) {
+			if (!dev_filled) {
+				dev_accumulator = (uint32_t) input << SHIFT;
+				dev_filled = true;
+			} else {
+				//Вычитается округлённое среднее: с отбрасыванием дробной части накопитель при спаде застревал бы выше входа
+				dev_accumulator = dev_accumulator - ((dev_accumulator + ((uint32_t) 1 << (SHIFT - 1))) >> SHIFT) + input;
+			}
+			output = (dev_accumulator + ((uint32_t) 1 << (SHIFT - 1))) >> SHIFT;
+			return true;
+		}
+		void reset() {
+			dev_filled = false;
+		}
+	private:
+		uint32_t dev_accumulator; //Среднее, умноженное на 2^SHIFT
+		boolean dev_filled;
+};
+
+template <byte N>
+class MedianStage {
+	static_assert(N >= 3 && N <= 9 && (N & 1), "MedianStage: N must be odd, 3..9");
+	public:
+		MedianStage() {
+			reset();
+		}
+		boolean process(word input, word &output) {
+			if (!dev_filled) {
+				for (byte i = 0; i < N; i++) {
+					dev_window[i] = input;
+				}
+				dev_filled = true;
+			} else {
+				dev_window[dev_index] = input;
+			}
+			if (++dev_index >= N) dev_index = 0;
+			word sorted[N];
+			for (byte i = 0; i < N; i++) { //Сортировка вставками, для N <= 9 быстрее любой другой
+				word value = dev_window[i];
+				byte j = i;
+				while (j > 0 && sorted[j - 1] > value) {
+					sorted[j] = sorted[j - 1];
+					j--;
+				}
+				sorted[j] = value;
+			}
+			output = sorted[N / 2];
+			return true;
+		}
+		void reset() {
+			dev_index = 0;
+			dev_filled = false;
+		}
+	private:
+		word dev_window[N];
+		byte dev_index;
+		boolean dev_filled;
+};
+
+template <word ALPHA, byte SHIFT = 8>
+class IIRStage {
+	static_assert(SHIFT >= 1 && SHIFT <= 8, "IIRStage: SHIFT must be 1..8");
+	static_assert(ALPHA >= 1 && ALPHA < (1 << SHIFT), "IIRStage: ALPHA must be 1..2^SHIFT-1");
+	public:
+		IIRStage() {
+			reset();
+		}
+		boolean process(word input, word &output) {
+			int32_t scaledInput = (int32_t) input << SHIFT;
+			if (!dev_filled) {
+				dev_value = scaledInput;
+				dev_filled = true;
+			} else {
+				//1023 << 8 * 255 помещается в 31 бит. Сдвиг отрицательного числа округлял бы вниз, и рост останавливался бы не дойдя до входа
+				int32_t product = (scaledInput - dev_value) * ALPHA;
+				dev_value += product >= 0 ? (product + (1L << (SHIFT - 1))) >> SHIFT : -((-product + (1L << (SHIFT - 1))) >> SHIFT);
+			}
+			output = (dev_value + (1L << (SHIFT - 1))) >> SHIFT;
+			return true;
+		}
+		void reset() {
+			dev_filled = false;
+		}
+	private:
+		int32_t dev_value; //Выход фильтра с SHIFT дробными битами
+		boolean dev_filled;
+};
+
+template <byte N>
+class DecimatorStage {
+	static_assert(N >= 1, "DecimatorStage: N must be at least 1");
+	public:
+		DecimatorStage() {
+			reset();
+		}
+		boolean process(word input, word &output) {
+			dev_sum += input;
+			if (++dev_count < N) return false;
+			output = dev_sum / N;
+			dev_sum = 0;
+			dev_count = 0;
+			return true;
+		}
+		void reset() {
+			dev_sum = 0;
+			dev_count = 0;
+		}
+	private:
+		uint32_t dev_sum;
+		byte dev_count;
+};
+
+template <class First, class Second>
+class FilterChain {
+	public:
+		boolean process(word input, word &output) {
+			word intermediate;
+			if (!dev_first.process(input, intermediate)) return false;
+			return dev_second.process(intermediate, output);
+		}
+		void reset() {
+			dev_first.reset();
+			dev_second.reset();
+		}
+	private:
+		First dev_first;
+		Second dev_second;
+};
+
+template <class Stage>
+class VoltmeterFilterPipeline : public VoltmeterFilter {
+	public:
+		boolean process(word input, word &output) {
+			return dev_stage.process(input, output);
+		}
+		void reset() {
+			dev_stage.reset();
+		}
+	private:
+		Stage dev_stage;
+};
+
+#endif
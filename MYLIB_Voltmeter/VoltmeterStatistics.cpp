@@ -0,0 +1,96 @@
+/**
+	VoltmeterStatistics_h - потоковая статистика по выборкам АЦП: минимум, максимум, среднее, среднеквадратичное значение (RMS) и размах (peak-to-peak).
+	Значения не хранятся, на каждую выборку выполняется одно сравнение с минимумом и максимумом, одно умножение и сложения 32-битных чисел, поэтому 
+	статистику можно накапливать прямо из прерывания АЦП. Сумма квадратов переносится в 64-битную раз в несколько тысяч выборок.
+	Выборки - коды 10-битного АЦП (до 1023). Сумма 32-битная, поэтому учитываются первые VST_MAX_COUNT = 4194303 выборки (больше 4 секунд на самой 
+	высокой частоте АЦП), дальнейшие add() игнорируются.
+	
+	Выборка добавляется методом add(word value), сброс - методом reset().
+	Все результаты возвращаются в единицах АЦП. Для перевода в вольты используйте метод Voltmeter::codesToVoltage(float codes) нужного вольтметра.
+	Если статистика накапливается из прерывания, читайте результаты методами этого класса - они копируют данные с запрещёнными прерываниями.
+*/
+
+#include "Arduino.h"
+#include "VoltmeterStatistics.h"
+
+VoltmeterStatistics::VoltmeterStatistics() {
+	reset();
+}
+
+void VoltmeterStatistics::add(word value) {
+	if (dev_count >= VST_MAX_COUNT) return; //Дальше переполнилась бы сумма
+	if (value < dev_min) dev_min = value;
+	if (value > dev_max) dev_max = value;
+	dev_sum += value;
+	uint32_t square = (uint32_t) value * value;
+	if (dev_squaresPart > 0xFFFFFFFFUL - square) {
+		dev_sumOfSquares += dev_squaresPart;
+		dev_squaresPart = 0;
+	}
+	dev_squaresPart += square;
+	dev_count++;
+}
+
+void VoltmeterStatistics::reset() {
+	uint8_t oldSREG = SREG;
+	cli();
+	dev_count = 0;
+	dev_min = 0xFFFF;
+	dev_max = 0;
+	dev_sum = 0;
+	dev_squaresPart = 0;
+	dev_sumOfSquares = 0;
+	SREG = oldSREG;
+}
+
+unsigned long VoltmeterStatistics::getCount() {
+	uint8_t oldSREG = SREG;
+	cli();
+	unsigned long temp = dev_count;
+	SREG = oldSREG;
+	return temp;
+}
+
+word VoltmeterStatistics::getMin() {
+	uint8_t oldSREG = SREG;
+	cli();
+	word temp = dev_count ? dev_min : 0;
+	SREG = oldSREG;
+	return temp;
+}
+
+word VoltmeterStatistics::getMax() {
+	uint8_t oldSREG = SREG;
+	cli();
+	word temp = dev_max;
+	SREG = oldSREG;
+	return temp;
+}
+
+word VoltmeterStatistics::getPeakToPeak() {
+	uint8_t oldSREG = SREG;
+	cli();
+	word temp = dev_count ? dev_max - dev_min : 0;
+	SREG = oldSREG;
+	return temp;
+}
+
+float VoltmeterStatistics::getMean() {
+	uint8_t oldSREG = SREG;
+	cli();
+	unsigned long count = dev_count;
+	uint32_t sum = dev_sum;
+	SREG = oldSREG;
+	if (count == 0) return 0;
+	return (float) sum / count;
+}
+
+float VoltmeterStatistics::getRMS() {
+	uint8_t oldSREG = SREG;
+	cli();
+	unsigned long count = dev_count;
+	uint64_t sumOfSquares = dev_sumOfSquares + dev_squaresPart;
+	SREG = oldSREG;
+	if (count == 0) return 0;
+	return sqrt((float) sumOfSquares / count);
+}
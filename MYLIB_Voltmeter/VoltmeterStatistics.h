@@ -0,0 +1,40 @@
+/**
+	VoltmeterStatistics_h - потоковая статистика по выборкам АЦП: минимум, максимум, среднее, среднеквадратичное значение (RMS) и размах (peak-to-peak).
+	Значения не хранятся, на каждую выборку выполняется одно сравнение с минимумом и максимумом, одно умножение и сложения 32-битных чисел, поэтому 
+	статистику можно накапливать прямо из прерывания АЦП. Сумма квадратов переносится в 64-битную раз в несколько тысяч выборок.
+	Выборки - коды 10-битного АЦП (до 1023). Сумма 32-битная, поэтому учитываются первые VST_MAX_COUNT = 4194303 выборки (больше 4 секунд на самой 
+	высокой частоте АЦП), дальнейшие add() игнорируются.
+	
+	Выборка добавляется методом add(word value), сброс - методом reset().
+	Все результаты возвращаются в единицах АЦП. Для перевода в вольты используйте метод Voltmeter::codesToVoltage(float codes) нужного вольтметра.
+	Если статистика накапливается из прерывания, читайте результаты методами этого класса - они копируют данные с запрещёнными прерываниями.
+*/
+
+#ifndef VoltmeterStatistics_h
+#define VoltmeterStatistics_h
+
+#include "Arduino.h"
+
+#define VST_MAX_COUNT 4194303UL //4194303 * 1023 < 2^32
+
+class VoltmeterStatistics {
+	public:
+		VoltmeterStatistics();
+		void add(word value);
+		void reset();
+		unsigned long getCount();
+		word getMin();
+		word getMax();
+		word getPeakToPeak();
+		float getMean();
+		float getRMS();
+	private:
+		unsigned long dev_count; //Без volatile: читаются только с запрещёнными прерываниями, а cli() - барьер для компилятора
+		word dev_min;
+		word dev_max;
+		uint32_t dev_sum;
+		uint32_t dev_squaresPart; //Накопитель квадратов, переносится в dev_sumOfSquares перед переполнением
+		uint64_t dev_sumOfSquares;
+};
+
+#endif
@@ -0,0 +1,37 @@
+/**
+	HostBench_h - замер скорости кода библиотек на компьютере.
+	Функция hostBenchRun(имя, функция, количество) вызывает функцию заданное количество раз (после короткого прогрева) и печатает среднее время 
+	одного вызова в наносекундах. Результат возвращается, чтобы его можно было сравнить с прошлым замером. hostBenchMeasure() - то же без печати.
+	Время измеряется по часам компьютера, а не по модельному времени эмулятора, поэтому замер показывает относительную стоимость операций, 
+	а не время их выполнения на плате.
+*/
+
+#ifndef HostBench_h
+#define HostBench_h
+
+#include "Arduino.h"
+#include "HostMcu.h"
+#include <chrono>
+#include <functional>
+#include <stdio.h>
+
+static volatile unsigned long hostBenchSink; //Не даёт компилятору выбросить результат замеряемого кода
+
+inline double hostBenchMeasure(std::function<void ()> operation, unsigned long iterations) {
+	for (unsigned long i = 0; i < iterations / 10 + 1; i++) {
+		operation();
+	}
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (unsigned long i = 0; i < iterations; i++) {
+		operation();
+	}
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+inline double hostBenchRun(const char *name, std::function<void ()> operation, unsigned long iterations) {
+	double nanoseconds = hostBenchMeasure(operation, iterations);
+	printf("%-40s %12.1f ns/op %12lu ops\n", name, nanoseconds, iterations);
+	return nanoseconds;
+}
+
+#endif
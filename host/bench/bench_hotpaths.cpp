@@ -0,0 +1,253 @@
+/**
+	bench_hotpaths - замеры горячих путей библиотек с базовой линией: HandledButton::processStep(), HandledEventTimer::processStep(),
+	SevenSegmentsIndicator::refreshNext() и print(), усреднение Voltmeter (processSample() и чтение результата, то есть averageFromSamples()).
+	Размеры - как в скетчах: 4-64 события, индикаторы на 4 и 8 разрядов, фильтр на 8-64 выборки.
+	Использование:
+		bench_hotpaths [-b базовая_линия] [-w новая_базовая_линия] [-t допуск_в_процентах]
+	Каждый замер повторяется BENCH_REPEATS раз (прогон - не меньше 20 мс), берётся лучший: помехи других процессов только замедляют.
+	Сравниваются не наносекунды, а отношение к калибровочному циклу, замеренному в том же проходе (столбец relative): так сравнение
+	не зависит от того, на какой частоте процессор работал в момент замера. С ключом -b результат сравнивается с файлом: если отношение
+	выросло больше, чем на допуск (по умолчанию 25%), набор прогоняется ещё до BENCH_CONFIRM_PASSES раз и берётся лучшее отношение каждого
+	замера. Если превышение осталось, строка помечается REGRESSION и программа завершается с кодом 1. Замеров, которых нет в файле, это не касается.
+	Ключ -w прогоняет набор BENCH_BASELINE_PASSES раз и записывает в файл медиану каждого замера.
+	Формат файла - по строке на замер: "имя отношение наносекунд_на_вызов" (наносекунды - для справки), строки с # - комментарии.
+	Базовая линия (host/bench/hotpaths_baseline.txt) записана на одном компьютере: отношения от частоты почти не зависят, но на процессоре
+	другой архитектуры их лучше перезаписать. Из сборки:
+		cmake --build build --target bench_check - сравнить с базовой линией;
+		cmake --build build --target bench_baseline - перезаписать её (после намеренного изменения скорости или на другом компьютере).
+	Что ускоренный код работает так же, как прежний, проверяет host/tests/test_HotPaths.cpp (сверка с замороженной копией).
+*/
+
+#include "HostBench.h"
+#include "HandledButton.h"
+#include "HandledEventTimer.h"
+#include "SevenSegmentsIndicator.h"
+#include "Voltmeter.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#define BENCH_REPEATS 7
+#define BENCH_DEFAULT_THRESHOLD 25.
+#define BENCH_MIN_RUN_NS 20e6 //Прогон не короче 20 мс
+#define BENCH_BASELINE_PASSES 3 //Проходов набора для записи базовой линии
+#define BENCH_CONFIRM_PASSES 2 //Сколько раз перепроверить набор, если есть превышение
+
+struct BenchResult {
+	std::string name;
+	double nanoseconds;
+	double relative; //Во сколько раз дольше калибровочного цикла
+};
+
+static std::vector<BenchResult> results;
+static byte segmentPins[8] = {2, 3, 4, 5, 6, 7, 8, 9};
+static byte digitPins[8] = {10, 11, 12, 13, 14, 15, 16, 17};
+
+static void measure(const char *name, std::function<void ()> operation, unsigned long iterations) {
+	while (hostBenchMeasure(operation, iterations) * iterations < BENCH_MIN_RUN_NS) { //Короткий прогон - почти один шум часов
+		iterations *= 2;
+	}
+	double best = 0;
+	for (int i = 0; i < BENCH_REPEATS; i++) {
+		double nanoseconds = hostBenchMeasure(operation, iterations);
+		if (i == 0 || nanoseconds < best) best = nanoseconds;
+	}
+	BenchResult result = {name, best, 0};
+	results.push_back(result);
+}
+
+//Цепочка зависимых умножений: её время меняется вместе с частотой процессора, поэтому отношение к нему устойчивее наносекунд
+static void calibrationLoop() {
+	uint32_t value = hostBenchSink;
+	for (int i = 0; i < 64; i++) {
+		value = value * 1664525UL + 1013904223UL;
+	}
+	hostBenchSink = value;
+}
+
+static void benchButton() {
+	HostMcu &mcu = HostMcu::current();
+	HandledButton button(2, 1);
+	mcu.setPinInput(2, HIGH);
+	measure("button.processStep.stable", [&]() {
+		button.processStep();
+	}, 100000);
+	byte level = LOW;
+	unsigned long step = 0;
+	measure("button.processStep.bouncing", [&]() {
+		if ((++step & 7) == 0) { //Смена уровня каждые 8 тиков - кнопка всё время подавляет дребезг
+			level = !level;
+			mcu.setPinInput(2, level);
+		}
+		button.processStep();
+	}, 100000);
+}
+
+static void benchTimer(word eventsCount, const char *name) {
+	HandledEvent events[64];
+	HandledEventTimer timer(1, events, eventsCount);
+	for (word i = 0; i < eventsCount; i++) {
+		timer.createRepeatedEvent(10 + 7 * i, NULL, 0);
+	}
+	timer.start();
+	measure(name, [&]() {
+		timer.processStep();
+	}, 100000);
+}
+
+static void benchIndicator(byte digits, const char *refreshName, const char *printName, const char *text) {
+	byte memory[8];
+	SevenSegmentsIndicator indicator(segmentPins, digits, digitPins, SSI_DGPIN_ANODE, memory);
+	indicator.print(text);
+	measure(refreshName, [&]() {
+		indicator.refreshNext();
+	}, 10000);
+	measure(printName, [&]() {
+		indicator.print(text);
+	}, 100000);
+}
+
+static void benchVoltmeter(byte samplesCount, const char *name) {
+	word samples[64];
+	Voltmeter voltmeter(A0, samples, samplesCount);
+	word code = 0;
+	measure(name, [&]() {
+		voltmeter.processSample(500 + (++code & 15));
+		hostBenchSink += voltmeter.getMillivolts();
+	}, 100000);
+}
+
+static std::vector<BenchResult> runSuite() {
+	results.clear();
+	HostMcu::current().reset();
+	measure("calibration", calibrationLoop, 100000);
+	double calibration = results[0].nanoseconds;
+	results.clear();
+	benchButton();
+	benchTimer(4, "timer.processStep.4");
+	benchTimer(16, "timer.processStep.16");
+	benchTimer(64, "timer.processStep.64");
+	benchIndicator(4, "indicator.refreshNext.4", "indicator.print.4", "-1.23");
+	benchIndicator(8, "indicator.refreshNext.8", "indicator.print.8", "12345.678");
+	benchVoltmeter(8, "voltmeter.average.8");
+	benchVoltmeter(32, "voltmeter.average.32");
+	benchVoltmeter(64, "voltmeter.average.64");
+	for (size_t i = 0; i < results.size(); i++) {
+		results[i].relative = results[i].nanoseconds / calibration;
+	}
+	return results;
+}
+
+//По каждому замеру - медиана проходов (для базовой линии) или лучший из них (для сравнения)
+static std::vector<BenchResult> combine(const std::vector<std::vector<BenchResult> > &passes, bool median) {
+	std::vector<BenchResult> combined = passes[0];
+	for (size_t i = 0; i < combined.size(); i++) {
+		std::vector<double> values;
+		for (size_t pass = 0; pass < passes.size(); pass++) {
+			values.push_back(passes[pass][i].relative);
+		}
+		std::sort(values.begin(), values.end());
+		combined[i].relative = median ? values[values.size() / 2] : values[0];
+		for (size_t pass = 0; pass < passes.size(); pass++) {
+			if (passes[pass][i].relative == combined[i].relative) combined[i].nanoseconds = passes[pass][i].nanoseconds;
+		}
+	}
+	return combined;
+}
+
+static int countRegressions(const std::vector<BenchResult> &measured, std::map<std::string, double> &baseline, double threshold) {
+	int regressions = 0;
+	for (size_t i = 0; i < measured.size(); i++) {
+		std::map<std::string, double>::iterator recorded = baseline.find(measured[i].name);
+		if (recorded != baseline.end() && 100 * (measured[i].relative / recorded->second - 1) > threshold) regressions++;
+	}
+	return regressions;
+}
+
+static bool readBaseline(const char *path, std::map<std::string, double> &baseline) {
+	FILE *file = fopen(path, "r");
+	if (file == NULL) return false;
+	char line[256];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		char name[128];
+		double relative;
+		if (line[0] == '#') continue;
+		if (sscanf(line, "%127s %lf", name, &relative) == 2) baseline[name] = relative;
+	}
+	fclose(file);
+	return true;
+}
+
+static bool writeBaseline(const char *path) {
+	FILE *file = fopen(path, "w");
+	if (file == NULL) return false;
+	fprintf(file, "# bench_hotpaths: name, cost relative to the calibration loop, ns per call (median of %d passes, each best of %d runs)\n",
+		BENCH_BASELINE_PASSES, BENCH_REPEATS);
+	fprintf(file, "# Rewrite: cmake --build build --target bench_baseline\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		fprintf(file, "%s %.4f %.2f\n", results[i].name.c_str(), results[i].relative, results[i].nanoseconds);
+	}
+	fclose(file);
+	return true;
+}
+
+static void printUsage() {
+	fprintf(stderr, "usage: bench_hotpaths [-b baseline] [-w new_baseline] [-t threshold_percent]\n");
+}
+
+int main(int argc, char **argv) {
+	const char *baselinePath = NULL;
+	const char *outputPath = NULL;
+	double threshold = BENCH_DEFAULT_THRESHOLD;
+	for (int i = 1; i < argc; i++) {
+		if (i + 1 < argc && !strcmp(argv[i], "-b")) {
+			baselinePath = argv[++i];
+		} else if (i + 1 < argc && !strcmp(argv[i], "-w")) {
+			outputPath = argv[++i];
+		} else if (i + 1 < argc && !strcmp(argv[i], "-t")) {
+			threshold = atof(argv[++i]);
+		} else {
+			printUsage();
+			return 2;
+		}
+	}
+	std::map<std::string, double> baseline;
+	if (baselinePath != NULL && !readBaseline(baselinePath, baseline)) {
+		fprintf(stderr, "bench_hotpaths: cannot read %s\n", baselinePath);
+		return 1;
+	}
+
+	std::vector<std::vector<BenchResult> > passes;
+	int passesCount = outputPath != NULL ? BENCH_BASELINE_PASSES : 1;
+	for (int pass = 0; pass < passesCount; pass++) {
+		passes.push_back(runSuite());
+	}
+	//Превышение сначала перепроверяется: на занятом компьютере один проход может попасть на чужую нагрузку
+	for (int retry = 0; retry < BENCH_CONFIRM_PASSES && countRegressions(combine(passes, false), baseline, threshold) > 0; retry++) {
+		passes.push_back(runSuite());
+	}
+	results = combine(passes, outputPath != NULL);
+
+	int regressions = countRegressions(results, baseline, threshold);
+	printf("%-32s %12s %10s %10s %9s\n", "hot path", "ns/op", "relative", "baseline", "change");
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchResult &result = results[i];
+		printf("%-32s %12.2f %10.4f", result.name.c_str(), result.nanoseconds, result.relative);
+		std::map<std::string, double>::iterator recorded = baseline.find(result.name);
+		if (recorded == baseline.end()) {
+			printf("\n");
+			continue;
+		}
+		double change = 100 * (result.relative / recorded->second - 1);
+		printf(" %10.4f %+8.1f%%%s\n", recorded->second, change, change > threshold ? "  REGRESSION" : "");
+	}
+	if (outputPath != NULL && !writeBaseline(outputPath)) {
+		fprintf(stderr, "bench_hotpaths: cannot write %s\n", outputPath);
+		return 1;
+	}
+	if (baselinePath != NULL) printf("%d of %u hot paths slower than baseline by more than %.0f%%\n", regressions, (unsigned int) results.size(), threshold);
+	return regressions > 0 ? 1 : 0;
+}
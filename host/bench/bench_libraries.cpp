@@ -0,0 +1,122 @@
+//Замеры основных операций библиотек на эмуляторе. Запуск: ./bench_libraries
+
+#include "HostBench.h"
+#include "HandledButton.h"
+#include "HandledEventTimer.h"
+#include "PatternPlayer.h"
+#include "KeyframePlayer.h"
+#include "Rtttl.h"
+#include "SevenSegmentsIndicator.h"
+#include "Voltmeter.h"
+#include "TraceRecorder.h"
+#include "TraceReplay.h"
+#include <vector>
+
+static void silentTone(int frequency, int duration) {
+	hostBenchSink += frequency;
+}
+
+static void silentNoTone() {}
+
+static void silentOutput(int value) {
+	hostBenchSink += value;
+}
+
+static void emptyHandler() {}
+
+int main() {
+	HostMcu &mcu = HostMcu::current();
+	mcu.reset();
+
+	HandledButton button(2, 10);
+	hostBenchRun("HandledButton::processStep", [&button]() {
+		button.processStep();
+	}, 1000000);
+
+	HandledEventTimer timer(10);
+	for (int i = 0; i < 16; i++) {
+		timer.createRepeatedEvent(10 * (i + 1), emptyHandler, 0);
+	}
+	timer.start();
+	hostBenchRun("HandledEventTimer::processStep (16 events)", [&timer]() {
+		timer.processStep();
+		timer.processHandlers();
+	}, 1000000);
+
+	int frequencies[] = {440, 494, 523, 587, 659, 698, 784, 880};
+	int durations[] = {30, 70, 20, 110, 45, 60, 80, 25};
+	PatternPlayer player(silentTone, silentNoTone, 10);
+	player.play(frequencies, durations, 8, 0x7FFF);
+	hostBenchRun("PatternPlayer::processStep", [&player]() {
+		player.processStep();
+	}, 1000000);
+
+	const char *rtttl = "Simpsons:d=4,o=5,b=160:c.6,e6,f#6,8a6,g.6,e6,c6,8a,8f#,8f#,8f#,2g,8p,8p,8f#,8f#,8f#,8g,a#.,8c6,8c6,8c6,c6";
+	int notes[32], noteDurations[32];
+	hostBenchRun("Rtttl::parse (23 notes)", [&]() {
+		hostBenchSink += Rtttl::parse(rtttl, notes, noteDurations, 32);
+	}, 200000);
+
+	const Keyframe fade[] = {{255, 1000, KF_EASE_IN_OUT}, {0, 1000, KF_LINEAR}};
+	KeyframePlayer keyframes(silentOutput, 10);
+	keyframes.play(fade, 2, 0x7FFF);
+	hostBenchRun("KeyframePlayer::processStep", [&keyframes]() {
+		keyframes.processStep();
+	}, 1000000);
+
+	byte segmentPins[8] = {2, 3, 4, 5, 6, 7, 8, 9};
+	byte digitPins[4] = {10, 11, 12, 13};
+	SevenSegmentsIndicator indicator(segmentPins, 4, digitPins);
+	hostBenchRun("SevenSegmentsIndicator::print", [&indicator]() {
+		indicator.print("12.34");
+	}, 200000);
+	hostBenchRun("SevenSegmentsIndicator::refreshNext", [&indicator]() {
+		indicator.refreshNext();
+	}, 1000000);
+
+	mcu.setAdcVoltage(A0, 2.5);
+	Voltmeter voltmeter(A0);
+	hostBenchRun("Voltmeter::processMeasurement", [&voltmeter]() {
+		voltmeter.processMeasurement();
+	}, 200000);
+	hostBenchRun("Voltmeter::getMillivolts", [&voltmeter]() {
+		hostBenchSink += voltmeter.getMillivolts();
+	}, 1000000);
+	hostBenchRun("analogRead (emulator cost)", []() {
+		hostBenchSink += analogRead(A0);
+	}, 200000);
+
+	//Запись минуты работы кнопки (нажатие раз в секунду) и кода АЦП раз в 10 мс, затем воспроизведение через HandledButton и Voltmeter
+	static byte traceBuffer[4096];
+	TraceRecorder recorder(traceBuffer, sizeof(traceBuffer), 1000);
+	mcu.setPinInput(2, HIGH);
+	recorder.addPin(2);
+	recorder.start();
+	for (unsigned long tick = 1; tick <= 60000; tick++) {
+		mcu.setPinInput(2, tick % 1000 < 100 ? LOW : HIGH);
+		recorder.processTick();
+		if (tick % 10 == 0) recorder.recordAdc(0, 500 + tick % 5);
+	}
+	std::vector<uint8_t> image(recorder.getDumpSize());
+	recorder.copyTo(image.data(), image.size());
+	std::vector<Trace> traces = decodeTraces(image.data(), image.size());
+	for (int clock = 1; clock >= 0; clock--) {
+		TraceReplayer *replayer = NULL;
+		double tickNanoseconds = hostBenchRun(clock ? "TraceReplayer (1 tick, model clock)" : "TraceReplayer (1 tick, no clock)", [&]() {
+			if (replayer == NULL || !replayer->step()) {
+				delete replayer;
+				replayer = new TraceReplayer(traces[0]);
+				replayer->setClockEnabled(clock);
+				replayer->setTickHandler([&button]() {
+					button.processStep();
+				});
+				replayer->setAdcHandler([&voltmeter](uint8_t channel, uint16_t code) {
+					voltmeter.processSample(code);
+				});
+			}
+		}, 1000000);
+		delete replayer;
+		printf("%-40s %12.0fx real time\n", "", 1e6 / tickNanoseconds);
+	}
+	return 0;
+}
@@ -0,0 +1,192 @@
+// Пропускная способность SerialProtocol на линии 115200 и 1000000 бод (модельное время эмулятора, HostMcu::serialReceive()).
+// Компьютер шлёт поток кадров: текст на индикатор, значения разрядов, мелодия из 8 нот, запрос напряжения (ответ - кадр с милливольтами).
+// Скетч в loop() разбирает принятое, измеряет напряжение и делает свою работу - delayMicroseconds(работа). Если работа дольше, чем заполняется
+// буфер порта (64 байта - 640 мкс на 1 Мбод), байты теряются, кадры с ними отбрасываются по контрольной сумме, остальные принимаются.
+// В конце - стоимость разбора на компьютере: кадр SerialProtocol против строки, собираемой через String += (старый пример PrintSerial).
+// Куча компьютера быстрая, поэтому String здесь не проигрывает по времени: на плате он опасен дроблением 2 КБ ОЗУ, а не скоростью.
+#include "Arduino.h"
+#include "HostMcu.h"
+#include "HostBench.h"
+#include "SerialProtocol.h"
+#include "SevenSegmentsIndicator.h"
+#include "PatternPlayer.h"
+#include "Voltmeter.h"
+#include <stdio.h>
+#include <string>
+
+#define GROUPS_COUNT 500 //По 4 кадра
+
+static byte segmentPins[8] = {2, 3, 4, 5, 6, 7, 8, 14};
+static byte digitPins[4] = {10, 11, 12, 13};
+static SevenSegmentsIndicator *indicator;
+static PatternPlayer *player;
+static SerialProtocol *protocol;
+static unsigned long millivolts;
+static int melodyFrequencies[SPR_MAX_PAYLOAD / 2];
+static int melodyDurations[SPR_MAX_PAYLOAD / 2];
+static unsigned long repliesCount;
+
+static void buzzerTone(int frequency, int duration) {
+	tone(9, frequency, duration);
+}
+
+static void buzzerNoTone() {
+	noTone(9);
+}
+
+static void setDigits(ProtocolFrame &frame) {
+	for (byte i = 0; i < 4; i++) {
+		indicator->setDigitValue(i, frame.getByte(i));
+	}
+}
+
+static void printText(ProtocolFrame &frame) {
+	char text[SPR_MAX_PAYLOAD + 1];
+	frame.copyText(text, sizeof(text));
+	indicator->print(text);
+}
+
+static void playMelody(ProtocolFrame &frame) {
+	byte count = frame.getLength() / 2;
+	player->stop();
+	for (byte i = 0; i < count; i++) {
+		word note = frame.getWord(i * 2);
+		melodyFrequencies[i] = PatternPlayer::noteToFrequency(note >> 8);
+		melodyDurations[i] = (note & 0xFF) * PP_DEFAULT_DURATION_UNIT;
+	}
+	player->play(melodyFrequencies, melodyDurations, count);
+}
+
+static void sendVoltage(ProtocolFrame &frame) {
+	byte reply[4];
+	for (byte i = 0; i < 4; i++) {
+		reply[i] = millivolts >> (8 * i);
+	}
+	protocol->sendReply(frame, reply, sizeof(reply));
+}
+
+static void countReply(ProtocolFrame &frame) {
+	repliesCount++;
+}
+
+static std::string encodeFrame(byte command, const std::string &payload) {
+	std::string frame;
+	frame += (char) SPR_SYNC;
+	frame += (char) command;
+	frame += (char) payload.size();
+	frame += payload;
+	byte crc = 0;
+	for (size_t i = 1; i < frame.size(); i++) {
+		crc = SerialProtocol::crc8(crc, frame[i]);
+	}
+	frame += (char) crc;
+	return frame;
+}
+
+static std::string encodeGroup() {
+	std::string melody;
+	for (byte i = 0; i < 8; i++) {
+		uint16_t note = PP_NOTE(60 + i, 10);
+		melody += (char) (note & 0xFF);
+		melody += (char) (note >> 8);
+	}
+	return encodeFrame(SPR_CMD_TEXT, "12.34") + encodeFrame(SPR_CMD_DIGITS, "\xFC\x60\xDA\xF2") + encodeFrame(SPR_CMD_MELODY, melody)
+		+ encodeFrame(SPR_CMD_VOLTAGE, "");
+}
+
+static void addHandlers(SerialProtocol &link) {
+	link.addCommand(SPR_CMD_DIGITS, setDigits);
+	link.addCommand(SPR_CMD_TEXT, printText);
+	link.addCommand(SPR_CMD_MELODY, playMelody);
+	link.addCommand(SPR_CMD_VOLTAGE, sendVoltage);
+}
+
+static void runLine(unsigned long baud, unsigned int loopWorkMicros) {
+	HostMcu &mcu = HostMcu::current();
+	mcu.reset();
+	mcu.setAdcVoltage(0, 3.3);
+	SevenSegmentsIndicator display(segmentPins, 4, digitPins);
+	PatternPlayer buzzer(buzzerTone, buzzerNoTone, 10);
+	Voltmeter battery(A0);
+	SerialProtocol link(Serial);
+	indicator = &display;
+	player = &buzzer;
+	protocol = &link;
+	addHandlers(link);
+	Serial.begin(baud);
+	std::string group = encodeGroup();
+	std::string stream;
+	for (int i = 0; i < GROUPS_COUNT; i++) {
+		stream += group;
+	}
+	mcu.serialReceive((const uint8_t *) stream.data(), stream.size());
+	uint64_t lineEnd = mcu.getCycles() + stream.size() * 10ULL * F_CPU / baud;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	while (mcu.getCycles() < lineEnd || Serial.available() > 0) {
+		link.processInput();
+		battery.processMeasurement();
+		millivolts = battery.getMillivolts();
+		delayMicroseconds(loopWorkMicros);
+	}
+	Serial.flush();
+	double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	double modelSeconds = (double) mcu.getCycles() / F_CPU;
+
+	SerialProtocol decoder(Serial);
+	decoder.addCommand(SPR_CMD_VOLTAGE | SPR_REPLY_FLAG, countReply);
+	repliesCount = 0;
+	std::string output = mcu.takeSerialOutput();
+	for (size_t i = 0; i < output.size(); i++) {
+		decoder.feed(output[i]);
+	}
+	printf("%7lu baud, loop %4u us: %5lu/%d frames %8.0f frames/s %7.0f B/s (line %5.1f%%)  lost %5lu B  crc errors %4lu  replies %4lu  %6.0fx real time\n",
+		baud, loopWorkMicros, link.getFramesCount(), GROUPS_COUNT * 4, link.getFramesCount() / modelSeconds, link.getBytesCount() / modelSeconds,
+		100. * link.getBytesCount() * 10 / baud / modelSeconds, mcu.getSerialLostBytes(), link.getChecksumErrorsCount(), repliesCount,
+		modelSeconds / wallSeconds);
+}
+
+int main() {
+	unsigned long bauds[2] = {115200, 1000000};
+	unsigned int loopWork[3] = {50, 500, 2000};
+	for (int i = 0; i < 2; i++) {
+		for (int j = 0; j < 3; j++) {
+			runLine(bauds[i], loopWork[j]);
+		}
+	}
+
+	HostMcu::current().reset();
+	SevenSegmentsIndicator display(segmentPins, 4, digitPins);
+	PatternPlayer buzzer(buzzerTone, buzzerNoTone, 10);
+	SerialProtocol link(Serial);
+	indicator = &display;
+	player = &buzzer;
+	protocol = &link;
+	addHandlers(link);
+	std::string frame = encodeFrame(SPR_CMD_TEXT, "12.34");
+	std::string line = "12.34\n";
+	hostBenchRun("SerialProtocol text frame", [&]() {
+		for (size_t i = 0; i < frame.size(); i++) {
+			link.feed(frame[i]);
+		}
+	}, 1000000);
+	String buf = "";
+	hostBenchRun("String += line (PrintSerial)", [&]() {
+		for (size_t i = 0; i < line.size(); i++) {
+			char a = line[i];
+			if (a == '\n') {
+				display.print(buf, false);
+				buf = "";
+			} else {
+				buf += a;
+			}
+		}
+	}, 1000000);
+	std::string group = encodeGroup();
+	hostBenchRun("SerialProtocol group of 4 frames", [&]() {
+		for (size_t i = 0; i < group.size(); i++) {
+			link.feed(group[i]);
+		}
+	}, 200000);
+	HostMcu::current().takeSerialOutput();
+	return 0;
+}
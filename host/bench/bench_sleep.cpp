@@ -0,0 +1,133 @@
+// Доля активного времени устройства на батарейках с SleepManager и без глубокого сна. Время модельное, поэтому результат повторяется точно.
+// Скетч: событие раз в секунду, кнопка на ноге 2 (нажимается раз в 10 секунд), короткий сигнал на каждое нажатие. Проход loop() стоит LOOP_WORK_US.
+#include "Arduino.h"
+#include "HostMcu.h"
+#include "SleepManager.h"
+#include "TickDispatcher.h"
+#include "HandledEventTimer.h"
+#include "HandledButton.h"
+#include "PatternPlayer.h"
+#include <stdio.h>
+
+#define LOOP_WORK_US 200
+#define RUN_SECONDS 60
+
+static TickDispatcher *ticker;
+static SleepManager *sleeper;
+static HandledEventTimer *events;
+static HandledButton *button;
+static PatternPlayer *player;
+
+ISR(TIMER2_COMPA_vect) {
+	ticker->processTick();
+}
+
+ISR(WDT_vect) {
+	sleeper->processWatchdog();
+}
+
+EMPTY_INTERRUPT(PCINT2_vect);
+
+static void buzzerTone(int frequency, int duration) {
+	tone(8, frequency, duration);
+}
+
+static void buzzerNoTone() {
+	noTone(8);
+}
+
+static void emptyHandler() {}
+
+static int beepFrequencies[] = {2000, 0};
+static int beepDurations[] = {50, 50};
+
+static void beep() {
+	player->play(beepFrequencies, beepDurations, 2, 1);
+}
+
+static void eventsTask() {
+	events->processStep();
+}
+
+static void buttonTask() {
+	button->processStep();
+}
+
+static void playerTask() {
+	player->processStep();
+}
+
+static unsigned long eventsDeadline() {
+	return events->getTimeToNextEvent();
+}
+
+static void eventsCatchUp(unsigned long sleptMs) {
+	events->processMcsStep(sleptMs);
+}
+
+static unsigned long buttonDeadline() {
+	return button->isSettling() || button->isPressed() ? 0 : SM_NO_DEADLINE;
+}
+
+static unsigned long playerDeadline() {
+	return player->getTimeToNextStep();
+}
+
+static void playerCatchUp(unsigned long sleptMs) {
+	player->processStepMs(sleptMs);
+}
+
+static void run(const char *name, boolean deepSleepAllowed) {
+	HostMcu &mcu = HostMcu::current();
+	mcu.reset();
+	TickDispatcher tickerInstance(1000);
+	SleepManager sleeperInstance;
+	HandledEventTimer eventsInstance(1);
+	HandledButton buttonInstance(2, 1);
+	PatternPlayer playerInstance(buzzerTone, buzzerNoTone, 10);
+	ticker = &tickerInstance;
+	sleeper = &sleeperInstance;
+	events = &eventsInstance;
+	button = &buttonInstance;
+	player = &playerInstance;
+	events->createRepeatedEvent(1000, emptyHandler, 0);
+	events->start();
+	button->attachHandlerToPushDown(beep);
+	ticker->addTask(eventsTask);
+	ticker->addTask(buttonTask);
+	ticker->addTask(playerTask, 10);
+	sleeper->addComponent(eventsDeadline, eventsCatchUp);
+	sleeper->addComponent(buttonDeadline);
+	sleeper->addComponent(playerDeadline, playerCatchUp);
+	sleeper->addWakePin(2);
+	sleeper->setDeepSleepAllowed(deepSleepAllowed);
+	for (unsigned long second = 5; second < RUN_SECONDS; second += 10) {
+		mcu.scheduleAction(second * F_CPU, [&mcu]() {
+			mcu.setPinInput(2, LOW);
+		});
+		mcu.scheduleAction(second * F_CPU + F_CPU / 5, [&mcu]() {
+			mcu.releasePin(2);
+		});
+	}
+	ticker->begin();
+	unsigned long passes = 0;
+	while (mcu.getMillis() < RUN_SECONDS * 1000UL) {
+		events->processHandlers();
+		button->processHandlers();
+		delayMicroseconds(LOOP_WORK_US);
+		sleeper->sleep();
+		passes++;
+	}
+	ticker->stop();
+	double total = (double) mcu.getCycles();
+	double idle = mcu.getSleepCycles(SLEEP_MODE_IDLE) / total;
+	double powerDown = mcu.getSleepCycles(SLEEP_MODE_PWR_DOWN) / total;
+	printf("%-24s active %6.2f%%  idle %6.2f%%  power-down %6.2f%%  wakeups %8lu (%lu deep)\n", name,
+		100 * (1 - idle - powerDown), 100 * idle, 100 * powerDown, passes, sleeper->getDeepSleepsCount());
+}
+
+int main() {
+	run("SleepManager, idle only", false);
+	run("SleepManager, deep", true);
+	return 0;
+}
@@ -0,0 +1,111 @@
+// Стоимость задач EventTask на сотнях задач: переключение (возобновление тела), проход processTasks() и тик таймера, когда задачи спят
+// или ждут флага, и память на задачу. Время - по часам компьютера: отношения между строками важнее абсолютных значений.
+#include "HostBench.h"
+#include "HandledEventTimer.h"
+#include "EventTask.h"
+#include <vector>
+
+static volatile boolean neverSet;
+
+static void yielder(EventTask &task) {
+	TASK_BEGIN(task);
+	while (true) {
+		hostBenchSink++;
+		TASK_YIELD(task);
+	}
+	TASK_END(task);
+}
+
+static void longSleeper(EventTask &task) {
+	TASK_BEGIN(task);
+	while (true) {
+		TASK_SLEEP_FOR(task, 0x7FFFFFFFUL);
+	}
+	TASK_END(task);
+}
+
+static void flagWaiter(EventTask &task) {
+	TASK_BEGIN(task);
+	while (true) {
+		TASK_WAIT_FLAG(task, neverSet);
+	}
+	TASK_END(task);
+}
+
+//Каждая задача спит свой интервал: за проход просыпается примерно одна задача из period
+static void staggeredSleeper(EventTask &task) {
+	TASK_BEGIN(task);
+	while (true) {
+		hostBenchSink++;
+		TASK_SLEEP_FOR(task, (unsigned long) (size_t) task.getContext());
+	}
+	TASK_END(task);
+}
+
+static void benchTasks(int count) {
+	char name[80];
+	HandledEventTimer timer(1);
+	TaskScheduler scheduler(timer);
+	std::vector<EventTask> tasks;
+	tasks.reserve(count);
+	for (int i = 0; i < count; i++) {
+		tasks.push_back(EventTask(yielder));
+		scheduler.addTask(tasks.back());
+	}
+	timer.start();
+	snprintf(name, sizeof(name), "processTasks, %d yielding tasks", count);
+	double perTask = hostBenchRun(name, [&]() {
+		scheduler.processTasks();
+	}, 2000000 / count) / count;
+	printf("%-40s %12.1f ns/task\n", "  -> context switch", perTask);
+
+	void (*bodies[2])(EventTask &task) = {longSleeper, flagWaiter};
+	const char *kinds[2] = {"sleeping", "flag-waiting"};
+	for (int kind = 0; kind < 2; kind++) {
+		HandledEventTimer idleTimer(1);
+		TaskScheduler idleScheduler(idleTimer);
+		std::vector<EventTask> idle;
+		idle.reserve(count);
+		for (int i = 0; i < count; i++) {
+			idle.push_back(EventTask(bodies[kind]));
+			idleScheduler.addTask(idle.back());
+		}
+		idleTimer.start();
+		idleScheduler.processTasks();
+		snprintf(name, sizeof(name), "processStep, %d %s tasks", count, kinds[kind]);
+		double tick = hostBenchRun(name, [&]() {
+			idleTimer.processStep();
+		}, 20000000 / count);
+		snprintf(name, sizeof(name), "processTasks, %d %s tasks", count, kinds[kind]);
+		double pass = hostBenchRun(name, [&]() {
+			idleScheduler.processTasks();
+		}, 20000000 / count);
+		printf("%-40s %12.2f ns/task per tick, %.2f ns/task per pass\n", "  -> idle cost", tick / count, pass / count);
+	}
+
+	HandledEventTimer mixedTimer(1);
+	TaskScheduler mixedScheduler(mixedTimer);
+	std::vector<EventTask> mixed;
+	mixed.reserve(count);
+	for (int i = 0; i < count; i++) {
+		mixed.push_back(EventTask(staggeredSleeper, (void *) (size_t) (count + i % 97)));
+		mixedScheduler.addTask(mixed.back());
+	}
+	mixedTimer.start();
+	snprintf(name, sizeof(name), "tick + tasks, %d tasks, ~1 wake per tick", count);
+	hostBenchRun(name, [&]() {
+		mixedTimer.processStep();
+		mixedScheduler.processTasks();
+	}, 20000000 / count);
+}
+
+int main() {
+	HostMcu::current().reset();
+	int counts[] = {100, 300, 1000};
+	for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+		benchTasks(counts[i]);
+	}
+	printf("RAM per task on this host: EventTask %u + HandledEvent %u bytes (on AVR: 13 + 17)\n", (unsigned int) sizeof(EventTask),
+		(unsigned int) sizeof(HandledEvent));
+	return 0;
+}
@@ -0,0 +1,203 @@
+/**
+	HostFleet_h - моделирование множества независимых устройств в одном процессе на всех ядрах компьютера.
+	Устройство - класс, унаследованный от HostDevice. У каждого устройства свой эмулятор контроллера (HostMcu): модельное время, регистры,
+	ноги, источники сигнала АЦП и очередь действий scheduleAction(). Конструктор HostDevice выбирает этот эмулятор в текущем потоке
+	(HostMcu::select()), поэтому библиотеки - члены производного класса - создаются уже на нём:
+		class Panel : public HostDevice {
+			public:
+				Panel() : HostDevice(1000), button(2, 1) {getMcu().setAdcVoltage(0, 3.7);}
+				void tick() {button.processStep(); ...}
+			private:
+				HandledButton button;
+		};
+	Метод tick() вызывается после каждого сдвига модельного времени устройства на tickMicros, с выбранным эмулятором устройства, - как задачи
+	по прерыванию таймера на плате. runFor(такты) прогоняет устройство в текущем потоке.
+	Устройства не должны делить состояние: обработчики-функции без контекста (attachHandler..., обработчики HandledEventTimer, функции звука
+	PatternPlayer) общие для всех экземпляров, поэтому внутри устройств используются опрос (isClicked(), getEventState()), задачи EventTask
+	с контекстом и выход Timer1 проигрывателя (PatternPlayer(PP_TIMER1_PIN_A, ...)). Обработчики прерываний (ISR) тоже общие - их не объявляйте.
+	Общее и у Voltmeter: запомненный источник опорного напряжения и счётчики переключений (processMeasurement(), readRaw(), measureAll()).
+	Вольтметр устройства получает коды через processSample(analogRead(...)). Profiler (MYLIB_PROFILE) во флоте не используется.
+	HostFleet(потоки) - планировщик (0 потоков - по числу ядер). addDevice() добавляет устройство (флот им не владеет и после добавления
+	возвращает поток к общему эмулятору), run(секунды, квант) прогоняет каждое устройство на заданное модельное время:
+		* Работа режется на кванты модельного времени (по умолчанию 0.05 с). У каждого потока своя очередь устройств, устройства раздаются
+			по очереди. Поток берёт устройство с конца своей очереди и после кванта кладёт его обратно туда же - одно устройство идёт подряд,
+			пока его данные в кэше. Поток с пустой очередью крадёт устройство с начала очереди другого потока (getSteals() - сколько раз).
+		* Устройство в каждый момент выполняет один поток, а эмулятор выбирается на время кванта, поэтому результат каждого устройства
+			не зависит от числа потоков и совпадает с runFor() того же устройства в одном потоке.
+	После run(): getSimulatedSeconds() - сумма модельного времени всех устройств, getWallSeconds() - время по часам компьютера,
+	getSpeed() - модельных секунд в секунду (во сколько раз быстрее реального времени работает весь флот), getSlices() - выполнено квантов.
+	Пример - host/fleet/fleet_sim.cpp: тысяча панелей (кнопка, таймер с задачами, вольтметр, пищалка, индикатор) и таблица масштабирования по ядрам.
+*/
+
+#include "HostFleet.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+struct HostFleetTask {
+	HostDevice *device;
+	uint64_t endCycle; //До какого такта прогнать устройство
+};
+
+struct HostFleetWorker {
+	std::mutex lock;
+	std::deque<HostFleetTask> queue;
+	std::atomic<size_t> *remaining; //Устройств, ещё не дошедших до конца, - на весь флот
+	unsigned long steals;
+	unsigned long slices;
+};
+
+HostDevice::HostDevice(unsigned long tickMicros) {
+	dev_tickMicros = tickMicros != 0 ? tickMicros : 1;
+	dev_mcu.select(); //Члены производного класса создаются после этого - на эмуляторе устройства
+}
+
+HostDevice::~HostDevice() {
+	if (&HostMcu::current() == &dev_mcu) HostMcu::selectDefault();
+}
+
+HostMcu &HostDevice::getMcu() {
+	return dev_mcu;
+}
+
+unsigned long HostDevice::getTickMicros() {
+	return dev_tickMicros;
+}
+
+void HostDevice::runFor(uint64_t cycles) {
+	HostMcu &previous = HostMcu::current();
+	dev_runUntil(dev_mcu.getCycles() + cycles);
+	previous.select();
+}
+
+void HostDevice::dev_runUntil(uint64_t cycle) {
+	dev_mcu.select();
+	while (dev_mcu.getCycles() < cycle) {
+		dev_mcu.advanceMicros(dev_tickMicros);
+		tick();
+	}
+}
+
+HostFleet::HostFleet(unsigned int threadsCount) {
+	if (threadsCount == 0) threadsCount = std::thread::hardware_concurrency();
+	dev_threadsCount = threadsCount != 0 ? threadsCount : 1;
+	dev_simulatedSeconds = 0;
+	dev_wallSeconds = 0;
+	dev_steals = 0;
+	dev_slices = 0;
+}
+
+void HostFleet::addDevice(HostDevice *device) {
+	dev_devices.push_back(device);
+	HostMcu::selectDefault(); //Конструктор устройства выбрал его эмулятор в этом потоке
+}
+
+size_t HostFleet::getDevicesCount() {
+	return dev_devices.size();
+}
+
+unsigned int HostFleet::getThreadsCount() {
+	return dev_threadsCount;
+}
+
+void HostFleet::run(double seconds, double sliceSeconds) {
+	uint64_t cycles = (uint64_t) (seconds * F_CPU);
+	uint64_t sliceCycles = (uint64_t) (sliceSeconds * F_CPU);
+	if (sliceCycles == 0) sliceCycles = 1;
+	std::vector<HostFleetWorker> workers(dev_threadsCount);
+	std::atomic<size_t> remaining(dev_devices.size());
+	uint64_t startCycles = 0;
+	for (unsigned int i = 0; i < dev_threadsCount; i++) {
+		workers[i].remaining = &remaining;
+		workers[i].steals = 0;
+		workers[i].slices = 0;
+	}
+	for (size_t i = 0; i < dev_devices.size(); i++) {
+		HostFleetTask task = {dev_devices[i], dev_devices[i]->getMcu().getCycles() + cycles};
+		startCycles += dev_devices[i]->getMcu().getCycles();
+		workers[i % dev_threadsCount].queue.push_back(task);
+	}
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for (unsigned int i = 1; i < dev_threadsCount; i++) {
+		threads.push_back(std::thread(&HostFleet::dev_work, this, std::ref(workers), i, sliceCycles));
+	}
+	dev_work(workers, 0, sliceCycles);
+	for (size_t i = 0; i < threads.size(); i++) {
+		threads[i].join();
+	}
+	dev_wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	uint64_t endCycles = 0;
+	for (size_t i = 0; i < dev_devices.size(); i++) {
+		endCycles += dev_devices[i]->getMcu().getCycles();
+	}
+	dev_simulatedSeconds = (double) (endCycles - startCycles) / F_CPU;
+	dev_steals = 0;
+	dev_slices = 0;
+	for (unsigned int i = 0; i < dev_threadsCount; i++) {
+		dev_steals += workers[i].steals;
+		dev_slices += workers[i].slices;
+	}
+	HostMcu::selectDefault();
+}
+
+void HostFleet::dev_work(std::vector<HostFleetWorker> &workers, unsigned int index, uint64_t sliceCycles) {
+	HostFleetWorker &own = workers[index];
+	while (own.remaining->load() > 0) {
+		HostFleetTask task;
+		bool found = false;
+		{
+			std::lock_guard<std::mutex> guard(own.lock);
+			if (!own.queue.empty()) {
+				task = own.queue.back();
+				own.queue.pop_back();
+				found = true;
+			}
+		}
+		for (unsigned int offset = 1; !found && offset < workers.size(); offset++) { //Кража - с начала чужой очереди
+			HostFleetWorker &victim = workers[(index + offset) % workers.size()];
+			std::lock_guard<std::mutex> guard(victim.lock);
+			if (!victim.queue.empty()) {
+				task = victim.queue.front();
+				victim.queue.pop_front();
+				found = true;
+				own.steals++;
+			}
+		}
+		if (!found) { //Все оставшиеся устройства сейчас выполняются другими потоками
+			std::this_thread::yield();
+			continue;
+		}
+		uint64_t now = task.device->getMcu().getCycles();
+		task.device->dev_runUntil(now + sliceCycles < task.endCycle ? now + sliceCycles : task.endCycle);
+		own.slices++;
+		if (task.device->getMcu().getCycles() >= task.endCycle) {
+			own.remaining->fetch_sub(1);
+		} else {
+			std::lock_guard<std::mutex> guard(own.lock);
+			own.queue.push_back(task);
+		}
+	}
+}
+
+double HostFleet::getSimulatedSeconds() {
+	return dev_simulatedSeconds;
+}
+
+double HostFleet::getWallSeconds() {
+	return dev_wallSeconds;
+}
+
+double HostFleet::getSpeed() {
+	return dev_wallSeconds > 0 ? dev_simulatedSeconds / dev_wallSeconds : 0;
+}
+
+unsigned long HostFleet::getSteals() {
+	return dev_steals;
+}
+
+unsigned long HostFleet::getSlices() {
+	return dev_slices;
+}
@@ -0,0 +1,80 @@
+/**
+	HostFleet_h - моделирование множества независимых устройств в одном процессе на всех ядрах компьютера.
+	Устройство - класс, унаследованный от HostDevice. У каждого устройства свой эмулятор контроллера (HostMcu): модельное время, регистры,
+	ноги, источники сигнала АЦП и очередь действий scheduleAction(). Конструктор HostDevice выбирает этот эмулятор в текущем потоке
+	(HostMcu::select()), поэтому библиотеки - члены производного класса - создаются уже на нём:
+		class Panel : public HostDevice {
+			public:
+				Panel() : HostDevice(1000), button(2, 1) {getMcu().setAdcVoltage(0, 3.7);}
+				void tick() {button.processStep(); ...}
+			private:
+				HandledButton button;
+		};
+	Метод tick() вызывается после каждого сдвига модельного времени устройства на tickMicros, с выбранным эмулятором устройства, - как задачи
+	по прерыванию таймера на плате. runFor(такты) прогоняет устройство в текущем потоке.
+	Устройства не должны делить состояние: обработчики-функции без контекста (attachHandler..., обработчики HandledEventTimer, функции звука
+	PatternPlayer) общие для всех экземпляров, поэтому внутри устройств используются опрос (isClicked(), getEventState()), задачи EventTask
+	с контекстом и выход Timer1 проигрывателя (PatternPlayer(PP_TIMER1_PIN_A, ...)). Обработчики прерываний (ISR) тоже общие - их не объявляйте.
+	Общее и у Voltmeter: запомненный источник опорного напряжения и счётчики переключений (processMeasurement(), readRaw(), measureAll()).
+	Вольтметр устройства получает коды через processSample(analogRead(...)). Profiler (MYLIB_PROFILE) во флоте не используется.
+	HostFleet(потоки) - планировщик (0 потоков - по числу ядер). addDevice() добавляет устройство (флот им не владеет и после добавления
+	возвращает поток к общему эмулятору), run(секунды, квант) прогоняет каждое устройство на заданное модельное время:
+		* Работа режется на кванты модельного времени (по умолчанию 0.05 с). У каждого потока своя очередь устройств, устройства раздаются
+			по очереди. Поток берёт устройство с конца своей очереди и после кванта кладёт его обратно туда же - одно устройство идёт подряд,
+			пока его данные в кэше. Поток с пустой очередью крадёт устройство с начала очереди другого потока (getSteals() - сколько раз).
+		* Устройство в каждый момент выполняет один поток, а эмулятор выбирается на время кванта, поэтому результат каждого устройства
+			не зависит от числа потоков и совпадает с runFor() того же устройства в одном потоке.
+	После run(): getSimulatedSeconds() - сумма модельного времени всех устройств, getWallSeconds() - время по часам компьютера,
+	getSpeed() - модельных секунд в секунду (во сколько раз быстрее реального времени работает весь флот), getSlices() - выполнено квантов.
+	Пример - host/fleet/fleet_sim.cpp: тысяча панелей (кнопка, таймер с задачами, вольтметр, пищалка, индикатор) и таблица масштабирования по ядрам.
+*/
+
+#ifndef HostFleet_h
+#define HostFleet_h
+
+#include "Arduino.h"
+#include "HostMcu.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+class HostDevice {
+	public:
+		HostDevice(unsigned long tickMicros = 1000);
+		virtual ~HostDevice();
+		HostMcu &getMcu();
+		unsigned long getTickMicros();
+		void runFor(uint64_t cycles);
+		virtual void tick() = 0;
+	private:
+		HostMcu dev_mcu;
+		unsigned long dev_tickMicros;
+		void dev_runUntil(uint64_t cycle);
+		friend class HostFleet;
+};
+
+struct HostFleetWorker;
+
+class HostFleet {
+	public:
+		HostFleet(unsigned int threadsCount = 0);
+		void addDevice(HostDevice *device);
+		size_t getDevicesCount();
+		unsigned int getThreadsCount();
+		void run(double seconds, double sliceSeconds = 0.05);
+		double getSimulatedSeconds();
+		double getWallSeconds();
+		double getSpeed();
+		unsigned long getSteals();
+		unsigned long getSlices();
+	private:
+		std::vector<HostDevice *> dev_devices;
+		unsigned int dev_threadsCount;
+		double dev_simulatedSeconds;
+		double dev_wallSeconds;
+		unsigned long dev_steals;
+		unsigned long dev_slices;
+		void dev_work(std::vector<HostFleetWorker> &workers, unsigned int index, uint64_t sliceCycles);
+};
+
+#endif
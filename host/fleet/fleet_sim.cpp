@@ -0,0 +1,225 @@
+/**
+	fleet_sim - прогон флота виртуальных панелей (HostFleet) на всех ядрах компьютера и таблица масштабирования по числу потоков.
+	Использование:
+		fleet_sim [-d устройств] [-s секунд] [-t потоков]
+	По умолчанию 1000 панелей по 10 модельных секунд, потоки - 1, 2, 4 ... до числа ядер (-t задаёт наибольшее число потоков).
+	Панель - типичное устройство на библиотеках репозитория, тик 1 мс:
+		* кнопка на ноге 2 (HandledButton), нажатия подаёт очередь действий эмулятора с псевдослучайными паузами, своими у каждой панели;
+		* таймер событий с двумя задачами EventTask: раз в 250 мс выводит напряжение аккумулятора на индикатор, по клику играет мелодию;
+		* вольтметр на A0 (StaticVoltmeter), аккумулятор разряжается со своей скоростью и с пульсацией, коды раз в 10 мс через processSample();
+		* пищалка - Timer1 на ноге 9 (PatternPlayer(PP_TIMER1_PIN_A, 1)), мелодия из флеш-памяти;
+		* четырёхразрядный индикатор (StaticSevenSegmentsIndicator), разряд обновляется каждый тик.
+	Для каждого числа потоков панели создаются заново и печатается: модельных секунд в секунду, ускорение и эффективность относительно
+	одного потока, количество краж. Итог каждой панели (клики, мелодии, напряжение, свёртка состояния ног) сравнивается с прогоном в одном
+	потоке - при расхождении утилита завершается с кодом 1. Линейный рост скорости виден, пока потоков не больше физических ядер.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <math.h>
+#include <thread>
+#include <vector>
+#include "HostFleet.h"
+#include "HandledButton.h"
+#include "HandledEventTimer.h"
+#include "EventTask.h"
+#include "PatternPlayer.h"
+#include "SevenSegmentsIndicator.h"
+#include "Voltmeter.h"
+
+#define PANEL_BUTTON_PIN 2
+#define PANEL_DIGITS 4
+#define PANEL_MAX_MILLIVOLTS 99999UL //На 4 разрядах помещается 99.99
+#define PANEL_ADC_PERIOD 10 //Тиков между кодами АЦП
+#define PANEL_DIGEST_PERIOD 100 //Тиков между добавлениями состояния в свёртку
+
+static byte segmentPins[8] = {3, 4, 5, 6, 7, 8, 10, 11};
+static byte digitPins[PANEL_DIGITS] = {12, 13, 15, 16};
+
+static const uint16_t chime[] PROGMEM = {
+	PP_NOTE(76, 8), PP_NOTE(72, 8), PP_NOTE(74, 8), PP_NOTE(67, 16), PP_REST(8), PP_NOTE(67, 8), PP_NOTE(74, 8), PP_NOTE(76, 8), PP_NOTE(72, 16)
+};
+
+struct PanelResult {
+	unsigned long clicks;
+	unsigned long melodies;
+	unsigned long millivolts;
+	uint32_t digest;
+	bool operator==(const PanelResult &other) const {
+		return clicks == other.clicks && melodies == other.melodies && millivolts == other.millivolts && digest == other.digest;
+	}
+};
+
+class Panel : public HostDevice {
+	public:
+		Panel(unsigned int index) : HostDevice(1000), button(PANEL_BUTTON_PIN, 1), timer(1), scheduler(timer), battery(A0),
+			player(PP_TIMER1_PIN_A, 1), display(segmentPins, digitPins), showTask(showVoltage, this), tuneTask(playOnClick, this) {
+			seed = 2166136261UL ^ (index * 16777619UL);
+			ticks = 0;
+			result.clicks = 0;
+			result.melodies = 0;
+			result.millivolts = 0;
+			result.digest = 2166136261UL;
+			float drain = 0.01f + 0.002f * (index % 16); //Вольт в секунду
+			float phase = index * 0.7f;
+			getMcu().setPinInput(PANEL_BUTTON_PIN, HIGH);
+			getMcu().setAdcWaveform(0, [drain, phase](double seconds) {
+				return (float) (4.2 - drain * seconds + 0.03 * sin(phase + seconds * 314.159));
+			});
+			scheduler.addTask(showTask);
+			scheduler.addTask(tuneTask);
+			timer.start();
+			schedulePress();
+		}
+		void tick() {
+			ticks++;
+			button.processStep();
+			timer.processStep();
+			if (ticks % PANEL_ADC_PERIOD == 0) battery.processSample(analogRead(A0));
+			scheduler.processTasks();
+			player.processStep();
+			display.refreshNext();
+			if (ticks % PANEL_DIGEST_PERIOD == 0) {
+				mix(PORTB);
+				mix(PORTD);
+				mix(OCR1A);
+			}
+		}
+		PanelResult getResult() {
+			return result;
+		}
+	private:
+		HandledButton button;
+		StaticHandledEventTimer<2> timer;
+		TaskScheduler scheduler;
+		StaticVoltmeter<8> battery;
+		PatternPlayer player;
+		StaticSevenSegmentsIndicator<PANEL_DIGITS> display;
+		EventTask showTask;
+		EventTask tuneTask;
+		uint32_t seed;
+		unsigned long ticks;
+		PanelResult result;
+		uint32_t random(uint32_t range) {
+			seed = seed * 1664525UL + 1013904223UL;
+			return (seed >> 8) % range;
+		}
+		void mix(uint32_t value) {
+			result.digest = (result.digest ^ value) * 16777619UL;
+		}
+		//Нажатие на 40..140 мс через 0.5..3.5 с после прошлого
+		void schedulePress() {
+			uint64_t pressAt = getMcu().getCycles() + (uint64_t) (500 + random(3000)) * (F_CPU / 1000);
+			uint64_t releaseAt = pressAt + (uint64_t) (40 + random(100)) * (F_CPU / 1000);
+			getMcu().scheduleAction(pressAt, [this]() {getMcu().setPinInput(PANEL_BUTTON_PIN, LOW);});
+			getMcu().scheduleAction(releaseAt, [this]() {
+				getMcu().setPinInput(PANEL_BUTTON_PIN, HIGH);
+				schedulePress();
+			});
+		}
+		static void showVoltage(EventTask &task) {
+			Panel *panel = (Panel *) task.getContext();
+			TASK_BEGIN(task);
+			while (true) {
+				TASK_SLEEP_FOR(task, 250);
+				char text[8];
+				panel->result.millivolts = panel->battery.getMillivolts();
+				unsigned long shown = panel->result.millivolts > PANEL_MAX_MILLIVOLTS ? PANEL_MAX_MILLIVOLTS : panel->result.millivolts;
+				snprintf(text, sizeof(text), "%lu.%02lu", shown / 1000, shown % 1000 / 10);
+				panel->display.print(text);
+				panel->mix(panel->result.millivolts);
+			}
+			TASK_END(task);
+		}
+		static void playOnClick(EventTask &task) {
+			Panel *panel = (Panel *) task.getContext();
+			TASK_BEGIN(task);
+			while (true) {
+				TASK_WAIT_BUTTON(task, panel->button);
+				panel->result.clicks++;
+				if (panel->player.getState() != PLAYING) {
+					panel->player.playProgmem(chime, sizeof(chime) / sizeof(chime[0]));
+					panel->result.melodies++;
+				}
+			}
+			TASK_END(task);
+		}
+};
+
+static void printUsage() {
+	fprintf(stderr, "usage: fleet_sim [-d devices] [-s seconds] [-t threads]\n");
+}
+
+static bool runFleet(unsigned int devicesCount, double seconds, std::vector<PanelResult> &results, HostFleet &fleet) {
+	std::vector<Panel *> panels;
+	for (unsigned int i = 0; i < devicesCount; i++) {
+		panels.push_back(new Panel(i));
+		fleet.addDevice(panels.back());
+	}
+	fleet.run(seconds);
+	bool same = true;
+	for (unsigned int i = 0; i < devicesCount; i++) {
+		if (results.size() < devicesCount) {
+			results.push_back(panels[i]->getResult());
+		} else if (!(results[i] == panels[i]->getResult())) {
+			same = false;
+		}
+		delete panels[i];
+	}
+	return same;
+}
+
+int main(int argc, char **argv) {
+	unsigned int devicesCount = 1000;
+	double seconds = 10;
+	unsigned int maxThreads = std::thread::hardware_concurrency();
+	for (int i = 1; i < argc; i++) {
+		char *end;
+		if (i + 1 < argc && !strcmp(argv[i], "-d")) {
+			devicesCount = strtoul(argv[++i], &end, 10);
+		} else if (i + 1 < argc && !strcmp(argv[i], "-s")) {
+			seconds = strtod(argv[++i], &end);
+		} else if (i + 1 < argc && !strcmp(argv[i], "-t")) {
+			maxThreads = strtoul(argv[++i], &end, 10);
+		} else {
+			printUsage();
+			return 2;
+		}
+		if (*end != 0) {
+			printUsage();
+			return 2;
+		}
+	}
+	if (maxThreads == 0) maxThreads = 1;
+	if (devicesCount == 0 || seconds <= 0) {
+		printUsage();
+		return 2;
+	}
+	std::vector<unsigned int> threadCounts;
+	for (unsigned int threads = 1; threads < maxThreads; threads *= 2) {
+		threadCounts.push_back(threads);
+	}
+	threadCounts.push_back(maxThreads);
+
+	printf("%u panels x %.1f s, %u hardware threads\n", devicesCount, seconds, std::thread::hardware_concurrency());
+	printf("%8s %12s %14s %10s %11s %8s\n", "threads", "wall s", "sim s / s", "speedup", "efficiency", "steals");
+	std::vector<PanelResult> results;
+	double baseSpeed = 0;
+	bool same = true;
+	for (size_t i = 0; i < threadCounts.size(); i++) {
+		HostFleet fleet(threadCounts[i]);
+		same = runFleet(devicesCount, seconds, results, fleet) && same;
+		if (i == 0) baseSpeed = fleet.getSpeed();
+		double speedup = baseSpeed > 0 ? fleet.getSpeed() / baseSpeed : 0;
+		printf("%8u %12.3f %14.0f %9.2fx %10.0f%% %8lu\n", threadCounts[i], fleet.getWallSeconds(), fleet.getSpeed(), speedup,
+			100 * speedup / threadCounts[i], fleet.getSteals());
+	}
+	unsigned long clicks = 0, melodies = 0;
+	for (size_t i = 0; i < results.size(); i++) {
+		clicks += results[i].clicks;
+		melodies += results[i].melodies;
+	}
+	printf("%lu clicks, %lu melodies, results %s\n", clicks, melodies, same ? "identical for every thread count" : "DIFFER between thread counts");
+	return same ? 0 : 1;
+}
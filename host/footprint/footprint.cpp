@@ -0,0 +1,198 @@
+/**
+	footprint - отчёт о расходе памяти библиотеками MYLIB_* в обычном режиме и в режиме без кучи (MYLIB_STATIC). Запускается на компьютере.
+
+	Режим MYLIB_STATIC. Библиотеки, собранные с этим флагом, не вызывают malloc(), realloc(), free() и new и не используют String:
+	всю память задаёт скетч, поэтому расход оперативной памяти виден при компиляции и куча не дробится за время работы.
+	Конструкторы и методы, которые выделяют память, при этом не компилируются (вызов - ошибка компиляции, а не сбой на плате):
+		* HandledEventTimer(интервал) - вместо него StaticHandledEventTimer<N>(интервал) или HandledEventTimer(интервал, массив HandledEvent, размер).
+			Лишнее событие не добавляется: createEvent() возвращает HET_NO_EVENT_ID.
+		* Voltmeter(пин, ..., выборки) - вместо него StaticVoltmeter<N>(пин, ...) или Voltmeter(пин, массив word, выборки, ...).
+			setFilterSamplesCount() не даёт выборок больше, чем помещается в массив.
+		* SevenSegmentsIndicator(пины сегментов, разряды, пины разрядов, тип) и print(String) - вместо них StaticSevenSegmentsIndicator<N>(...)
+			или конструктор с массивом памяти разрядов, и print(const char*).
+		* PatternPlayer::play(String) и convertInpMelodyToStr() - вместо них play(const char*) и convertInpMelodyToBuffer(). Буфер нот задаётся
+			setMelodyBuffer() или объявлением StaticPatternPlayer<N>, без буфера разбор строки возвращает PP_PARSE_ERR_TOO_LONG.
+		Остальные библиотеки (HandledButton, SerialProtocol, TraceRecorder, TickDispatcher, SleepManager, Profiler) кучей не пользуются и так.
+	Флаг включается для всего скетча: в Arduino IDE - строкой compiler.cpp.extra_flags=-DMYLIB_STATIC в platform.local.txt (как MYLIB_PROFILE),
+	на компьютере библиотеки в этом режиме собираются в архив mylib_static (CMakeLists.txt в корне), тест host/tests/test_StaticMode.cpp
+	проверяет, что ни один их вызов не обращается к куче.
+
+	Отчёт. Утилита собирается дважды: footprint_heap - с обычными библиотеками, footprint_static - с mylib_static. Для каждого класса печатается:
+		* object - sizeof объекта (на компьютере: указатели и int здесь длиннее, чем на AVR, но разница между режимами та же);
+		* heap blocks / heap bytes - сколько раз и сколько байт выделено из кучи при типичной настройке (hostHeap*, см. host/hal/HostHeap.h);
+		* code / data - размер функций и переменных класса в архивах, переданных аргументами (по выводу nm -C -S), если архивы указаны.
+	Запуск обоих вариантов: cmake --build build --target footprint. Размеры для платы даёт avr-size по .elf скетча, собранного Arduino IDE.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include "HostHeap.h"
+#include "HostMcu.h"
+#include "HandledButton.h"
+#include "HandledEventTimer.h"
+#include "PatternPlayer.h"
+#include "SerialProtocol.h"
+#include "SevenSegmentsIndicator.h"
+#include "TraceRecorder.h"
+#include "Voltmeter.h"
+
+#ifdef MYLIB_STATIC
+#define FOOTPRINT_MODE "MYLIB_STATIC"
+#else
+#define FOOTPRINT_MODE "heap"
+#endif
+
+#define FOOTPRINT_EVENTS 4
+#define FOOTPRINT_SAMPLES 8
+#define FOOTPRINT_DIGITS 4
+#define FOOTPRINT_NOTES 8
+
+struct SymbolSizes {
+	unsigned long code;
+	unsigned long data;
+};
+
+static std::map<std::string, SymbolSizes> symbolSizes;
+
+static byte segmentPins[8] = {2, 3, 4, 5, 6, 7, 8, 9};
+static byte digitsPins[FOOTPRINT_DIGITS] = {10, 11, 12, 13};
+static byte traceBuffer[256];
+static const char *melody = "@8#440,10%494,10%523,10%587,10%659,10%698,10%784,10%880,10%!";
+
+static void onEvent() {
+}
+
+static void onTone(int frequency, int duration) {
+}
+
+static void onNoTone() {
+}
+
+static void onFrame(ProtocolFrame &frame) {
+}
+
+//Класс - часть имени до первого "::" (без параметров шаблона), остальное - в "(other)"
+static std::string ownerOf(const char *symbol) {
+	const char *separator = strstr(symbol, "::");
+	const char *bracket = strpbrk(symbol, "(< ");
+	if (separator == NULL || (bracket != NULL && bracket < separator)) return "(other)";
+	return std::string(symbol, separator - symbol);
+}
+
+static void readArchive(const char *path) {
+	std::string command = std::string("nm -C -S --size-sort -t d '") + path + "' 2>/dev/null";
+	FILE *output = popen(command.c_str(), "r");
+	if (output == NULL) return;
+	char line[1024];
+	while (fgets(line, sizeof(line), output) != NULL) {
+		unsigned long address, size;
+		char type;
+		int consumed;
+		if (sscanf(line, "%lu %lu %c %n", &address, &size, &type, &consumed) != 3) continue;
+		line[strcspn(line, "\n")] = 0;
+		SymbolSizes &sizes = symbolSizes[ownerOf(line + consumed)];
+		if (strchr("TtWw", type)) {
+			sizes.code += size;
+		} else {
+			sizes.data += size;
+		}
+	}
+	pclose(output);
+}
+
+static void report(const char *name, size_t objectSize) {
+	unsigned long heapBlocks = hostHeapAllocations(); //До поиска в symbolSizes - он сам выделяет память
+	unsigned long heapBytes = hostHeapBytes();
+	SymbolSizes sizes = symbolSizes[name];
+	printf("%-24s %8u %12lu %12lu %10lu %10lu\n", name, (unsigned int) objectSize, heapBlocks, heapBytes, sizes.code, sizes.data);
+}
+
+static void eventTimer() {
+	hostHeapReset();
+#ifdef MYLIB_STATIC
+	StaticHandledEventTimer<FOOTPRINT_EVENTS> timer(1);
+#else
+	HandledEventTimer timer(1);
+#endif
+	for (int i = 0; i < FOOTPRINT_EVENTS; i++) {
+		timer.createEvent(10 * (i + 1), onEvent);
+	}
+	report("HandledEventTimer", sizeof(timer));
+}
+
+static void voltmeter() {
+	hostHeapReset();
+#ifdef MYLIB_STATIC
+	StaticVoltmeter<FOOTPRINT_SAMPLES> battery(A0);
+#else
+	Voltmeter battery(A0, 5., 0, 1, FOOTPRINT_SAMPLES);
+#endif
+	battery.processMeasurement();
+	report("Voltmeter", sizeof(battery));
+}
+
+static void indicator() {
+	hostHeapReset();
+#ifdef MYLIB_STATIC
+	StaticSevenSegmentsIndicator<FOOTPRINT_DIGITS> display(segmentPins, digitsPins);
+#else
+	SevenSegmentsIndicator display(segmentPins, FOOTPRINT_DIGITS, digitsPins);
+#endif
+	display.print("12.34");
+	display.refreshNext();
+	report("SevenSegmentsIndicator", sizeof(display));
+}
+
+static void player() {
+	hostHeapReset();
+#ifdef MYLIB_STATIC
+	StaticPatternPlayer<FOOTPRINT_NOTES> buzzer(onTone, onNoTone, 1);
+#else
+	PatternPlayer buzzer(onTone, onNoTone, 1);
+#endif
+	buzzer.play(melody);
+	report("PatternPlayer", sizeof(buzzer));
+}
+
+static void button() {
+	hostHeapReset();
+	HandledButton key(2, 1);
+	key.processStep();
+	report("HandledButton", sizeof(key));
+}
+
+static void protocol() {
+	hostHeapReset();
+	SerialProtocol commands(Serial);
+	commands.addCommand(SPR_CMD_DIGITS, onFrame);
+	report("SerialProtocol", sizeof(commands));
+}
+
+static void recorder() {
+	hostHeapReset();
+	TraceRecorder trace(traceBuffer, sizeof(traceBuffer), 1000);
+	trace.addPin(2);
+	trace.start();
+	trace.processTick();
+	report("TraceRecorder", sizeof(trace));
+}
+
+int main(int argc, char **argv) {
+	for (int i = 1; i < argc; i++) {
+		readArchive(argv[i]);
+	}
+	HostMcu::current().setAdcVoltage(0, 3.3); //Эмулятор выделяет память под источник сигнала АЦП - до замеров
+	printf("mode: %s (%d events, %d samples, %d digits, %d notes)\n", FOOTPRINT_MODE, FOOTPRINT_EVENTS, FOOTPRINT_SAMPLES, FOOTPRINT_DIGITS,
+		FOOTPRINT_NOTES);
+	printf("%-24s %8s %12s %12s %10s %10s\n", "class", "object", "heap blocks", "heap bytes", "code", "data");
+	eventTimer();
+	voltmeter();
+	indicator();
+	player();
+	button();
+	protocol();
+	recorder();
+	return 0;
+}
@@ -0,0 +1,113 @@
+/**
+	Arduino.h (компьютер) - ядро Arduino для сборки библиотек MYLIB_* на компьютере (Linux) без платы.
+	Вместо настоящего контроллера работает эмулятор ATmega328P (HostMcu.h): регистры, ноги, АЦП, таймеры и модельное время.
+	Функции ядра (pinMode, digitalWrite, analogRead, millis, delay, tone и т.д.) работают через регистры эмулятора, так же как на плате.
+	Отличия от платы:
+		* Время идёт только тогда, когда его двигают: HostMcu::advanceMicros(), delay(), ожидание окончания преобразования АЦП, сон.
+			Прерывания срабатывают во время этого движения. millis() и micros() не переполняются через 49 дней и 71 минуту, как на плате.
+		* int занимает 4 байта, а не 2, поэтому переполнения 16-битной арифметики здесь не видны.
+		* min() и max() не определены как макросы, чтобы не ломать стандартную библиотеку C++.
+	Сборка: CMakeLists.txt в корне репозитория, он же задаёт макрос MYLIB_HOST.
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h> //На плате - через WCharacter.h
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef uint16_t word;
+
+#include "binary.h"
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+#include "WString.h"
+#include "HardwareSerial.h"
+
+#ifndef MYLIB_HOST
+#define MYLIB_HOST 1
+#endif
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define DEFAULT 1
+#define EXTERNAL 0
+#define INTERNAL 3
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+#define LED_BUILTIN 13
+#define NUM_DIGITAL_PINS 20
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define radians(deg) ((deg) * DEG_TO_RAD)
+#define degrees(rad) ((rad) * RAD_TO_DEG)
+#define sq(x) ((x) * (x))
+
+#define interrupts() sei()
+#define noInterrupts() cli()
+
+#define clockCyclesPerMicrosecond() (F_CPU / 1000000L)
+#define clockCyclesToMicroseconds(a) ((a) / clockCyclesPerMicrosecond())
+#define microsecondsToClockCycles(a) ((a) * clockCyclesPerMicrosecond())
+
+#define lowByte(w) ((uint8_t) ((w) & 0xff))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+#define bit(b) (1UL << (b))
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogReference(uint8_t mode);
+void analogWrite(uint8_t pin, int value);
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh);
+
+#endif
@@ -0,0 +1,139 @@
+/**
+	HardwareSerial_h (компьютер) - последовательный порт эмулятора контроллера.
+	Принятые байты подаются методом HostMcu::serialInput(), переданные забираются методом HostMcu::takeSerialOutput().
+	Скорость порта (begin()) запоминается, но на время передачи не влияет.
+*/
+
+#include "Arduino.h"
+#include "HostMcu.h"
+#include <stdio.h>
+
+HardwareSerial Serial;
+
+void HardwareSerial::begin(unsigned long baud, uint8_t config) {
+	HostMcu::current().serialBegin(baud);
+}
+
+void HardwareSerial::end() {
+	HostMcu::current().serialBegin(0);
+}
+
+int HardwareSerial::available() {
+	return HostMcu::current().serialAvailable();
+}
+
+int HardwareSerial::availableForWrite() {
+	return HostMcu::current().serialAvailableForWrite();
+}
+
+int HardwareSerial::peek() {
+	return HostMcu::current().serialRead(false);
+}
+
+int HardwareSerial::read() {
+	return HostMcu::current().serialRead(true);
+}
+
+void HardwareSerial::flush() {
+	HostMcu::current().serialFlush();
+}
+
+size_t HardwareSerial::write(uint8_t value) {
+	HostMcu::current().serialWrite(value);
+	return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+	for (size_t i = 0; i < size; i++) {
+		write(buffer[i]);
+	}
+	return size;
+}
+
+size_t HardwareSerial::write(const char *text) {
+	return text == NULL ? 0 : write((const uint8_t *) text, strlen(text));
+}
+
+size_t HardwareSerial::print(const char *text) {
+	return write(text);
+}
+
+size_t HardwareSerial::print(const String &text) {
+	return write(text.c_str());
+}
+
+size_t HardwareSerial::print(char symbol) {
+	return write((uint8_t) symbol);
+}
+
+size_t HardwareSerial::print(unsigned char value, int base) {
+	return print((unsigned long) value, base);
+}
+
+size_t HardwareSerial::print(int value, int base) {
+	return print((long) value, base);
+}
+
+size_t HardwareSerial::print(unsigned int value, int base) {
+	return print((unsigned long) value, base);
+}
+
+size_t HardwareSerial::print(long value, int base) {
+	if (base == 0) return write((uint8_t) value);
+	return print(String(value, (unsigned char) base));
+}
+
+size_t HardwareSerial::print(unsigned long value, int base) {
+	if (base == 0) return write((uint8_t) value);
+	return print(String(value, (unsigned char) base));
+}
+
+size_t HardwareSerial::print(double value, int digits) {
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+	return print(buffer);
+}
+
+size_t HardwareSerial::println() {
+	return write("\r\n");
+}
+
+size_t HardwareSerial::println(const char *text) {
+	return print(text) + println();
+}
+
+size_t HardwareSerial::println(const String &text) {
+	return print(text) + println();
+}
+
+size_t HardwareSerial::println(char symbol) {
+	return print(symbol) + println();
+}
+
+size_t HardwareSerial::println(unsigned char value, int base) {
+	return print(value, base) + println();
+}
+
+size_t HardwareSerial::println(int value, int base) {
+	return print(value, base) + println();
+}
+
+size_t HardwareSerial::println(unsigned int value, int base) {
+	return print(value, base) + println();
+}
+
+size_t HardwareSerial::println(long value, int base) {
+	return print(value, base) + println();
+}
+
+size_t HardwareSerial::println(unsigned long value, int base) {
+	return print(value, base) + println();
+}
+
+size_t HardwareSerial::println(double value, int digits) {
+	return print(value, digits) + println();
+}
+
+HardwareSerial::operator bool() {
+	return true;
+}
@@ -0,0 +1,56 @@
+/**
+	HardwareSerial_h (компьютер) - последовательный порт эмулятора контроллера.
+	Принятые байты подаются методом HostMcu::serialInput(), переданные забираются методом HostMcu::takeSerialOutput().
+	Скорость порта (begin()) запоминается, но на время передачи не влияет.
+*/
+
+#ifndef HostHardwareSerial_h
+#define HostHardwareSerial_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class String;
+
+class HardwareSerial {
+	public:
+		void begin(unsigned long baud, uint8_t config = 0);
+		void end();
+		int available();
+		int availableForWrite();
+		int peek();
+		int read();
+		void flush();
+		size_t write(uint8_t value);
+		size_t write(const uint8_t *buffer, size_t size);
+		size_t write(const char *text);
+		size_t print(const char *text);
+		size_t print(const String &text);
+		size_t print(char symbol);
+		size_t print(unsigned char value, int base = DEC);
+		size_t print(int value, int base = DEC);
+		size_t print(unsigned int value, int base = DEC);
+		size_t print(long value, int base = DEC);
+		size_t print(unsigned long value, int base = DEC);
+		size_t print(double value, int digits = 2);
+		size_t println();
+		size_t println(const char *text);
+		size_t println(const String &text);
+		size_t println(char symbol);
+		size_t println(unsigned char value, int base = DEC);
+		size_t println(int value, int base = DEC);
+		size_t println(unsigned int value, int base = DEC);
+		size_t println(long value, int base = DEC);
+		size_t println(unsigned long value, int base = DEC);
+		size_t println(double value, int digits = 2);
+		operator bool();
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,130 @@
+/**
+	Arduino.h (компьютер) - ядро Arduino для сборки библиотек MYLIB_* на компьютере (Linux) без платы.
+	Вместо настоящего контроллера работает эмулятор ATmega328P (HostMcu.h): регистры, ноги, АЦП, таймеры и модельное время.
+	Функции ядра (pinMode, digitalWrite, analogRead, millis, delay, tone и т.д.) работают через регистры эмулятора, так же как на плате.
+	Отличия от платы:
+		* Время идёт только тогда, когда его двигают: HostMcu::advanceMicros(), delay(), ожидание окончания преобразования АЦП, сон.
+			Прерывания срабатывают во время этого движения. millis() и micros() не переполняются через 49 дней и 71 минуту, как на плате.
+		* int занимает 4 байта, а не 2, поэтому переполнения 16-битной арифметики здесь не видны.
+		* min() и max() не определены как макросы, чтобы не ломать стандартную библиотеку C++.
+	Сборка: CMakeLists.txt в корне репозитория, он же задаёт макрос MYLIB_HOST.
+*/
+
+#include "Arduino.h"
+#include "HostMcu.h"
+
+void pinMode(uint8_t pin, uint8_t mode) {
+	byte bit;
+	uint8_t pinAddress = HostMcu::pinPortAddress(pin, &bit);
+	if (pinAddress == 0) return;
+	HostRegister8 direction(pinAddress + 1);
+	HostRegister8 output(pinAddress + 2);
+	uint8_t oldSREG = SREG;
+	cli();
+	if (mode == OUTPUT) {
+		direction |= _BV(bit);
+	} else {
+		direction &= ~_BV(bit);
+		if (mode == INPUT_PULLUP) {
+			output |= _BV(bit);
+		} else {
+			output &= ~_BV(bit);
+		}
+	}
+	SREG = oldSREG;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+	byte bit;
+	uint8_t pinAddress = HostMcu::pinPortAddress(pin, &bit);
+	if (pinAddress == 0) return;
+	HostMcu::current().setPwmOutput(pin, -1); //Как turnOffPWM() в ядре
+	HostRegister8 output(pinAddress + 2);
+	uint8_t oldSREG = SREG;
+	cli();
+	if (value == LOW) {
+		output &= ~_BV(bit);
+	} else {
+		output |= _BV(bit);
+	}
+	SREG = oldSREG;
+}
+
+int digitalRead(uint8_t pin) {
+	byte bit;
+	uint8_t pinAddress = HostMcu::pinPortAddress(pin, &bit);
+	if (pinAddress == 0) return LOW;
+	HostMcu::current().setPwmOutput(pin, -1);
+	return (HostRegister8(pinAddress) & _BV(bit)) ? HIGH : LOW;
+}
+
+void analogReference(uint8_t mode) {
+	HostMcu::current().setAnalogReference(mode);
+}
+
+int analogRead(uint8_t pin) {
+	if (pin >= 14) pin -= 14;
+	ADMUX = (HostMcu::current().getAnalogReference() << 6) | (pin & 0x07);
+	ADCSRA |= _BV(ADSC);
+	while (ADCSRA & _BV(ADSC));
+	uint8_t low = ADCL;
+	uint8_t high = ADCH;
+	return (high << 8) | low;
+}
+
+void analogWrite(uint8_t pin, int value) {
+	pinMode(pin, OUTPUT);
+	if (value <= 0) {
+		digitalWrite(pin, LOW);
+	} else if (value >= 255) {
+		digitalWrite(pin, HIGH);
+	} else {
+		HostMcu::current().setPwmOutput(pin, value);
+	}
+}
+
+unsigned long millis() {
+	return HostMcu::current().getMillis();
+}
+
+unsigned long micros() {
+	return HostMcu::current().getMicros();
+}
+
+void delay(unsigned long ms) {
+	HostMcu::current().advanceMillis(ms);
+}
+
+void delayMicroseconds(unsigned int us) {
+	HostMcu::current().advanceMicros(us);
+}
+
+void yield() {}
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration) {
+	pinMode(pin, OUTPUT);
+	HostMcu::current().startTone(pin, frequency, duration);
+}
+
+void noTone(uint8_t pin) {
+	HostMcu::current().stopTone(pin);
+	digitalWrite(pin, LOW);
+}
+
+long random(long howBig) {
+	if (howBig == 0) return 0;
+	return ::random() % howBig;
+}
+
+long random(long howSmall, long howBig) {
+	if (howSmall >= howBig) return howSmall;
+	return random(howBig - howSmall) + howSmall;
+}
+
+void randomSeed(unsigned long seed) {
+	if (seed != 0) srandom(seed);
+}
+
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh) {
+	return (value - fromLow) * (toHigh - toLow) / (fromHigh - fromLow) + toLow;
+}
@@ -0,0 +1,68 @@
+/**
+	HostHeap_h - счётчик обращений к куче на компьютере, для проверки режима MYLIB_STATIC и отчёта о расходе памяти (host/footprint).
+	HostHeap.cpp подменяет malloc(), calloc(), realloc() и free() всей программы (operator new в libstdc++ тоже вызывает malloc())
+	и передаёт вызовы настоящим функциям glibc, считая выделения. Подмена попадает в программу, только если она вызывает функции ниже,
+	поэтому библиотека mylib_host_heap подключается лишь к тем тестам и утилитам, которым счётчик нужен.
+	Счётчики у каждого потока свои, как текущий эмулятор (HostMcu::current()).
+		hostHeapReset(); //Обнулить счётчики
+		StaticVoltmeter<8> battery(A0);
+		battery.processMeasurement();
+		CHECK_EQUAL(0, hostHeapAllocations()); //Ни одного malloc(), calloc(), realloc() или new с момента hostHeapReset()
+	hostHeapBytes() - сколько байт запрошено за это время (освобождения не вычитаются), hostHeapFrees() - сколько раз вызван free() с ненулевым указателем.
+*/
+
+#include "HostHeap.h"
+#include <stddef.h>
+
+extern "C" {
+	void *__libc_malloc(size_t size);
+	void *__libc_calloc(size_t count, size_t size);
+	void *__libc_realloc(void *pointer, size_t size);
+	void __libc_free(void *pointer);
+}
+
+//Без конструкторов: malloc() вызывается и до инициализации статических объектов
+static thread_local unsigned long hostHeapAllocationsCount;
+static thread_local unsigned long hostHeapBytesCount;
+static thread_local unsigned long hostHeapFreesCount;
+
+extern "C" void *malloc(size_t size) {
+	hostHeapAllocationsCount++;
+	hostHeapBytesCount += size;
+	return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size) {
+	hostHeapAllocationsCount++;
+	hostHeapBytesCount += count * size;
+	return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *pointer, size_t size) {
+	hostHeapAllocationsCount++;
+	hostHeapBytesCount += size;
+	return __libc_realloc(pointer, size);
+}
+
+extern "C" void free(void *pointer) {
+	if (pointer != NULL) hostHeapFreesCount++;
+	__libc_free(pointer);
+}
+
+void hostHeapReset() {
+	hostHeapAllocationsCount = 0;
+	hostHeapBytesCount = 0;
+	hostHeapFreesCount = 0;
+}
+
+unsigned long hostHeapAllocations() {
+	return hostHeapAllocationsCount;
+}
+
+unsigned long hostHeapBytes() {
+	return hostHeapBytesCount;
+}
+
+unsigned long hostHeapFrees() {
+	return hostHeapFreesCount;
+}
@@ -0,0 +1,22 @@
+/**
+	HostHeap_h - счётчик обращений к куче на компьютере, для проверки режима MYLIB_STATIC и отчёта о расходе памяти (host/footprint).
+	HostHeap.cpp подменяет malloc(), calloc(), realloc() и free() всей программы (operator new в libstdc++ тоже вызывает malloc())
+	и передаёт вызовы настоящим функциям glibc, считая выделения. Подмена попадает в программу, только если она вызывает функции ниже,
+	поэтому библиотека mylib_host_heap подключается лишь к тем тестам и утилитам, которым счётчик нужен.
+	Счётчики у каждого потока свои, как текущий эмулятор (HostMcu::current()).
+		hostHeapReset(); //Обнулить счётчики
+		StaticVoltmeter<8> battery(A0);
+		battery.processMeasurement();
+		CHECK_EQUAL(0, hostHeapAllocations()); //Ни одного malloc(), calloc(), realloc() или new с момента hostHeapReset()
+	hostHeapBytes() - сколько байт запрошено за это время (освобождения не вычитаются), hostHeapFrees() - сколько раз вызван free() с ненулевым указателем.
+*/
+
+#ifndef HostHeap_h
+#define HostHeap_h
+
+void hostHeapReset();
+unsigned long hostHeapAllocations();
+unsigned long hostHeapBytes();
+unsigned long hostHeapFrees();
+
+#endif
@@ -0,0 +1,1033 @@
+/**
+	HostMcu_h - эмулятор ATmega328P (Arduino Uno) для сборки, проверки и измерения библиотек MYLIB_* на компьютере.
+	Эмулятор хранит всё, что на плате хранит железо: регистры, модельное время в тактах (F_CPU), уровни ног, источники сигнала для АЦП,
+	состояние таймеров и последовательного порта. Библиотеки работают с ним через обычные регистры и функции ядра Arduino (см. Arduino.h).
+
+	Каждый поток работает со своим текущим эмулятором. По умолчанию это общий экземпляр, другой можно выбрать методом select(), вернуться к общему -
+	статическим методом selectDefault().
+	Так в одном процессе можно моделировать несколько независимых устройств. Пример теста:
+		HostMcu &mcu = HostMcu::current();
+		mcu.reset();
+		mcu.setAdcVoltage(0, 2.5);
+		Voltmeter battery(A0);
+		battery.processMeasurement(); //Ожидание окончания преобразования сдвигает модельное время
+		mcu.advanceMillis(10); //Таймеры и АЦП работают, прерывания вызываются по ходу времени
+
+	Время:
+		* getCycles(), getMicros(), getMillis() - модельное время с момента reset().
+		* advanceCycles(), advanceMicros(), advanceMillis() - сдвинуть время. По дороге завершаются преобразования АЦП, срабатывают таймеры и
+			вызываются разрешённые обработчики прерываний (ISR), если в SREG установлен флаг I.
+		* sleepUntilInterrupt() - вызывается из sleep_cpu(). Сдвигает время до ближайшего прерывания, которое может разбудить контроллер в режиме,
+			заданном в SMCR. Таймеры 0 и 1 и АЦП в глубоких режимах сна стоят, Timer2 стоит в power-down и standby (асинхронный режим не моделируется).
+			Если разбудить контроллер нечему, возвращает false и время не сдвигает.
+			getSleepCycles() - сколько тактов контроллер проспал, getSleepCycles(SLEEP_MODE_*) - сколько проспал в заданном режиме.
+		* scheduleAction(cycle, action) - выполнить действие (например, нажать кнопку через setPinInput()) в заданный такт модельного времени,
+			в том числе во время сна.
+	Ноги (номера как на Arduino Uno: 0-13 цифровые, 14-19 - A0-A5):
+		* setPinInput(pin, level) - подать на ногу внешний уровень, releasePin(pin) - отпустить (нога висит в воздухе или подтянута к питанию).
+		* getPinLevel(pin), getPinMode(pin) - уровень и режим ноги. getPwm(pin) - последнее значение analogWrite() (-1, если ШИМ выключен).
+		* setPinListener(listener) - вызывается при каждом изменении уровня выхода.
+		* Изменение уровня ноги, разрешённой в PCMSKn, ставит флаг в PCIFR и вызывает PCINTn_vect (если разрешено в PCICR), в том числе будит из любого сна.
+		* getToneFrequency(pin) - частота tone() на ноге (0 - тишина).
+		* getCompareOutputFrequency(pin) - частота меандра на выходе сравнения таймера (OC0A/B - ноги 6, 5, OC1A/B - 9, 10, OC2A/B - 11, 3),
+			если выход в режиме переключения (COMnx = 01), нога настроена на выход, а таймер идёт в режиме Normal или CTC. Иначе 0.
+	АЦП:
+		* setAdcVoltage(channel, volts) - постоянное напряжение на входе, setAdcWaveform(channel, waveform) - напряжение как функция времени в секундах.
+		* setAdcNoise(lsbRms) - нормальный шум с заданным СКО в единицах младшего разряда. setReferenceVoltages() - напряжения AVCC, AREF и внутреннего источника.
+		* Преобразование длится 13 тактов АЦП. Напряжение и ADMUX запоминаются в начале преобразования, как на плате,
+			поэтому в режиме непрерывного преобразования новый ADMUX действует только со следующего преобразования.
+		* getAdcConversionsCount() - количество завершённых преобразований.
+	Последовательный порт: serialInput() - подать принятые байты, takeSerialOutput() - забрать переданные.
+		* serialInput() кладёт байты в приёмный буфер сразу и без ограничения размера - удобно для тестов разбора команд.
+		* serialReceive() передаёт байты по линии со скоростью Serial.begin() (10 бит на байт) вслед за ещё не принятыми: каждый байт
+			появляется в приёмном буфере в свой такт модельного времени. Буфер, как у HardwareSerial, - HOST_MCU_SERIAL_BUFFER байт,
+			байт, не поместившийся в буфер (или пришедший до Serial.begin()), теряется - getSerialLostBytes().
+		* После Serial.begin() передача тоже занимает время: write() ждёт (сдвигая модельное время), пока в буфере передачи
+			на HOST_MCU_SERIAL_BUFFER байт не освободится место, flush() - пока не уйдёт последний байт.
+			getSerialTxEndCycle() - такт, в который линия передачи освободится.
+	Таймеры 0, 1, 2 считают по настройкам предделителя и режима (WGM), ставят флаги совпадения и переполнения и вызывают прерывания.
+	Сторожевой таймер (WDTCSR, avr/wdt.h) в режиме прерывания вызывает WDT_vect раз в 16 мс * 2^WDP и будит из любого сна.
+	После reset() таймеры и АЦП настроены так же, как их настраивает ядро Arduino при запуске, прерывания разрешены.
+*/
+
+#include "HostMcu.h"
+
+#define DEV_HOST_PINB 0x23
+#define DEV_HOST_PINC 0x26
+#define DEV_HOST_PIND 0x29
+#define DEV_HOST_MCUCR 0x55
+#define DEV_HOST_SMCR 0x53
+#define DEV_HOST_SREG 0x5F
+#define DEV_HOST_ADCL 0x78
+#define DEV_HOST_ADCH 0x79
+#define DEV_HOST_ADCSRA 0x7A
+#define DEV_HOST_ADCSRB 0x7B
+#define DEV_HOST_ADMUX 0x7C
+#define DEV_HOST_ICR1 0x86
+#define DEV_HOST_PCIFR 0x3B
+#define DEV_HOST_WDTCSR 0x60
+#define DEV_HOST_PCICR 0x68
+#define DEV_HOST_PCMSK0 0x6B
+#define DEV_HOST_NEVER UINT64_MAX
+#define DEV_HOST_CYCLES_PER_US (F_CPU / 1000000UL)
+
+struct DevHostTimer {
+	uint8_t controlA;
+	uint8_t controlB;
+	uint8_t counter;
+	uint8_t compareA;
+	uint8_t compareB;
+	uint8_t mask;
+	uint8_t flags;
+	boolean wide;
+};
+
+static const DevHostTimer dev_hostTimers[HOST_MCU_TIMERS_COUNT] = {
+	{0x44, 0x45, 0x46, 0x47, 0x48, 0x6E, 0x35, false},
+	{0x80, 0x81, 0x84, 0x88, 0x8A, 0x6F, 0x36, true},
+	{0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0x70, 0x37, false}
+};
+
+static const uint8_t dev_hostTimerFlags[3] = {OCF0A, OCF0B, TOV0}; //Флаги событий таймера в TIFRn
+
+struct DevHostVector {
+	uint8_t flags;
+	uint8_t flagBit;
+	uint8_t mask;
+	uint8_t maskBit;
+	void (*handler)(void);
+	byte source; //Событие модельного времени, которое ставит флаг (для выбора источников пробуждения)
+};
+
+static const DevHostVector dev_hostVectors[] = { //В порядке приоритета, как в таблице векторов ATmega328P
+	{DEV_HOST_PCIFR, PCIF0, DEV_HOST_PCICR, PCIE0, PCINT0_vect, DEV_HOST_SOURCE_NONE},
+	{DEV_HOST_PCIFR, PCIF1, DEV_HOST_PCICR, PCIE1, PCINT1_vect, DEV_HOST_SOURCE_NONE},
+	{DEV_HOST_PCIFR, PCIF2, DEV_HOST_PCICR, PCIE2, PCINT2_vect, DEV_HOST_SOURCE_NONE},
+	{DEV_HOST_WDTCSR, WDIF, DEV_HOST_WDTCSR, WDIE, WDT_vect, DEV_HOST_SOURCE_WATCHDOG},
+	{0x37, OCF2A, 0x70, OCIE2A, TIMER2_COMPA_vect, DEV_HOST_SOURCE_TIMER + 6},
+	{0x37, OCF2B, 0x70, OCIE2B, TIMER2_COMPB_vect, DEV_HOST_SOURCE_TIMER + 7},
+	{0x37, TOV2, 0x70, TOIE2, TIMER2_OVF_vect, DEV_HOST_SOURCE_TIMER + 8},
+	{0x36, OCF1A, 0x6F, OCIE1A, TIMER1_COMPA_vect, DEV_HOST_SOURCE_TIMER + 3},
+	{0x36, OCF1B, 0x6F, OCIE1B, TIMER1_COMPB_vect, DEV_HOST_SOURCE_TIMER + 4},
+	{0x36, TOV1, 0x6F, TOIE1, TIMER1_OVF_vect, DEV_HOST_SOURCE_TIMER + 5},
+	{0x35, OCF0A, 0x6E, OCIE0A, TIMER0_COMPA_vect, DEV_HOST_SOURCE_TIMER},
+	{0x35, OCF0B, 0x6E, OCIE0B, TIMER0_COMPB_vect, DEV_HOST_SOURCE_TIMER + 1},
+	{0x35, TOV0, 0x6E, TOIE0, TIMER0_OVF_vect, DEV_HOST_SOURCE_TIMER + 2},
+	{DEV_HOST_ADCSRA, ADIF, DEV_HOST_ADCSRA, ADIE, ADC_vect, DEV_HOST_SOURCE_ADC}
+};
+
+static const uint8_t dev_hostPinChangePorts[3] = {0x23, 0x26, 0x29}; //PINB, PINC, PIND - PCINT0, PCINT1, PCINT2
+
+static thread_local HostMcu *dev_hostCurrentMcu = NULL;
+
+static HostMcu &dev_hostDefaultMcu() {
+	static HostMcu mcu; //Создаётся при первом обращении, даже если конструкторы глобальных объектов скетча вызываются раньше
+	return mcu;
+}
+
+HostMcu::HostMcu() {
+	reset();
+}
+
+void HostMcu::select() {
+	dev_hostCurrentMcu = this;
+}
+
+void HostMcu::selectDefault() {
+	dev_hostCurrentMcu = NULL;
+}
+
+HostMcu &HostMcu::current() {
+	return dev_hostCurrentMcu != NULL ? *dev_hostCurrentMcu : dev_hostDefaultMcu();
+}
+
+void HostMcu::reset() {
+	memset(dev_registers, 0, sizeof(dev_registers));
+	dev_cycles = 0;
+	dev_sleepCycles = 0;
+	for (byte mode = 0; mode < 8; mode++) {
+		dev_sleepModeCycles[mode] = 0;
+	}
+	dev_actions.clear();
+	dev_watchdogOrigin = 0;
+	dev_interruptsCount = 0;
+	dev_interruptDepth = 0;
+	for (byte pin = 0; pin < HOST_MCU_PINS_COUNT; pin++) {
+		dev_externalLevels[pin] = -1;
+		dev_outputLevels[pin] = -1;
+		dev_pwm[pin] = -1;
+	}
+	dev_pinListener = nullptr;
+	dev_tonePin = 0;
+	dev_toneFrequency = 0;
+	dev_toneEnd = 0;
+	dev_analogReference = DEFAULT;
+	dev_adcConverting = false;
+	dev_adcCompleteAt = 0;
+	dev_adcLatchedMux = 0;
+	dev_adcHeldSample = 0;
+	dev_adcConversions = 0;
+	for (byte channel = 0; channel < HOST_MCU_ADC_CHANNELS; channel++) {
+		dev_adcVoltages[channel] = 0;
+		dev_adcWaveforms[channel] = nullptr;
+	}
+	dev_adcNoise = 0;
+	dev_randomState = 1;
+	dev_avcc = 5.0;
+	dev_aref = 5.0;
+	dev_internalReference = 1.1;
+	for (byte timer = 0; timer < HOST_MCU_TIMERS_COUNT; timer++) {
+		dev_timerOrigins[timer] = 0;
+		dev_timerStoppedCounts[timer] = 0;
+	}
+	dev_serialInput.clear();
+	dev_serialOutput.clear();
+	dev_serialBaud = 0;
+	dev_serialLostBytes = 0;
+	dev_serialRxEnd = 0;
+	dev_serialTxEnd = 0;
+	//Так же, как init() ядра Arduino: таймер 0 - fast PWM, таймеры 1 и 2 - phase correct PWM, предделитель 64; АЦП включён с предделителем 128
+	dev_registers[dev_hostTimers[0].controlA] = _BV(WGM01) | _BV(WGM00);
+	dev_registers[dev_hostTimers[0].controlB] = _BV(CS01) | _BV(CS00);
+	dev_registers[dev_hostTimers[1].controlA] = _BV(WGM10);
+	dev_registers[dev_hostTimers[1].controlB] = _BV(CS11) | _BV(CS10);
+	dev_registers[dev_hostTimers[2].controlA] = _BV(WGM20);
+	dev_registers[dev_hostTimers[2].controlB] = _BV(CS22);
+	dev_registers[DEV_HOST_ADCSRA] = _BV(ADEN) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+	dev_registers[DEV_HOST_SREG] = _BV(SREG_I);
+	for (byte port = 0; port < 3; port++) {
+		dev_pinChangeLevels[port] = dev_readPins(dev_hostPinChangePorts[port]);
+	}
+}
+
+uint64_t HostMcu::getCycles() {
+	return dev_cycles;
+}
+
+unsigned long HostMcu::getMicros() {
+	return dev_cycles / DEV_HOST_CYCLES_PER_US;
+}
+
+unsigned long HostMcu::getMillis() {
+	return dev_cycles / (DEV_HOST_CYCLES_PER_US * 1000UL);
+}
+
+void HostMcu::advanceCycles(uint64_t cycles) {
+	dev_runUntil(dev_cycles + cycles, 0xFFFF);
+}
+
+void HostMcu::advanceMicros(unsigned long us) {
+	advanceCycles((uint64_t) us * DEV_HOST_CYCLES_PER_US);
+}
+
+void HostMcu::advanceMillis(unsigned long ms) {
+	advanceCycles((uint64_t) ms * DEV_HOST_CYCLES_PER_US * 1000UL);
+}
+
+boolean HostMcu::sleepUntilInterrupt() {
+	if (!(dev_registers[DEV_HOST_SMCR] & _BV(SE))) return false;
+	if (!(dev_registers[DEV_HOST_SREG] & _BV(SREG_I))) return false; //Без флага I контроллер не проснётся никогда
+	uint16_t timer2Sources = 0;
+	for (byte event = 0; event < 3; event++) {
+		timer2Sources |= _BV(DEV_HOST_SOURCE_TIMER + 2 * 3 + event);
+	}
+	uint16_t sources = _BV(DEV_HOST_SOURCE_WATCHDOG) | _BV(DEV_HOST_SOURCE_ACTION); //Сторожевой таймер и внешний мир работают в любом режиме
+	byte mode = (dev_registers[DEV_HOST_SMCR] >> SM0) & 7;
+	switch (mode) {
+		case 0: //Idle
+			sources = 0xFFFF;
+			break;
+		case 1: //ADC noise reduction
+			sources |= timer2Sources | _BV(DEV_HOST_SOURCE_ADC) | _BV(DEV_HOST_SOURCE_TONE);
+			break;
+		case 3: //Power-save
+		case 7: //Extended standby
+			sources |= timer2Sources | _BV(DEV_HOST_SOURCE_TONE);
+			break;
+		default: //Power-down, standby: будят только смена уровня ноги и сторожевой таймер
+			break;
+	}
+	boolean pinWake = false;
+	for (byte index = 0; index < sizeof(dev_hostVectors) / sizeof(dev_hostVectors[0]); index++) {
+		const DevHostVector &vector = dev_hostVectors[index];
+		if (vector.source == DEV_HOST_SOURCE_NONE && (dev_registers[vector.mask] & _BV(vector.maskBit))) pinWake = true;
+	}
+	uint64_t start = dev_cycles;
+	uint16_t frozenCounts[HOST_MCU_TIMERS_COUNT];
+	for (byte timer = 0; timer < HOST_MCU_TIMERS_COUNT; timer++) {
+		frozenCounts[timer] = dev_timerCount(timer);
+	}
+	unsigned long interruptsBefore = dev_interruptsCount;
+	boolean slept = false;
+	while (dev_interruptsCount == interruptsBefore) {
+		uint64_t times[DEV_HOST_SOURCES_COUNT];
+		dev_collectEventTimes(times);
+		uint64_t wakeAt = DEV_HOST_NEVER;
+		for (byte index = 0; index < sizeof(dev_hostVectors) / sizeof(dev_hostVectors[0]); index++) {
+			const DevHostVector &vector = dev_hostVectors[index];
+			if (vector.source == DEV_HOST_SOURCE_NONE || !(dev_registers[vector.mask] & _BV(vector.maskBit))) continue;
+			if ((sources & _BV(vector.source)) && times[vector.source] < wakeAt) wakeAt = times[vector.source];
+		}
+		//Действие по расписанию может сменить уровень ноги и разбудить контроллер раньше
+		uint64_t until = pinWake && times[DEV_HOST_SOURCE_ACTION] < wakeAt ? times[DEV_HOST_SOURCE_ACTION] : wakeAt;
+		if (until == DEV_HOST_NEVER) break;
+		dev_runUntil(until, sources);
+		slept = true;
+	}
+	if (!slept) return false;
+	uint64_t sleptCycles = dev_cycles - start;
+	dev_sleepCycles += sleptCycles;
+	dev_sleepModeCycles[mode] += sleptCycles;
+	for (byte timer = 0; timer < HOST_MCU_TIMERS_COUNT; timer++) { //Таймеры 0 и 1 тактируются от clkIO и во сне (кроме idle) стоят, Timer2 - в power-down
+		if (!(sources & _BV(DEV_HOST_SOURCE_TIMER + timer * 3))) dev_timerAnchor(timer, frozenCounts[timer]);
+	}
+	if (!(sources & _BV(DEV_HOST_SOURCE_ADC)) && dev_adcConverting) dev_adcCompleteAt += sleptCycles;
+	return true;
+}
+
+uint64_t HostMcu::getSleepCycles() {
+	return dev_sleepCycles;
+}
+
+uint64_t HostMcu::getSleepCycles(uint8_t sleepMode) {
+	return dev_sleepModeCycles[(sleepMode >> SM0) & 7];
+}
+
+void HostMcu::scheduleAction(uint64_t cycle, std::function<void ()> action) {
+	dev_actions.insert(std::make_pair(cycle, action));
+}
+
+void HostMcu::watchdogReset() {
+	dev_watchdogOrigin = dev_cycles;
+}
+
+uint64_t HostMcu::dev_nextWatchdogEvent() {
+	uint8_t control = dev_registers[DEV_HOST_WDTCSR];
+	if (!(control & (_BV(WDIE) | _BV(WDE)))) return DEV_HOST_NEVER;
+	byte prescaler = (control & 7) | ((control >> 2) & 8);
+	if (prescaler > 9) prescaler = 9;
+	uint64_t period = (2048ULL << prescaler) * F_CPU / 128000UL; //Генератор сторожевого таймера - 128 кГц
+	return dev_watchdogOrigin + ((dev_cycles - dev_watchdogOrigin) / period + 1) * period;
+}
+
+unsigned long HostMcu::getInterruptsCount() {
+	return dev_interruptsCount;
+}
+
+byte HostMcu::getInterruptDepth() {
+	return dev_interruptDepth;
+}
+
+void HostMcu::dev_runUntil(uint64_t target, uint16_t sourcesMask) {
+	uint64_t times[DEV_HOST_SOURCES_COUNT];
+	while (true) {
+		dev_collectEventTimes(times);
+		uint64_t next = DEV_HOST_NEVER;
+		for (byte source = 0; source < DEV_HOST_SOURCES_COUNT; source++) {
+			if ((sourcesMask & _BV(source)) && times[source] < next) next = times[source];
+		}
+		if (next > target) break;
+		if (next > dev_cycles) dev_cycles = next;
+		for (byte source = 0; source < DEV_HOST_SOURCES_COUNT; source++) {
+			if ((sourcesMask & _BV(source)) && times[source] == next) dev_processEvent(source);
+		}
+		dev_dispatchInterrupts();
+	}
+	if (target > dev_cycles) dev_cycles = target; //Обработчик мог сам сдвинуть время дальше
+}
+
+void HostMcu::dev_collectEventTimes(uint64_t *times) {
+	times[DEV_HOST_SOURCE_ADC] = dev_adcConverting ? dev_adcCompleteAt : DEV_HOST_NEVER;
+	for (byte timer = 0; timer < HOST_MCU_TIMERS_COUNT; timer++) {
+		for (byte event = 0; event < 3; event++) {
+			times[DEV_HOST_SOURCE_TIMER + timer * 3 + event] = dev_nextTimerEvent(timer, event);
+		}
+	}
+	times[DEV_HOST_SOURCE_TONE] = dev_toneEnd != 0 ? dev_toneEnd : DEV_HOST_NEVER;
+	times[DEV_HOST_SOURCE_WATCHDOG] = dev_nextWatchdogEvent();
+	times[DEV_HOST_SOURCE_ACTION] = dev_actions.empty() ? DEV_HOST_NEVER : dev_actions.begin()->first;
+}
+
+void HostMcu::dev_processEvent(byte source) {
+	if (source == DEV_HOST_SOURCE_ADC) {
+		dev_completeConversion();
+	} else if (source == DEV_HOST_SOURCE_TONE) {
+		byte bit;
+		uint8_t pinAddress = pinPortAddress(dev_tonePin, &bit);
+		stopTone(dev_tonePin);
+		if (pinAddress != 0) dev_writePort(pinAddress, pinAddress + 2, dev_registers[pinAddress + 2] & ~_BV(bit));
+	} else if (source == DEV_HOST_SOURCE_WATCHDOG) {
+		if (dev_registers[DEV_HOST_WDTCSR] & _BV(WDIE)) dev_registers[DEV_HOST_WDTCSR] |= _BV(WDIF);
+	} else if (source == DEV_HOST_SOURCE_ACTION) {
+		std::function<void ()> action = dev_actions.begin()->second;
+		dev_actions.erase(dev_actions.begin());
+		action();
+	} else {
+		byte timer = (source - DEV_HOST_SOURCE_TIMER) / 3;
+		byte event = (source - DEV_HOST_SOURCE_TIMER) % 3;
+		uint8_t &flags = dev_registers[dev_hostTimers[timer].flags];
+		boolean rising = !(flags & _BV(dev_hostTimerFlags[event]));
+		flags |= _BV(dev_hostTimerFlags[event]);
+		//Автозапуск АЦП происходит по фронту флага: если флаг не сброшен, нового запуска нет, как на плате
+		uint8_t control = dev_registers[DEV_HOST_ADCSRA];
+		if (rising && (control & _BV(ADEN)) && (control & _BV(ADATE)) && !dev_adcConverting) {
+			byte trigger = dev_registers[DEV_HOST_ADCSRB] & 7;
+			if ((trigger == 3 && timer == 0 && event == 0) || (trigger == 4 && timer == 0 && event == 2)
+				|| (trigger == 5 && timer == 1 && event == 1) || (trigger == 6 && timer == 1 && event == 2)) {
+				dev_startConversion();
+			}
+		}
+	}
+}
+
+void HostMcu::dev_dispatchInterrupts() {
+	while (dev_registers[DEV_HOST_SREG] & _BV(SREG_I)) {
+		const DevHostVector *pending = NULL;
+		for (byte index = 0; index < sizeof(dev_hostVectors) / sizeof(dev_hostVectors[0]); index++) {
+			const DevHostVector &vector = dev_hostVectors[index];
+			if ((dev_registers[vector.flags] & _BV(vector.flagBit)) && (dev_registers[vector.mask] & _BV(vector.maskBit))) {
+				pending = &vector;
+				break;
+			}
+		}
+		if (pending == NULL) return;
+		dev_registers[pending->flags] &= ~_BV(pending->flagBit); //Флаг сбрасывается при переходе на вектор
+		dev_registers[DEV_HOST_SREG] &= ~_BV(SREG_I);
+		dev_interruptDepth++;
+		dev_interruptsCount++;
+		pending->handler();
+		dev_interruptDepth--;
+		dev_registers[DEV_HOST_SREG] |= _BV(SREG_I); //reti
+	}
+}
+
+uint8_t HostMcu::pinPortAddress(byte pin, byte *bit) {
+	if (pin < 8) {
+		*bit = pin;
+		return DEV_HOST_PIND;
+	}
+	if (pin < 14) {
+		*bit = pin - 8;
+		return DEV_HOST_PINB;
+	}
+	if (pin < HOST_MCU_PINS_COUNT) {
+		*bit = pin - 14;
+		return DEV_HOST_PINC;
+	}
+	return 0;
+}
+
+static byte dev_hostFirstPin(uint8_t pinAddress) {
+	return pinAddress == DEV_HOST_PIND ? 0 : pinAddress == DEV_HOST_PINB ? 8 : 14;
+}
+
+static byte dev_hostPortPins(uint8_t pinAddress) {
+	return pinAddress == DEV_HOST_PIND ? 8 : 6;
+}
+
+uint8_t HostMcu::dev_readPins(uint8_t pinAddress) {
+	uint8_t direction = dev_registers[pinAddress + 1];
+	uint8_t output = dev_registers[pinAddress + 2];
+	boolean pullUps = !(dev_registers[DEV_HOST_MCUCR] & _BV(PUD));
+	byte firstPin = dev_hostFirstPin(pinAddress);
+	uint8_t levels = 0;
+	for (byte bit = 0; bit < dev_hostPortPins(pinAddress); bit++) {
+		boolean level;
+		if (direction & _BV(bit)) {
+			level = output & _BV(bit);
+		} else if (dev_externalLevels[firstPin + bit] >= 0) {
+			level = dev_externalLevels[firstPin + bit];
+		} else {
+			level = pullUps && (output & _BV(bit)); //Висящий в воздухе вход читается как 0
+		}
+		if (level) levels |= _BV(bit);
+	}
+	return levels;
+}
+
+void HostMcu::dev_writePort(uint8_t pinAddress, uint8_t address, uint8_t value) {
+	if (address == pinAddress) {
+		dev_registers[pinAddress + 2] ^= value; //Запись единицы в PINx переключает PORTx
+	} else {
+		dev_registers[address] = value;
+	}
+	dev_notifyPins(pinAddress);
+}
+
+void HostMcu::dev_notifyPins(uint8_t pinAddress) {
+	uint8_t direction = dev_registers[pinAddress + 1];
+	uint8_t output = dev_registers[pinAddress + 2];
+	byte firstPin = dev_hostFirstPin(pinAddress);
+	for (byte bit = 0; bit < dev_hostPortPins(pinAddress); bit++) {
+		int8_t level = (direction & _BV(bit)) ? ((output & _BV(bit)) ? HIGH : LOW) : -1;
+		if (level == dev_outputLevels[firstPin + bit]) continue;
+		dev_outputLevels[firstPin + bit] = level;
+		if (level >= 0 && dev_pinListener) dev_pinListener(firstPin + bit, level);
+	}
+	dev_checkPinChange();
+}
+
+void HostMcu::dev_checkPinChange() {
+	for (byte port = 0; port < 3; port++) {
+		uint8_t levels = dev_readPins(dev_hostPinChangePorts[port]);
+		uint8_t changed = levels ^ dev_pinChangeLevels[port];
+		dev_pinChangeLevels[port] = levels;
+		if (changed & dev_registers[DEV_HOST_PCMSK0 + port]) dev_registers[DEV_HOST_PCIFR] |= _BV(port);
+	}
+	dev_dispatchInterrupts();
+}
+
+void HostMcu::setPinInput(byte pin, byte level) {
+	if (pin >= HOST_MCU_PINS_COUNT) return;
+	dev_externalLevels[pin] = level ? HIGH : LOW;
+	dev_checkPinChange();
+}
+
+void HostMcu::releasePin(byte pin) {
+	if (pin >= HOST_MCU_PINS_COUNT) return;
+	dev_externalLevels[pin] = -1;
+	dev_checkPinChange();
+}
+
+byte HostMcu::getPinLevel(byte pin) {
+	byte bit;
+	uint8_t pinAddress = pinPortAddress(pin, &bit);
+	if (pinAddress == 0) return LOW;
+	return (dev_readPins(pinAddress) >> bit) & 1;
+}
+
+byte HostMcu::getPinMode(byte pin) {
+	byte bit;
+	uint8_t pinAddress = pinPortAddress(pin, &bit);
+	if (pinAddress == 0) return INPUT;
+	if (dev_registers[pinAddress + 1] & _BV(bit)) return OUTPUT;
+	return (dev_registers[pinAddress + 2] & _BV(bit)) ? INPUT_PULLUP : INPUT;
+}
+
+int HostMcu::getPwm(byte pin) {
+	return pin < HOST_MCU_PINS_COUNT ? dev_pwm[pin] : -1;
+}
+
+void HostMcu::setPwmOutput(byte pin, int value) {
+	if (pin < HOST_MCU_PINS_COUNT) dev_pwm[pin] = value;
+}
+
+void HostMcu::setPinListener(std::function<void (byte pin, byte level)> listener) {
+	dev_pinListener = listener;
+}
+
+void HostMcu::startTone(byte pin, unsigned int frequency, unsigned long duration) {
+	dev_tonePin = pin;
+	dev_toneFrequency = frequency;
+	dev_toneEnd = duration != 0 ? dev_cycles + (uint64_t) duration * DEV_HOST_CYCLES_PER_US * 1000UL : 0;
+}
+
+void HostMcu::stopTone(byte pin) {
+	if (pin != dev_tonePin) return;
+	dev_toneFrequency = 0;
+	dev_toneEnd = 0;
+}
+
+unsigned int HostMcu::getToneFrequency(byte pin) {
+	return pin == dev_tonePin ? dev_toneFrequency : 0;
+}
+
+double HostMcu::getCompareOutputFrequency(byte pin) {
+	static const byte outputPins[HOST_MCU_TIMERS_COUNT][2] = {{6, 5}, {9, 10}, {11, 3}}; //OCnA, OCnB
+	for (byte timer = 0; timer < HOST_MCU_TIMERS_COUNT; timer++) {
+		for (byte channel = 0; channel < 2; channel++) {
+			if (outputPins[timer][channel] != pin) continue;
+			const DevHostTimer &registers = dev_hostTimers[timer];
+			uint16_t prescaler = dev_timerPrescaler(timer);
+			uint16_t top;
+			boolean dualSlope, clearOnMatch;
+			dev_timerGeometry(timer, &top, &dualSlope, &clearOnMatch);
+			uint8_t controlA = dev_registers[registers.controlA];
+			uint8_t controlB = dev_registers[registers.controlB];
+			byte waveform = (controlA & 3) | ((controlB >> 1) & (registers.wide ? 12 : 4));
+			byte outputMode = (controlA >> (channel == 0 ? 6 : 4)) & 3;
+			if (outputMode != 1 || prescaler == 0 || getPinMode(pin) != OUTPUT || (waveform != 0 && !clearOnMatch)) return 0; //Только Normal и CTC
+			uint8_t address = channel == 0 ? registers.compareA : registers.compareB;
+			uint16_t compare = dev_registers[address];
+			if (registers.wide) compare |= dev_registers[address + 1] << 8;
+			if (compare > top) return 0; //Совпадения не бывает
+			return (double) F_CPU / (2.0 * prescaler * (top + 1.0)); //Выход переключается раз за период счётчика
+		}
+	}
+	return 0;
+}
+
+void HostMcu::setAnalogReference(uint8_t mode) {
+	dev_analogReference = mode;
+}
+
+uint8_t HostMcu::getAnalogReference() {
+	return dev_analogReference;
+}
+
+void HostMcu::setAdcVoltage(byte channel, float volts) {
+	if (channel >= 14) channel -= 14;
+	if (channel >= HOST_MCU_ADC_CHANNELS) return;
+	dev_adcVoltages[channel] = volts;
+	dev_adcWaveforms[channel] = nullptr;
+}
+
+void HostMcu::setAdcWaveform(byte channel, std::function<float (double seconds)> waveform) {
+	if (channel >= 14) channel -= 14;
+	if (channel < HOST_MCU_ADC_CHANNELS) dev_adcWaveforms[channel] = waveform;
+}
+
+void HostMcu::setAdcNoise(float lsbRms, uint32_t seed) {
+	dev_adcNoise = lsbRms;
+	dev_randomState = seed != 0 ? seed : 1;
+}
+
+void HostMcu::setReferenceVoltages(float avcc, float aref, float internal) {
+	dev_avcc = avcc;
+	dev_aref = aref;
+	dev_internalReference = internal;
+}
+
+unsigned long HostMcu::getAdcConversionsCount() {
+	return dev_adcConversions;
+}
+
+float HostMcu::dev_gaussian() {
+	double sum = 0; //Сумма 12 равномерных величин минус 6 - почти нормальная величина с единичным СКО
+	for (byte i = 0; i < 12; i++) {
+		dev_randomState ^= dev_randomState << 13;
+		dev_randomState ^= dev_randomState >> 7;
+		dev_randomState ^= dev_randomState << 17;
+		sum += (dev_randomState >> 11) * (1.0 / 9007199254740992.0);
+	}
+	return sum - 6;
+}
+
+uint16_t HostMcu::dev_sampleAdc(uint8_t mux) {
+	float reference;
+	switch (mux >> REFS0) {
+		case 0:
+			reference = dev_aref;
+			break;
+		case 3:
+			reference = dev_internalReference;
+			break;
+		default:
+			reference = dev_avcc;
+	}
+	byte channel = mux & 0x0F;
+	float volts;
+	if (channel < HOST_MCU_ADC_CHANNELS) {
+		volts = dev_adcWaveforms[channel] ? dev_adcWaveforms[channel]((double) dev_cycles / F_CPU) : dev_adcVoltages[channel];
+	} else if (channel == 14) {
+		volts = dev_internalReference;
+	} else if (channel == 15) {
+		volts = 0;
+	} else {
+		volts = 0.314; //Датчик температуры, около 25 градусов
+	}
+	float code = volts / reference * 1024 + 0.5; //Первый переход кода - на половине младшего разряда
+	if (dev_adcNoise > 0) code += dev_gaussian() * dev_adcNoise;
+	if (code < 0) return 0;
+	if (code > 1023) return 1023;
+	return code;
+}
+
+void HostMcu::dev_startConversion() {
+	byte prescalerBits = dev_registers[DEV_HOST_ADCSRA] & 7;
+	unsigned int prescaler = prescalerBits == 0 ? 2 : 1 << prescalerBits;
+	dev_adcConverting = true;
+	dev_adcLatchedMux = dev_registers[DEV_HOST_ADMUX];
+	dev_adcHeldSample = dev_sampleAdc(dev_adcLatchedMux);
+	dev_adcCompleteAt = dev_cycles + 13UL * prescaler;
+	dev_registers[DEV_HOST_ADCSRA] |= _BV(ADSC);
+}
+
+void HostMcu::dev_completeConversion() {
+	uint16_t value = dev_adcHeldSample;
+	if (dev_adcLatchedMux & _BV(ADLAR)) value <<= 6;
+	dev_registers[DEV_HOST_ADCL] = value & 0xFF;
+	dev_registers[DEV_HOST_ADCH] = value >> 8;
+	dev_adcConversions++;
+	uint8_t &control = dev_registers[DEV_HOST_ADCSRA];
+	control |= _BV(ADIF);
+	if ((control & _BV(ADATE)) && (dev_registers[DEV_HOST_ADCSRB] & 7) == 0) {
+		dev_startConversion(); //Free running: следующее преобразование начинается сразу, с текущим ADMUX
+	} else {
+		dev_adcConverting = false;
+		control &= ~_BV(ADSC);
+	}
+}
+
+void HostMcu::dev_writeAdcControl(uint8_t value) {
+	uint8_t control = value & ~(_BV(ADIF) | _BV(ADSC));
+	if (!(value & _BV(ADIF))) control |= dev_registers[DEV_HOST_ADCSRA] & _BV(ADIF); //Флаг сбрасывается записью единицы
+	if (!(control & _BV(ADEN))) dev_adcConverting = false; //Выключение АЦП прерывает преобразование
+	if (dev_adcConverting) control |= _BV(ADSC); //Запись нуля в ADSC ни на что не влияет
+	dev_registers[DEV_HOST_ADCSRA] = control;
+	if ((control & _BV(ADEN)) && (value & _BV(ADSC)) && !dev_adcConverting) dev_startConversion();
+	dev_dispatchInterrupts();
+}
+
+int HostMcu::dev_timerForRegister(uint8_t address) {
+	for (byte timer = 0; timer < HOST_MCU_TIMERS_COUNT; timer++) {
+		const DevHostTimer &registers = dev_hostTimers[timer];
+		if (address == registers.controlA || address == registers.controlB || address == registers.compareA || address == registers.compareB
+			|| address == registers.counter) return timer;
+		if (registers.wide && (address == registers.counter + 1 || address == registers.compareA + 1 || address == registers.compareB + 1
+			|| address == DEV_HOST_ICR1 || address == DEV_HOST_ICR1 + 1)) return timer;
+	}
+	return -1;
+}
+
+uint16_t HostMcu::dev_timerPrescaler(byte timer) {
+	static const uint16_t prescalers[8] = {0, 1, 8, 64, 256, 1024, 0, 0}; //6 и 7 - внешний тактовый сигнал, не моделируется
+	static const uint16_t prescalers2[8] = {0, 1, 8, 32, 64, 128, 256, 1024};
+	byte select = dev_registers[dev_hostTimers[timer].controlB] & 7;
+	return timer == 2 ? prescalers2[select] : prescalers[select];
+}
+
+void HostMcu::dev_timerGeometry(byte timer, uint16_t *top, boolean *dualSlope, boolean *clearOnMatch) {
+	const DevHostTimer &registers = dev_hostTimers[timer];
+	uint8_t controlA = dev_registers[registers.controlA];
+	uint8_t controlB = dev_registers[registers.controlB];
+	uint16_t compareA = dev_registers[registers.compareA];
+	if (registers.wide) compareA |= dev_registers[registers.compareA + 1] << 8;
+	*dualSlope = false;
+	*clearOnMatch = false;
+	if (!registers.wide) {
+		byte mode = (controlA & 3) | ((controlB >> 1) & 4);
+		*top = (mode == 2 || mode == 5 || mode == 7) ? compareA : 0xFF;
+		*dualSlope = mode == 1 || mode == 5;
+		*clearOnMatch = mode == 2;
+		return;
+	}
+	uint16_t capture = dev_registers[DEV_HOST_ICR1] | (dev_registers[DEV_HOST_ICR1 + 1] << 8);
+	byte mode = (controlA & 3) | ((controlB >> 1) & 12);
+	static const uint16_t fixedTops[4] = {0xFFFF, 0xFF, 0x1FF, 0x3FF};
+	switch (mode) {
+		case 1: case 2: case 3:
+			*top = fixedTops[mode];
+			*dualSlope = true;
+			break;
+		case 4:
+			*top = compareA;
+			*clearOnMatch = true;
+			break;
+		case 5: case 6: case 7:
+			*top = fixedTops[mode - 4];
+			break;
+		case 8: case 10:
+			*top = capture;
+			*dualSlope = true;
+			break;
+		case 9: case 11:
+			*top = compareA;
+			*dualSlope = true;
+			break;
+		case 12:
+			*top = capture;
+			*clearOnMatch = true;
+			break;
+		case 14:
+			*top = capture;
+			break;
+		case 15:
+			*top = compareA;
+			break;
+		default:
+			*top = 0xFFFF;
+	}
+}
+
+uint16_t HostMcu::dev_timerCount(byte timer) {
+	uint16_t prescaler = dev_timerPrescaler(timer);
+	if (prescaler == 0) return dev_timerStoppedCounts[timer];
+	uint16_t top;
+	boolean dualSlope, clearOnMatch;
+	dev_timerGeometry(timer, &top, &dualSlope, &clearOnMatch);
+	uint32_t period = dualSlope ? 2UL * top : top + 1UL;
+	if (period == 0) period = 1;
+	uint32_t position = ((dev_cycles - dev_timerOrigins[timer]) / prescaler) % period;
+	return dualSlope && position > top ? 2 * top - position : position;
+}
+
+void HostMcu::dev_timerAnchor(byte timer, uint16_t count) {
+	uint16_t prescaler = dev_timerPrescaler(timer);
+	if (prescaler == 0) {
+		dev_timerStoppedCounts[timer] = count;
+		return;
+	}
+	uint16_t top;
+	boolean dualSlope, clearOnMatch;
+	dev_timerGeometry(timer, &top, &dualSlope, &clearOnMatch);
+	if (count > top) count = 0; //На плате счётчик в этом случае досчитал бы до MAX, здесь он просто начинает заново
+	dev_timerOrigins[timer] = dev_cycles - (uint64_t) count * prescaler; //В начале времени может "уйти в минус": арифметика по модулю 2^64
+}
+
+uint64_t HostMcu::dev_nextOccurrence(byte timer, uint32_t offset, uint32_t period) {
+	uint16_t prescaler = dev_timerPrescaler(timer);
+	uint64_t first = (dev_cycles - dev_timerOrigins[timer]) / prescaler + 1; //Первый тик после текущего момента
+	uint64_t tick = first + (offset + period - first % period) % period;
+	return dev_timerOrigins[timer] + tick * prescaler;
+}
+
+uint64_t HostMcu::dev_nextTimerEvent(byte timer, byte event) {
+	if (dev_timerPrescaler(timer) == 0) return DEV_HOST_NEVER;
+	uint16_t top;
+	boolean dualSlope, clearOnMatch;
+	dev_timerGeometry(timer, &top, &dualSlope, &clearOnMatch);
+	uint32_t period = dualSlope ? 2UL * top : top + 1UL;
+	if (period == 0) period = 1;
+	uint16_t maximum = dev_hostTimers[timer].wide ? 0xFFFF : 0xFF;
+	if (event == 2) { //Переполнение: в CTC только при TOP = MAX, в остальных режимах - по TOP (BOTTOM для двухскатных)
+		if (clearOnMatch && top != maximum) return DEV_HOST_NEVER;
+		return dev_nextOccurrence(timer, 0, period);
+	}
+	const DevHostTimer &registers = dev_hostTimers[timer];
+	uint8_t address = event == 0 ? registers.compareA : registers.compareB;
+	uint16_t compare = dev_registers[address];
+	if (registers.wide) compare |= dev_registers[address + 1] << 8;
+	if (compare > top) return DEV_HOST_NEVER;
+	if (!dualSlope) return dev_nextOccurrence(timer, (compare + 1UL) % period, period); //Флаг ставится на следующем тике после совпадения
+	uint64_t up = dev_nextOccurrence(timer, compare % period, period);
+	uint64_t down = dev_nextOccurrence(timer, (2UL * top - compare) % period, period);
+	return up < down ? up : down;
+}
+
+uint8_t HostMcu::readRegister(uint8_t address) {
+	switch (address) {
+		case DEV_HOST_PINB:
+		case DEV_HOST_PINC:
+		case DEV_HOST_PIND:
+			return dev_readPins(address);
+		case DEV_HOST_ADCSRA:
+			//Одиночное преобразование: опрос ADSC в цикле ожидания сразу переносит время на конец преобразования
+			if (dev_adcConverting && !(dev_registers[address] & _BV(ADATE))) dev_runUntil(dev_adcCompleteAt, 0xFFFF);
+			return dev_registers[address];
+	}
+	int timer = dev_timerForRegister(address);
+	if (timer >= 0 && (address == dev_hostTimers[timer].counter || (dev_hostTimers[timer].wide && address == dev_hostTimers[timer].counter + 1))) {
+		uint16_t count = dev_timerCount(timer);
+		return address == dev_hostTimers[timer].counter ? count & 0xFF : count >> 8;
+	}
+	return dev_registers[address];
+}
+
+uint16_t HostMcu::readRegister16(uint8_t address) {
+	uint8_t low = readRegister(address);
+	return low | (readRegister(address + 1) << 8);
+}
+
+void HostMcu::writeRegister(uint8_t address, uint8_t value) {
+	switch (address) {
+		case DEV_HOST_PINB:
+		case DEV_HOST_PINC:
+		case DEV_HOST_PIND:
+			dev_writePort(address, address, value);
+			return;
+		case DEV_HOST_PINB + 1:
+		case DEV_HOST_PINB + 2:
+		case DEV_HOST_PINC + 1:
+		case DEV_HOST_PINC + 2:
+		case DEV_HOST_PIND + 1:
+		case DEV_HOST_PIND + 2:
+			dev_writePort(address - (address - DEV_HOST_PINB) % 3, address, value);
+			return;
+		case 0x35:
+		case 0x36:
+		case 0x37:
+		case DEV_HOST_PCIFR:
+			dev_registers[address] &= ~value; //Флаги прерываний таймеров и смены уровня сбрасываются записью единицы
+			return;
+		case DEV_HOST_WDTCSR:
+			dev_registers[address] = (value & ~_BV(WDIF)) | (dev_registers[address] & _BV(WDIF) & ~value);
+			dev_dispatchInterrupts();
+			return;
+		case DEV_HOST_PCICR:
+		case 0x6E:
+		case 0x6F:
+		case 0x70:
+			dev_registers[address] = value;
+			dev_dispatchInterrupts(); //Разрешили прерывание с уже поднятым флагом - оно срабатывает сразу
+			return;
+		case DEV_HOST_SREG: {
+			boolean enabling = !(dev_registers[address] & _BV(SREG_I)) && (value & _BV(SREG_I));
+			dev_registers[address] = value;
+			if (enabling) dev_dispatchInterrupts();
+			return;
+		}
+		case DEV_HOST_ADCSRA:
+			dev_writeAdcControl(value);
+			return;
+		case DEV_HOST_ADCL:
+		case DEV_HOST_ADCH:
+			return; //Только для чтения
+	}
+	int timer = dev_timerForRegister(address);
+	if (timer < 0) {
+		dev_registers[address] = value;
+		return;
+	}
+	const DevHostTimer &registers = dev_hostTimers[timer];
+	uint16_t count = dev_timerCount(timer);
+	if (address == registers.counter) {
+		count = (count & 0xFF00) | value;
+	} else if (registers.wide && address == registers.counter + 1) {
+		count = (count & 0x00FF) | (value << 8);
+	} else {
+		dev_registers[address] = value;
+	}
+	dev_timerAnchor(timer, count);
+}
+
+void HostMcu::writeRegister16(uint8_t address, uint16_t value) {
+	int timer = dev_timerForRegister(address);
+	if (timer < 0) {
+		writeRegister(address + 1, value >> 8);
+		writeRegister(address, value & 0xFF);
+		return;
+	}
+	uint16_t count = dev_timerCount(timer);
+	if (address == dev_hostTimers[timer].counter) {
+		count = value;
+	} else {
+		dev_registers[address] = value & 0xFF;
+		dev_registers[address + 1] = value >> 8;
+	}
+	dev_timerAnchor(timer, count);
+}
+
+void HostMcu::serialInput(const uint8_t *data, size_t size) {
+	dev_serialInput.insert(dev_serialInput.end(), data, data + size);
+}
+
+void HostMcu::serialInput(const char *text) {
+	serialInput((const uint8_t *) text, strlen(text));
+}
+
+void HostMcu::serialReceive(const uint8_t *data, size_t size) {
+	if (dev_serialBaud == 0) {
+		dev_serialLostBytes += size;
+		return;
+	}
+	uint64_t byteCycles = dev_serialByteCycles();
+	if (dev_serialRxEnd < dev_cycles) dev_serialRxEnd = dev_cycles;
+	for (size_t i = 0; i < size; i++) {
+		dev_serialRxEnd += byteCycles;
+		uint8_t value = data[i];
+		scheduleAction(dev_serialRxEnd, [this, value]() {
+			dev_serialPush(value);
+		});
+	}
+}
+
+void HostMcu::dev_serialPush(uint8_t value) {
+	if (dev_serialInput.size() >= HOST_MCU_SERIAL_BUFFER) {
+		dev_serialLostBytes++; //Переполнение приёмника: скетч не успевает читать
+		return;
+	}
+	dev_serialInput.push_back(value);
+}
+
+std::string HostMcu::takeSerialOutput() {
+	std::string output;
+	output.swap(dev_serialOutput);
+	return output;
+}
+
+unsigned long HostMcu::getSerialBaud() {
+	return dev_serialBaud;
+}
+
+unsigned long HostMcu::getSerialLostBytes() {
+	return dev_serialLostBytes;
+}
+
+uint64_t HostMcu::getSerialTxEndCycle() {
+	return dev_serialTxEnd > dev_cycles ? dev_serialTxEnd : dev_cycles;
+}
+
+uint64_t HostMcu::dev_serialByteCycles() {
+	return 10ULL * F_CPU / dev_serialBaud; //Старт, 8 бит данных, стоп; погрешность делителя UBRR не моделируется
+}
+
+int HostMcu::serialAvailable() {
+	return dev_serialInput.size();
+}
+
+int HostMcu::serialRead(boolean remove) {
+	if (dev_serialInput.empty()) return -1;
+	uint8_t value = dev_serialInput.front();
+	if (remove) dev_serialInput.pop_front();
+	return value;
+}
+
+void HostMcu::serialWrite(uint8_t value) {
+	if (dev_serialBaud != 0) {
+		uint64_t byteCycles = dev_serialByteCycles();
+		if (dev_serialTxEnd < dev_cycles) dev_serialTxEnd = dev_cycles;
+		uint64_t queued = dev_serialTxEnd - dev_cycles;
+		if (queued > (HOST_MCU_SERIAL_BUFFER - 1) * byteCycles) { //Буфер передачи полон: write() ждёт, прерывания работают
+			advanceCycles(queued - (HOST_MCU_SERIAL_BUFFER - 1) * byteCycles);
+		}
+		dev_serialTxEnd += byteCycles;
+	}
+	dev_serialOutput.push_back(value);
+}
+
+int HostMcu::serialAvailableForWrite() {
+	if (dev_serialBaud == 0 || dev_serialTxEnd <= dev_cycles) return HOST_MCU_SERIAL_BUFFER - 1;
+	uint64_t byteCycles = dev_serialByteCycles();
+	uint64_t queued = (dev_serialTxEnd - dev_cycles + byteCycles - 1) / byteCycles;
+	return queued >= HOST_MCU_SERIAL_BUFFER ? 0 : HOST_MCU_SERIAL_BUFFER - queued; //Один байт - в сдвиговом регистре
+}
+
+void HostMcu::serialBegin(unsigned long baud) {
+	dev_serialBaud = baud;
+}
+
+void HostMcu::serialFlush() {
+	if (dev_serialTxEnd > dev_cycles) advanceCycles(dev_serialTxEnd - dev_cycles);
+}
+
+uint8_t hostMcuReadRegister(uint8_t address) {
+	return HostMcu::current().readRegister(address);
+}
+
+void hostMcuWriteRegister(uint8_t address, uint8_t value) {
+	HostMcu::current().writeRegister(address, value);
+}
+
+uint16_t hostMcuReadRegister16(uint8_t address) {
+	return HostMcu::current().readRegister16(address);
+}
+
+void hostMcuWriteRegister16(uint8_t address, uint16_t value) {
+	HostMcu::current().writeRegister16(address, value);
+}
+
+void hostMcuSleep() {
+	HostMcu::current().sleepUntilInterrupt();
+}
+
+void hostMcuWatchdogReset() {
+	HostMcu::current().watchdogReset();
+}
+
+//Обработчики по умолчанию: скетч или тест заменяет нужные своими ISR(...)
+#define DEV_HOST_DEFAULT_VECTOR(vector) extern "C" __attribute__((weak)) void vector(void) {}
+DEV_HOST_DEFAULT_VECTOR(PCINT0_vect)
+DEV_HOST_DEFAULT_VECTOR(PCINT1_vect)
+DEV_HOST_DEFAULT_VECTOR(PCINT2_vect)
+DEV_HOST_DEFAULT_VECTOR(TIMER2_COMPA_vect)
+DEV_HOST_DEFAULT_VECTOR(TIMER2_COMPB_vect)
+DEV_HOST_DEFAULT_VECTOR(TIMER2_OVF_vect)
+DEV_HOST_DEFAULT_VECTOR(TIMER1_COMPA_vect)
+DEV_HOST_DEFAULT_VECTOR(TIMER1_COMPB_vect)
+DEV_HOST_DEFAULT_VECTOR(TIMER1_OVF_vect)
+DEV_HOST_DEFAULT_VECTOR(TIMER0_COMPA_vect)
+DEV_HOST_DEFAULT_VECTOR(TIMER0_COMPB_vect)
+DEV_HOST_DEFAULT_VECTOR(TIMER0_OVF_vect)
+DEV_HOST_DEFAULT_VECTOR(ADC_vect)
+DEV_HOST_DEFAULT_VECTOR(WDT_vect)
@@ -0,0 +1,196 @@
+/**
+	HostMcu_h - эмулятор ATmega328P (Arduino Uno) для сборки, проверки и измерения библиотек MYLIB_* на компьютере.
+	Эмулятор хранит всё, что на плате хранит железо: регистры, модельное время в тактах (F_CPU), уровни ног, источники сигнала для АЦП,
+	состояние таймеров и последовательного порта. Библиотеки работают с ним через обычные регистры и функции ядра Arduino (см. Arduino.h).
+
+	Каждый поток работает со своим текущим эмулятором. По умолчанию это общий экземпляр, другой можно выбрать методом select(), вернуться к общему -
+	статическим методом selectDefault().
+	Так в одном процессе можно моделировать несколько независимых устройств. Пример теста:
+		HostMcu &mcu = HostMcu::current();
+		mcu.reset();
+		mcu.setAdcVoltage(0, 2.5);
+		Voltmeter battery(A0);
+		battery.processMeasurement(); //Ожидание окончания преобразования сдвигает модельное время
+		mcu.advanceMillis(10); //Таймеры и АЦП работают, прерывания вызываются по ходу времени
+
+	Время:
+		* getCycles(), getMicros(), getMillis() - модельное время с момента reset().
+		* advanceCycles(), advanceMicros(), advanceMillis() - сдвинуть время. По дороге завершаются преобразования АЦП, срабатывают таймеры и
+			вызываются разрешённые обработчики прерываний (ISR), если в SREG установлен флаг I.
+		* sleepUntilInterrupt() - вызывается из sleep_cpu(). Сдвигает время до ближайшего прерывания, которое может разбудить контроллер в режиме,
+			заданном в SMCR. Таймеры 0 и 1 и АЦП в глубоких режимах сна стоят, Timer2 стоит в power-down и standby (асинхронный режим не моделируется).
+			Если разбудить контроллер нечему, возвращает false и время не сдвигает.
+			getSleepCycles() - сколько тактов контроллер проспал, getSleepCycles(SLEEP_MODE_*) - сколько проспал в заданном режиме.
+		* scheduleAction(cycle, action) - выполнить действие (например, нажать кнопку через setPinInput()) в заданный такт модельного времени,
+			в том числе во время сна.
+	Ноги (номера как на Arduino Uno: 0-13 цифровые, 14-19 - A0-A5):
+		* setPinInput(pin, level) - подать на ногу внешний уровень, releasePin(pin) - отпустить (нога висит в воздухе или подтянута к питанию).
+		* getPinLevel(pin), getPinMode(pin) - уровень и режим ноги. getPwm(pin) - последнее значение analogWrite() (-1, если ШИМ выключен).
+		* setPinListener(listener) - вызывается при каждом изменении уровня выхода.
+		* Изменение уровня ноги, разрешённой в PCMSKn, ставит флаг в PCIFR и вызывает PCINTn_vect (если разрешено в PCICR), в том числе будит из любого сна.
+		* getToneFrequency(pin) - частота tone() на ноге (0 - тишина).
+		* getCompareOutputFrequency(pin) - частота меандра на выходе сравнения таймера (OC0A/B - ноги 6, 5, OC1A/B - 9, 10, OC2A/B - 11, 3),
+			если выход в режиме переключения (COMnx = 01), нога настроена на выход, а таймер идёт в режиме Normal или CTC. Иначе 0.
+	АЦП:
+		* setAdcVoltage(channel, volts) - постоянное напряжение на входе, setAdcWaveform(channel, waveform) - напряжение как функция времени в секундах.
+		* setAdcNoise(lsbRms) - нормальный шум с заданным СКО в единицах младшего разряда. setReferenceVoltages() - напряжения AVCC, AREF и внутреннего источника.
+		* Преобразование длится 13 тактов АЦП. Напряжение и ADMUX запоминаются в начале преобразования, как на плате,
+			поэтому в режиме непрерывного преобразования новый ADMUX действует только со следующего преобразования.
+		* getAdcConversionsCount() - количество завершённых преобразований.
+	Последовательный порт: serialInput() - подать принятые байты, takeSerialOutput() - забрать переданные.
+		* serialInput() кладёт байты в приёмный буфер сразу и без ограничения размера - удобно для тестов разбора команд.
+		* serialReceive() передаёт байты по линии со скоростью Serial.begin() (10 бит на байт) вслед за ещё не принятыми: каждый байт
+			появляется в приёмном буфере в свой такт модельного времени. Буфер, как у HardwareSerial, - HOST_MCU_SERIAL_BUFFER байт,
+			байт, не поместившийся в буфер (или пришедший до Serial.begin()), теряется - getSerialLostBytes().
+		* После Serial.begin() передача тоже занимает время: write() ждёт (сдвигая модельное время), пока в буфере передачи
+			на HOST_MCU_SERIAL_BUFFER байт не освободится место, flush() - пока не уйдёт последний байт.
+			getSerialTxEndCycle() - такт, в который линия передачи освободится.
+	Таймеры 0, 1, 2 считают по настройкам предделителя и режима (WGM), ставят флаги совпадения и переполнения и вызывают прерывания.
+	Сторожевой таймер (WDTCSR, avr/wdt.h) в режиме прерывания вызывает WDT_vect раз в 16 мс * 2^WDP и будит из любого сна.
+	После reset() таймеры и АЦП настроены так же, как их настраивает ядро Arduino при запуске, прерывания разрешены.
+*/
+
+#ifndef HostMcu_h
+#define HostMcu_h
+
+#include "Arduino.h"
+#include <functional>
+#include <deque>
+#include <map>
+#include <string>
+
+#define HOST_MCU_PINS_COUNT 20
+#define HOST_MCU_ADC_CHANNELS 8
+#define HOST_MCU_TIMERS_COUNT 3
+#define HOST_MCU_SERIAL_BUFFER 64
+
+#define DEV_HOST_SOURCE_ADC 0 //Источники событий модельного времени
+#define DEV_HOST_SOURCE_TIMER 1 //Три события на таймер: совпадение A, совпадение B, переполнение
+#define DEV_HOST_SOURCE_TONE 10
+#define DEV_HOST_SOURCE_WATCHDOG 11
+#define DEV_HOST_SOURCE_ACTION 12
+#define DEV_HOST_SOURCES_COUNT 13
+#define DEV_HOST_SOURCE_NONE 0xFF //Прерывание не от события модельного времени (смена уровня ноги)
+
+class HostMcu {
+	public:
+		HostMcu();
+		void select();
+		static void selectDefault();
+		static HostMcu &current();
+		void reset();
+		uint64_t getCycles();
+		unsigned long getMicros();
+		unsigned long getMillis();
+		void advanceCycles(uint64_t cycles);
+		void advanceMicros(unsigned long us);
+		void advanceMillis(unsigned long ms);
+		boolean sleepUntilInterrupt();
+		uint64_t getSleepCycles();
+		uint64_t getSleepCycles(uint8_t sleepMode);
+		void scheduleAction(uint64_t cycle, std::function<void ()> action);
+		unsigned long getInterruptsCount();
+		byte getInterruptDepth();
+		void setPinInput(byte pin, byte level);
+		void releasePin(byte pin);
+		byte getPinLevel(byte pin);
+		byte getPinMode(byte pin);
+		int getPwm(byte pin);
+		void setPinListener(std::function<void (byte pin, byte level)> listener);
+		unsigned int getToneFrequency(byte pin);
+		double getCompareOutputFrequency(byte pin);
+		void setAdcVoltage(byte channel, float volts);
+		void setAdcWaveform(byte channel, std::function<float (double seconds)> waveform);
+		void setAdcNoise(float lsbRms, uint32_t seed = 1);
+		void setReferenceVoltages(float avcc, float aref, float internal = 1.1);
+		unsigned long getAdcConversionsCount();
+		void serialInput(const uint8_t *data, size_t size);
+		void serialInput(const char *text);
+		void serialReceive(const uint8_t *data, size_t size);
+		std::string takeSerialOutput();
+		unsigned long getSerialBaud();
+		unsigned long getSerialLostBytes();
+		uint64_t getSerialTxEndCycle();
+
+		//Для ядра Arduino (HostArduino.cpp) и регистров (avr/io.h)
+		uint8_t readRegister(uint8_t address);
+		void writeRegister(uint8_t address, uint8_t value);
+		uint16_t readRegister16(uint8_t address);
+		void writeRegister16(uint8_t address, uint16_t value);
+		static uint8_t pinPortAddress(byte pin, byte *bit);
+		void setPwmOutput(byte pin, int value);
+		void startTone(byte pin, unsigned int frequency, unsigned long duration);
+		void stopTone(byte pin);
+		void setAnalogReference(uint8_t mode);
+		uint8_t getAnalogReference();
+		int serialAvailable();
+		int serialRead(boolean remove);
+		void serialWrite(uint8_t value);
+		int serialAvailableForWrite();
+		void serialBegin(unsigned long baud);
+		void serialFlush();
+		void watchdogReset();
+	private:
+		uint8_t dev_registers[0x100];
+		uint64_t dev_cycles;
+		uint64_t dev_sleepCycles;
+		uint64_t dev_sleepModeCycles[8];
+		std::multimap<uint64_t, std::function<void ()> > dev_actions;
+		uint64_t dev_watchdogOrigin;
+		uint8_t dev_pinChangeLevels[3]; //Уровни портов B, C, D при последней проверке смены уровня
+		unsigned long dev_interruptsCount;
+		byte dev_interruptDepth;
+		int8_t dev_externalLevels[HOST_MCU_PINS_COUNT]; //-1 - на ногу ничего не подано
+		int8_t dev_outputLevels[HOST_MCU_PINS_COUNT]; //-1 - нога не выход
+		int dev_pwm[HOST_MCU_PINS_COUNT];
+		std::function<void (byte pin, byte level)> dev_pinListener;
+		byte dev_tonePin;
+		unsigned int dev_toneFrequency;
+		uint64_t dev_toneEnd;
+		uint8_t dev_analogReference;
+		boolean dev_adcConverting;
+		uint64_t dev_adcCompleteAt;
+		uint8_t dev_adcLatchedMux;
+		uint16_t dev_adcHeldSample; //Выборка-хранение в начале преобразования
+		unsigned long dev_adcConversions;
+		float dev_adcVoltages[HOST_MCU_ADC_CHANNELS];
+		std::function<float (double seconds)> dev_adcWaveforms[HOST_MCU_ADC_CHANNELS];
+		float dev_adcNoise;
+		uint64_t dev_randomState;
+		float dev_avcc;
+		float dev_aref;
+		float dev_internalReference;
+		uint64_t dev_timerOrigins[HOST_MCU_TIMERS_COUNT]; //Такт, на котором счётчик был равен 0
+		uint16_t dev_timerStoppedCounts[HOST_MCU_TIMERS_COUNT];
+		std::deque<uint8_t> dev_serialInput;
+		std::string dev_serialOutput;
+		unsigned long dev_serialBaud;
+		unsigned long dev_serialLostBytes;
+		uint64_t dev_serialRxEnd; //Такт, в который будет принят последний байт, переданный serialReceive()
+		uint64_t dev_serialTxEnd; //Такт, в который уйдёт последний байт из буфера передачи
+		uint64_t dev_serialByteCycles();
+		void dev_serialPush(uint8_t value);
+		void dev_runUntil(uint64_t target, uint16_t sourcesMask);
+		void dev_collectEventTimes(uint64_t *times);
+		void dev_processEvent(byte source);
+		void dev_dispatchInterrupts();
+		void dev_writePort(uint8_t pinAddress, uint8_t address, uint8_t value);
+		uint8_t dev_readPins(uint8_t pinAddress);
+		void dev_notifyPins(uint8_t pinAddress);
+		void dev_checkPinChange();
+		uint64_t dev_nextWatchdogEvent();
+		void dev_writeAdcControl(uint8_t value);
+		void dev_startConversion();
+		void dev_completeConversion();
+		uint16_t dev_sampleAdc(uint8_t mux);
+		float dev_gaussian();
+		uint16_t dev_timerPrescaler(byte timer);
+		void dev_timerGeometry(byte timer, uint16_t *top, boolean *dualSlope, boolean *clearOnMatch);
+		uint16_t dev_timerCount(byte timer);
+		void dev_timerAnchor(byte timer, uint16_t count);
+		uint64_t dev_nextTimerEvent(byte timer, byte event);
+		uint64_t dev_nextOccurrence(byte timer, uint32_t offset, uint32_t period);
+		static int dev_timerForRegister(uint8_t address);
+};
+
+#endif
@@ -0,0 +1,314 @@
+/**
+	WString_h (компьютер) - класс String с тем же набором методов, что и в ядре Arduino (основная часть), для сборки библиотек на компьютере.
+	Строка хранится в std::string, поэтому поведение при нехватке памяти отличается от Arduino: память не кончается.
+*/
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+static std::string hostNumberToText(unsigned long value, unsigned char base, bool negative) {
+	if (base < 2 || base > 36) base = 10;
+	char buffer[8 * sizeof(unsigned long) + 2];
+	char *position = buffer + sizeof(buffer) - 1;
+	*position = 0;
+	do {
+		unsigned char digit = value % base;
+		*--position = digit < 10 ? '0' + digit : 'A' + digit - 10;
+		value /= base;
+	} while (value != 0);
+	if (negative) *--position = '-';
+	return position;
+}
+
+String::String(const char *text) : dev_text(text == NULL ? "" : text) {}
+
+String::String(const String &other) : dev_text(other.dev_text) {}
+
+String::String(char symbol) : dev_text(1, symbol) {}
+
+String::String(unsigned char value, unsigned char base) : dev_text(hostNumberToText(value, base, false)) {}
+
+String::String(int value, unsigned char base) : dev_text(base == 10 && value < 0 ? hostNumberToText(-(long) value, 10, true) 
+	: hostNumberToText(base == 10 ? (unsigned long) value : (unsigned int) value, base, false)) {}
+
+String::String(unsigned int value, unsigned char base) : dev_text(hostNumberToText(value, base, false)) {}
+
+String::String(long value, unsigned char base) : dev_text(base == 10 && value < 0 ? hostNumberToText(-(unsigned long) value, 10, true) 
+	: hostNumberToText((unsigned long) value, base, false)) {}
+
+String::String(unsigned long value, unsigned char base) : dev_text(hostNumberToText(value, base, false)) {}
+
+String::String(float value, unsigned char decimalPlaces) {
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "%.*f", decimalPlaces, (double) value);
+	dev_text = buffer;
+}
+
+String::String(double value, unsigned char decimalPlaces) {
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "%.*f", decimalPlaces, value);
+	dev_text = buffer;
+}
+
+String &String::operator=(const String &other) {
+	dev_text = other.dev_text;
+	return *this;
+}
+
+String &String::operator=(const char *text) {
+	dev_text = text == NULL ? "" : text;
+	return *this;
+}
+
+unsigned int String::length() const {
+	return dev_text.size();
+}
+
+const char *String::c_str() const {
+	return dev_text.c_str();
+}
+
+char String::charAt(unsigned int index) const {
+	return index < dev_text.size() ? dev_text[index] : 0;
+}
+
+void String::setCharAt(unsigned int index, char symbol) {
+	if (index < dev_text.size()) dev_text[index] = symbol;
+}
+
+char String::operator[](unsigned int index) const {
+	return charAt(index);
+}
+
+char &String::operator[](unsigned int index) {
+	static char dummy; //Как в Arduino: запись за пределы строки уходит в никуда
+	if (index >= dev_text.size()) {
+		dummy = 0;
+		return dummy;
+	}
+	return dev_text[index];
+}
+
+boolean String::concat(const String &other) {
+	dev_text += other.dev_text;
+	return true;
+}
+
+boolean String::concat(const char *text) {
+	if (text == NULL) return false;
+	dev_text += text;
+	return true;
+}
+
+boolean String::concat(char symbol) {
+	dev_text += symbol;
+	return true;
+}
+
+boolean String::concat(int value) {
+	return concat(String(value));
+}
+
+boolean String::concat(unsigned int value) {
+	return concat(String(value));
+}
+
+boolean String::concat(long value) {
+	return concat(String(value));
+}
+
+boolean String::concat(unsigned long value) {
+	return concat(String(value));
+}
+
+String &String::operator+=(const String &other) {
+	concat(other);
+	return *this;
+}
+
+String &String::operator+=(const char *text) {
+	concat(text);
+	return *this;
+}
+
+String &String::operator+=(char symbol) {
+	concat(symbol);
+	return *this;
+}
+
+String &String::operator+=(int value) {
+	concat(value);
+	return *this;
+}
+
+String &String::operator+=(unsigned int value) {
+	concat(value);
+	return *this;
+}
+
+String &String::operator+=(long value) {
+	concat(value);
+	return *this;
+}
+
+String &String::operator+=(unsigned long value) {
+	concat(value);
+	return *this;
+}
+
+boolean String::equals(const String &other) const {
+	return dev_text == other.dev_text;
+}
+
+boolean String::equals(const char *text) const {
+	return dev_text == (text == NULL ? "" : text);
+}
+
+boolean String::operator==(const String &other) const {
+	return equals(other);
+}
+
+boolean String::operator==(const char *text) const {
+	return equals(text);
+}
+
+boolean String::operator!=(const String &other) const {
+	return !equals(other);
+}
+
+boolean String::operator!=(const char *text) const {
+	return !equals(text);
+}
+
+int String::compareTo(const String &other) const {
+	return dev_text.compare(other.dev_text);
+}
+
+boolean String::startsWith(const String &prefix) const {
+	return dev_text.compare(0, prefix.dev_text.size(), prefix.dev_text) == 0;
+}
+
+boolean String::endsWith(const String &suffix) const {
+	return dev_text.size() >= suffix.dev_text.size() 
+		&& dev_text.compare(dev_text.size() - suffix.dev_text.size(), suffix.dev_text.size(), suffix.dev_text) == 0;
+}
+
+int String::indexOf(char symbol, unsigned int fromIndex) const {
+	size_t position = dev_text.find(symbol, fromIndex);
+	return position == std::string::npos ? -1 : (int) position;
+}
+
+int String::indexOf(const String &text, unsigned int fromIndex) const {
+	size_t position = dev_text.find(text.dev_text, fromIndex);
+	return position == std::string::npos ? -1 : (int) position;
+}
+
+int String::lastIndexOf(char symbol) const {
+	size_t position = dev_text.rfind(symbol);
+	return position == std::string::npos ? -1 : (int) position;
+}
+
+String String::substring(unsigned int beginIndex) const {
+	return substring(beginIndex, dev_text.size());
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+	if (beginIndex > endIndex) {
+		unsigned int temp = beginIndex;
+		beginIndex = endIndex;
+		endIndex = temp;
+	}
+	if (beginIndex >= dev_text.size()) return String();
+	if (endIndex > dev_text.size()) endIndex = dev_text.size();
+	return String(dev_text.substr(beginIndex, endIndex - beginIndex).c_str());
+}
+
+void String::replace(char find, char replacement) {
+	for (size_t i = 0; i < dev_text.size(); i++) {
+		if (dev_text[i] == find) dev_text[i] = replacement;
+	}
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+	if (index >= dev_text.size()) return;
+	dev_text.erase(index, count);
+}
+
+void String::toUpperCase() {
+	for (size_t i = 0; i < dev_text.size(); i++) dev_text[i] = toupper((unsigned char) dev_text[i]);
+}
+
+void String::toLowerCase() {
+	for (size_t i = 0; i < dev_text.size(); i++) dev_text[i] = tolower((unsigned char) dev_text[i]);
+}
+
+void String::trim() {
+	size_t begin = dev_text.find_first_not_of(" \t\r\n\f\v");
+	if (begin == std::string::npos) {
+		dev_text.clear();
+		return;
+	}
+	size_t end = dev_text.find_last_not_of(" \t\r\n\f\v");
+	dev_text = dev_text.substr(begin, end - begin + 1);
+}
+
+long String::toInt() const {
+	return atol(dev_text.c_str());
+}
+
+float String::toFloat() const {
+	return atof(dev_text.c_str());
+}
+
+boolean String::reserve(unsigned int size) {
+	dev_text.reserve(size);
+	return true;
+}
+
+String operator+(const String &left, const String &right) {
+	String result(left);
+	result += right;
+	return result;
+}
+
+String operator+(const String &left, const char *right) {
+	String result(left);
+	result += right;
+	return result;
+}
+
+String operator+(const char *left, const String &right) {
+	String result(left);
+	result += right;
+	return result;
+}
+
+String operator+(const String &left, char right) {
+	String result(left);
+	result += right;
+	return result;
+}
+
+String operator+(char left, const String &right) {
+	String result(left);
+	result += right;
+	return result;
+}
+
+String operator+(const String &left, int right) {
+	return left + String(right);
+}
+
+String operator+(const String &left, unsigned int right) {
+	return left + String(right);
+}
+
+String operator+(const String &left, long right) {
+	return left + String(right);
+}
+
+String operator+(const String &left, unsigned long right) {
+	return left + String(right);
+}
@@ -0,0 +1,82 @@
+/**
+	WString_h (компьютер) - класс String с тем же набором методов, что и в ядре Arduino (основная часть), для сборки библиотек на компьютере.
+	Строка хранится в std::string, поэтому поведение при нехватке памяти отличается от Arduino: память не кончается.
+*/
+
+#ifndef HostWString_h
+#define HostWString_h
+
+#include <string>
+#include <stddef.h>
+
+class String {
+	public:
+		String(const char *text = "");
+		String(const String &other);
+		explicit String(char symbol);
+		explicit String(unsigned char value, unsigned char base = 10);
+		explicit String(int value, unsigned char base = 10);
+		explicit String(unsigned int value, unsigned char base = 10);
+		explicit String(long value, unsigned char base = 10);
+		explicit String(unsigned long value, unsigned char base = 10);
+		explicit String(float value, unsigned char decimalPlaces = 2);
+		explicit String(double value, unsigned char decimalPlaces = 2);
+		String &operator=(const String &other);
+		String &operator=(const char *text);
+		unsigned int length() const;
+		const char *c_str() const;
+		char charAt(unsigned int index) const;
+		void setCharAt(unsigned int index, char symbol);
+		char operator[](unsigned int index) const;
+		char &operator[](unsigned int index);
+		boolean concat(const String &other);
+		boolean concat(const char *text);
+		boolean concat(char symbol);
+		boolean concat(int value);
+		boolean concat(unsigned int value);
+		boolean concat(long value);
+		boolean concat(unsigned long value);
+		String &operator+=(const String &other);
+		String &operator+=(const char *text);
+		String &operator+=(char symbol);
+		String &operator+=(int value);
+		String &operator+=(unsigned int value);
+		String &operator+=(long value);
+		String &operator+=(unsigned long value);
+		boolean equals(const String &other) const;
+		boolean equals(const char *text) const;
+		boolean operator==(const String &other) const;
+		boolean operator==(const char *text) const;
+		boolean operator!=(const String &other) const;
+		boolean operator!=(const char *text) const;
+		int compareTo(const String &other) const;
+		boolean startsWith(const String &prefix) const;
+		boolean endsWith(const String &suffix) const;
+		int indexOf(char symbol, unsigned int fromIndex = 0) const;
+		int indexOf(const String &text, unsigned int fromIndex = 0) const;
+		int lastIndexOf(char symbol) const;
+		String substring(unsigned int beginIndex) const;
+		String substring(unsigned int beginIndex, unsigned int endIndex) const;
+		void replace(char find, char replacement);
+		void remove(unsigned int index, unsigned int count = (unsigned int) -1);
+		void toUpperCase();
+		void toLowerCase();
+		void trim();
+		long toInt() const;
+		float toFloat() const;
+		boolean reserve(unsigned int size);
+	private:
+		std::string dev_text;
+};
+
+String operator+(const String &left, const String &right);
+String operator+(const String &left, const char *right);
+String operator+(const char *left, const String &right);
+String operator+(const String &left, char right);
+String operator+(char left, const String &right);
+String operator+(const String &left, int right);
+String operator+(const String &left, unsigned int right);
+String operator+(const String &left, long right);
+String operator+(const String &left, unsigned long right);
+
+#endif
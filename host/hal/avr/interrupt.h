@@ -0,0 +1,45 @@
+/**
+	avr/interrupt.h (компьютер) - обработчики прерываний для эмулятора контроллера.
+	ISR(вектор) объявляет обычную функцию с именем вектора. Эмулятор (HostMcu.h) вызывает её, когда по ходу модельного времени срабатывает
+	разрешённое прерывание и в SREG установлен флаг I. Для векторов, которые скетч не объявил, есть пустые обработчики по умолчанию.
+	cli() и sei() меняют флаг I в SREG. Если после sei() есть ожидающие прерывания, их обработчики вызываются сразу.
+*/
+
+#ifndef HostAvrInterrupt_h
+#define HostAvrInterrupt_h
+
+#include <avr/io.h>
+
+#define ISR(vector, ...) extern "C" void vector(void)
+#define SIGNAL(vector) extern "C" void vector(void)
+#define EMPTY_INTERRUPT(vector) extern "C" void vector(void) {}
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR_NAKED
+
+extern "C" {
+	void PCINT0_vect(void);
+	void PCINT1_vect(void);
+	void PCINT2_vect(void);
+	void WDT_vect(void);
+	void TIMER2_COMPA_vect(void);
+	void TIMER2_COMPB_vect(void);
+	void TIMER2_OVF_vect(void);
+	void TIMER1_COMPA_vect(void);
+	void TIMER1_COMPB_vect(void);
+	void TIMER1_OVF_vect(void);
+	void TIMER0_COMPA_vect(void);
+	void TIMER0_COMPB_vect(void);
+	void TIMER0_OVF_vect(void);
+	void ADC_vect(void);
+}
+
+inline void cli() {
+	SREG &= ~_BV(SREG_I);
+}
+
+inline void sei() {
+	SREG |= _BV(SREG_I);
+}
+
+#endif
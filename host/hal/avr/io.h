@@ -0,0 +1,311 @@
+/**
+	avr/io.h (компьютер) - регистры ATmega328P для сборки библиотек на компьютере.
+	Каждый регистр - это макрос, как и в настоящем avr/io.h, но вместо адреса памяти он даёт объект HostRegister8/HostRegister16.
+	Чтение и запись такого объекта попадают в эмулятор контроллера (HostMcu.h), который ведёт себя как железо: запись ADSC в ADCSRA запускает
+	преобразование, запись единицы в флаг прерывания его сбрасывает, PINx возвращает уровни ног и т.д.
+	Адреса регистров совпадают с адресами ATmega328P в пространстве данных.
+*/
+
+#ifndef HostAvrIo_h
+#define HostAvrIo_h
+
+#include <stdint.h>
+
+uint8_t hostMcuReadRegister(uint8_t address);
+void hostMcuWriteRegister(uint8_t address, uint8_t value);
+uint16_t hostMcuReadRegister16(uint8_t address);
+void hostMcuWriteRegister16(uint8_t address, uint16_t value);
+
+class HostRegister8 {
+	public:
+		explicit HostRegister8(uint8_t address) : dev_address(address) {}
+		operator uint8_t() const {
+			return hostMcuReadRegister(dev_address);
+		}
+		HostRegister8 &operator=(unsigned int value) {
+			hostMcuWriteRegister(dev_address, (uint8_t) value);
+			return *this;
+		}
+		HostRegister8 &operator=(const HostRegister8 &other) {
+			return *this = (uint8_t) other;
+		}
+		HostRegister8 &operator|=(unsigned int value) {
+			return *this = (uint8_t) *this | value;
+		}
+		HostRegister8 &operator&=(unsigned int value) {
+			return *this = (uint8_t) *this & value;
+		}
+		HostRegister8 &operator^=(unsigned int value) {
+			return *this = (uint8_t) *this ^ value;
+		}
+		HostRegister8 &operator+=(unsigned int value) {
+			return *this = (uint8_t) *this + value;
+		}
+		HostRegister8 &operator-=(unsigned int value) {
+			return *this = (uint8_t) *this - value;
+		}
+	private:
+		uint8_t dev_address;
+};
+
+class HostRegister16 {
+	public:
+		explicit HostRegister16(uint8_t address) : dev_address(address) {}
+		operator uint16_t() const {
+			return hostMcuReadRegister16(dev_address);
+		}
+		HostRegister16 &operator=(unsigned int value) {
+			hostMcuWriteRegister16(dev_address, (uint16_t) value);
+			return *this;
+		}
+		HostRegister16 &operator=(const HostRegister16 &other) {
+			return *this = (uint16_t) other;
+		}
+		HostRegister16 &operator|=(unsigned int value) {
+			return *this = (uint16_t) *this | value;
+		}
+		HostRegister16 &operator&=(unsigned int value) {
+			return *this = (uint16_t) *this & value;
+		}
+		HostRegister16 &operator+=(unsigned int value) {
+			return *this = (uint16_t) *this + value;
+		}
+	private:
+		uint8_t dev_address;
+};
+
+#define _SFR_MEM8(address) HostRegister8(address)
+#define _SFR_MEM16(address) HostRegister16(address)
+#define _BV(bit) (1 << (bit))
+
+#define PINB _SFR_MEM8(0x23)
+#define DDRB _SFR_MEM8(0x24)
+#define PORTB _SFR_MEM8(0x25)
+#define PINC _SFR_MEM8(0x26)
+#define DDRC _SFR_MEM8(0x27)
+#define PORTC _SFR_MEM8(0x28)
+#define PIND _SFR_MEM8(0x29)
+#define DDRD _SFR_MEM8(0x2A)
+#define PORTD _SFR_MEM8(0x2B)
+#define TIFR0 _SFR_MEM8(0x35)
+#define TIFR1 _SFR_MEM8(0x36)
+#define TIFR2 _SFR_MEM8(0x37)
+#define PCIFR _SFR_MEM8(0x3B)
+#define GPIOR0 _SFR_MEM8(0x3E)
+#define TCCR0A _SFR_MEM8(0x44)
+#define TCCR0B _SFR_MEM8(0x45)
+#define TCNT0 _SFR_MEM8(0x46)
+#define OCR0A _SFR_MEM8(0x47)
+#define OCR0B _SFR_MEM8(0x48)
+#define GPIOR1 _SFR_MEM8(0x4A)
+#define GPIOR2 _SFR_MEM8(0x4B)
+#define SMCR _SFR_MEM8(0x53)
+#define MCUSR _SFR_MEM8(0x54)
+#define MCUCR _SFR_MEM8(0x55)
+#define SREG _SFR_MEM8(0x5F)
+#define WDTCSR _SFR_MEM8(0x60)
+#define PRR _SFR_MEM8(0x64)
+#define PCICR _SFR_MEM8(0x68)
+#define PCMSK0 _SFR_MEM8(0x6B)
+#define PCMSK1 _SFR_MEM8(0x6C)
+#define PCMSK2 _SFR_MEM8(0x6D)
+#define TIMSK0 _SFR_MEM8(0x6E)
+#define TIMSK1 _SFR_MEM8(0x6F)
+#define TIMSK2 _SFR_MEM8(0x70)
+#define ADCW _SFR_MEM16(0x78)
+#define ADC _SFR_MEM16(0x78)
+#define ADCL _SFR_MEM8(0x78)
+#define ADCH _SFR_MEM8(0x79)
+#define ADCSRA _SFR_MEM8(0x7A)
+#define ADCSRB _SFR_MEM8(0x7B)
+#define ADMUX _SFR_MEM8(0x7C)
+#define DIDR0 _SFR_MEM8(0x7E)
+#define TCCR1A _SFR_MEM8(0x80)
+#define TCCR1B _SFR_MEM8(0x81)
+#define TCCR1C _SFR_MEM8(0x82)
+#define TCNT1 _SFR_MEM16(0x84)
+#define TCNT1L _SFR_MEM8(0x84)
+#define TCNT1H _SFR_MEM8(0x85)
+#define ICR1 _SFR_MEM16(0x86)
+#define OCR1A _SFR_MEM16(0x88)
+#define OCR1B _SFR_MEM16(0x8A)
+#define TCCR2A _SFR_MEM8(0xB0)
+#define TCCR2B _SFR_MEM8(0xB1)
+#define TCNT2 _SFR_MEM8(0xB2)
+#define OCR2A _SFR_MEM8(0xB3)
+#define OCR2B _SFR_MEM8(0xB4)
+#define ASSR _SFR_MEM8(0xB6)
+
+//SREG
+#define SREG_I 7
+//ADCSRA
+#define ADEN 7
+#define ADSC 6
+#define ADATE 5
+#define ADIF 4
+#define ADIE 3
+#define ADPS2 2
+#define ADPS1 1
+#define ADPS0 0
+//ADCSRB
+#define ACME 6
+#define ADTS2 2
+#define ADTS1 1
+#define ADTS0 0
+//ADMUX
+#define REFS1 7
+#define REFS0 6
+#define ADLAR 5
+#define MUX3 3
+#define MUX2 2
+#define MUX1 1
+#define MUX0 0
+//DIDR0
+#define ADC5D 5
+#define ADC4D 4
+#define ADC3D 3
+#define ADC2D 2
+#define ADC1D 1
+#define ADC0D 0
+//TCCR0A, TCCR2A
+#define COM0A1 7
+#define COM0A0 6
+#define COM0B1 5
+#define COM0B0 4
+#define WGM01 1
+#define WGM00 0
+#define COM2A1 7
+#define COM2A0 6
+#define COM2B1 5
+#define COM2B0 4
+#define WGM21 1
+#define WGM20 0
+//TCCR0B, TCCR2B
+#define FOC0A 7
+#define FOC0B 6
+#define WGM02 3
+#define CS02 2
+#define CS01 1
+#define CS00 0
+#define FOC2A 7
+#define FOC2B 6
+#define WGM22 3
+#define CS22 2
+#define CS21 1
+#define CS20 0
+//TIMSK0, TIFR0, TIMSK2, TIFR2
+#define OCIE0B 2
+#define OCIE0A 1
+#define TOIE0 0
+#define OCF0B 2
+#define OCF0A 1
+#define TOV0 0
+#define OCIE2B 2
+#define OCIE2A 1
+#define TOIE2 0
+#define OCF2B 2
+#define OCF2A 1
+#define TOV2 0
+//TCCR1A
+#define COM1A1 7
+#define COM1A0 6
+#define COM1B1 5
+#define COM1B0 4
+#define WGM11 1
+#define WGM10 0
+//TCCR1B
+#define ICNC1 7
+#define ICES1 6
+#define WGM13 4
+#define WGM12 3
+#define CS12 2
+#define CS11 1
+#define CS10 0
+//TCCR1C
+#define FOC1A 7
+#define FOC1B 6
+//TIMSK1, TIFR1
+#define ICIE1 5
+#define OCIE1B 2
+#define OCIE1A 1
+#define TOIE1 0
+#define ICF1 5
+#define OCF1B 2
+#define OCF1A 1
+#define TOV1 0
+//ASSR
+#define EXCLK 6
+#define AS2 5
+//SMCR
+#define SM2 3
+#define SM1 2
+#define SM0 1
+#define SE 0
+//MCUCR
+#define BODS 6
+#define BODSE 5
+#define PUD 4
+//WDTCSR
+#define WDIF 7
+#define WDIE 6
+#define WDP3 5
+#define WDCE 4
+#define WDE 3
+#define WDP2 2
+#define WDP1 1
+#define WDP0 0
+//MCUSR
+#define WDRF 3
+#define BORF 2
+#define EXTRF 1
+#define PORF 0
+//PCICR, PCIFR
+#define PCIE2 2
+#define PCIE1 1
+#define PCIE0 0
+#define PCIF2 2
+#define PCIF1 1
+#define PCIF0 0
+//PRR
+#define PRTWI 7
+#define PRTIM2 6
+#define PRTIM0 5
+#define PRTIM1 3
+#define PRSPI 2
+#define PRUSART0 1
+#define PRADC 0
+//WDTCSR
+#define WDIF 7
+#define WDIE 6
+#define WDP3 5
+#define WDCE 4
+#define WDE 3
+#define WDP2 2
+#define WDP1 1
+#define WDP0 0
+//Ноги портов
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PC6 6
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+
+#endif
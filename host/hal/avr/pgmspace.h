@@ -0,0 +1,28 @@
+/**
+	avr/pgmspace.h (компьютер) - на компьютере флеш-память и оперативная общие, поэтому PROGMEM ничего не делает, а pgm_read_* - обычное чтение.
+*/
+
+#ifndef HostAvrPgmspace_h
+#define HostAvrPgmspace_h
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+
+#define pgm_read_byte(address) (*(const uint8_t *) (address))
+#define pgm_read_word(address) (*(const uint16_t *) (address))
+#define pgm_read_dword(address) (*(const uint32_t *) (address))
+#define pgm_read_float(address) (*(const float *) (address))
+#define pgm_read_ptr(address) (*(const void * const *) (address))
+#define pgm_read_byte_near(address) pgm_read_byte(address)
+#define pgm_read_word_near(address) pgm_read_word(address)
+
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strcmp_P strcmp
+
+#endif
@@ -0,0 +1,45 @@
+/**
+	avr/sleep.h (компьютер) - режимы сна для эмулятора контроллера.
+	sleep_cpu() при установленном бите SE в SMCR продвигает модельное время до ближайшего прерывания, которое может разбудить контроллер
+	в выбранном режиме (см. HostMcu::sleepUntilInterrupt()). Время сна учитывается отдельно, по нему считается доля активного времени.
+*/
+
+#ifndef HostAvrSleep_h
+#define HostAvrSleep_h
+
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE 0
+#define SLEEP_MODE_ADC _BV(SM0)
+#define SLEEP_MODE_PWR_DOWN _BV(SM1)
+#define SLEEP_MODE_PWR_SAVE (_BV(SM0) | _BV(SM1))
+#define SLEEP_MODE_STANDBY (_BV(SM1) | _BV(SM2))
+#define SLEEP_MODE_EXT_STANDBY (_BV(SM0) | _BV(SM1) | _BV(SM2))
+
+void hostMcuSleep();
+
+inline void set_sleep_mode(uint8_t mode) {
+	SMCR = (SMCR & ~(_BV(SM0) | _BV(SM1) | _BV(SM2))) | mode;
+}
+
+inline void sleep_enable() {
+	SMCR |= _BV(SE);
+}
+
+inline void sleep_disable() {
+	SMCR &= ~_BV(SE);
+}
+
+inline void sleep_cpu() {
+	hostMcuSleep();
+}
+
+inline void sleep_mode() {
+	sleep_enable();
+	sleep_cpu();
+	sleep_disable();
+}
+
+inline void sleep_bod_disable() {}
+
+#endif
@@ -0,0 +1,39 @@
+/**
+	avr/wdt.h (компьютер) - сторожевой таймер для эмулятора контроллера.
+	Эмулятор считает периоды сторожевого таймера от его генератора 128 кГц (16 мс * 2^WDP) и в режиме прерывания (WDIE) вызывает WDT_vect.
+	Сброс контроллера по сторожевому таймеру (WDE без WDIE) не моделируется. wdt_reset() начинает период заново.
+*/
+
+#ifndef HostAvrWdt_h
+#define HostAvrWdt_h
+
+#include <avr/io.h>
+
+#define WDTO_15MS 0
+#define WDTO_30MS 1
+#define WDTO_60MS 2
+#define WDTO_120MS 3
+#define WDTO_250MS 4
+#define WDTO_500MS 5
+#define WDTO_1S 6
+#define WDTO_2S 7
+#define WDTO_4S 8
+#define WDTO_8S 9
+
+void hostMcuWatchdogReset();
+
+inline void wdt_reset() {
+	hostMcuWatchdogReset();
+}
+
+inline void wdt_enable(uint8_t timeout) {
+	WDTCSR = _BV(WDCE) | _BV(WDE);
+	WDTCSR = _BV(WDE) | (timeout & 7) | ((timeout & 8) ? _BV(WDP3) : 0);
+}
+
+inline void wdt_disable() {
+	WDTCSR = _BV(WDCE) | _BV(WDE);
+	WDTCSR = 0;
+}
+
+#endif
@@ -0,0 +1,59 @@
+/**
+	HostTest_h - минимальный набор макросов для модульных тестов библиотек на компьютере (см. HostMcu.h).
+	Тест объявляется макросом TEST(имя) { ... }, проверки - макросами CHECK(условие), CHECK_EQUAL(ожидаемое, полученное) и
+	CHECK_NEAR(ожидаемое, полученное, допуск). Каждое выражение вычисляется один раз. Первая неудачная проверка прерывает тест. Перед каждым тестом эмулятор контроллера сбрасывается
+	(HostMcu::reset()), так что время, регистры и ноги у каждого теста свои.
+	Функция main() находится в HostTest.cpp: она запускает все тесты файла по порядку и возвращает 1, если хотя бы один не прошёл.
+	Запуск одного теста: имя_программы имя_теста.
+*/
+
+#include "HostTest.h"
+#include <stdio.h>
+#include <vector>
+
+struct DevHostTest {
+	const char *name;
+	void (*testFunc)();
+};
+
+static std::vector<DevHostTest> &dev_hostTests() {
+	static std::vector<DevHostTest> tests;
+	return tests;
+}
+
+static boolean dev_hostTestFailed;
+
+HostTestRegistration::HostTestRegistration(const char *name, void (*testFunc)()) {
+	DevHostTest test = {name, testFunc};
+	dev_hostTests().push_back(test);
+}
+
+void hostTestFail(const char *file, int line, const char *message) {
+	printf("%s:%d: check failed: %s\n", file, line, message);
+	dev_hostTestFailed = true;
+}
+
+void hostTestFailEqual(const char *file, int line, const char *expression, double expected, double actual) {
+	printf("%s:%d: %s: expected %.6g, got %.6g\n", file, line, expression, expected, actual);
+	dev_hostTestFailed = true;
+}
+
+int main(int argc, char **argv) {
+	int failed = 0;
+	int passed = 0;
+	for (size_t i = 0; i < dev_hostTests().size(); i++) {
+		const DevHostTest &test = dev_hostTests()[i];
+		if (argc > 1 && strcmp(argv[1], test.name) != 0) continue;
+		HostMcu::current().reset();
+		dev_hostTestFailed = false;
+		test.testFunc();
+		printf("[%s] %s\n", dev_hostTestFailed ? "FAIL" : " OK ", test.name);
+		if (dev_hostTestFailed) {
+			failed++;
+		} else {
+			passed++;
+		}
+	}
+	printf("%d passed, %d failed\n", passed, failed);
+	return failed == 0 && passed > 0 ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+/**
+	HostTest_h - минимальный набор макросов для модульных тестов библиотек на компьютере (см. HostMcu.h).
+	Тест объявляется макросом TEST(имя) { ... }, проверки - макросами CHECK(условие), CHECK_EQUAL(ожидаемое, полученное) и
+	CHECK_NEAR(ожидаемое, полученное, допуск). Каждое выражение вычисляется один раз. Первая неудачная проверка прерывает тест. Перед каждым тестом эмулятор контроллера сбрасывается
+	(HostMcu::reset()), так что время, регистры и ноги у каждого теста свои.
+	Функция main() находится в HostTest.cpp: она запускает все тесты файла по порядку и возвращает 1, если хотя бы один не прошёл.
+	Запуск одного теста: имя_программы имя_теста.
+*/
+
+#ifndef HostTest_h
+#define HostTest_h
+
+#include "Arduino.h"
+#include "HostMcu.h"
+
+class HostTestRegistration {
+	public:
+		HostTestRegistration(const char *name, void (*testFunc)());
+};
+
+void hostTestFail(const char *file, int line, const char *message);
+void hostTestFailEqual(const char *file, int line, const char *expression, double expected, double actual);
+
+#define TEST(name) \
+	static void hostTest_##name(); \
+	static HostTestRegistration hostTestRegistration_##name(#name, hostTest_##name); \
+	static void hostTest_##name()
+
+#define CHECK(condition) do { \
+		if (!(condition)) { \
+			hostTestFail(__FILE__, __LINE__, #condition); \
+			return; \
+		} \
+	} while (0)
+
+#define CHECK_EQUAL(expected, actual) do { \
+		double hostTestExpected = (double) (expected); \
+		double hostTestActual = (double) (actual); \
+		if (!(hostTestExpected == hostTestActual)) { \
+			hostTestFailEqual(__FILE__, __LINE__, #actual, hostTestExpected, hostTestActual); \
+			return; \
+		} \
+	} while (0)
+
+#define CHECK_NEAR(expected, actual, tolerance) do { \
+		double hostTestExpected = (double) (expected); \
+		double hostTestActual = (double) (actual); \
+		double hostTestTolerance = (double) (tolerance); \
+		if (hostTestExpected - hostTestActual > hostTestTolerance || hostTestActual - hostTestExpected > hostTestTolerance) { \
+			hostTestFailEqual(__FILE__, __LINE__, #actual, hostTestExpected, hostTestActual); \
+			return; \
+		} \
+	} while (0)
+
+#endif
@@ -0,0 +1,399 @@
+/**
+	HotPathsReference_h - замороженные копии горячих путей библиотек для разностных тестов (host/tests/test_HotPaths.cpp).
+	Здесь снимок поведения кода на момент появления набора замеров host/bench/bench_hotpaths.cpp:
+		* FrozenButton - HandledButton::processStep() и методы состояния кнопки;
+		* FrozenEventTimer - HandledEventTimer::processStep(), processMcsStep(), getEventState(), getTimeToNextEvent() на массиве скетча;
+		* FrozenIndicator - SevenSegmentsIndicator::print(const char*), refreshNext() и вывод сегментов;
+		* FrozenVoltmeter - Voltmeter::processSample(), averageFromSamples(), усреднение с прошлым результатом, getMillivolts() и getVoltage()
+			(без фильтров VoltmeterFilter и сторожей VoltageWatcher).
+	Тест подаёт одни и те же случайные входы библиотеке и копии и сравнивает результат бит в бит, поэтому ускорять можно только библиотеку:
+	эти файлы не правятся вместе с ней. Обновлять снимок можно только при намеренной смене поведения - тогда в тестах библиотеки должна
+	появиться проверка нового поведения. Константы (коды сегментов, сдвиги) скопированы числами, чтобы их правка в библиотеке тоже была видна.
+*/
+
+#include "HotPathsReference.h"
+
+#define FROZEN_BTN_MAX_COUNTER_VALUE 960000
+#define FROZEN_NO_EVENT 0xFFFFFFFFUL
+#define FROZEN_NO_EVENT_ID 0xFFFF
+#define FROZEN_VLM_RESULT_FRACTION_BITS 6
+#define FROZEN_VLM_MAX_OVERSAMPLING_BITS 4
+#define FROZEN_SSI_DOTPOINT 0b00000001
+
+FrozenButton::FrozenButton(byte pin, word timerInterval, unsigned long minimalHoldTime, byte buttonActiveState) {
+	_pin = pin;
+	pinMode(_pin, buttonActiveState == 1 ? INPUT : INPUT_PULLUP);
+	dev_changed = false;
+	dev_pushedDown = false;
+	dev_pulledUp = false;
+	dev_lastReadedState = false;
+	dev_currentStableState = false;
+	dev_clicked = false;
+	dev_buttonActiveState = buttonActiveState > 0;
+	dev_minimalHoldTime = minimalHoldTime;
+	dev_timerInterval = timerInterval;
+	dev_holdStateCounter = 0;
+	dev_timeInLastState = 0;
+}
+
+void FrozenButton::processStep() {
+	boolean dev_gettedState = digitalRead(_pin);
+	dev_gettedState = dev_buttonActiveState ? dev_gettedState : !dev_gettedState;
+	
+	if (dev_gettedState == dev_lastReadedState) {
+		dev_holdStateCounter += dev_timerInterval;
+	} else {
+		if (dev_holdStateCounter > dev_minimalHoldTime) {
+			dev_timeInLastState = dev_holdStateCounter;
+		}
+		dev_holdStateCounter = 0;
+		dev_lastReadedState = dev_gettedState;
+	}
+	
+	if (dev_holdStateCounter >= dev_minimalHoldTime && dev_currentStableState != dev_lastReadedState) {
+		dev_changed = true;
+		dev_currentStableState = dev_lastReadedState;
+		if (dev_currentStableState) {
+			dev_pushedDown = true;
+		} else {
+			dev_pulledUp = true;
+			dev_clicked = true;
+		}
+	}
+	
+	if (dev_holdStateCounter >= FROZEN_BTN_MAX_COUNTER_VALUE) {
+		dev_holdStateCounter = FROZEN_BTN_MAX_COUNTER_VALUE;
+	}
+}
+
+boolean FrozenButton::isPressed() {
+	return dev_currentStableState;
+}
+
+boolean FrozenButton::isClicked() {
+	boolean temp = dev_clicked;
+	dev_clicked = false;
+	return temp;
+}
+
+unsigned long FrozenButton::getTimeInCurrentState() {
+	return dev_holdStateCounter > dev_minimalHoldTime ? dev_holdStateCounter - dev_minimalHoldTime : 0;
+}
+
+unsigned long FrozenButton::getTimeInLastState() {
+	return dev_timeInLastState;
+}
+
+FrozenEventTimer::FrozenEventTimer(word timerInterval, FrozenEvent *eventsBuffer, word capacity) {
+	events = eventsBuffer;
+	enabled = false;
+	dev_eventCount = 0;
+	dev_eventCapacity = capacity;
+	dev_timerInterval = timerInterval;
+}
+
+word FrozenEventTimer::createEvent(unsigned long eventInterval) {
+	if (dev_eventCount >= dev_eventCapacity) return FROZEN_NO_EVENT_ID;
+	dev_eventCount++;
+	events[dev_eventCount-1].flag = false;
+	events[dev_eventCount-1].interval = eventInterval;
+	events[dev_eventCount-1].counter = 0;
+	events[dev_eventCount-1].active = true;
+	events[dev_eventCount-1].repeated = false;
+	events[dev_eventCount-1].maxRepeatCount = 0;
+	events[dev_eventCount-1].repeatationCounter = 0;
+	return dev_eventCount - 1;
+}
+
+void FrozenEventTimer::setRepeatability(word eventId, boolean repeatIt, word repeatationCount) {
+	if (eventId >= dev_eventCount) return;
+	events[eventId].repeated = repeatIt;
+	events[eventId].maxRepeatCount = repeatationCount;
+}
+
+void FrozenEventTimer::disableEvent(word eventId) {
+	if (eventId >= dev_eventCount) return;
+	events[eventId].active = false;
+}
+
+void FrozenEventTimer::enableEvent(word eventId) {
+	if (eventId >= dev_eventCount) return;
+	events[eventId].active = true;
+}
+
+void FrozenEventTimer::start() {
+	enabled = true;
+}
+
+void FrozenEventTimer::stop() {
+	enabled = false;
+}
+
+boolean FrozenEventTimer::getEventState(word eventId) {
+	if (eventId >= dev_eventCount) return false;
+	boolean temp_flag = events[eventId].flag;
+	events[eventId].flag = false;
+	return temp_flag;
+}
+
+boolean FrozenEventTimer::isEventActive(word eventId) {
+	if (eventId >= dev_eventCount) return false;
+	return events[eventId].active;
+}
+
+unsigned long FrozenEventTimer::getTimeToNextEvent() {
+	if (!enabled) return FROZEN_NO_EVENT;
+	unsigned long nearest = FROZEN_NO_EVENT;
+	for (word i = 0; i < dev_eventCount; i++) {
+		if (events[i].active) {
+			unsigned long left = events[i].counter < events[i].interval ? events[i].interval - events[i].counter : 0;
+			if (left < nearest) nearest = left;
+		}
+	}
+	return nearest;
+}
+
+void FrozenEventTimer::processStep() {
+	processMcsStep(dev_timerInterval); //В библиотеке - два одинаковых цикла, отличаются только шагом
+}
+
+void FrozenEventTimer::processMcsStep(word stepWidthMicros) {
+	if (!enabled) return;
+	for (word i = 0; i < dev_eventCount; i++) {
+		if (events[i].active) {
+			if ((events[i].counter += stepWidthMicros) >= events[i].interval) {
+				events[i].counter -= events[i].interval;
+				events[i].flag = true;
+				if (!events[i].repeated) {
+					events[i].active = false;
+				} else {
+					if (events[i].maxRepeatCount != 0) {
+						if (++events[i].repeatationCounter >= events[i].maxRepeatCount) {
+							events[i].active = false;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+FrozenIndicator::FrozenIndicator(byte *segmentPins, byte countOfDigits, byte *digitsPins, boolean digitPinType, byte *memory) {
+	_indicatorMemory = memory;
+	_segmentPins = segmentPins;
+	_digitPins = digitsPins;
+	_countOfDigits = countOfDigits;
+	_digitPinType = digitPinType;
+	_currentActiveDigit = 0;
+	_enabled = true;
+	_refreshing = true;
+	_showPoint = true;
+	for (int i = 0; i < countOfDigits; i++) {
+		_indicatorMemory[i] = 0b11111110 | FROZEN_SSI_DOTPOINT;
+	}
+	for (int i = 0; i < 8; i++) {
+		pinMode(_segmentPins[i], OUTPUT);
+	}
+	insolateDigitPins();
+}
+
+void FrozenIndicator::print(const char *str, boolean shiftToRight) {
+	if (str == NULL) str = "";
+	byte symbolsCount = 0;
+	for (const char *c = str; *c; c++) {
+		if (*c != '.' || c == str || c[-1] == '.') symbolsCount++;
+	}
+	byte blank = interpretateSymbolToActiveSegments(' ');
+	byte i = 0;
+	if (shiftToRight) {
+		for (; i + symbolsCount < _countOfDigits; i++) {
+			_indicatorMemory[i] = blank;
+		}
+	}
+	const char *c = str;
+	for (; i < _countOfDigits && *c; i++) {
+		boolean isDot = *c == '.';
+		_indicatorMemory[i] = interpretateSymbolToActiveSegments(toupper(*c));
+		c++;
+		if (!isDot && *c == '.') {
+			_indicatorMemory[i] |= FROZEN_SSI_DOTPOINT;
+			c++;
+		}
+	}
+	for (; i < _countOfDigits; i++) {
+		_indicatorMemory[i] = blank;
+	}
+}
+
+byte FrozenIndicator::interpretateSymbolToActiveSegments(char __inputSymbol) {
+	switch (__inputSymbol) {
+		case '0': case 'O': return 0b11111100;
+		case '1': case 'I': return 0b01100000;
+		case '2': return 0b11011010;
+		case '3': return 0b11110010;
+		case '4': return 0b01100110;
+		case '5': case 'S': return 0b10110110;
+		case '6': return 0b10111110;
+		case '7': return 0b11100000;
+		case '8': return 0b11111110;
+		case '9': return 0b11110110;
+		case 'A': return 0b11101110;
+		case 'B': return 0b00111110;
+		case 'C': return 0b10011100;
+		case 'D': return 0b01111010;
+		case 'E': return 0b10011110;
+		case 'F': return 0b10001110;
+		case 'G': return 0b11011110;
+		case 'H': return 0b01101110;
+		case 'J': return 0b01111000;
+		case 'L': return 0b00011100;
+		case 'N': return 0b11101100;
+		case 'P': return 0b11001110;
+		case 'Q': return 0b11100110;
+		case 'R': return 0b10001100;
+		case 'T': return 0b00011110;
+		case 'U': case 'V': return 0b01111100;
+		case 'Y': return 0b01110110;
+		case '-': return 0b00000010;
+		case '[': return 0b10011100;
+		case ']': return 0b11110000;
+		case '.': return FROZEN_SSI_DOTPOINT;
+		default: return 0;
+	}
+}
+
+void FrozenIndicator::insolateDigitPins() {
+	for (int i = 0; i < _countOfDigits; i++) {
+		pinMode(_digitPins[i], INPUT);
+	}
+}
+
+void FrozenIndicator::setDigitValue(byte digitIndex, byte value) {
+	if (digitIndex < _countOfDigits) {
+		_indicatorMemory[digitIndex] = value;
+	}
+}
+
+void FrozenIndicator::setPointShow(boolean enabled) {
+	_showPoint = enabled;
+}
+
+void FrozenIndicator::stopRefreshing() {
+	_refreshing = false;
+}
+
+void FrozenIndicator::resumeRefreshing() {
+	_refreshing = true;
+}
+
+void FrozenIndicator::refreshNext() {
+	if (_enabled) {
+		if (_refreshing){
+			pinMode(_digitPins[_currentActiveDigit], INPUT);
+			if (++_currentActiveDigit >= _countOfDigits) _currentActiveDigit = 0;
+		}
+		pinMode(_digitPins[_currentActiveDigit], OUTPUT);
+		setSegmentsState(_indicatorMemory[_currentActiveDigit]);
+		digitalWrite(_digitPins[_currentActiveDigit], _digitPinType ? HIGH : LOW);
+	}
+}
+
+void FrozenIndicator::setSegmentsState(byte value) {
+	for (int currentSegmentPin = 0; currentSegmentPin < 8; currentSegmentPin++) {
+		boolean segmentState = getBitState(value, 7 - currentSegmentPin);
+		if (_digitPinType) {
+			segmentState = !segmentState;
+		}
+		if (currentSegmentPin < 7) {
+			digitalWrite(_segmentPins[currentSegmentPin], segmentState ? HIGH : LOW);
+		} else {
+			if (_showPoint) {
+				digitalWrite(_segmentPins[7], segmentState ? HIGH : LOW);
+			} else {
+				digitalWrite(_segmentPins[7], _digitPinType ? HIGH : LOW);
+			}
+		}
+	}
+}
+
+boolean FrozenIndicator::getBitState(byte input, byte bitIndex) {
+	if (bitIndex >= 8) bitIndex = 7;
+	return (input >> bitIndex) & 1u;
+}
+
+FrozenVoltmeter::FrozenVoltmeter(word *samplesBuffer, byte samplesCount, float ctrl_ref_voltage, float rdiv_TopResistance, float rdiv_BottomResistance) {
+	samples = samplesBuffer;
+	dev_maxFilterSamplesCount = samplesCount < 1 ? 1 : samplesCount;
+	for (byte i = 0; i < dev_maxFilterSamplesCount; i++) {
+		samples[i] = 0;
+	}
+	dev_changed = true;
+	dev_lastResult = 0;
+	dev_oversamplingBits = 0;
+	dev_oversampleCount = 0;
+	dev_oversampleSum = 0;
+	dev_transferCoeff = (ctrl_ref_voltage / 1024.) / (rdiv_BottomResistance / (rdiv_TopResistance + rdiv_BottomResistance));
+	double millivoltsPerCode = dev_transferCoeff * 1000.;
+	dev_millivoltsShift = 24;
+	while (dev_millivoltsShift > 0 && millivoltsPerCode * (1UL << dev_millivoltsShift) >= 65536.) {
+		dev_millivoltsShift--;
+	}
+	dev_millivoltsScale = millivoltsPerCode * (1UL << dev_millivoltsShift) + 0.5;
+}
+
+void FrozenVoltmeter::setOversampling(byte extraBits) {
+	dev_oversamplingBits = extraBits > FROZEN_VLM_MAX_OVERSAMPLING_BITS ? FROZEN_VLM_MAX_OVERSAMPLING_BITS : extraBits;
+	dev_oversampleCount = 0;
+	dev_oversampleSum = 0;
+	for (byte i = 0; i < dev_maxFilterSamplesCount; i++) {
+		samples[i] = 0;
+	}
+	dev_changed = true;
+}
+
+void FrozenVoltmeter::processSample(word adcValue) {
+	if (dev_oversamplingBits) {
+		dev_oversampleSum += adcValue;
+		if (++dev_oversampleCount < (1 << (2 * dev_oversamplingBits))) return;
+		adcValue = dev_oversampleSum >> dev_oversamplingBits;
+		dev_oversampleSum = 0;
+		dev_oversampleCount = 0;
+	}
+	for (byte i = dev_maxFilterSamplesCount - 1; i > 0; i--) {
+		samples[i] = samples[i - 1];
+	}
+	samples[0] = adcValue;
+	dev_changed = true;
+}
+
+word FrozenVoltmeter::averageFromSamples() {
+	unsigned long sumOfSamples = 0;
+	for (byte i = 0; i < dev_maxFilterSamplesCount; i++) {
+		sumOfSamples += samples[i];
+	}
+	return sumOfSamples / dev_maxFilterSamplesCount;
+}
+
+word FrozenVoltmeter::dev_currentReading() {
+	byte scaleShift = FROZEN_VLM_RESULT_FRACTION_BITS - dev_oversamplingBits;
+	if (dev_changed) {
+		if (dev_maxFilterSamplesCount > 1) {
+			dev_lastResult = ((unsigned long) dev_lastResult + ((unsigned long) averageFromSamples() << scaleShift)) >> 1;
+		} else {
+			dev_lastResult = samples[0] << scaleShift;
+		}
+		dev_changed = false;
+	}
+	return dev_lastResult;
+}
+
+float FrozenVoltmeter::getVoltage() {
+	word reading = dev_currentReading();
+	return reading * dev_transferCoeff / (1 << FROZEN_VLM_RESULT_FRACTION_BITS);
+}
+
+unsigned long FrozenVoltmeter::getMillivolts() {
+	word reading = dev_currentReading();
+	byte shift = dev_millivoltsShift + FROZEN_VLM_RESULT_FRACTION_BITS;
+	return ((unsigned long) reading * dev_millivoltsScale + (1UL << (shift - 1))) >> shift;
+}
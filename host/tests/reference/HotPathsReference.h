@@ -0,0 +1,121 @@
+/**
+	HotPathsReference_h - замороженные копии горячих путей библиотек для разностных тестов (host/tests/test_HotPaths.cpp).
+	Здесь снимок поведения кода на момент появления набора замеров host/bench/bench_hotpaths.cpp:
+		* FrozenButton - HandledButton::processStep() и методы состояния кнопки;
+		* FrozenEventTimer - HandledEventTimer::processStep(), processMcsStep(), getEventState(), getTimeToNextEvent() на массиве скетча;
+		* FrozenIndicator - SevenSegmentsIndicator::print(const char*), refreshNext() и вывод сегментов;
+		* FrozenVoltmeter - Voltmeter::processSample(), averageFromSamples(), усреднение с прошлым результатом, getMillivolts() и getVoltage()
+			(без фильтров VoltmeterFilter и сторожей VoltageWatcher).
+	Тест подаёт одни и те же случайные входы библиотеке и копии и сравнивает результат бит в бит, поэтому ускорять можно только библиотеку:
+	эти файлы не правятся вместе с ней. Обновлять снимок можно только при намеренной смене поведения - тогда в тестах библиотеки должна
+	появиться проверка нового поведения. Константы (коды сегментов, сдвиги) скопированы числами, чтобы их правка в библиотеке тоже была видна.
+*/
+
+#ifndef HotPathsReference_h
+#define HotPathsReference_h
+
+#include "Arduino.h"
+
+class FrozenButton {
+	public:
+		FrozenButton(byte pin, word timerInterval, unsigned long minimalHoldTime, byte buttonActiveState);
+		void processStep();
+		boolean isPressed();
+		boolean isClicked();
+		unsigned long getTimeInCurrentState();
+		unsigned long getTimeInLastState();
+	private:
+		boolean dev_changed;
+		boolean dev_lastReadedState;
+		boolean dev_currentStableState;
+		boolean dev_pushedDown;
+		boolean dev_clicked;
+		boolean dev_pulledUp;
+		boolean dev_buttonActiveState;
+		unsigned long dev_minimalHoldTime;
+		word dev_timerInterval;
+		unsigned long dev_holdStateCounter;
+		unsigned long dev_timeInLastState;
+		byte _pin;
+};
+
+struct FrozenEvent {
+	boolean flag;
+	unsigned long interval;
+	unsigned long counter;
+	boolean active;
+	boolean repeated;
+	word maxRepeatCount;
+	word repeatationCounter;
+};
+
+class FrozenEventTimer {
+	public:
+		FrozenEventTimer(word timerInterval, FrozenEvent *eventsBuffer, word capacity);
+		word createEvent(unsigned long eventInterval);
+		void setRepeatability(word eventId, boolean repeatIt, word repeatationCount);
+		void disableEvent(word eventId);
+		void enableEvent(word eventId);
+		void start();
+		void stop();
+		boolean getEventState(word eventId);
+		boolean isEventActive(word eventId);
+		unsigned long getTimeToNextEvent();
+		void processStep();
+		void processMcsStep(word stepWidthMicros);
+	private:
+		FrozenEvent *events;
+		word dev_eventCount;
+		word dev_eventCapacity;
+		word dev_timerInterval;
+		boolean enabled;
+};
+
+class FrozenIndicator {
+	public:
+		FrozenIndicator(byte *segmentPins, byte countOfDigits, byte *digitsPins, boolean digitPinType, byte *memory);
+		void refreshNext();
+		void print(const char *str, boolean shiftToRight = true);
+		void setDigitValue(byte digitIndex, byte value);
+		void setPointShow(boolean enabled);
+		void stopRefreshing();
+		void resumeRefreshing();
+	private:
+		byte *_segmentPins;
+		byte *_digitPins;
+		byte _currentActiveDigit;
+		byte _countOfDigits;
+		byte *_indicatorMemory;
+		boolean _enabled;
+		boolean _refreshing;
+		boolean _showPoint;
+		boolean _digitPinType;
+		void setSegmentsState(byte value);
+		void insolateDigitPins();
+		byte interpretateSymbolToActiveSegments(char __inputSymbol);
+		boolean getBitState(byte input, byte bitIndex);
+};
+
+class FrozenVoltmeter {
+	public:
+		FrozenVoltmeter(word *samplesBuffer, byte samplesCount, float ctrl_ref_voltage, float rdiv_TopResistance, float rdiv_BottomResistance);
+		void setOversampling(byte extraBits);
+		void processSample(word adcValue);
+		float getVoltage();
+		unsigned long getMillivolts();
+	private:
+		word *samples;
+		byte dev_maxFilterSamplesCount;
+		double dev_transferCoeff;
+		unsigned long dev_millivoltsScale;
+		byte dev_millivoltsShift;
+		boolean dev_changed;
+		word dev_lastResult;
+		byte dev_oversamplingBits;
+		word dev_oversampleCount;
+		unsigned long dev_oversampleSum;
+		word averageFromSamples();
+		word dev_currentReading();
+};
+
+#endif
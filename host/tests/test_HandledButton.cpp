@@ -0,0 +1,70 @@
+#include "HostTest.h"
+#include "HandledButton.h"
+
+#define BUTTON_PIN 2
+#define STEP_MS 10
+
+static int pushDowns = 0;
+static int pullUps = 0;
+
+static void onPushDown() {
+	pushDowns++;
+}
+
+static void onPullUp() {
+	pullUps++;
+}
+
+static void runSteps(HandledButton &button, int steps) {
+	for (int i = 0; i < steps; i++) {
+		button.processStep();
+		delay(STEP_MS);
+	}
+}
+
+TEST(activeLowUsesPullUp) {
+	HandledButton button(BUTTON_PIN, STEP_MS);
+	CHECK_EQUAL(INPUT_PULLUP, HostMcu::current().getPinMode(BUTTON_PIN));
+	runSteps(button, 10);
+	CHECK(!button.isPressed());
+}
+
+TEST(pressIsDebounced) {
+	HostMcu &mcu = HostMcu::current();
+	HandledButton button(BUTTON_PIN, STEP_MS);
+	pushDowns = 0;
+	pullUps = 0;
+	button.attachHandlerToPushDown(onPushDown);
+	button.attachHandlerToPullUp(onPullUp);
+	mcu.setPinInput(BUTTON_PIN, LOW);
+	runSteps(button, 2); //Дребезг короче BTN_DEFAULT_HOLD_TIME
+	mcu.setPinInput(BUTTON_PIN, HIGH);
+	runSteps(button, 5);
+	button.processHandlers();
+	CHECK(!button.isPressed());
+	CHECK_EQUAL(0, pushDowns);
+	mcu.setPinInput(BUTTON_PIN, LOW);
+	runSteps(button, 5);
+	CHECK(button.isPressed());
+	button.processHandlers();
+	CHECK_EQUAL(1, pushDowns);
+	runSteps(button, 20);
+	CHECK(button.getTimeInCurrentState() > 0);
+	mcu.setPinInput(BUTTON_PIN, HIGH);
+	runSteps(button, 5);
+	button.processHandlers();
+	CHECK(!button.isPressed());
+	CHECK_EQUAL(1, pullUps);
+	CHECK(button.isClicked());
+	CHECK(!button.isClicked());
+	CHECK(button.getTimeInLastState() >= 200);
+}
+
+TEST(activeHighButton) {
+	HostMcu &mcu = HostMcu::current();
+	HandledButton button(BUTTON_PIN, STEP_MS, 20, BTN_ACTIVE_HIGH);
+	CHECK_EQUAL(INPUT, mcu.getPinMode(BUTTON_PIN));
+	mcu.setPinInput(BUTTON_PIN, HIGH);
+	runSteps(button, 4);
+	CHECK(button.isPressed());
+}
@@ -0,0 +1,261 @@
+#include "HostTest.h"
+#include "HandledEventTimer.h"
+#include "EventTask.h"
+#include "HandledButton.h"
+#include <vector>
+
+static int firstCalls = 0;
+static int secondCalls = 0;
+
+static void onFirst() {
+	firstCalls++;
+}
+
+static void onSecond() {
+	secondCalls++;
+}
+
+TEST(singleEventFiresOnce) {
+	HandledEventTimer timer(10);
+	word event = timer.createEvent(100, onFirst);
+	timer.start();
+	firstCalls = 0;
+	for (int i = 0; i < 9; i++) {
+		timer.processStep();
+	}
+	CHECK(!timer.getEventState(event));
+	timer.processStep();
+	CHECK(!timer.isEventActive(event));
+	timer.processHandlers();
+	CHECK_EQUAL(1, firstCalls);
+	for (int i = 0; i < 50; i++) {
+		timer.processStep();
+	}
+	timer.processHandlers();
+	CHECK_EQUAL(1, firstCalls);
+}
+
+TEST(repeatedEventsKeepCadence) {
+	HandledEventTimer timer(10);
+	timer.createRepeatedEvent(30, onFirst, 0);
+	timer.createRepeatedEvent(25, onSecond, 3);
+	timer.start();
+	firstCalls = 0;
+	secondCalls = 0;
+	for (int i = 0; i < 300; i++) { //3 секунды
+		timer.processStep();
+		timer.processHandlers();
+	}
+	CHECK_EQUAL(100, firstCalls);
+	CHECK_EQUAL(3, secondCalls);
+}
+
+static HandledEventTimer *activeTimer = NULL;
+static unsigned long timerTicks = 0;
+static unsigned long isrDeadline = 0;
+static boolean isrInterruptsEnabled = false;
+
+ISR(TIMER2_COMPA_vect) {
+	if (activeTimer == NULL) return;
+	activeTimer->processStep();
+	timerTicks++;
+	isrDeadline = activeTimer->getTimeToNextEvent();
+	if (isrDeadline != 7 - timerTicks % 7) isrDeadline = HET_NO_EVENT; //Запоминаем первое расхождение
+	if (SREG & _BV(SREG_I)) isrInterruptsEnabled = true;
+}
+
+TEST(deadlineIsConsistentWhileTimerInterruptRuns) {
+	HostMcu &mcu = HostMcu::current();
+	HandledEventTimer timer(1);
+	timer.createRepeatedEvent(7, onFirst, 0);
+	timer.start();
+	timerTicks = 0;
+	isrInterruptsEnabled = false;
+	activeTimer = &timer;
+	TCCR2A = _BV(WGM21); //CTC, 1 мс
+	TCCR2B = 4;
+	OCR2A = 249;
+	TIMSK2 = _BV(OCIE2A);
+	sei();
+	boolean consistent = true;
+	for (int i = 0; i < 500; i++) {
+		mcu.advanceMicros(137); //Не кратно периоду прерывания
+		unsigned long left = timer.getTimeToNextEvent();
+		if (left != 7 - timerTicks % 7) consistent = false;
+		if (isrDeadline == HET_NO_EVENT) consistent = false;
+		if (!(SREG & _BV(SREG_I))) consistent = false; //Прерывания снова разрешены
+	}
+	TIMSK2 = 0;
+	activeTimer = NULL;
+	CHECK(timerTicks >= 68);
+	CHECK(consistent);
+	CHECK(!isrInterruptsEnabled); //Запрос из обработчика не разрешает прерывания
+}
+
+TEST(stoppedTimerDoesNothing) {
+	HandledEventTimer timer(10);
+	word event = timer.createRepeatedEvent(10, onFirst, 0);
+	firstCalls = 0;
+	for (int i = 0; i < 10; i++) {
+		timer.processStep();
+	}
+	timer.processHandlers();
+	CHECK_EQUAL(0, firstCalls);
+	timer.start();
+	timer.disableEvent(event);
+	timer.processStep();
+	CHECK(!timer.getEventState(event));
+	timer.enableEvent(event);
+	timer.processMcsStep(10);
+	CHECK(timer.getEventState(event));
+}
+
+static std::vector<unsigned long> taskTicks; //Тики, на которых задача возобновлялась после ожидания
+static unsigned long currentTick;
+static volatile boolean dataReady;
+static int conditionValue;
+
+static void sleeper(EventTask &task) {
+	TASK_BEGIN(task);
+	while (true) {
+		TASK_SLEEP_FOR(task, 100);
+		taskTicks.push_back(currentTick);
+		TASK_SLEEP_FOR(task, 30);
+		taskTicks.push_back(currentTick);
+	}
+	TASK_END(task);
+}
+
+static void runTicks(HandledEventTimer &timer, TaskScheduler &scheduler, unsigned long ticks) {
+	for (unsigned long i = 0; i < ticks; i++) {
+		currentTick++;
+		timer.processStep();
+		timer.processHandlers();
+		scheduler.processTasks();
+	}
+}
+
+TEST(tasksSleepOnTimerEvents) {
+	HandledEventTimer timer(10);
+	TaskScheduler scheduler(timer);
+	EventTask task(sleeper);
+	timer.createRepeatedEvent(20, onFirst, 0); //Обычное событие рядом: processHandlers() не должен съедать флаги задач
+	CHECK(scheduler.addTask(task));
+	CHECK(!scheduler.addTask(task));
+	timer.start();
+	taskTicks.clear();
+	currentTick = 0;
+	scheduler.processTasks();
+	CHECK_EQUAL(TASK_SLEEPING, task.getState());
+	CHECK_EQUAL(20, timer.getTimeToNextEvent()); //Сон задачи (100) считает таймер, ближайшее - обычное событие
+	runTicks(timer, scheduler, 30);
+	CHECK_EQUAL(4, taskTicks.size());
+	CHECK_EQUAL(10, taskTicks[0]);
+	CHECK_EQUAL(13, taskTicks[1]);
+	CHECK_EQUAL(23, taskTicks[2]);
+	CHECK_EQUAL(26, taskTicks[3]);
+	task.restart();
+	CHECK_EQUAL(TASK_READY, task.getState());
+	scheduler.processTasks();
+	runTicks(timer, scheduler, 10);
+	CHECK_EQUAL(5, taskTicks.size());
+	CHECK_EQUAL(40, taskTicks[4]);
+}
+
+static int waiterStage;
+
+static void waiter(EventTask &task) {
+	TASK_BEGIN(task);
+	waiterStage = 1;
+	TASK_WAIT_FLAG(task, dataReady);
+	waiterStage = 2;
+	TASK_WAIT_UNTIL(task, conditionValue > 0); //Уже выполнено - задача идёт дальше без остановки
+	waiterStage = 3;
+	TASK_WAIT_UNTIL(task, conditionValue > 5);
+	waiterStage = 4;
+	TASK_YIELD(task);
+	waiterStage = 5;
+	TASK_END(task);
+}
+
+TEST(tasksWaitForFlagsAndConditions) {
+	StaticHandledEventTimer<2> timer(10);
+	TaskScheduler scheduler(timer);
+	EventTask task(waiter);
+	EventTask second(waiter);
+	EventTask third(waiter);
+	CHECK(scheduler.addTask(task));
+	CHECK(scheduler.addTask(second));
+	CHECK(!scheduler.addTask(third)); //Массив событий таймера заполнен
+	CHECK_EQUAL(2, scheduler.getTasksCount());
+	second.finish(); //Вторая задача не мешает первой
+	dataReady = false;
+	conditionValue = 1;
+	waiterStage = 0;
+	scheduler.processTasks();
+	CHECK_EQUAL(1, waiterStage);
+	CHECK_EQUAL(TASK_WAITING_FLAG, task.getState());
+	scheduler.processTasks();
+	CHECK_EQUAL(1, waiterStage);
+	dataReady = true;
+	scheduler.processTasks();
+	CHECK(!dataReady); //Флаг сброшен при пробуждении
+	CHECK_EQUAL(3, waiterStage);
+	CHECK_EQUAL(TASK_WAITING, task.getState());
+	conditionValue = 6;
+	scheduler.processTasks();
+	CHECK_EQUAL(4, waiterStage);
+	CHECK_EQUAL(TASK_READY, task.getState());
+	scheduler.processTasks();
+	CHECK_EQUAL(5, waiterStage);
+	CHECK(task.isFinished());
+	CHECK(second.isFinished());
+	waiterStage = 0;
+	scheduler.processTasks();
+	CHECK_EQUAL(0, waiterStage);
+}
+
+static HandledButton *taskButton;
+static int buttonClicks;
+
+static void clickCounter(EventTask &task) {
+	TASK_BEGIN(task);
+	while (true) {
+		TASK_WAIT_BUTTON(task, *taskButton);
+		buttonClicks++;
+	}
+	TASK_END(task);
+}
+
+TEST(tasksWaitForButton) {
+	HostMcu &mcu = HostMcu::current();
+	mcu.setPinInput(2, HIGH);
+	HandledButton button(2, 10, 30);
+	taskButton = &button;
+	HandledEventTimer timer(10);
+	TaskScheduler scheduler(timer);
+	EventTask task(clickCounter);
+	scheduler.addTask(task);
+	timer.start();
+	buttonClicks = 0;
+	mcu.setPinInput(2, LOW); //Клик до начала ожидания
+	for (int i = 0; i < 5; i++) button.processStep();
+	mcu.setPinInput(2, HIGH);
+	for (int i = 0; i < 5; i++) button.processStep();
+	scheduler.processTasks();
+	CHECK_EQUAL(0, buttonClicks);
+	for (int click = 0; click < 3; click++) {
+		mcu.setPinInput(2, LOW);
+		for (int i = 0; i < 5; i++) {
+			button.processStep();
+			scheduler.processTasks();
+		}
+		CHECK_EQUAL(click, buttonClicks); //Нажатие без отпускания - ещё не клик
+		mcu.setPinInput(2, HIGH);
+		for (int i = 0; i < 5; i++) {
+			button.processStep();
+			scheduler.processTasks();
+		}
+		CHECK_EQUAL(click + 1, buttonClicks);
+	}
+}
@@ -0,0 +1,131 @@
+#include "HostTest.h"
+#include "HostFleet.h"
+#include "HandledButton.h"
+#include "HandledEventTimer.h"
+#include "EventTask.h"
+#include "Voltmeter.h"
+#include <vector>
+
+#define BUTTON_PIN 2
+#define DEVICES 24
+
+//Устройство: кнопка с нажатиями в своём ритме, задача считает клики, вольтметр на своём напряжении
+class Counter : public HostDevice {
+	public:
+		Counter(unsigned int index) : HostDevice(500), button(BUTTON_PIN, 1), timer(1), scheduler(timer), battery(A0), task(countClicks, this) {
+			clicks = 0;
+			period = 200 + 37 * index;
+			float volts = 1 + 0.1f * index;
+			getMcu().setPinInput(BUTTON_PIN, HIGH);
+			getMcu().setAdcWaveform(0, [volts](double seconds) {return (float) (volts + 0.2 * seconds);});
+			scheduler.addTask(task);
+			timer.start();
+			schedulePress(period);
+		}
+		void tick() {
+			button.processStep();
+			timer.processStep();
+			battery.processSample(analogRead(A0));
+			millivolts = battery.getMillivolts();
+			scheduler.processTasks();
+		}
+		unsigned long clicks;
+		unsigned long clickMillis;
+		unsigned long millivolts;
+		HandledButton button;
+		StaticHandledEventTimer<1> timer;
+		TaskScheduler scheduler;
+		StaticVoltmeter<4> battery;
+		EventTask task;
+	private:
+		unsigned long period;
+		void schedulePress(unsigned long atMillis) {
+			getMcu().scheduleAction((uint64_t) atMillis * (F_CPU / 1000), [this]() {getMcu().setPinInput(BUTTON_PIN, LOW);});
+			getMcu().scheduleAction((uint64_t) (atMillis + 50) * (F_CPU / 1000), [this, atMillis]() {
+				getMcu().setPinInput(BUTTON_PIN, HIGH);
+				schedulePress(atMillis + period);
+			});
+		}
+		static void countClicks(EventTask &task) {
+			Counter *counter = (Counter *) task.getContext();
+			TASK_BEGIN(task);
+			while (true) {
+				TASK_WAIT_BUTTON(task, counter->button);
+				counter->clicks++;
+				counter->clickMillis = millis();
+			}
+			TASK_END(task);
+		}
+};
+
+static void createDevices(std::vector<Counter *> &devices) {
+	for (unsigned int i = 0; i < DEVICES; i++) {
+		devices.push_back(new Counter(i));
+	}
+	HostMcu::selectDefault();
+}
+
+static void deleteDevices(std::vector<Counter *> &devices) {
+	for (size_t i = 0; i < devices.size(); i++) {
+		delete devices[i];
+	}
+	devices.clear();
+}
+
+TEST(fleetMatchesSequentialRuns) {
+	std::vector<Counter *> alone, together;
+	createDevices(alone);
+	createDevices(together);
+	HostFleet fleet(4);
+	for (size_t i = 0; i < together.size(); i++) {
+		fleet.addDevice(together[i]);
+	}
+	fleet.run(3, 0.01);
+	for (size_t i = 0; i < alone.size(); i++) {
+		alone[i]->runFor(3 * F_CPU);
+		CHECK(alone[i]->clicks > 0);
+		CHECK_EQUAL(alone[i]->clicks, together[i]->clicks);
+		CHECK_EQUAL(alone[i]->clickMillis, together[i]->clickMillis);
+		CHECK_EQUAL(alone[i]->millivolts, together[i]->millivolts);
+	}
+	CHECK_EQUAL(14, alone[0]->clicks); //Нажатия на 200, 400 ... 2800 мс
+	CHECK_NEAR(1600, alone[0]->millivolts, 5);
+	deleteDevices(alone);
+	deleteDevices(together);
+}
+
+TEST(everyDeviceRunsItsOwnClock) {
+	std::vector<Counter *> devices;
+	createDevices(devices);
+	HostFleet fleet(3);
+	for (size_t i = 0; i < devices.size(); i++) {
+		fleet.addDevice(devices[i]);
+	}
+	devices[5]->runFor(F_CPU / 2); //Одно устройство впереди остальных на 0.5 с
+	fleet.run(2, 0.05);
+	for (size_t i = 0; i < devices.size(); i++) {
+		CHECK_EQUAL(i == 5 ? 2500 : 2000, devices[i]->getMcu().getMillis());
+	}
+	CHECK_NEAR(2. * DEVICES, fleet.getSimulatedSeconds(), DEVICES * 0.001); //analogRead() тоже сдвигает время, последний тик может выйти за срок
+	CHECK_EQUAL(DEVICES * 40, fleet.getSlices());
+	CHECK_EQUAL(3, fleet.getThreadsCount());
+	CHECK(fleet.getSpeed() > 0);
+	CHECK_EQUAL(0, HostMcu::current().getCycles()); //Общий эмулятор потока не сдвигался
+	fleet.run(1);
+	CHECK_EQUAL(3000, devices[0]->getMcu().getMillis());
+	deleteDevices(devices);
+}
+
+TEST(singleThreadFleetWorks) {
+	std::vector<Counter *> devices;
+	createDevices(devices);
+	HostFleet fleet(1);
+	for (size_t i = 0; i < devices.size(); i++) {
+		fleet.addDevice(devices[i]);
+	}
+	fleet.run(0.5);
+	CHECK_EQUAL(0, fleet.getSteals()); //Красть не у кого
+	CHECK_EQUAL(DEVICES * 10, fleet.getSlices());
+	CHECK_EQUAL(500, devices[DEVICES - 1]->getMcu().getMillis());
+	deleteDevices(devices);
+}
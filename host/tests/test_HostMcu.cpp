@@ -0,0 +1,251 @@
+//Проверки самого эмулятора: если он врёт, врут и все остальные тесты
+
+#include "HostTest.h"
+#include <avr/sleep.h>
+
+static volatile unsigned long timer2Matches = 0;
+static volatile unsigned long timer1Overflows = 0;
+static volatile unsigned long nestedDepth = 0;
+
+ISR(TIMER2_COMPA_vect) {
+	timer2Matches++;
+	nestedDepth = HostMcu::current().getInterruptDepth();
+}
+
+ISR(TIMER1_OVF_vect) {
+	timer1Overflows++;
+}
+
+static void setupTimer2Millisecond() {
+	TCCR2A = _BV(WGM21); //CTC
+	TCCR2B = _BV(CS22); //64
+	OCR2A = 249; //16 МГц / 64 / 250 = 1 кГц
+	TCNT2 = 0;
+	TIFR2 = 0xFF;
+	TIMSK2 = _BV(OCIE2A);
+}
+
+TEST(timeAdvancesOnlyExplicitly) {
+	HostMcu &mcu = HostMcu::current();
+	CHECK_EQUAL(0, millis());
+	delay(25);
+	CHECK_EQUAL(25, millis());
+	CHECK_EQUAL(25000, micros());
+	delayMicroseconds(7);
+	CHECK_EQUAL(25007, micros());
+	mcu.advanceCycles(16);
+	CHECK_EQUAL(25008, micros());
+}
+
+TEST(digitalPins) {
+	HostMcu &mcu = HostMcu::current();
+	int changes = 0;
+	mcu.setPinListener([&changes](byte pin, byte level) {
+		if (pin == 13) changes++;
+	});
+	pinMode(13, OUTPUT);
+	digitalWrite(13, HIGH);
+	CHECK_EQUAL(HIGH, mcu.getPinLevel(13));
+	CHECK_EQUAL(OUTPUT, mcu.getPinMode(13));
+	CHECK(PORTB & _BV(PB5));
+	PINB = _BV(PB5); //Запись в PINx переключает выход
+	CHECK_EQUAL(LOW, digitalRead(13));
+	CHECK_EQUAL(3, changes);
+	pinMode(2, INPUT_PULLUP);
+	CHECK_EQUAL(HIGH, digitalRead(2));
+	mcu.setPinInput(2, LOW);
+	CHECK_EQUAL(LOW, digitalRead(2));
+	mcu.releasePin(2);
+	pinMode(2, INPUT);
+	CHECK_EQUAL(LOW, digitalRead(2)); //Вход в воздухе
+	CHECK_EQUAL(INPUT, mcu.getPinMode(2));
+	analogWrite(9, 100);
+	CHECK_EQUAL(100, mcu.getPwm(9));
+	digitalWrite(9, LOW);
+	CHECK_EQUAL(-1, mcu.getPwm(9));
+}
+
+TEST(analogReadTakesConversionTime) {
+	HostMcu &mcu = HostMcu::current();
+	mcu.setAdcVoltage(A0, 2.5);
+	mcu.setAdcVoltage(A3, 5.0);
+	CHECK_EQUAL(512, analogRead(A0));
+	CHECK_EQUAL(13 * 128, mcu.getCycles()); //Предделитель 128, как после init() ядра
+	CHECK_EQUAL(1023, analogRead(A3));
+	analogReference(INTERNAL);
+	mcu.setAdcVoltage(A1, 0.55);
+	CHECK_EQUAL(512, analogRead(A1));
+	CHECK_EQUAL(3, mcu.getAdcConversionsCount());
+	mcu.setAdcWaveform(A2, [](double seconds) {
+		return (float) (seconds * 1000); //1 В за миллисекунду
+	});
+	analogReference(DEFAULT);
+	delay(2);
+	double volts = micros() / 1000.0;
+	CHECK_NEAR(volts / 5 * 1024, analogRead(A2), 1);
+}
+
+TEST(adcNoiseHasRequestedSpread) {
+	HostMcu &mcu = HostMcu::current();
+	mcu.setAdcVoltage(A0, 2.5);
+	mcu.setAdcNoise(4);
+	double sum = 0, squares = 0;
+	for (int i = 0; i < 2000; i++) {
+		int code = analogRead(A0);
+		sum += code;
+		squares += (double) code * code;
+	}
+	double mean = sum / 2000;
+	CHECK_NEAR(512, mean, 1);
+	CHECK_NEAR(4, sqrt(squares / 2000 - mean * mean), 0.5);
+}
+
+TEST(freeRunningAdcLatchesMuxAtConversionStart) {
+	HostMcu &mcu = HostMcu::current();
+	mcu.setAdcVoltage(A0, 1.0);
+	mcu.setAdcVoltage(A1, 4.0);
+	ADMUX = _BV(REFS0) | 0;
+	ADCSRB = 0;
+	ADCSRA = _BV(ADEN) | _BV(ADSC) | _BV(ADATE) | _BV(ADIF) | 7;
+	ADMUX = _BV(REFS0) | 1; //Попадёт только во второе преобразование
+	mcu.advanceCycles(13 * 128);
+	CHECK(ADCSRA & _BV(ADIF));
+	CHECK_NEAR(205, ADC, 1);
+	ADCSRA |= _BV(ADIF);
+	CHECK(!(ADCSRA & _BV(ADIF)));
+	mcu.advanceCycles(13 * 128);
+	CHECK_NEAR(819, ADC, 1);
+	ADMUX = _BV(REFS0) | _BV(ADLAR) | 0;
+	mcu.advanceCycles(2 * 13 * 128);
+	CHECK_EQUAL(205 >> 2, ADCH);
+}
+
+TEST(timer2CompareInterrupt) {
+	HostMcu &mcu = HostMcu::current();
+	timer2Matches = 0;
+	setupTimer2Millisecond();
+	mcu.advanceMillis(100);
+	CHECK_EQUAL(100, timer2Matches);
+	CHECK_EQUAL(1, nestedDepth);
+	CHECK_EQUAL(0, mcu.getInterruptDepth());
+	cli();
+	mcu.advanceMillis(5);
+	CHECK_EQUAL(100, timer2Matches); //Флаг поднят, но прерывания запрещены
+	CHECK(TIFR2 & _BV(OCF2A));
+	sei(); //Ожидающее прерывание срабатывает сразу
+	CHECK_EQUAL(101, timer2Matches);
+	TIMSK2 = 0;
+	mcu.advanceMillis(5);
+	CHECK_EQUAL(101, timer2Matches);
+}
+
+TEST(timerCounterFollowsTime) {
+	HostMcu &mcu = HostMcu::current();
+	TCCR1A = 0;
+	TCCR1B = _BV(CS10); //Normal, без предделителя
+	TCNT1 = 0;
+	mcu.advanceCycles(1000);
+	CHECK_EQUAL(1000, TCNT1);
+	timer1Overflows = 0;
+	TIMSK1 = _BV(TOIE1);
+	mcu.advanceCycles(65536UL * 10);
+	CHECK_EQUAL(10, timer1Overflows);
+	CHECK_EQUAL(1000, TCNT1);
+	TCCR1B = 0; //Остановлен - счётчик стоит
+	mcu.advanceCycles(500);
+	CHECK_EQUAL(1000, TCNT1);
+	TCCR0A = 0;
+	TCCR0B = _BV(CS01); //Таймер 0, предделитель 8
+	TCNT0 = 250;
+	mcu.advanceCycles(8 * 10);
+	CHECK_EQUAL(4, TCNT0);
+	CHECK(TIFR0 & _BV(TOV0));
+	OCR0A = 123; //У 8-битных таймеров за TCNT сразу идёт OCRA, а не старший байт счётчика
+	CHECK_EQUAL(123, OCR0A);
+}
+
+TEST(sleepWakesOnTimer2) {
+	HostMcu &mcu = HostMcu::current();
+	timer2Matches = 0;
+	setupTimer2Millisecond();
+	mcu.advanceMicros(300);
+	set_sleep_mode(SLEEP_MODE_PWR_SAVE);
+	sleep_mode();
+	CHECK_EQUAL(1, timer2Matches);
+	CHECK_EQUAL(1000, micros());
+	CHECK_EQUAL(700UL * 16, mcu.getSleepCycles());
+	TIMSK2 = 0;
+	set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+	sleep_enable();
+	CHECK(!mcu.sleepUntilInterrupt()); //Разбудить нечему
+	sleep_disable();
+}
+
+TEST(serialPort) {
+	HostMcu &mcu = HostMcu::current();
+	Serial.begin(115200);
+	CHECK_EQUAL(115200, mcu.getSerialBaud());
+	Serial.print("t=");
+	Serial.println(42);
+	Serial.print(255, HEX);
+	CHECK(mcu.takeSerialOutput() == "t=42\r\nFF");
+	mcu.serialInput("ab");
+	CHECK_EQUAL(2, Serial.available());
+	CHECK_EQUAL('a', Serial.peek());
+	CHECK_EQUAL('a', Serial.read());
+	CHECK_EQUAL('b', Serial.read());
+	CHECK_EQUAL(-1, Serial.read());
+}
+
+TEST(serialLineTiming) {
+	HostMcu &mcu = HostMcu::current();
+	uint8_t data[100];
+	for (int i = 0; i < 100; i++) {
+		data[i] = i;
+	}
+	mcu.serialReceive(data, 10);
+	CHECK_EQUAL(10, mcu.getSerialLostBytes()); //Порт не открыт
+	Serial.begin(9600);
+	mcu.serialReceive(data, 100);
+	mcu.advanceMicros(1041); //Байт - 10 бит по 104,2 мкс
+	CHECK_EQUAL(0, Serial.available());
+	mcu.advanceMicros(1);
+	CHECK_EQUAL(1, Serial.available());
+	CHECK_EQUAL(0, Serial.read());
+	mcu.advanceMillis(200);
+	CHECK_EQUAL(HOST_MCU_SERIAL_BUFFER, Serial.available());
+	CHECK_EQUAL(10 + 100 - 1 - HOST_MCU_SERIAL_BUFFER, mcu.getSerialLostBytes());
+	CHECK_EQUAL(1, Serial.read());
+
+	Serial.begin(115200);
+	uint64_t byteCycles = 10 * F_CPU / 115200; //86,8 мкс
+	uint64_t start = mcu.getCycles();
+	Serial.write(data, HOST_MCU_SERIAL_BUFFER);
+	CHECK_EQUAL(start, mcu.getCycles()); //Поместилось в буфер
+	CHECK_EQUAL(0, Serial.availableForWrite());
+	Serial.write(data, 36);
+	CHECK_EQUAL(36 * byteCycles, mcu.getCycles() - start);
+	Serial.flush();
+	CHECK_EQUAL(100 * byteCycles, mcu.getCycles() - start);
+	CHECK_EQUAL(HOST_MCU_SERIAL_BUFFER - 1, Serial.availableForWrite());
+	CHECK_EQUAL(100, mcu.takeSerialOutput().size());
+}
+
+TEST(devicesAreIndependent) {
+	HostMcu first, second;
+	first.select();
+	struct Restore {
+		~Restore() {
+			HostMcu::selectDefault();
+		}
+	} restore; //Неудачная проверка выходит из теста раньше
+	pinMode(13, OUTPUT);
+	digitalWrite(13, HIGH);
+	delay(10);
+	second.select();
+	CHECK_EQUAL(LOW, digitalRead(13));
+	CHECK_EQUAL(0, millis());
+	first.select();
+	CHECK_EQUAL(HIGH, digitalRead(13));
+	CHECK_EQUAL(10, millis());
+}
@@ -0,0 +1,218 @@
+#include "HostTest.h"
+#include "HotPathsReference.h"
+#include "HandledButton.h"
+#include "HandledEventTimer.h"
+#include "SevenSegmentsIndicator.h"
+#include "Voltmeter.h"
+#include <vector>
+
+//Разностные тесты: библиотека и её замороженная копия (reference/HotPathsReference.h) получают одни и те же случайные входы
+
+#define BUTTON_PIN 2
+#define MAX_EVENTS 64
+#define MAX_DIGITS 8
+#define MAX_SAMPLES 64
+
+static uint32_t randomState;
+
+static uint32_t random32() {
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+static uint32_t randomBelow(uint32_t range) {
+	return random32() % range;
+}
+
+TEST(buttonMatchesReference) {
+	randomState = 0x12345678;
+	const word intervals[] = {1, 2, 5, 10, 20, 1000};
+	for (int round = 0; round < 60; round++) {
+		word interval = intervals[randomBelow(6)];
+		unsigned long hold = randomBelow(4) == 0 ? 0 : randomBelow(200);
+		byte activeState = randomBelow(3);
+		HandledButton button(BUTTON_PIN, interval, hold, activeState);
+		FrozenButton reference(BUTTON_PIN, interval, hold, activeState);
+		byte level = randomBelow(2);
+		uint32_t bounceChance = 1 + randomBelow(64); //Дребезг сериями: то частая смена уровня, то долгое удержание
+		for (int step = 0; step < 3000; step++) {
+			if (step % 200 == 0) bounceChance = 1 + randomBelow(64);
+			if (randomBelow(bounceChance) == 0) level = !level;
+			HostMcu::current().setPinInput(BUTTON_PIN, level);
+			button.processStep();
+			reference.processStep();
+			CHECK_EQUAL(reference.isPressed(), button.isPressed());
+			CHECK_EQUAL(reference.getTimeInCurrentState(), button.getTimeInCurrentState());
+			CHECK_EQUAL(reference.getTimeInLastState(), button.getTimeInLastState());
+			if (randomBelow(8) == 0) CHECK_EQUAL(reference.isClicked(), button.isClicked());
+		}
+	}
+}
+
+TEST(eventTimerMatchesReference) {
+	randomState = 0x9E3779B9;
+	for (int round = 0; round < 40; round++) {
+		word interval = 1 + randomBelow(100);
+		StaticHandledEventTimer<MAX_EVENTS> timer(interval);
+		FrozenEvent referenceEvents[MAX_EVENTS];
+		FrozenEventTimer reference(interval, referenceEvents, MAX_EVENTS);
+		word count = 1 + randomBelow(MAX_EVENTS);
+		for (word i = 0; i < count; i++) {
+			unsigned long eventInterval = randomBelow(4) == 0 ? randomBelow(3) : randomBelow(5000);
+			boolean repeated = randomBelow(2);
+			word repeats = randomBelow(3) == 0 ? 0 : randomBelow(6);
+			CHECK_EQUAL(reference.createEvent(eventInterval), timer.createEvent(eventInterval, NULL));
+			timer.setRepeatability(i, repeated, repeats);
+			reference.setRepeatability(i, repeated, repeats);
+		}
+		timer.start();
+		reference.start();
+		for (int step = 0; step < 4000; step++) {
+			uint32_t action = randomBelow(100);
+			word id = randomBelow(count + 1); //Иногда - несуществующее событие
+			if (action < 80) {
+				timer.processStep();
+				reference.processStep();
+			} else if (action < 90) {
+				word micros = randomBelow(20000);
+				timer.processMcsStep(micros);
+				reference.processMcsStep(micros);
+			} else if (action < 95) {
+				timer.enableEvent(id);
+				reference.enableEvent(id);
+			} else if (action < 97) {
+				timer.disableEvent(id);
+				reference.disableEvent(id);
+			} else if (action < 98) {
+				timer.stop();
+				reference.stop();
+			} else {
+				timer.start();
+				reference.start();
+			}
+			CHECK_EQUAL(reference.getTimeToNextEvent(), timer.getTimeToNextEvent());
+			if (randomBelow(3) == 0) CHECK_EQUAL(reference.getEventState(id), timer.getEventState(id));
+			for (word i = 0; i < count; i++) {
+				CHECK_EQUAL(reference.isEventActive(i), timer.isEventActive(i));
+			}
+		}
+		for (word i = 0; i < count; i++) {
+			CHECK_EQUAL(reference.getEventState(i), timer.getEventState(i));
+		}
+	}
+}
+
+struct PinLog {
+	std::vector<int> changes; //Нога * 2 + уровень, в порядке записи
+};
+
+static void listen(HostMcu &mcu, PinLog &log) {
+	log.changes.clear();
+	mcu.setPinListener([&log](byte pin, byte level) {log.changes.push_back(pin * 2 + level);});
+}
+
+static boolean samePins(HostMcu &first, HostMcu &second) {
+	for (byte pin = 0; pin < 20; pin++) {
+		if (first.getPinMode(pin) != second.getPinMode(pin) || first.getPinLevel(pin) != second.getPinLevel(pin)) return false;
+	}
+	return true;
+}
+
+static void randomText(char *text, int size) {
+	static const char symbols[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz -[].....";
+	int length = randomBelow(size);
+	for (int i = 0; i < length; i++) {
+		text[i] = symbols[randomBelow(sizeof(symbols) - 1)];
+	}
+	text[length] = 0;
+}
+
+TEST(indicatorMatchesReference) {
+	randomState = 0xC0FFEE11;
+	byte segmentPins[8] = {2, 3, 4, 5, 6, 7, 8, 9};
+	byte digitPins[MAX_DIGITS] = {10, 11, 12, 13, 14, 15, 16, 17};
+	HostMcu &liveMcu = HostMcu::current();
+	HostMcu referenceMcu;
+	for (int round = 0; round < 40; round++) {
+		byte digits = 1 + randomBelow(MAX_DIGITS);
+		boolean pinType = randomBelow(2);
+		byte memory[MAX_DIGITS], referenceMemory[MAX_DIGITS];
+		liveMcu.reset();
+		referenceMcu.reset();
+		SevenSegmentsIndicator indicator(segmentPins, digits, digitPins, pinType, memory);
+		referenceMcu.select();
+		FrozenIndicator reference(segmentPins, digits, digitPins, pinType, referenceMemory);
+		liveMcu.select();
+		CHECK(samePins(liveMcu, referenceMcu));
+		PinLog liveLog, referenceLog;
+		listen(liveMcu, liveLog);
+		listen(referenceMcu, referenceLog);
+		for (int step = 0; step < 400; step++) {
+			uint32_t action = randomBelow(100);
+			if (action < 20) {
+				char text[16];
+				randomText(text, sizeof(text));
+				boolean shiftToRight = randomBelow(2);
+				indicator.print(text, shiftToRight);
+				reference.print(text, shiftToRight);
+			} else if (action < 23) {
+				byte index = randomBelow(MAX_DIGITS + 1);
+				byte value = randomBelow(256);
+				indicator.setDigitValue(index, value);
+				reference.setDigitValue(index, value);
+			} else if (action < 25) {
+				boolean show = randomBelow(2);
+				indicator.setPointShow(show);
+				reference.setPointShow(show);
+			} else if (action < 27) {
+				indicator.stopRefreshing();
+				reference.stopRefreshing();
+			} else if (action < 30) {
+				indicator.resumeRefreshing();
+				reference.resumeRefreshing();
+			} else {
+				indicator.refreshNext();
+				referenceMcu.select();
+				reference.refreshNext();
+				liveMcu.select();
+			}
+			CHECK(liveLog.changes == referenceLog.changes);
+			CHECK(samePins(liveMcu, referenceMcu));
+		}
+		liveMcu.setPinListener(NULL);
+		referenceMcu.setPinListener(NULL);
+	}
+	HostMcu::selectDefault();
+}
+
+TEST(voltmeterMatchesReference) {
+	randomState = 0x51ED2701;
+	const float references[] = {5., 1.1f, 3.3f};
+	for (int round = 0; round < 60; round++) {
+		byte samplesCount = 1 + randomBelow(MAX_SAMPLES);
+		float referenceVoltage = references[randomBelow(3)];
+		float top = randomBelow(2) ? 0 : randomBelow(100000);
+		float bottom = 1 + randomBelow(100000);
+		byte extraBits = randomBelow(3) == 0 ? randomBelow(VOLTMETER_MAX_OVERSAMPLING_BITS + 2) : 0;
+		word samples[MAX_SAMPLES], referenceSamples[MAX_SAMPLES];
+		Voltmeter voltmeter(A0, samples, samplesCount, referenceVoltage, top, bottom);
+		FrozenVoltmeter reference(referenceSamples, samplesCount, referenceVoltage, top, bottom);
+		voltmeter.setOversampling(extraBits);
+		reference.setOversampling(extraBits);
+		int code = randomBelow(1024);
+		int readChance = 1 + randomBelow(40);
+		for (int step = 0; step < 3000; step++) {
+			code += (int) randomBelow(9) - 4;
+			if (randomBelow(500) == 0) code = randomBelow(1024); //Скачок напряжения
+			code = code < 0 ? 0 : (code > 1023 ? 1023 : code);
+			voltmeter.processSample(code);
+			reference.processSample(code);
+			if (randomBelow(readChance) == 0) { //Результат усредняется с прошлым при чтении, поэтому важно, когда читать
+				CHECK_EQUAL(reference.getMillivolts(), voltmeter.getMillivolts());
+				CHECK(reference.getVoltage() == voltmeter.getVoltage());
+			}
+		}
+	}
+}
@@ -0,0 +1,371 @@
+#include "HostTest.h"
+#include "PatternPlayer.h"
+#include "PlayerMixer.h"
+#include "KeyframePlayer.h"
+#include "Rtttl.h"
+#include <vector>
+#include <math.h>
+#include <string.h>
+#include <limits.h>
+
+#define BUZZER_PIN 8
+
+struct ToneEvent {
+	unsigned long at;
+	int frequency; //0 - выключение звука
+	int duration;
+};
+
+static std::vector<ToneEvent> toneEvents;
+
+static void buzzerTone(int frequency, int duration) {
+	ToneEvent event = {millis(), frequency, duration};
+	toneEvents.push_back(event);
+	tone(BUZZER_PIN, frequency, duration);
+}
+
+static void buzzerNoTone() {
+	ToneEvent event = {millis(), 0, 0};
+	toneEvents.push_back(event);
+	noTone(BUZZER_PIN);
+}
+
+static int firstToneFrequency() { //play() начинает с выключения звука
+	for (size_t i = 0; i < toneEvents.size(); i++) {
+		if (toneEvents[i].frequency != 0) return toneEvents[i].frequency;
+	}
+	return 0;
+}
+
+static unsigned long playToEnd(SequencePlayer &player, unsigned int stepMs, unsigned long limitMs = 100000) {
+	unsigned long start = millis();
+	while (millis() - start < limitMs) {
+		player.processStepMs(stepMs);
+		if (player.getState() != PLAYING) break;
+		delay(stepMs);
+	}
+	return millis() - start;
+}
+
+TEST(playsArraysWithExactDuration) {
+	toneEvents.clear();
+	PatternPlayer player(buzzerTone, buzzerNoTone, 10);
+	int frequencies[] = {440, 0, 880};
+	int durations[] = {100, 50, 200};
+	player.play(frequencies, durations, 3, 2);
+	player.processStepMs(0);
+	CHECK_EQUAL(440, HostMcu::current().getToneFrequency(BUZZER_PIN));
+	unsigned long elapsed = playToEnd(player, 10);
+	CHECK_NEAR(700, elapsed, 10);
+	CHECK(toneEvents.size() >= 4);
+	CHECK_EQUAL(440, firstToneFrequency());
+	CHECK_EQUAL(0, HostMcu::current().getToneFrequency(BUZZER_PIN));
+}
+
+TEST(rareStepsDoNotStretchMelody) {
+	int frequencies[] = {500, 600, 700, 800, 900};
+	int durations[] = {30, 70, 20, 110, 45};
+	for (unsigned int stepMs = 1; stepMs <= 400; stepMs += 17) {
+		PatternPlayer player(buzzerTone, buzzerNoTone, stepMs);
+		player.play(frequencies, durations, 5, 3);
+		unsigned long elapsed = playToEnd(player, stepMs);
+		CHECK_NEAR(3 * 275, elapsed, stepMs);
+	}
+}
+
+TEST(parsesMelodyString) {
+	int frequencies[4], durations[4];
+	CHECK_EQUAL(2, PatternPlayer::parseMelody("@2#440,100%0,50%!", frequencies, durations, 4));
+	CHECK_EQUAL(440, frequencies[0]);
+	CHECK_EQUAL(50, durations[1]);
+	CHECK_EQUAL(PP_PARSE_ERR_UNTERMINATED, PatternPlayer::parseMelody("@1#440,100%", frequencies, durations, 4));
+	PatternPlayer player(buzzerTone, buzzerNoTone, 10);
+	player.play("@2#440,100%880,100%!");
+	CHECK_EQUAL(PP_PARSE_OK, player.getParseError());
+	CHECK_NEAR(200, playToEnd(player, 10), 10);
+}
+
+TEST(bufferHoldsWideNumbers) { //На хосте int 32-битный: числа длиннее пяти цифр
+	int frequencies[] = {123456789, -2147483647 - 1};
+	int durations[] = {250, -5};
+	char buffer[64];
+	const char *expected = "@2#123456789,250%-2147483648,-5%!";
+	CHECK_EQUAL(strlen(expected), PatternPlayer::convertInpMelodyToBuffer(frequencies, durations, 2, buffer, sizeof(buffer)));
+	CHECK(strcmp(expected, buffer) == 0);
+	char shortBuffer[8];
+	CHECK_EQUAL(strlen(expected), PatternPlayer::convertInpMelodyToBuffer(frequencies, durations, 2, shortBuffer, sizeof(shortBuffer)));
+	CHECK(strncmp(expected, shortBuffer, 7) == 0 && shortBuffer[7] == 0);
+}
+
+TEST(convertedMelodyParsesBack) {
+	int frequencies[] = {440, -1, 123456, INT_MAX, INT_MIN};
+	int durations[] = {100, -250, 0, INT_MIN, INT_MAX};
+	char buffer[96];
+	PatternPlayer::convertInpMelodyToBuffer(frequencies, durations, 5, buffer, sizeof(buffer));
+	int parsedFrequencies[5], parsedDurations[5];
+	CHECK_EQUAL(5, PatternPlayer::parseMelody(buffer, parsedFrequencies, parsedDurations, 5));
+	for (int i = 0; i < 5; i++) {
+		CHECK_EQUAL(frequencies[i], parsedFrequencies[i]);
+		CHECK_EQUAL(durations[i], parsedDurations[i]);
+	}
+	CHECK_EQUAL(PP_PARSE_ERR_NUMBER, PatternPlayer::parseMelody("@1#-,100%!", parsedFrequencies, parsedDurations, 5));
+	snprintf(buffer, sizeof(buffer), "@1#%ld,100%%!", (long) INT_MAX + 1);
+	CHECK_EQUAL(PP_PARSE_ERR_NUMBER, PatternPlayer::parseMelody(buffer, parsedFrequencies, parsedDurations, 5));
+	snprintf(buffer, sizeof(buffer), "@1#%ld,100%%!", (long) INT_MIN - 1);
+	CHECK_EQUAL(PP_PARSE_ERR_NUMBER, PatternPlayer::parseMelody(buffer, parsedFrequencies, parsedDurations, 5));
+}
+
+static const uint16_t progmemMelody[] PROGMEM = {PP_NOTE(69, 10), PP_REST(5), PP_NOTE(81, 10)};
+
+TEST(playsProgmemMelody) {
+	toneEvents.clear();
+	PatternPlayer player(buzzerTone, buzzerNoTone, 10);
+	player.playProgmem(progmemMelody, 3);
+	CHECK_NEAR(250, playToEnd(player, 10), 10);
+	CHECK_EQUAL(440, firstToneFrequency());
+	CHECK_EQUAL(440, PatternPlayer::noteToFrequency(69));
+	CHECK_EQUAL(880, PatternPlayer::noteToFrequency(81));
+}
+
+static const uint16_t outOfRangeMelody[] PROGMEM = {PP_NOTE(200, 10), PP_NOTE(255, 255)};
+
+TEST(packedNotesStayInIntRange) {
+	CHECK_EQUAL(12544, PatternPlayer::noteToFrequency(PP_MAX_NOTE)); //Соль девятой октавы
+	CHECK_EQUAL(0, PatternPlayer::noteToFrequency(PP_MAX_NOTE + 1));
+	CHECK_EQUAL(0, PatternPlayer::noteToFrequency(255));
+	for (byte note = 1; note <= PP_MAX_NOTE; note++) {
+		CHECK(PatternPlayer::noteToFrequency(note) > 0 && PatternPlayer::noteToFrequency(note) <= 32767);
+	}
+	toneEvents.clear();
+	PatternPlayer player(buzzerTone, buzzerNoTone, 100);
+	player.playProgmem(outOfRangeMelody, 2, 255); //255 * 255 мс не помещается в 16-битный int
+	CHECK_NEAR(10 * 255 + 32767, playToEnd(player, 100), 100);
+	CHECK_EQUAL(0, firstToneFrequency()); //Номера выше MIDI - паузы
+}
+
+TEST(compilesRtttl) {
+	const char *melody = "Test:d=4,o=5,b=120:8a,8p,a6,2c.6";
+	int notes[8], durations[8];
+	CHECK_EQUAL(4, Rtttl::parse(melody, notes, durations, 8));
+	CHECK_EQUAL(81, notes[0]); //a4 = 69, октава по умолчанию 5
+	CHECK_EQUAL(250, durations[0]);
+	CHECK_EQUAL(0, notes[1]);
+	CHECK_EQUAL(93, notes[2]);
+	CHECK_EQUAL(1500, durations[3]);
+	CHECK_EQUAL(4, Rtttl::parse(melody, NULL, NULL, 0));
+	CHECK(Rtttl::parse("broken", notes, durations, 8) < 0);
+	uint16_t packed[8];
+	byte unit = Rtttl::suggestDurationUnit(durations, 4);
+	CHECK_EQUAL(4, Rtttl::pack(notes, durations, 4, packed, unit));
+	CHECK_EQUAL(PP_NOTE(81, (250 + unit / 2) / unit), packed[0]);
+	PatternPlayer player(buzzerTone, buzzerNoTone, 10);
+	player.playRtttl(melody);
+	CHECK_NEAR(2500, playToEnd(player, 10), 10);
+}
+
+TEST(mixerPreemptsLowerPriority) {
+	toneEvents.clear();
+	PatternPlayer alarm(buzzerTone, buzzerNoTone, 10);
+	PatternPlayer click(buzzerTone, buzzerNoTone, 10);
+	PlayerMixer mixer(10);
+	mixer.addVoice(&alarm, 2, PM_PREEMPT_PAUSE);
+	mixer.addVoice(&click, 1);
+	int clickFrequencies[] = {500, 600, 700};
+	int clickDurations[] = {40, 40, 40};
+	int alarmFrequencies[] = {1000, 2000};
+	int alarmDurations[] = {30, 30};
+	click.play(clickFrequencies, clickDurations, 3);
+	for (int i = 0; i < 3; i++) {
+		delay(10);
+		mixer.processStep();
+	}
+	CHECK(mixer.getActiveVoice() == &click);
+	alarm.play(alarmFrequencies, alarmDurations, 2);
+	delay(10);
+	mixer.processStep();
+	CHECK(mixer.getActiveVoice() == &alarm);
+	CHECK(click.isMuted());
+	for (int i = 0; i < 20 && alarm.getState() == PLAYING; i++) {
+		delay(10);
+		mixer.processStep();
+	}
+	delay(10);
+	mixer.processStep();
+	CHECK(mixer.getActiveVoice() == &click);
+	CHECK(!click.isMuted());
+}
+
+TEST(mixerContinueKeepsMutedVoiceAdvancing) {
+	toneEvents.clear();
+	PatternPlayer alarm(buzzerTone, buzzerNoTone, 10);
+	PatternPlayer background(buzzerTone, buzzerNoTone, 10);
+	PlayerMixer mixer(10);
+	mixer.addVoice(&alarm, 2);
+	mixer.addVoice(&background, 1, PM_PREEMPT_CONTINUE);
+	int backgroundFrequencies[] = {300, 310, 320, 330, 340};
+	int backgroundDurations[] = {50, 50, 50, 50, 50};
+	int alarmFrequencies[] = {1000};
+	int alarmDurations[] = {100};
+	unsigned long start = millis();
+	background.play(backgroundFrequencies, backgroundDurations, 5);
+	for (int i = 0; i < 2; i++) {
+		mixer.processStep();
+		delay(10);
+	}
+	alarm.play(alarmFrequencies, alarmDurations, 1);
+	size_t alarmFirstEvent = toneEvents.size();
+	while (alarm.getState() == PLAYING) {
+		mixer.processStep();
+		CHECK(background.isMuted());
+		CHECK_EQUAL(PLAYING, background.getState());
+		delay(10);
+	}
+	size_t alarmLastEvent = toneEvents.size();
+	while (background.getState() == PLAYING && millis() - start < 1000) {
+		mixer.processStep();
+		delay(10);
+	}
+	CHECK_NEAR(250, millis() - start, 20); //Пауза под сигналом не растянула мелодию
+	for (size_t i = alarmFirstEvent; i < alarmLastEvent; i++) {
+		CHECK(toneEvents[i].frequency == 0 || toneEvents[i].frequency == 1000);
+	}
+	int resumedFrequency = 0;
+	for (size_t i = alarmLastEvent; i < toneEvents.size() && resumedFrequency == 0; i++) {
+		resumedFrequency = toneEvents[i].frequency;
+	}
+	CHECK_EQUAL(320, resumedFrequency); //Третья нота: первые две прошли без звука
+}
+
+TEST(mixerRoundRobinAlternatesEqualPriorities) {
+	toneEvents.clear();
+	PatternPlayer left(buzzerTone, buzzerNoTone, 10);
+	PatternPlayer right(buzzerTone, buzzerNoTone, 10);
+	PlayerMixer mixer(10);
+	mixer.addVoice(&left, 1, PM_PREEMPT_PAUSE); //В очереди голоса идут дальше независимо от правила
+	mixer.addVoice(&right, 1, PM_PREEMPT_PAUSE);
+	mixer.setRoundRobin(30);
+	int leftFrequencies[] = {400};
+	int rightFrequencies[] = {800};
+	int durations[] = {300};
+	unsigned long start = millis();
+	left.play(leftFrequencies, durations, 1);
+	right.play(rightFrequencies, durations, 1);
+	PatternPlayer *previous = NULL;
+	int switches = 0;
+	int runLength = 0;
+	boolean evenSlots = true;
+	for (int i = 0; i < 24; i++) {
+		mixer.processStep();
+		PatternPlayer *active = mixer.getActiveVoice();
+		CHECK(active == &left || active == &right);
+		CHECK(left.isMuted() != right.isMuted());
+		CHECK(!active->isMuted());
+		if (active != previous) {
+			if (previous != NULL && runLength != 3) evenSlots = false;
+			if (previous != NULL) switches++;
+			previous = active;
+			runLength = 0;
+		}
+		runLength++;
+		delay(10);
+	}
+	CHECK(evenSlots); //Каждый голос - по 30 мс подряд
+	CHECK_EQUAL(7, switches);
+	int lastFrequency = 0;
+	int alternations = 0;
+	for (size_t i = 0; i < toneEvents.size(); i++) {
+		int frequency = toneEvents[i].frequency;
+		if (frequency == 0) continue;
+		if (lastFrequency != 0 && frequency != lastFrequency) alternations++;
+		lastFrequency = frequency;
+	}
+	CHECK_EQUAL(7, alternations);
+	while ((left.getState() == PLAYING || right.getState() == PLAYING) && millis() - start < 1000) {
+		mixer.processStep();
+		delay(10);
+	}
+	CHECK_NEAR(300, millis() - start, 20); //Оба голоса шли всё время, а не только в свои отрезки
+}
+
+static int ledValue = -1;
+
+static void setLed(int value) {
+	ledValue = value;
+	analogWrite(9, value);
+}
+
+TEST(keyframesReachTargets) {
+	const Keyframe fade[] = {{255, 100, KF_LINEAR}, {0, 100, KF_EASE_IN_OUT}};
+	KeyframePlayer led(setLed, 10);
+	led.play(fade, 2);
+	for (int i = 0; i < 5; i++) {
+		led.processStep();
+		delay(10);
+	}
+	led.processStep();
+	CHECK_NEAR(128, led.getValue(), 3);
+	CHECK_EQUAL(ledValue, led.getValue());
+	CHECK_NEAR(150, playToEnd(led, 10), 10);
+	CHECK_EQUAL(0, led.getValue());
+	CHECK_EQUAL(-1, HostMcu::current().getPwm(9)); //analogWrite(0) выключает ШИМ
+}
+
+TEST(timer1BackendProgramsCtc) {
+	HostMcu &mcu = HostMcu::current();
+	PatternPlayer player(PP_TIMER1_PIN_A, 10);
+	int frequencies[] = {1000, 0, 440, 10};
+	int durations[] = {50, 20, 50, 50};
+	player.play(frequencies, durations, 4);
+	player.processStepMs(50); //Нота начинается, затем отсчитываются 50 мс до следующего вызова
+	CHECK_EQUAL(_BV(COM1A0), TCCR1A);
+	CHECK_EQUAL(_BV(WGM12) | _BV(CS11), TCCR1B);
+	CHECK_EQUAL(999, OCR1A); //16 МГц / 8 / 2 / 1000 Гц = 1000 тактов на полупериод
+	CHECK_NEAR(1000, mcu.getCompareOutputFrequency(PP_TIMER1_PIN_A), 0.001);
+	CHECK_EQUAL(0, mcu.getCompareOutputFrequency(PP_TIMER1_PIN_B));
+	TIFR1 = _BV(OCF1A);
+	mcu.advanceCycles(1000UL * 8 - 1);
+	CHECK(!(TIFR1 & _BV(OCF1A)));
+	mcu.advanceCycles(1); //Выход переключается каждые OCR1A + 1 тиков таймера
+	CHECK(TIFR1 & _BV(OCF1A));
+	player.processStepMs(20);
+	CHECK_EQUAL(0, TCCR1A); //Пауза: таймер стоит, нога в LOW
+	CHECK_EQUAL(0, TCCR1B);
+	CHECK_EQUAL(0, mcu.getCompareOutputFrequency(PP_TIMER1_PIN_A));
+	CHECK_EQUAL(LOW, mcu.getPinLevel(PP_TIMER1_PIN_A));
+	player.processStepMs(50);
+	CHECK_EQUAL(2272, OCR1A);
+	CHECK_NEAR(440, mcu.getCompareOutputFrequency(PP_TIMER1_PIN_A), 0.1);
+	player.processStepMs(20);
+	CHECK_EQUAL(_BV(WGM12) | _BV(CS11) | _BV(CS10), TCCR1B); //10 Гц не помещаются в 16 бит с предделителем 8
+	CHECK_EQUAL(12499, OCR1A);
+	CHECK_NEAR(10, mcu.getCompareOutputFrequency(PP_TIMER1_PIN_A), 0.001);
+	player.setMuted(true);
+	CHECK_EQUAL(0, TCCR1B);
+	player.setMuted(false);
+	player.processStepMs(0);
+	CHECK_NEAR(10, mcu.getCompareOutputFrequency(PP_TIMER1_PIN_A), 0.001);
+	player.stop();
+	CHECK_EQUAL(0, mcu.getCompareOutputFrequency(PP_TIMER1_PIN_A));
+}
+
+TEST(timer1NoteTableMatchesPitch) {
+	HostMcu &mcu = HostMcu::current();
+	PatternPlayer player(PP_TIMER1_PIN_B, 10);
+	for (int note = 12; note <= 127; note++) {
+		uint16_t melody[1] = {PP_NOTE(note, 10)};
+		player.playProgmem(melody, 1);
+		player.processStepMs(0);
+		CHECK_EQUAL(_BV(COM1B0), TCCR1A);
+		CHECK_EQUAL(0, OCR1B);
+		double expected = 440 * pow(2, (note - 69) / 12.);
+		double frequency = mcu.getCompareOutputFrequency(PP_TIMER1_PIN_B);
+		double prescaler = (TCCR1B & 7) == _BV(CS11) ? 8 : 64;
+		CHECK(fabs(F_CPU / (2 * prescaler * frequency) - F_CPU / (2 * prescaler * expected)) <= 1); //Ошибка периода - не больше такта таймера
+		if (note <= 108) CHECK(fabs(1200 * log2(frequency / expected)) < 2); //До C8 - меньше 2 центов, выше на полупериод меньше 240 тактов
+		player.stop();
+	}
+	uint16_t lowest[1] = {PP_NOTE(5, 10)}; //Ниже таблицы - через частоту в герцах
+	player.playProgmem(lowest, 1);
+	player.processStepMs(0);
+	CHECK_NEAR(PatternPlayer::noteToFrequency(5), mcu.getCompareOutputFrequency(PP_TIMER1_PIN_B), 0.01);
+}
@@ -0,0 +1,116 @@
+#include "HostTest.h"
+#include "Profiler.h"
+#include "ProfileDump.h"
+#include "HandledButton.h"
+#include "HandledEventTimer.h"
+#include <string>
+
+#define PROFILER_ID_OUTER PROFILER_ID_USER
+#define PROFILER_ID_INNER (PROFILER_ID_USER + 1)
+#define PROFILER_ID_TICK (PROFILER_ID_USER + 2)
+
+static HandledButton *tickedButton = NULL;
+
+ISR(TIMER2_COMPA_vect) {
+	PROFILER_SCOPE(PROFILER_ID_TICK);
+	if (tickedButton != NULL) tickedButton->processStep();
+}
+
+static volatile unsigned long spinSink = 0;
+
+static void inner() {
+	PROFILER_SCOPE(PROFILER_ID_INNER);
+	for (int i = 0; i < 1000; i++) spinSink += i;
+}
+
+static void outer() {
+	PROFILER_SCOPE(PROFILER_ID_OUTER);
+	inner();
+	inner();
+}
+
+static void startTimer2(byte compare) {
+	TCCR2A = _BV(WGM21);
+	TCCR2B = _BV(CS22); //Предделитель 64
+	OCR2A = compare;
+	TIMSK2 = _BV(OCIE2A);
+}
+
+TEST(countsCallsAndNesting) {
+	Profiler::reset();
+	for (int i = 0; i < 5; i++) outer();
+	ProfilerEntry outerEntry, innerEntry;
+	CHECK(Profiler::getEntry(PROFILER_ID_OUTER, &outerEntry));
+	CHECK(Profiler::getEntry(PROFILER_ID_INNER, &innerEntry));
+	CHECK_EQUAL(5, outerEntry.calls);
+	CHECK_EQUAL(10, innerEntry.calls);
+	CHECK_EQUAL(0, outerEntry.isrCalls);
+	CHECK_EQUAL(1, outerEntry.maxDepth);
+	CHECK_EQUAL(2, innerEntry.maxDepth);
+	CHECK(innerEntry.minTime <= innerEntry.maxTime);
+	CHECK(innerEntry.totalTime >= (uint64_t) innerEntry.maxTime);
+	CHECK(outerEntry.minTime >= 2 * innerEntry.minTime);
+	CHECK_EQUAL(0, Profiler::getDepth());
+	CHECK(!Profiler::getEntry(PROFILER_ID_SEVEN_SEGMENTS_REFRESH, &outerEntry));
+}
+
+TEST(libraryHooksAreRecorded) {
+	Profiler::reset();
+	HandledButton button(2, 10);
+	HandledEventTimer timer(10);
+	for (int i = 0; i < 7; i++) button.processStep();
+	for (int i = 0; i < 3; i++) timer.processHandlers();
+	ProfilerEntry entry;
+	CHECK(Profiler::getEntry(PROFILER_ID_BUTTON_STEP, &entry));
+	CHECK_EQUAL(7, entry.calls);
+	CHECK(Profiler::getEntry(PROFILER_ID_EVENT_TIMER_HANDLERS, &entry));
+	CHECK_EQUAL(3, entry.calls);
+}
+
+TEST(interruptCallsAreNested) {
+	Profiler::reset();
+	HandledButton button(2, 1);
+	tickedButton = &button;
+	startTimer2(249); //1 мс
+	HostMcu::current().advanceMillis(20);
+	TIMSK2 = 0;
+	tickedButton = NULL;
+	ProfilerEntry tick, step;
+	CHECK(Profiler::getEntry(PROFILER_ID_TICK, &tick));
+	CHECK(Profiler::getEntry(PROFILER_ID_BUTTON_STEP, &step));
+	CHECK_EQUAL(20, tick.calls);
+	CHECK_EQUAL(20, tick.isrCalls);
+	CHECK_EQUAL(20, step.isrCalls);
+	CHECK_EQUAL(2, step.maxDepth);
+}
+
+TEST(dumpDecodesOnHost) {
+	Profiler::reset();
+	HandledButton button(2, 10);
+	for (int i = 0; i < 4; i++) button.processStep();
+	outer();
+	Serial.print("boot\n");
+	Profiler::dump(Serial);
+	Serial.print("tail");
+	std::string bytes = HostMcu::current().takeSerialOutput();
+	CHECK_EQUAL(5 + 6 + 3 * 26 + 1 + 4, bytes.size());
+	std::vector<ProfileDump> dumps = decodeProfileDumps((const uint8_t *) bytes.data(), bytes.size());
+	CHECK_EQUAL(1, dumps.size());
+	const ProfileDump &dump = dumps[0];
+	CHECK_EQUAL(PROFILER_UNIT_NANOSECONDS, dump.timeUnit);
+	CHECK_EQUAL(F_CPU / 1000000UL, dump.cpuMhz);
+	CHECK_EQUAL(3, dump.entries.size());
+	CHECK_EQUAL(PROFILER_ID_BUTTON_STEP, dump.entries[0].id);
+	CHECK_EQUAL(4, dump.entries[0].calls);
+	ProfilerEntry inner;
+	Profiler::getEntry(PROFILER_ID_INNER, &inner);
+	CHECK_EQUAL(PROFILER_ID_INNER, dump.entries[2].id);
+	CHECK_EQUAL(inner.maxTime, dump.entries[2].maxTime);
+	CHECK_EQUAL(inner.totalTime, dump.entries[2].totalTime);
+	CHECK_EQUAL(2, dump.entries[2].maxDepth);
+	std::string report = formatProfileReport(dump);
+	CHECK(report.find("HandledButton::processStep") != std::string::npos);
+	CHECK(report.find("user 1") != std::string::npos);
+	bytes[20] ^= 0x40; //Испорченный дамп пропускается
+	CHECK_EQUAL(0, decodeProfileDumps((const uint8_t *) bytes.data(), bytes.size()).size());
+}
@@ -0,0 +1,233 @@
+#include "HostTest.h"
+#include "SerialProtocol.h"
+#include "SevenSegmentsIndicator.h"
+#include "PatternPlayer.h"
+#include "Voltmeter.h"
+#include <string>
+#include <vector>
+
+#define BUZZER_PIN 9
+
+struct Frame {
+	byte command;
+	std::string payload;
+};
+
+static std::vector<Frame> received;
+
+static void recordFrame(ProtocolFrame &frame) {
+	Frame copy;
+	copy.command = frame.getCommand();
+	for (byte i = 0; i < frame.getLength(); i++) {
+		copy.payload += (char) frame.getByte(i);
+	}
+	received.push_back(copy);
+}
+
+static std::string encodeFrame(byte command, const std::string &payload) {
+	std::string frame;
+	frame += (char) SPR_SYNC;
+	frame += (char) command;
+	frame += (char) payload.size();
+	frame += payload;
+	byte crc = 0;
+	for (size_t i = 1; i < frame.size(); i++) {
+		crc = SerialProtocol::crc8(crc, frame[i]);
+	}
+	frame += (char) crc;
+	return frame;
+}
+
+static std::vector<Frame> decodeFrames(const std::string &bytes) {
+	std::vector<Frame> frames;
+	SerialProtocol decoder(Serial);
+	received.clear();
+	decoder.addCommand(SPR_REPLY_UNKNOWN, recordFrame);
+	decoder.addCommand(SPR_CMD_STATISTICS | SPR_REPLY_FLAG, recordFrame);
+	decoder.addCommand(SPR_CMD_VOLTAGE | SPR_REPLY_FLAG, recordFrame);
+	for (size_t i = 0; i < bytes.size(); i++) {
+		decoder.feed(bytes[i]);
+	}
+	frames.swap(received);
+	return frames;
+}
+
+static void feedAll(SerialProtocol &protocol, const std::string &bytes) {
+	for (size_t i = 0; i < bytes.size(); i++) {
+		protocol.feed(bytes[i]);
+	}
+}
+
+TEST(parsesFramesByteByByte) {
+	received.clear();
+	SerialProtocol protocol(Serial);
+	CHECK(protocol.addCommand(SPR_CMD_TEXT, recordFrame));
+	std::string stream = "noise" + encodeFrame(SPR_CMD_TEXT, "12.34") + encodeFrame(SPR_CMD_TEXT, "");
+	for (size_t i = 0; i < stream.size(); i++) {
+		CHECK_EQUAL(i < stream.size() - 4 ? 0 : 1, received.size()); //Кадр разбирается по приходу последнего байта
+		protocol.feed(stream[i]);
+	}
+	CHECK_EQUAL(2, received.size());
+	CHECK_EQUAL(SPR_CMD_TEXT, received[0].command);
+	CHECK(received[0].payload == "12.34");
+	CHECK(received[1].payload.empty());
+	CHECK_EQUAL(stream.size(), protocol.getBytesCount());
+	CHECK_EQUAL(2, protocol.getFramesCount());
+	CHECK_EQUAL(5, protocol.getDroppedBytesCount());
+}
+
+TEST(resyncsInsideBufferedBytes) {
+	received.clear();
+	SerialProtocol protocol(Serial);
+	protocol.addCommand(SPR_CMD_DIGITS, recordFrame);
+	std::string broken = encodeFrame(SPR_CMD_DIGITS, "\x01\x02\x03\x04");
+	broken.erase(4, 1); //Порт потерял байт: кадр "съест" начало следующего
+	std::string corrupted = encodeFrame(SPR_CMD_DIGITS, "abcd");
+	corrupted[4] ^= 0x40;
+	std::string oversized = std::string(1, (char) SPR_SYNC) + (char) SPR_CMD_DIGITS + (char) (SPR_MAX_PAYLOAD + 1);
+	feedAll(protocol, broken + encodeFrame(SPR_CMD_DIGITS, "good") + corrupted + oversized + encodeFrame(SPR_CMD_DIGITS, "last"));
+	CHECK_EQUAL(2, received.size());
+	CHECK(received[0].payload == "good");
+	CHECK(received[1].payload == "last");
+	CHECK_EQUAL(2, protocol.getChecksumErrorsCount());
+}
+
+static std::vector<word> words;
+
+static void recordWords(ProtocolFrame &frame) {
+	for (byte i = 0; i + 1 < frame.getLength(); i += 2) {
+		words.push_back(frame.getWord(i));
+	}
+	byte copy[SPR_MAX_PAYLOAD];
+	CHECK_EQUAL(frame.getLength(), frame.copyTo(copy, sizeof(copy)));
+	for (byte i = 0; i < frame.getLength(); i++) {
+		CHECK_EQUAL(frame.getByte(i), copy[i]);
+	}
+	CHECK_EQUAL(0, frame.getByte(frame.getLength())); //За концом данных - нули
+}
+
+TEST(payloadWrapsAroundRing) {
+	words.clear();
+	SerialProtocol protocol(Serial);
+	protocol.addCommand(SPR_CMD_MELODY, recordWords);
+	std::vector<word> sent;
+	for (int frame = 0; frame < 50; frame++) {
+		std::string payload;
+		for (int i = 0; i < frame % 32 + 1; i++) { //Длины кадров не делят размер буфера, поэтому данные переходят через его конец
+			word value = frame * 1000 + i;
+			sent.push_back(value);
+			payload += (char) (value & 0xFF);
+			payload += (char) (value >> 8);
+		}
+		feedAll(protocol, encodeFrame(SPR_CMD_MELODY, payload));
+	}
+	CHECK_EQUAL(50, protocol.getFramesCount());
+	CHECK_EQUAL(sent.size(), words.size());
+	for (size_t i = 0; i < sent.size(); i++) {
+		CHECK_EQUAL(sent[i], words[i]);
+	}
+}
+
+TEST(repliesWithStatisticsAndUnknown) {
+	HostMcu &mcu = HostMcu::current();
+	Serial.begin(1000000);
+	SerialProtocol protocol(Serial);
+	std::string request = encodeFrame(0x33, "x") + "zz" + encodeFrame(SPR_CMD_STATISTICS, "");
+	mcu.serialInput((const uint8_t *) request.data(), request.size());
+	protocol.processInput();
+	CHECK_EQUAL(2, protocol.getSentFramesCount());
+	CHECK_EQUAL(1, protocol.getUnknownCommandsCount());
+	std::vector<Frame> replies = decodeFrames(mcu.takeSerialOutput());
+	CHECK_EQUAL(2, replies.size());
+	CHECK_EQUAL(SPR_REPLY_UNKNOWN, replies[0].command);
+	CHECK(replies[0].payload == "\x33");
+	CHECK_EQUAL(SPR_CMD_STATISTICS | SPR_REPLY_FLAG, replies[1].command);
+	CHECK_EQUAL(20, replies[1].payload.size());
+	const byte *counters = (const byte *) replies[1].payload.data();
+	CHECK_EQUAL(request.size(), counters[0]); //Принято байт
+	CHECK_EQUAL(2, counters[4]); //Кадров, вместе с запросом статистики
+	CHECK_EQUAL(0, counters[8]);
+	CHECK_EQUAL(2, counters[12]); //Пропущено байт
+	CHECK_EQUAL(1, counters[16]);
+	protocol.resetStatistics();
+	CHECK_EQUAL(0, protocol.getBytesCount());
+}
+
+static SevenSegmentsIndicator *indicator;
+static PatternPlayer *player;
+static unsigned long millivolts; //Читается после каждого измерения: getMillivolts() сглаживает результат между вызовами
+static SerialProtocol *protocol;
+static int melodyFrequencies[SPR_MAX_PAYLOAD / 2];
+static int melodyDurations[SPR_MAX_PAYLOAD / 2];
+
+static void buzzerTone(int frequency, int duration) {
+	tone(BUZZER_PIN, frequency, duration);
+}
+
+static void buzzerNoTone() {
+	noTone(BUZZER_PIN);
+}
+
+static void printText(ProtocolFrame &frame) {
+	char text[SPR_MAX_PAYLOAD + 1];
+	frame.copyText(text, sizeof(text));
+	indicator->print(text);
+}
+
+static void playMelody(ProtocolFrame &frame) {
+	byte count = frame.getLength() / 2;
+	player->stop();
+	for (byte i = 0; i < count; i++) {
+		word note = frame.getWord(i * 2);
+		melodyFrequencies[i] = PatternPlayer::noteToFrequency(note >> 8);
+		melodyDurations[i] = (note & 0xFF) * PP_DEFAULT_DURATION_UNIT;
+	}
+	player->play(melodyFrequencies, melodyDurations, count);
+}
+
+static void sendVoltage(ProtocolFrame &frame) {
+	byte reply[4];
+	for (byte i = 0; i < 4; i++) {
+		reply[i] = millivolts >> (8 * i);
+	}
+	protocol->sendReply(frame, reply, sizeof(reply));
+}
+
+TEST(drivesLibrariesOverTimedLine) {
+	HostMcu &mcu = HostMcu::current();
+	byte segmentPins[8] = {2, 3, 4, 5, 6, 7, 8, 14};
+	byte digitPins[4] = {10, 11, 12, 13};
+	SevenSegmentsIndicator display(segmentPins, 4, digitPins);
+	PatternPlayer buzzer(buzzerTone, buzzerNoTone, 10);
+	Voltmeter battery(A0);
+	SerialProtocol link(Serial);
+	indicator = &display;
+	player = &buzzer;
+	protocol = &link;
+	link.addCommand(SPR_CMD_TEXT, printText);
+	link.addCommand(SPR_CMD_MELODY, playMelody);
+	link.addCommand(SPR_CMD_VOLTAGE, sendVoltage);
+	mcu.setAdcVoltage(0, 2.5);
+	Serial.begin(115200);
+	uint16_t notes[2] = {PP_NOTE(69, 20), PP_NOTE(81, 20)}; //A4, A5 по 200 мс
+	std::string stream = encodeFrame(SPR_CMD_TEXT, "12.5") + encodeFrame(SPR_CMD_MELODY, std::string((const char *) notes, sizeof(notes)))
+		+ encodeFrame(SPR_CMD_VOLTAGE, "");
+	mcu.serialReceive((const uint8_t *) stream.data(), stream.size());
+	for (int step = 0; step < 100; step++) { //10 мс: кадры приходят за 2,3 мс
+		link.processInput();
+		battery.processMeasurement();
+		millivolts = battery.getMillivolts();
+		mcu.advanceMicros(100);
+	}
+	buzzer.processStep();
+	CHECK_EQUAL(3, link.getFramesCount());
+	CHECK_EQUAL(0, mcu.getSerialLostBytes());
+	CHECK_EQUAL(PLAYING, buzzer.getState());
+	CHECK_EQUAL(440, mcu.getToneFrequency(BUZZER_PIN));
+	std::vector<Frame> replies = decodeFrames(mcu.takeSerialOutput());
+	CHECK_EQUAL(1, replies.size());
+	CHECK_EQUAL(SPR_CMD_VOLTAGE | SPR_REPLY_FLAG, replies[0].command);
+	CHECK_EQUAL(4, replies[0].payload.size());
+	const byte *reply = (const byte *) replies[0].payload.data();
+	CHECK_NEAR(2500, reply[0] | (reply[1] << 8), 10);
+}
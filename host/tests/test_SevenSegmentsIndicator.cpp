@@ -0,0 +1,89 @@
+#include "HostTest.h"
+#include "SevenSegmentsIndicator.h"
+
+static byte segmentPins[8] = {2, 3, 4, 5, 6, 7, 8, 9}; //A, B, C, D, E, F, G, dp
+static byte digitPins[4] = {10, 11, 12, 13};
+
+static byte readSegments(boolean commonAnode) { //Что сейчас горит, в порядке A..dp от старшего бита
+	byte value = 0;
+	for (byte i = 0; i < 8; i++) {
+		boolean lit = HostMcu::current().getPinLevel(segmentPins[i]) == (commonAnode ? LOW : HIGH);
+		if (lit) value |= 0x80 >> i;
+	}
+	return value;
+}
+
+static int activeDigit() {
+	int active = -1;
+	for (byte i = 0; i < 4; i++) {
+		if (HostMcu::current().getPinMode(digitPins[i]) == OUTPUT) {
+			if (active >= 0) return -2; //Два разряда сразу
+			active = i;
+		}
+	}
+	return active;
+}
+
+TEST(multiplexesDigitsOneAtATime) {
+	SevenSegmentsIndicator indicator(segmentPins, 4, digitPins);
+	indicator.print("1.234");
+	byte expected[4] = {SSI_DIGIT_ONE | SSI_ADDITIVE_DOTPOINT, SSI_DIGIT_TWO, SSI_DIGIT_THREE, SSI_DIGIT_FOUR};
+	for (int step = 0; step < 8; step++) {
+		indicator.refreshNext();
+		int digit = activeDigit();
+		CHECK(digit >= 0);
+		CHECK_EQUAL(HIGH, HostMcu::current().getPinLevel(digitPins[digit]));
+		CHECK_EQUAL(expected[digit], readSegments(true));
+	}
+}
+
+TEST(kathodeAndLetters) {
+	SevenSegmentsIndicator indicator(segmentPins, 4, digitPins, SSI_DGPIN_KATHODE);
+	indicator.print("ab", false);
+	indicator.stopRefreshing();
+	indicator.refreshNext();
+	CHECK_EQUAL(0, activeDigit());
+	CHECK_EQUAL(LOW, HostMcu::current().getPinLevel(digitPins[0]));
+	CHECK_EQUAL(SSI_LETTER_A, readSegments(false));
+	indicator.setPowerState(false);
+	CHECK_EQUAL(-1, activeDigit());
+}
+
+static void readDisplay(SevenSegmentsIndicator &indicator, byte *digits) {
+	for (byte step = 0; step < 4; step++) {
+		indicator.refreshNext();
+		digits[activeDigit()] = readSegments(true);
+	}
+}
+
+TEST(printsCharStringWithoutHeap) {
+	SevenSegmentsIndicator indicator(segmentPins, 4, digitPins);
+	struct {
+		const char *text;
+		boolean shiftToRight;
+		byte digits[4];
+	} cases[] = {
+		{"1.234", true, {SSI_DIGIT_ONE | SSI_ADDITIVE_DOTPOINT, SSI_DIGIT_TWO, SSI_DIGIT_THREE, SSI_DIGIT_FOUR}},
+		{"12", true, {0, 0, SSI_DIGIT_ONE, SSI_DIGIT_TWO}},
+		{"12", false, {SSI_DIGIT_ONE, SSI_DIGIT_TWO, 0, 0}},
+		{"12345", true, {SSI_DIGIT_ONE, SSI_DIGIT_TWO, SSI_DIGIT_THREE, SSI_DIGIT_FOUR}},
+		{"-3.5", true, {0, SSI_SYMBOLS_MINUS, SSI_DIGIT_THREE | SSI_ADDITIVE_DOTPOINT, SSI_DIGIT_FIVE}},
+		{"1.2", true, {0, 0, SSI_DIGIT_ONE | SSI_ADDITIVE_DOTPOINT, SSI_DIGIT_TWO}}, //Точка не занимает разряд
+		{"", true, {0, 0, 0, 0}},
+	};
+	for (byte i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		indicator.print("8888"); //Вывод должен перезаписать все разряды
+		indicator.print(cases[i].text, cases[i].shiftToRight);
+		byte digits[4];
+		readDisplay(indicator, digits);
+		for (byte digit = 0; digit < 4; digit++) {
+			CHECK_EQUAL(cases[i].digits[digit], digits[digit]);
+		}
+	}
+	String text = "3.5";
+	indicator.print(text, false);
+	byte digits[4];
+	readDisplay(indicator, digits);
+	CHECK_EQUAL(SSI_DIGIT_THREE | SSI_ADDITIVE_DOTPOINT, digits[0]);
+	CHECK_EQUAL(0, digits[2]);
+}
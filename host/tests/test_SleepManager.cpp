@@ -0,0 +1,222 @@
+#include "HostTest.h"
+#include "SleepManager.h"
+#include "TickDispatcher.h"
+#include "HandledEventTimer.h"
+#include "HandledButton.h"
+#include "PatternPlayer.h"
+
+static TickDispatcher *activeTicker = NULL;
+static SleepManager *activeSleeper = NULL;
+
+ISR(TIMER2_COMPA_vect) {
+	if (activeTicker != NULL) activeTicker->processTick();
+}
+
+ISR(WDT_vect) {
+	if (activeSleeper != NULL) activeSleeper->processWatchdog();
+}
+
+EMPTY_INTERRUPT(PCINT2_vect);
+
+static unsigned long fixedDeadline = SM_NO_DEADLINE;
+
+static unsigned long fixedDeadlineFunc() {
+	return fixedDeadline;
+}
+
+static unsigned long farDeadline() {
+	return 500;
+}
+
+static unsigned long noDeadline() {
+	return SM_NO_DEADLINE;
+}
+
+static HandledEventTimer *activeEvents = NULL;
+static unsigned int firesCount = 0;
+
+static void countFire() {
+	firesCount++;
+}
+
+static void eventsTask() {
+	activeEvents->processStep();
+}
+
+static unsigned long eventsDeadline() {
+	return activeEvents->getTimeToNextEvent();
+}
+
+static void eventsCatchUp(unsigned long sleptMs) {
+	activeEvents->processMcsStep(sleptMs);
+}
+
+static double powerDownShare() {
+	HostMcu &mcu = HostMcu::current();
+	return (double) mcu.getSleepCycles(SLEEP_MODE_PWR_DOWN) / mcu.getCycles();
+}
+
+TEST(nearestDeadlineWins) {
+	SleepManager sleeper;
+	CHECK_EQUAL(SM_NO_DEADLINE, sleeper.getNextDeadline());
+	fixedDeadline = 40;
+	CHECK(sleeper.addComponent(farDeadline));
+	CHECK(sleeper.addComponent(fixedDeadlineFunc));
+	CHECK(sleeper.addComponent(noDeadline));
+	CHECK(!sleeper.addComponent(NULL));
+	CHECK_EQUAL(40, sleeper.getNextDeadline());
+	CHECK(sleeper.addWakePin(2));
+	CHECK(sleeper.addWakePin(A0));
+	CHECK(!sleeper.addWakePin(20));
+}
+
+TEST(shortDeadlineSleepsIdle) {
+	HostMcu &mcu = HostMcu::current();
+	TickDispatcher ticker(1000); //В эмуляторе Timer0 не вызывает прерываний, будит тик
+	ticker.begin();
+	SleepManager sleeper;
+	fixedDeadline = SM_MIN_DEEP_SLEEP - 1;
+	sleeper.addComponent(fixedDeadlineFunc);
+	CHECK_EQUAL(SM_SLEEP_IDLE, sleeper.sleep());
+	CHECK_EQUAL(1000UL * F_CPU / 1000000, mcu.getSleepCycles(SLEEP_MODE_IDLE));
+	CHECK_EQUAL(0, mcu.getSleepCycles(SLEEP_MODE_PWR_DOWN));
+	CHECK_EQUAL(1, sleeper.getIdleSleepsCount());
+	ticker.stop();
+}
+
+TEST(deepSleepUsesLargestWatchdogPeriod) {
+	HostMcu &mcu = HostMcu::current();
+	SleepManager sleeper;
+	activeSleeper = &sleeper;
+	fixedDeadline = 700;
+	sleeper.addComponent(fixedDeadlineFunc);
+	CHECK_EQUAL(SM_SLEEP_DEEP, sleeper.sleep());
+	CHECK_EQUAL(512, sleeper.getSleptMillis());
+	CHECK_EQUAL(512UL * F_CPU / 1000, mcu.getSleepCycles(SLEEP_MODE_PWR_DOWN));
+	CHECK_EQUAL(0, WDTCSR & (_BV(WDIE) | _BV(WDE))); //Сторожевой таймер выключен после сна
+	activeSleeper = NULL;
+}
+
+static void runEventsFor(SleepManager &sleeper, unsigned long ms) {
+	HandledEventTimer events(1);
+	activeEvents = &events;
+	firesCount = 0;
+	events.createRepeatedEvent(1000, countFire, 0);
+	events.start();
+	TickDispatcher ticker(1000);
+	activeTicker = &ticker;
+	activeSleeper = &sleeper;
+	ticker.addTask(eventsTask);
+	sleeper.addComponent(eventsDeadline, eventsCatchUp);
+	ticker.begin();
+	while (HostMcu::current().getMillis() < ms) {
+		events.processHandlers();
+		sleeper.sleep();
+	}
+	ticker.stop();
+	activeTicker = NULL;
+	activeSleeper = NULL;
+}
+
+TEST(eventsFireOnTimeBetweenDeepSleeps) {
+	SleepManager sleeper;
+	runEventsFor(sleeper, 10000);
+	CHECK_NEAR(10, firesCount, 1);
+	CHECK(sleeper.getDeepSleepsCount() > 0);
+	CHECK(powerDownShare() > 0.95);
+}
+
+TEST(deepSleepCanBeForbidden) {
+	SleepManager sleeper;
+	sleeper.setDeepSleepAllowed(false);
+	runEventsFor(sleeper, 10000);
+	CHECK_NEAR(10, firesCount, 1);
+	CHECK_EQUAL(0, sleeper.getDeepSleepsCount());
+	CHECK_EQUAL(0, HostMcu::current().getSleepCycles(SLEEP_MODE_PWR_DOWN));
+}
+
+static HandledButton *activeButton = NULL;
+
+static void buttonTask() {
+	activeButton->processStep();
+}
+
+static unsigned long buttonDeadline() {
+	return activeButton->isSettling() || activeButton->isPressed() ? 0 : SM_NO_DEADLINE;
+}
+
+TEST(buttonWakesFromDeepSleep) {
+	HostMcu &mcu = HostMcu::current();
+	HandledButton button(2, 1);
+	activeButton = &button;
+	TickDispatcher ticker(1000);
+	activeTicker = &ticker;
+	ticker.addTask(buttonTask);
+	ticker.begin();
+	SleepManager sleeper;
+	activeSleeper = &sleeper;
+	sleeper.addComponent(buttonDeadline);
+	sleeper.addWakePin(2);
+	mcu.scheduleAction(3000ULL * F_CPU / 1000, [&mcu]() {
+		mcu.setPinInput(2, LOW);
+	});
+	while (!button.isPressed() && mcu.getMillis() < 10000) {
+		button.processHandlers();
+		sleeper.sleep();
+	}
+	CHECK(button.isPressed());
+	CHECK_NEAR(3000 + BTN_DEFAULT_HOLD_TIME, mcu.getMillis(), 3);
+	CHECK_EQUAL(0, sleeper.getSleptMillis()); //Разбудила нога, а не сторожевой таймер
+	CHECK(powerDownShare() > 0.95);
+	ticker.stop();
+	activeTicker = NULL;
+	activeSleeper = NULL;
+}
+
+static void silentTone(int frequency, int duration) {
+	tone(8, frequency, duration);
+}
+
+static void silentNoTone() {
+	noTone(8);
+}
+
+static PatternPlayer *activePlayer = NULL;
+
+static void playerTask() {
+	activePlayer->processStep();
+}
+
+static unsigned long playerDeadline() {
+	return activePlayer->getTimeToNextStep();
+}
+
+static void playerCatchUp(unsigned long sleptMs) {
+	activePlayer->processStepMs(sleptMs);
+}
+
+TEST(playerSleepsDeepDuringRests) {
+	HostMcu &mcu = HostMcu::current();
+	PatternPlayer player(silentTone, silentNoTone, 10);
+	activePlayer = &player;
+	int frequencies[] = {440, 0, 880};
+	int durations[] = {100, 2000, 100};
+	player.play(frequencies, durations, 3, 1);
+	TickDispatcher ticker(1000);
+	activeTicker = &ticker;
+	ticker.addTask(playerTask, 10);
+	ticker.begin();
+	SleepManager sleeper;
+	activeSleeper = &sleeper;
+	sleeper.addComponent(playerDeadline, playerCatchUp);
+	while (player.getState() == PLAYING && mcu.getMillis() < 10000) {
+		sleeper.sleep();
+	}
+	CHECK_EQUAL(STOPPED, player.getState());
+	CHECK_NEAR(2200, mcu.getMillis(), 20);
+	CHECK(mcu.getSleepCycles(SLEEP_MODE_PWR_DOWN) > 1900ULL * F_CPU / 1000);
+	CHECK_EQUAL(0, mcu.getToneFrequency(8));
+	ticker.stop();
+	activeTicker = NULL;
+	activeSleeper = NULL;
+}
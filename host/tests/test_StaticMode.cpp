@@ -0,0 +1,126 @@
+#include "HostTest.h"
+#include "HostHeap.h"
+#include "HandledButton.h"
+#include "HandledEventTimer.h"
+#include "PatternPlayer.h"
+#include "SerialProtocol.h"
+#include "SevenSegmentsIndicator.h"
+#include "TraceRecorder.h"
+#include "Voltmeter.h"
+
+//Библиотеки собраны с MYLIB_STATIC (mylib_static): после hostHeapReset() ни один вызов не должен обращаться к куче
+
+static int firedEvents;
+static int tones;
+
+static void onEvent() {
+	firedEvents++;
+}
+
+static void onTone(int frequency, int duration) {
+	tones++;
+}
+
+static void onNoTone() {
+}
+
+static void onDigits(ProtocolFrame &frame) {
+}
+
+static byte segmentPins[8] = {2, 3, 4, 5, 6, 7, 8, 9};
+static byte digitsPins[4] = {10, 11, 12, 13};
+static byte traceBuffer[256];
+static void *volatile heapBlock; //Иначе компилятор выбросит malloc() вместе с free()
+
+TEST(counterSeesAllocations) {
+	hostHeapReset();
+	heapBlock = malloc(10);
+	CHECK_EQUAL(1, hostHeapAllocations());
+	CHECK_EQUAL(10, hostHeapBytes());
+	free(heapBlock);
+	CHECK_EQUAL(1, hostHeapFrees());
+	heapBlock = new int[4];
+	delete[] (int *) heapBlock;
+	CHECK_EQUAL(2, hostHeapAllocations());
+}
+
+TEST(eventTimerWithoutHeap) {
+	hostHeapReset();
+	StaticHandledEventTimer<3> timer(1);
+	firedEvents = 0;
+	CHECK_EQUAL(0, timer.createEvent(5, onEvent));
+	CHECK_EQUAL(1, timer.createRepeatedEvent(2, onEvent, 3));
+	CHECK_EQUAL(2, timer.createEvent(7, onEvent));
+	CHECK_EQUAL(HET_NO_EVENT_ID, timer.createEvent(9, onEvent)); //Массив заполнен
+	timer.start();
+	for (int i = 0; i < 20; i++) {
+		timer.processStep();
+		timer.processHandlers();
+	}
+	CHECK(firedEvents > 0);
+	CHECK_EQUAL(0, hostHeapAllocations());
+}
+
+TEST(voltmeterWithoutHeap) {
+	HostMcu::current().setAdcVoltage(0, 2.5);
+	hostHeapReset();
+	StaticVoltmeter<8> battery(A0);
+	battery.setFilterSamplesCount(32); //Больше буфера нельзя - ограничивается размером буфера
+	for (int i = 0; i < 16; i++) {
+		battery.processMeasurement();
+		battery.getMillivolts();
+	}
+	CHECK_NEAR(2500, battery.getMillivolts(), 10);
+	word samples[2];
+	Voltmeter external(A1, samples, 2);
+	external.processMeasurement();
+	CHECK_EQUAL(0, hostHeapAllocations());
+}
+
+TEST(indicatorWithoutHeap) {
+	hostHeapReset();
+	StaticSevenSegmentsIndicator<4> indicator(segmentPins, digitsPins);
+	indicator.print("12.34");
+	for (int i = 0; i < 8; i++) {
+		indicator.refreshNext();
+	}
+	indicator.print("AbC", false);
+	CHECK_EQUAL(0, hostHeapAllocations());
+}
+
+TEST(playerWithoutHeap) {
+	hostHeapReset();
+	StaticPatternPlayer<8> player(onTone, onNoTone, 1);
+	tones = 0;
+	player.play("@3#440,10%880,10%0,5%!");
+	CHECK_EQUAL(PP_PARSE_OK, player.getParseError());
+	for (int i = 0; i < 40; i++) {
+		player.processStep();
+	}
+	CHECK(tones > 0);
+	player.play("@9#1,1%1,1%1,1%1,1%1,1%1,1%1,1%1,1%1,1%!"); //Не помещается в буфер - ошибка вместо выделения памяти
+	CHECK_EQUAL(PP_PARSE_ERR_TOO_LONG, player.getParseError());
+	CHECK_EQUAL(0, hostHeapAllocations());
+}
+
+TEST(otherLibrariesWithoutHeap) {
+	hostHeapReset();
+	HandledButton button(2, 1);
+	for (int i = 0; i < 10; i++) {
+		button.processStep();
+	}
+	TraceRecorder recorder(traceBuffer, sizeof(traceBuffer), 1000);
+	recorder.addPin(2);
+	recorder.start();
+	recorder.processTick();
+	recorder.recordAdc(0, 512);
+	SerialProtocol protocol(Serial);
+	protocol.addCommand(SPR_CMD_DIGITS, onDigits);
+	byte frame[] = {SPR_SYNC, SPR_CMD_DIGITS, 1, 7, 0};
+	frame[4] = SerialProtocol::crc8(SerialProtocol::crc8(SerialProtocol::crc8(0, frame[1]), frame[2]), frame[3]);
+	for (byte i = 0; i < sizeof(frame); i++) {
+		protocol.feed(frame[i]);
+	}
+	CHECK_EQUAL(1, protocol.getFramesCount());
+	CHECK_EQUAL(0, hostHeapAllocations());
+}
@@ -0,0 +1,148 @@
+#include "HostTest.h"
+#include "TickDispatcher.h"
+#include "HandledButton.h"
+#include <vector>
+
+static TickDispatcher *activeTicker = NULL;
+
+ISR(TIMER2_COMPA_vect) {
+	if (activeTicker != NULL) activeTicker->processTick();
+}
+
+static std::vector<unsigned long> tickLog[3]; //Номера тиков, на которых вызывалась задача
+static unsigned int taskCost = 0;
+
+static void logTask(byte task) {
+	tickLog[task].push_back(activeTicker->getTicksCount());
+}
+
+static void fastTask() {
+	logTask(0);
+}
+
+static void middleTask() {
+	logTask(1);
+}
+
+static void slowTask() {
+	logTask(2);
+	if (taskCost) delayMicroseconds(taskCost);
+}
+
+static void clearLogs() {
+	for (int i = 0; i < 3; i++) tickLog[i].clear();
+	taskCost = 0;
+}
+
+TEST(configuresTimer2Ctc) {
+	TickDispatcher ticker(1000);
+	CHECK(ticker.begin());
+	CHECK_EQUAL(_BV(WGM21), TCCR2A);
+	CHECK_EQUAL(4, TCCR2B & 7); //Предделитель 64
+	CHECK_EQUAL(249, OCR2A);
+	CHECK(TIMSK2 & _BV(OCIE2A));
+	TickDispatcher fine(100);
+	CHECK(fine.begin());
+	CHECK_EQUAL(2, TCCR2B & 7);
+	CHECK_EQUAL(199, OCR2A);
+	TickDispatcher tooLong(20000);
+	CHECK(!tooLong.begin());
+	fine.stop();
+}
+
+TEST(tasksRunAtTheirRates) {
+	clearLogs();
+	TickDispatcher ticker(1000);
+	activeTicker = &ticker;
+	CHECK_EQUAL(0, ticker.addTask(fastTask, 1));
+	CHECK_EQUAL(1, ticker.addTask(middleTask, 2));
+	CHECK_EQUAL(2, ticker.addTask(slowTask, 10));
+	ticker.begin();
+	HostMcu::current().advanceMicros(100500);
+	ticker.stop();
+	activeTicker = NULL;
+	CHECK_EQUAL(100, ticker.getTicksCount());
+	CHECK_EQUAL(100, ticker.getTaskCalls(0));
+	CHECK_EQUAL(50, ticker.getTaskCalls(1));
+	CHECK_EQUAL(10, ticker.getTaskCalls(2));
+	CHECK_EQUAL(0, ticker.getOverrunsCount());
+}
+
+TEST(autoPhaseSpreadsTasks) {
+	clearLogs();
+	TickDispatcher ticker(1000);
+	activeTicker = &ticker;
+	ticker.addTask(middleTask, 2);
+	ticker.addTask(slowTask, 2);
+	CHECK_EQUAL(0, ticker.getTaskPhase(0));
+	CHECK_EQUAL(1, ticker.getTaskPhase(1));
+	ticker.addTask(fastTask, 4, 3);
+	CHECK_EQUAL(3, ticker.getTaskPhase(2));
+	ticker.begin();
+	HostMcu::current().advanceMicros(40500);
+	ticker.stop();
+	activeTicker = NULL;
+	CHECK_EQUAL(20, tickLog[1].size());
+	CHECK_EQUAL(20, tickLog[2].size());
+	for (size_t i = 0; i < tickLog[1].size(); i++) {
+		CHECK_EQUAL(0, tickLog[1][i] % 2);
+		CHECK_EQUAL(1, tickLog[2][i] % 2);
+	}
+	for (size_t i = 0; i < tickLog[0].size(); i++) {
+		CHECK_EQUAL(3, tickLog[0][i] % 4);
+	}
+	TickDispatcher crowded(1000);
+	crowded.addTask(fastTask, 10, 0);
+	crowded.addTask(fastTask, 10, 5);
+	byte phase = crowded.getTaskPhase(crowded.addTask(fastTask, 5));
+	CHECK(phase != 0); //Фаза 0 совпадала бы с обеими задачами
+}
+
+TEST(measuresTaskTime) {
+	clearLogs();
+	TickDispatcher ticker(1000);
+	activeTicker = &ticker;
+	ticker.addTask(fastTask, 1);
+	ticker.addTask(slowTask, 5);
+	taskCost = 200;
+	ticker.begin();
+	HostMcu::current().advanceMillis(50);
+	CHECK_NEAR(200 * 16, ticker.getTaskMaxCycles(1), 64);
+	CHECK_NEAR(200, ticker.getTaskAverageMicros(1), 4);
+	CHECK(ticker.getTaskMaxCycles(0) < 64);
+	CHECK(ticker.getTickMaxCycles() >= ticker.getTaskMaxCycles(1));
+	CHECK_EQUAL(0, ticker.getOverrunsCount());
+	taskCost = 1500; //Дольше тика
+	ticker.resetStatistics();
+	HostMcu::current().advanceMillis(50);
+	ticker.stop();
+	activeTicker = NULL;
+	CHECK(ticker.getOverrunsCount() > 0);
+	CHECK_NEAR(1500 * 16, ticker.getTaskMaxCycles(1), 64);
+	CHECK(ticker.getTickMaxCycles() > 1000 * 16);
+}
+
+static HandledButton *tickedButton = NULL;
+
+static void buttonTask() {
+	tickedButton->processStep();
+}
+
+TEST(drivesHandledButton) {
+	HostMcu &mcu = HostMcu::current();
+	TickDispatcher ticker(1000);
+	HandledButton button(2, 1);
+	tickedButton = &button;
+	activeTicker = &ticker;
+	ticker.addTask(buttonTask);
+	ticker.begin();
+	mcu.setPinInput(2, LOW);
+	mcu.advanceMillis(BTN_DEFAULT_HOLD_TIME + 5);
+	CHECK(button.isPressed());
+	mcu.setPinInput(2, HIGH);
+	mcu.advanceMillis(BTN_DEFAULT_HOLD_TIME + 5);
+	CHECK(!button.isPressed());
+	CHECK(button.isClicked());
+	ticker.stop();
+	activeTicker = NULL;
+}
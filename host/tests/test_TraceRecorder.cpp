@@ -0,0 +1,206 @@
+#include "HostTest.h"
+#include "TraceRecorder.h"
+#include "TraceReplay.h"
+#include "HandledButton.h"
+#include "Voltmeter.h"
+#include <string>
+#include <vector>
+
+#define BUTTON_PIN 2
+
+static byte traceBuffer[2048];
+
+//Нажатие с дребезгом на 1000-м тике (держится 200 тиков) и короткая помеха в 20 тиков на 3000-м
+static byte buttonLevel(unsigned long tick) {
+	if (tick >= 1000 && tick < 1006) return tick & 1;
+	if (tick >= 1006 && tick < 1200) return LOW;
+	if (tick >= 1200 && tick < 1204) return !(tick & 1);
+	if (tick >= 3000 && tick < 3020) return LOW;
+	return HIGH;
+}
+
+static word adcCode(unsigned long tick) {
+	return 512 + (tick * 7919 % 7) - 3; //Шум +-3 единицы
+}
+
+struct LiveResult {
+	std::vector<unsigned long> pressTicks;
+	unsigned long millivolts;
+};
+
+//"Плата": тик - запись, затем библиотеки, как задачи TickDispatcher в порядке добавления
+static LiveResult recordSession(TraceRecorder &recorder, unsigned long ticks, unsigned long holdTime) {
+	HostMcu &mcu = HostMcu::current();
+	HandledButton button(BUTTON_PIN, 1, holdTime);
+	Voltmeter voltmeter(A0);
+	mcu.setPinInput(BUTTON_PIN, HIGH);
+	recorder.addPin(BUTTON_PIN);
+	recorder.start();
+	LiveResult result;
+	for (unsigned long tick = 1; tick <= ticks; tick++) {
+		mcu.advanceMicros(1000);
+		mcu.setPinInput(BUTTON_PIN, buttonLevel(tick));
+		recorder.processTick();
+		boolean wasPressed = button.isPressed();
+		button.processStep();
+		if (button.isPressed() && !wasPressed) result.pressTicks.push_back(tick);
+		if (tick % 10 == 0) {
+			word code = adcCode(tick);
+			recorder.recordAdc(0, code);
+			voltmeter.processSample(code);
+		}
+	}
+	result.millivolts = voltmeter.getMillivolts();
+	return result;
+}
+
+static std::vector<Trace> dumpAndDecode(TraceRecorder &recorder) {
+	Serial.begin(115200);
+	Serial.print("boot\n");
+	recorder.dump(Serial);
+	Serial.print("tail");
+	std::string bytes = HostMcu::current().takeSerialOutput();
+	return decodeTraces((const uint8_t *) bytes.data(), bytes.size());
+}
+
+TEST(replayReproducesLibraries) {
+	TraceRecorder recorder(traceBuffer, sizeof(traceBuffer), 1000);
+	LiveResult live = recordSession(recorder, 4000, 10);
+	CHECK_EQUAL(2, live.pressTicks.size()); //С удержанием 10 мс помеха тоже считается нажатием
+	std::vector<Trace> traces = dumpAndDecode(recorder);
+	CHECK_EQUAL(1, traces.size());
+	const Trace &trace = traces[0];
+	CHECK_EQUAL(1000, trace.tickMicros);
+	CHECK_EQUAL(0, trace.startTick);
+	CHECK_EQUAL(4000, trace.endTick);
+	CHECK_EQUAL(1, trace.pins.size());
+	CHECK_EQUAL(HIGH, trace.startPins);
+
+	HostMcu::current().reset();
+	HandledButton button(BUTTON_PIN, 1, 10);
+	Voltmeter voltmeter(A0);
+	std::vector<unsigned long> pressTicks;
+	TraceReplayer replayer(trace);
+	replayer.setAdcHandler([&](uint8_t channel, uint16_t code) {
+		voltmeter.processSample(code);
+	});
+	replayer.setTickHandler([&]() {
+		boolean wasPressed = button.isPressed();
+		button.processStep();
+		if (button.isPressed() && !wasPressed) pressTicks.push_back(replayer.getTick());
+	});
+	CHECK_EQUAL(4000, replayer.run());
+	CHECK(!replayer.step());
+	CHECK_EQUAL(live.pressTicks.size(), pressTicks.size());
+	for (size_t i = 0; i < pressTicks.size(); i++) {
+		CHECK_EQUAL(live.pressTicks[i], pressTicks[i]);
+	}
+	CHECK_EQUAL(live.millivolts, voltmeter.getMillivolts());
+	CHECK_EQUAL(4000, HostMcu::current().getMillis());
+}
+
+TEST(replayComparesHoldTimes) {
+	TraceRecorder recorder(traceBuffer, sizeof(traceBuffer), 1000);
+	recordSession(recorder, 4000, 10);
+	std::vector<Trace> traces = dumpAndDecode(recorder);
+	CHECK_EQUAL(1, traces.size());
+	unsigned int presses[2] = {0, 0};
+	unsigned long holdTimes[2] = {10, 30};
+	for (int i = 0; i < 2; i++) {
+		HostMcu::current().reset();
+		HandledButton button(BUTTON_PIN, 1, holdTimes[i]);
+		TraceReplayer replayer(traces[0]);
+		replayer.setTickHandler([&]() {
+			boolean wasPressed = button.isPressed();
+			button.processStep();
+			if (button.isPressed() && !wasPressed) presses[i]++;
+		});
+		replayer.run();
+	}
+	CHECK_EQUAL(2, presses[0]);
+	CHECK_EQUAL(1, presses[1]); //Помеха в 20 мс короче удержания
+}
+
+TEST(encodingIsCompact) {
+	TraceRecorder recorder(traceBuffer, sizeof(traceBuffer), 1000);
+	HostMcu &mcu = HostMcu::current();
+	mcu.setPinInput(BUTTON_PIN, HIGH);
+	recorder.addPin(BUTTON_PIN);
+	recorder.start();
+	for (unsigned long tick = 1; tick <= 60000; tick++) {
+		mcu.setPinInput(BUTTON_PIN, buttonLevel(tick % 5000));
+		recorder.processTick();
+	}
+	CHECK_EQUAL(60000, recorder.getTicksCount());
+	CHECK_EQUAL(12 * 14, recorder.getRecordsCount()); //14 смен уровня на каждые 5000 тиков
+	CHECK_EQUAL(12 * (14 * 2 + 3 * 2), recorder.getUsedBytes()); //2 байта на смену, 3 паузы длиннее 62 тиков - ещё по 2 байта
+	CHECK_EQUAL(0, recorder.getDroppedRecordsCount());
+	word used = recorder.getUsedBytes();
+	recorder.recordAdc(3, 1000);
+	recorder.recordAdc(3, 1001);
+	CHECK_EQUAL(6 + 3, recorder.getUsedBytes() - used); //Первый код - через 980 тиков и с разницей от 0, второй - разница в 1 единицу
+	std::vector<Trace> traces = dumpAndDecode(recorder);
+	CHECK_EQUAL(1, traces.size());
+	CHECK_EQUAL(1001, traces[0].events.back().value);
+	CHECK_EQUAL(_BV(3), traces[0].adcChannels);
+}
+
+TEST(ringKeepsNewestRecords) {
+	byte smallBuffer[32];
+	TraceRecorder recorder(smallBuffer, sizeof(smallBuffer), 1000);
+	recorder.start();
+	std::vector<word> codes;
+	for (unsigned long tick = 1; tick <= 500; tick++) {
+		recorder.processTick();
+		if (tick % 5 == 0) {
+			word code = 100 + (tick * tick) % 900;
+			codes.push_back(code);
+			recorder.recordAdc(1, code);
+		}
+		if (tick == 490) recorder.recordMark(7);
+	}
+	CHECK(recorder.getDroppedRecordsCount() > 0);
+	CHECK(recorder.getUsedBytes() <= sizeof(smallBuffer));
+	CHECK_EQUAL(codes.size() + 1, recorder.getRecordsCount() + recorder.getDroppedRecordsCount());
+	std::vector<Trace> traces = dumpAndDecode(recorder);
+	CHECK_EQUAL(1, traces.size());
+	const Trace &trace = traces[0];
+	CHECK(trace.startTick > 0);
+	size_t adcEvents = 0;
+	for (size_t i = 0; i < trace.events.size(); i++) {
+		if (trace.events[i].type == TR_RECORD_ADC) adcEvents++;
+	}
+	CHECK_EQUAL(recorder.getRecordsCount(), trace.events.size());
+	size_t first = codes.size() - adcEvents; //Вытесненные записи ушли в начальное состояние
+	CHECK_EQUAL(codes[first - 1], trace.startCodes[1]);
+	for (size_t i = 0, code = first; i < trace.events.size(); i++) {
+		const TraceEvent &event = trace.events[i];
+		if (event.type == TR_RECORD_MARK) {
+			CHECK_EQUAL(490, event.tick);
+			CHECK_EQUAL(7, event.value);
+			continue;
+		}
+		CHECK_EQUAL(codes[code], event.value);
+		CHECK_EQUAL((code + 1) * 5, event.tick);
+		code++;
+	}
+}
+
+TEST(copiesDumpToMemory) {
+	TraceRecorder recorder(traceBuffer, sizeof(traceBuffer), 500);
+	recordSession(recorder, 1500, 10);
+	byte image[2048];
+	word size = recorder.getDumpSize();
+	CHECK_EQUAL(size, recorder.copyTo(image, sizeof(image)));
+	CHECK_EQUAL(0, recorder.copyTo(image, size - 1));
+	CHECK(recorder.isRecording());
+	std::vector<Trace> traces = decodeTraces(image, size);
+	CHECK_EQUAL(1, traces.size());
+	CHECK_EQUAL(500, traces[0].tickMicros);
+	image[size / 2] ^= 0x10;
+	CHECK_EQUAL(0, decodeTraces(image, size).size()); //Испорченная запись отбрасывается
+	CHECK(!recorder.addPin(3)); //Ноги добавляются только в пустую запись
+	recorder.clear();
+	CHECK(recorder.addPin(3));
+	CHECK_EQUAL(0, recorder.getTicksCount());
+}
@@ -0,0 +1,510 @@
+#include "HostTest.h"
+#include "Voltmeter.h"
+#include "ADCScanner.h"
+#include "VoltmeterBurst.h"
+#include "VoltageWatcher.h"
+#include "AnalogKeypad.h"
+#include "VoltmeterFilters.h"
+#include <math.h>
+
+static ADCScanner *activeScanner = NULL;
+static VoltmeterBurst *activeBurst = NULL;
+static unsigned int burstIsrMicros = 0; //Искусственная длительность обработчика
+static uint64_t burstFirstCycle, burstLastCycle; //Такты и номера преобразований первой и последней записанной выборки
+static unsigned long burstFirstConversion, burstLastConversion;
+
+ISR(ADC_vect) {
+	if (activeScanner != NULL) activeScanner->processInterrupt();
+	if (activeBurst != NULL) {
+		HostMcu &mcu = HostMcu::current();
+		unsigned long before = activeBurst->getCapturedCount();
+		activeBurst->processInterrupt();
+		unsigned long after = activeBurst->getCapturedCount();
+		if (after != before) {
+			if (after == 1) {
+				burstFirstCycle = mcu.getCycles();
+				burstFirstConversion = mcu.getAdcConversionsCount();
+			}
+			burstLastCycle = mcu.getCycles();
+			burstLastConversion = mcu.getAdcConversionsCount();
+		}
+		if (burstIsrMicros) delayMicroseconds(burstIsrMicros);
+	}
+}
+
+static void settle(Voltmeter &voltmeter) { //getVoltage() сглаживает результат между вызовами, как в loop()
+	for (int i = 0; i < 16; i++) {
+		voltmeter.processMeasurement();
+		voltmeter.getVoltage();
+	}
+}
+
+TEST(measuresVoltageThroughDivider) {
+	HostMcu &mcu = HostMcu::current();
+	Voltmeter::invalidateReference();
+	mcu.setAdcVoltage(A2, 2.0);
+	Voltmeter battery(A2, 5., 10000, 10000); //Делитель 1:2
+	CHECK_EQUAL(INPUT, mcu.getPinMode(A2));
+	settle(battery);
+	CHECK_NEAR(4.0, battery.getVoltage(), 0.02);
+	CHECK_NEAR(4000, battery.getMillivolts(), 20);
+	CHECK_NEAR(2.0 / 5 * 1024, battery.readRaw(), 1);
+}
+
+TEST(constructorOnlyTouchesItsPin) {
+	DDRC = 0xFF;
+	Voltmeter sensor(A3);
+	CHECK_EQUAL(0xFF & ~_BV(3), DDRC);
+}
+
+TEST(oversamplingAddsResolution) {
+	HostMcu &mcu = HostMcu::current();
+	Voltmeter::invalidateReference();
+	mcu.setAdcVoltage(A0, 1.2345);
+	mcu.setAdcNoise(1.5); //Передискретизации нужен шум
+	Voltmeter precise(A0, 5., 0, 1, 1);
+	precise.set_CTRL_STAT_REG_VAL(ADC_RATE_1MHz);
+	precise.setOversampling(3);
+	CHECK_EQUAL(13, precise.getEffectiveBits());
+	unsigned long start = mcu.getCycles();
+	precise.processMeasurement();
+	CHECK_EQUAL(64UL * 13 * 16, mcu.getCycles() - start); //64 преобразования по 13 тактов АЦП с предделителем 16
+	CHECK_NEAR(1.2345, precise.getVoltage(), 0.003);
+}
+
+TEST(referenceSwitchesAreCounted) {
+	HostMcu &mcu = HostMcu::current();
+	Voltmeter::invalidateReference();
+	Voltmeter::resetReferenceStatistics();
+	mcu.setAdcVoltage(A0, 0.5);
+	mcu.setAdcVoltage(A1, 3.0);
+	Voltmeter internal(A0, 1.1);
+	Voltmeter external(A1, 5.);
+	internal.enableREFcalibrationPass(4);
+	external.enableREFcalibrationPass(4);
+	Voltmeter *all[] = {&internal, &external, &internal, &external};
+	Voltmeter::measureAll(all, 4);
+	Voltmeter::measureAll(all, 4);
+	CHECK_EQUAL(2, Voltmeter::getReferenceSwitchCount()); //Группировка по источнику: AVCC -> 1.1, затем 1.1 -> AVCC
+	CHECK_EQUAL(3 * 4, Voltmeter::getDiscardedConversionsCount()); //Первое применение источника тоже калибруется
+	settle(internal);
+	settle(external);
+	CHECK_NEAR(0.5, internal.getVoltage(), 0.01);
+	CHECK_NEAR(3.0, external.getVoltage(), 0.02);
+}
+
+TEST(scannerRoundRobinsInInterrupt) {
+	HostMcu &mcu = HostMcu::current();
+	Voltmeter::invalidateReference();
+	mcu.setAdcVoltage(A0, 1.0);
+	mcu.setAdcVoltage(A1, 4.0);
+	Voltmeter first(A0);
+	Voltmeter second(A1);
+	ADCScanner scanner;
+	CHECK(scanner.addVoltmeter(&first));
+	CHECK(scanner.addVoltmeter(&second));
+	activeScanner = &scanner;
+	scanner.start();
+	for (int i = 0; i < 20; i++) {
+		mcu.advanceMillis(5);
+		first.getVoltage();
+		second.getVoltage();
+	}
+	scanner.stop();
+	activeScanner = NULL;
+	CHECK_NEAR(1.0, first.getVoltage(), 0.01);
+	CHECK_NEAR(4.0, second.getVoltage(), 0.01);
+	CHECK(scanner.getConversionsCount(0) > 800); //250 кГц / 13 = 19230 преобразований в секунду на два канала
+	CHECK(scanner.getConversionsCount(1) > 800);
+	unsigned long total = scanner.getTotalConversionsCount();
+	mcu.advanceMillis(10);
+	CHECK_EQUAL(total, scanner.getTotalConversionsCount());
+}
+
+TEST(millivoltsMatchVoltageOverFullRange) {
+	const float references[] = {5., 1.1f, 3.3f};
+	const float dividers[][2] = {{0, 1}, {10000, 10000}, {47000, 4700}}; //Без делителя, 1:2 и 1:11
+	for (byte r = 0; r < 3; r++) {
+		for (byte d = 0; d < 3; d++) {
+			Voltmeter voltmeter(A0, references[r], dividers[d][0], dividers[d][1], 1);
+			double lsbMillivolts = references[r] / 1024. * (dividers[d][0] + dividers[d][1]) / dividers[d][1] * 1000;
+			for (word code = 0; code < 1024; code++) {
+				voltmeter.processSample(code);
+				double millivolts = voltmeter.getMillivolts();
+				double volts = voltmeter.getVoltage();
+				CHECK_NEAR(1000 * volts, millivolts, lsbMillivolts);
+				CHECK_NEAR(code * lsbMillivolts, millivolts, lsbMillivolts);
+			}
+		}
+	}
+}
+
+//Первая выборка заполняет состояние ступени значением from, затем samples выборок со значением to. Возвращает последний выход
+template <class Stage> static word stepResponse(word from, word to, int samples) {
+	Stage stage;
+	word output = 0;
+	stage.process(from, output);
+	for (int i = 0; i < samples; i++) {
+		stage.process(to, output);
+	}
+	return output;
+}
+
+template <class Stage> static boolean reachesInput() {
+	const word steps[][2] = {{0, 1000}, {1000, 0}, {500, 501}, {501, 500}, {0, 1}, {1023, 1022}, {0, 1023}, {1023, 0}};
+	for (byte i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+		if (stepResponse<Stage>(steps[i][0], steps[i][1], 20000) != steps[i][1]) return false; //20 постоянных времени самой медленной ступени
+	}
+	return true;
+}
+
+TEST(filterStagesReachInputExactly) {
+	CHECK(reachesInput<MovingAverageStage<8> >());
+	CHECK(reachesInput<MovingAverageStage<5> >());
+	CHECK(reachesInput<EMAStage<4> >());
+	CHECK(reachesInput<EMAStage<10> >());
+	CHECK(reachesInput<MedianStage<5> >());
+	CHECK((reachesInput<IIRStage<1, 8> >())); //Самый медленный: 1/256 за выборку
+	CHECK((reachesInput<IIRStage<16, 8> >()));
+	CHECK((reachesInput<IIRStage<255, 8> >()));
+	CHECK((reachesInput<IIRStage<1, 1> >()));
+	CHECK((reachesInput<IIRStage<3, 4> >()));
+	CHECK((reachesInput<FilterChain<MedianStage<3>, EMAStage<4> > >()));
+	CHECK_EQUAL(1000, (stepResponse<IIRStage<1, 8> >(0, 1000, 5000)));
+}
+
+TEST(medianRejectsSingleSpike) {
+	MedianStage<3> median;
+	word output;
+	for (int i = 0; i < 10; i++) {
+		CHECK(median.process(i == 5 ? 1023 : 500, output));
+		CHECK_EQUAL(500, output);
+	}
+	MedianStage<5> wide;
+	for (int i = 0; i < 10; i++) {
+		wide.process(i == 4 || i == 5 ? 0 : 700, output); //Два выброса подряд - меньше половины окна
+		CHECK_EQUAL(700, output);
+	}
+}
+
+TEST(decimatorOutputRate) {
+	DecimatorStage<4> decimator;
+	word output = 0;
+	int outputs = 0;
+	for (int i = 0; i < 100; i++) {
+		if (decimator.process(i, output)) {
+			outputs++;
+			CHECK_EQUAL(i - 1.5 - 0.5, output); //Среднее i-3..i = i - 1.5, деление целочисленное
+		}
+	}
+	CHECK_EQUAL(25, outputs);
+	FilterChain<DecimatorStage<4>, DecimatorStage<2> > chain;
+	outputs = 0;
+	for (int i = 0; i < 100; i++) {
+		if (chain.process(300, output)) {
+			outputs++;
+			CHECK_EQUAL(300, output);
+			CHECK_EQUAL(7, i % 8);
+		}
+	}
+	CHECK_EQUAL(12, outputs);
+}
+
+//На AVR ступень занимает avrBytes, на компьютере ступень с 32-битным накопителем выравнивается на 4 байта
+#define CHECK_STAGE_RAM(avrBytes, ...) CHECK_EQUAL(((avrBytes) + 3) & ~3, sizeof(__VA_ARGS__))
+
+TEST(filterStagesRamMatchesDocumentation) {
+	CHECK_STAGE_RAM(2 * 8 + 6, MovingAverageStage<8>);
+	CHECK_STAGE_RAM(2 * 3 + 6, MovingAverageStage<3>);
+	CHECK_STAGE_RAM(5, EMAStage<4>);
+	CHECK_STAGE_RAM(5, IIRStage<16, 8>);
+	CHECK_STAGE_RAM(5, DecimatorStage<4>);
+	CHECK_EQUAL(2 * 3 + 2, sizeof(MedianStage<3>)); //Без 32-битных полей - без выравнивания
+	CHECK_EQUAL(2 * 9 + 2, sizeof(MedianStage<9>));
+	CHECK_EQUAL(sizeof(MedianStage<3>) + sizeof(EMAStage<4>), (sizeof(FilterChain<MedianStage<3>, EMAStage<4> >)));
+}
+
+static void runBurst(VoltmeterBurst &burst, word *buffer, word length, byte adcRate) {
+	activeBurst = &burst;
+	CHECK(burst.start(buffer, length, adcRate));
+	for (int i = 0; i < 1000 && !burst.isDone(); i++) HostMcu::current().advanceMillis(1);
+	activeBurst = NULL;
+	CHECK(burst.isDone());
+	CHECK_EQUAL(length, burst.getCapturedCount());
+}
+
+TEST(burstStatisticsMatchCapturedBuffer) {
+	HostMcu &mcu = HostMcu::current();
+	Voltmeter::invalidateReference();
+	mcu.setAdcWaveform(A1, [](double seconds) { return (float) (2.5 + 1.5 * sin(2 * M_PI * 1000 * seconds)); });
+	mcu.setAdcNoise(2);
+	Voltmeter probe(A1, 5.);
+	VoltmeterBurst burst(&probe);
+	word buffer[500];
+	burstIsrMicros = 0;
+	runBurst(burst, buffer, 500, ADC_RATE_1MHz);
+	word minimum = 1023, maximum = 0;
+	double sum = 0, sumSquares = 0;
+	for (word i = 0; i < 500; i++) {
+		if (buffer[i] < minimum) minimum = buffer[i];
+		if (buffer[i] > maximum) maximum = buffer[i];
+		sum += buffer[i];
+		sumSquares += (double) buffer[i] * buffer[i];
+	}
+	VoltmeterStatistics &statistics = burst.getStatistics();
+	CHECK_EQUAL(500, statistics.getCount());
+	CHECK_EQUAL(minimum, statistics.getMin());
+	CHECK_EQUAL(maximum, statistics.getMax());
+	CHECK_EQUAL(maximum - minimum, statistics.getPeakToPeak());
+	CHECK(maximum - minimum > 500); //Буфер действительно захватил синусоиду
+	CHECK_NEAR(sum / 500, statistics.getMean(), 0.01);
+	CHECK_NEAR(sqrt(sumSquares / 500), statistics.getRMS(), 0.01);
+	CHECK_NEAR(Voltmeter::conversionRateFor(ADC_RATE_1MHz), burst.getSampleRate(), 100);
+	CHECK_EQUAL(0, burst.getOverruns());
+	CHECK_EQUAL(burstLastConversion - burstFirstConversion + 1, 500); //Ни одно преобразование не пропущено
+}
+
+TEST(statisticsSurviveLongRuns) {
+	VoltmeterStatistics statistics;
+	for (unsigned long i = 0; i < 10000; i++) { //Квадраты 1023 переполняют 32 бита примерно через 4100 выборок
+		statistics.add(1023);
+		statistics.add(0);
+	}
+	CHECK_EQUAL(20000, statistics.getCount());
+	CHECK_NEAR(511.5, statistics.getMean(), 0.01);
+	CHECK_NEAR(1023 / sqrt(2.), statistics.getRMS(), 0.01);
+	statistics.reset();
+	for (unsigned long i = 0; i < VST_MAX_COUNT + 100; i++) {
+		statistics.add(1023);
+	}
+	CHECK_EQUAL(VST_MAX_COUNT, statistics.getCount());
+	CHECK_NEAR(1023, statistics.getMean(), 0.01);
+	CHECK_NEAR(1023, statistics.getRMS(), 0.01);
+}
+
+TEST(burstReportsOverrunsWhenIsrTooSlow) {
+	HostMcu &mcu = HostMcu::current();
+	Voltmeter::invalidateReference();
+	mcu.setAdcVoltage(A1, 1.0);
+	Voltmeter probe(A1, 5.);
+	VoltmeterBurst burst(&probe);
+	word buffer[200];
+	burstIsrMicros = 10; //Преобразование на 4 МГц длится 3.25 мкс, обработчик - 10 мкс
+	runBurst(burst, buffer, 200, ADC_RATE_4MHz);
+	burstIsrMicros = 0;
+	double seconds = (double) (burstLastCycle - burstFirstCycle) / F_CPU;
+	CHECK_NEAR(199 / seconds, burst.getSampleRate(), 199 / seconds * 0.01);
+	CHECK(burst.getSampleRate() < Voltmeter::conversionRateFor(ADC_RATE_4MHz) / 2);
+	unsigned long missed = burstLastConversion - burstFirstConversion + 1 - 200; //Преобразования, завершившиеся без записи
+	CHECK(missed > 200);
+	CHECK_NEAR(missed, burst.getOverruns(), 2);
+}
+
+static int risingCalls, fallingCalls, inWindowCalls;
+
+static void onRising() {
+	risingCalls++;
+}
+
+static void onFalling() {
+	fallingCalls++;
+}
+
+static void onInWindow() {
+	inWindowCalls++;
+}
+
+static void attachCounters(VoltageWatcher &watcher) {
+	risingCalls = 0;
+	fallingCalls = 0;
+	inWindowCalls = 0;
+	watcher.attachHandlerToRising(onRising);
+	watcher.attachHandlerToFalling(onFalling);
+	watcher.attachHandlerToInWindow(onInWindow);
+}
+
+static void feedMillivolts(Voltmeter &meter, word millivolts) { //Опорное 5 В без делителя: код = мВ * 1024 / 5000
+	meter.processSample((unsigned long) millivolts * 1024 / 5000);
+}
+
+static boolean handlersCalled(Voltmeter &meter, int rising, int falling, int inWindow) {
+	meter.processHandlers();
+	return risingCalls == rising && fallingCalls == falling && inWindowCalls == inWindow;
+}
+
+TEST(watcherFiresOnThresholdCrossing) {
+	Voltmeter meter(A0, 5., 0, 1, 1);
+	VoltageWatcher watcher(2000, 3000);
+	attachCounters(watcher);
+	meter.addWatcher(&watcher);
+	CHECK_EQUAL(VW_ZONE_UNKNOWN, watcher.getZone());
+	feedMillivolts(meter, 2500);
+	CHECK_EQUAL(VW_ZONE_INSIDE, watcher.getZone());
+	CHECK(handlersCalled(meter, 0, 0, 0)); //Первое значение только определяет область
+	feedMillivolts(meter, 3200);
+	feedMillivolts(meter, 3400);
+	CHECK_EQUAL(VW_ZONE_ABOVE, watcher.getZone());
+	CHECK(handlersCalled(meter, 1, 0, 0));
+	CHECK(handlersCalled(meter, 1, 0, 0)); //Флаг сброшен после вызова
+	feedMillivolts(meter, 2500);
+	CHECK(handlersCalled(meter, 1, 0, 1));
+	feedMillivolts(meter, 1500);
+	CHECK_EQUAL(VW_ZONE_BELOW, watcher.getZone());
+	CHECK(handlersCalled(meter, 1, 1, 1));
+	feedMillivolts(meter, 3500); //Прямо из-под окна выше окна
+	CHECK_EQUAL(VW_ZONE_ABOVE, watcher.getZone());
+	CHECK(handlersCalled(meter, 2, 1, 1));
+}
+
+TEST(watcherHysteresisIgnoresBounce) {
+	Voltmeter meter(A0, 5., 0, 1, 1);
+	VoltageWatcher watcher(2000, 3000, 200);
+	attachCounters(watcher);
+	meter.addWatcher(&watcher);
+	feedMillivolts(meter, 2500);
+	feedMillivolts(meter, 1900);
+	CHECK(handlersCalled(meter, 0, 1, 0));
+	word belowBounce[] = {2100, 1950, 2150, 1990, 2190};
+	for (word millivolts : belowBounce) {
+		feedMillivolts(meter, millivolts);
+		CHECK_EQUAL(VW_ZONE_BELOW, watcher.getZone());
+	}
+	CHECK(handlersCalled(meter, 0, 1, 0));
+	feedMillivolts(meter, 2250);
+	CHECK_EQUAL(VW_ZONE_INSIDE, watcher.getZone());
+	CHECK(handlersCalled(meter, 0, 1, 1));
+	feedMillivolts(meter, 3100);
+	CHECK(handlersCalled(meter, 1, 1, 1));
+	word aboveBounce[] = {2900, 3050, 2850, 2990, 2810};
+	for (word millivolts : aboveBounce) {
+		feedMillivolts(meter, millivolts);
+		CHECK_EQUAL(VW_ZONE_ABOVE, watcher.getZone());
+	}
+	CHECK(handlersCalled(meter, 1, 1, 1));
+	feedMillivolts(meter, 2750);
+	CHECK_EQUAL(VW_ZONE_INSIDE, watcher.getZone());
+	CHECK(handlersCalled(meter, 1, 1, 2));
+}
+
+TEST(watcherWaitsForHoldCount) {
+	Voltmeter meter(A0, 5., 0, 1, 1);
+	VoltageWatcher watcher(2000, 3000, 0, 3);
+	attachCounters(watcher);
+	meter.addWatcher(&watcher);
+	feedMillivolts(meter, 2500);
+	feedMillivolts(meter, 3200);
+	feedMillivolts(meter, 3200); //Меньше времени удержания
+	CHECK_EQUAL(VW_ZONE_INSIDE, watcher.getZone());
+	CHECK(handlersCalled(meter, 0, 0, 0));
+	feedMillivolts(meter, 2500); //Возврат сбрасывает счёт
+	feedMillivolts(meter, 3200);
+	feedMillivolts(meter, 3200);
+	CHECK_EQUAL(VW_ZONE_INSIDE, watcher.getZone());
+	CHECK(handlersCalled(meter, 0, 0, 0));
+	feedMillivolts(meter, 3200); //Ровно время удержания
+	CHECK_EQUAL(VW_ZONE_ABOVE, watcher.getZone());
+	CHECK(handlersCalled(meter, 1, 0, 0));
+	feedMillivolts(meter, 1500);
+	feedMillivolts(meter, 1500);
+	CHECK(handlersCalled(meter, 1, 0, 0));
+	feedMillivolts(meter, 1500);
+	CHECK_EQUAL(VW_ZONE_BELOW, watcher.getZone());
+	CHECK(handlersCalled(meter, 1, 1, 0));
+	CHECK(!watcher.isFallen()); //Обработчик уже сбросил флаг
+}
+
+#define KEYPAD_STEP_MS 10
+
+static const word ladderCodes[] = {0, 256, 512, 768}; //Ничего не нажато - 1023, граница с последней кнопкой - на 895.5
+static int keyPushDowns[4], keyPullUps[4], keyChanges[4];
+
+static void onKeyPushDown(byte key) {
+	keyPushDowns[key]++;
+}
+
+static void onKeyPullUp(byte key) {
+	keyPullUps[key]++;
+}
+
+static void onKeyChange(byte key) {
+	keyChanges[key]++;
+}
+
+static void setLadderCode(word code) {
+	HostMcu::current().setAdcVoltage(A3, (code + 0.25) * 5. / 1024);
+}
+
+static void runKeypadSteps(AnalogKeypad &keypad, int steps) {
+	for (int i = 0; i < steps; i++) {
+		keypad.processStep();
+		delay(KEYPAD_STEP_MS);
+	}
+}
+
+TEST(keypadDecodesLadderBands) {
+	Voltmeter ladder(A3, 5.);
+	AnalogKeypad keypad(&ladder, ladderCodes, 4, KEYPAD_STEP_MS);
+	for (byte key = 0; key < 4; key++) {
+		CHECK_EQUAL(key, keypad.decode(ladderCodes[key]));
+	}
+	CHECK_EQUAL(0, keypad.decode(127)); //Граница - посередине между соседними кодами
+	CHECK_EQUAL(1, keypad.decode(128));
+	CHECK_EQUAL(1, keypad.decode(383));
+	CHECK_EQUAL(2, keypad.decode(384));
+	CHECK_EQUAL(3, keypad.decode(895));
+	for (word code = 896; code <= 1023; code++) { //Между последней кнопкой и отпущенной клавиатурой
+		CHECK_EQUAL(AKP_NO_KEY, keypad.decode(code));
+	}
+	CHECK_EQUAL(AKP_NO_KEY, keypad.decode(2000));
+}
+
+TEST(keypadDebouncesEveryKey) {
+	Voltmeter::invalidateReference();
+	setLadderCode(1023);
+	Voltmeter ladder(A3, 5.);
+	AnalogKeypad keypad(&ladder, ladderCodes, 4, KEYPAD_STEP_MS);
+	keypad.attachHandlerToPushDown(onKeyPushDown);
+	keypad.attachHandlerToPullUp(onKeyPullUp);
+	keypad.attachHandlerToChange(onKeyChange);
+	for (byte key = 0; key < 4; key++) {
+		keyPushDowns[key] = 0;
+		keyPullUps[key] = 0;
+		keyChanges[key] = 0;
+	}
+	runKeypadSteps(keypad, 5);
+	CHECK_EQUAL(AKP_NO_KEY, keypad.getPressedKey());
+	for (byte key = 0; key < 4; key++) {
+		setLadderCode(ladderCodes[key] + 20); //Лестница не попадает точно в код кнопки
+		runKeypadSteps(keypad, 3); //Смена показаний и 20 мс стабильности - меньше AKP_DEFAULT_HOLD_TIME
+		CHECK(!keypad.isPressed(key));
+		setLadderCode(1023); //Дребезг
+		runKeypadSteps(keypad, 1);
+		setLadderCode(ladderCodes[key] + 20);
+		runKeypadSteps(keypad, 3);
+		CHECK(!keypad.isPressed(key));
+		runKeypadSteps(keypad, 1); //Ровно 30 мс стабильности
+		CHECK(keypad.isPressed(key));
+		CHECK_EQUAL(key, keypad.getPressedKey());
+		keypad.processHandlers();
+		CHECK_EQUAL(1, keyPushDowns[key]);
+		CHECK_EQUAL(0, keyPullUps[key]);
+		CHECK_EQUAL(1, keyChanges[key]);
+		runKeypadSteps(keypad, 20);
+		CHECK(!keypad.isClicked(key));
+		setLadderCode(1023);
+		runKeypadSteps(keypad, 4);
+		CHECK(!keypad.isPressed(key));
+		keypad.processHandlers();
+		CHECK_EQUAL(1, keyPullUps[key]);
+		CHECK_EQUAL(2, keyChanges[key]);
+		CHECK(keypad.isClicked(key));
+		CHECK(!keypad.isClicked(key));
+		CHECK(keypad.getTimeInLastState() >= 200);
+	}
+	for (byte key = 0; key < 4; key++) {
+		CHECK_EQUAL(1, keyPushDowns[key]); //Другие кнопки не срабатывали
+	}
+	setLadderCode(950); //Напряжение между последней кнопкой и отпущенной клавиатурой
+	runKeypadSteps(keypad, 10);
+	CHECK_EQUAL(AKP_NO_KEY, keypad.getPressedKey());
+}